@@ -73,6 +73,7 @@ int QAlsaAudioSink::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        ++m_xrunCount;
         errorState = QAudio::UnderrunError;
         emit errorChanged(errorState);
         err = snd_pcm_prepare(handle);
@@ -154,14 +155,16 @@ void QAlsaAudioSink::start(QIODevice* device)
     }
 
     close();
+    m_callback.reset();
 
     pullMode = true;
     audioSource = device;
 
     connect(audioSource, &QIODevice::readyRead, timer, [this] {
-        if (!timer->isActive()) {
+        if (m_audioThread)
+            userFeed();
+        else if (!timer->isActive())
             timer->start(period_time / 1000);
-        }
     });
     deviceState = QAudio::ActiveState;
 
@@ -184,6 +187,7 @@ QIODevice* QAlsaAudioSink::start()
     }
 
     close();
+    m_callback.reset();
 
     audioSource = new AlsaOutputPrivate(this);
     audioSource->open(QIODevice::WriteOnly|QIODevice::Unbuffered);
@@ -198,6 +202,36 @@ QIODevice* QAlsaAudioSink::start()
     return audioSource;
 }
 
+bool QAlsaAudioSink::startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback)
+{
+    if(deviceState != QAudio::StoppedState)
+        deviceState = QAudio::StoppedState;
+
+    errorState = QAudio::NoError;
+
+    // Handle change of mode
+    if(audioSource && !pullMode) {
+        delete audioSource;
+        audioSource = 0;
+    }
+
+    close();
+
+    pullMode = true;
+    audioSource = nullptr;
+    m_callback = std::move(callback);
+
+    // The callback keeps the stream active until it is stopped
+    deviceState = QAudio::ActiveState;
+
+    if (!open())
+        m_callback.reset();
+
+    emit stateChanged(deviceState);
+
+    return true;
+}
+
 void QAlsaAudioSink::stop()
 {
     if(deviceState == QAudio::StoppedState)
@@ -205,6 +239,7 @@ void QAlsaAudioSink::stop()
     errorState = QAudio::NoError;
     deviceState = QAudio::StoppedState;
     close();
+    m_callback.reset();
     emit stateChanged(deviceState);
 }
 
@@ -274,7 +309,8 @@ bool QAlsaAudioSink::open()
         }
     }
     if ( !fatal ) {
-        err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        err = usesAudioThread() ? QAlsaAudioThread::setAccess(handle, hwparams)
+                                : snd_pcm_hw_params_set_access( handle, hwparams, access );
         if ( err < 0 ) {
             fatal = true;
             errMessage = QString::fromLatin1("QAudioSink: snd_pcm_hw_params_set_access: err = %1").arg(err);
@@ -391,26 +427,46 @@ bool QAlsaAudioSink::open()
     // Step 4: Prepare audio
     if(audioBuffer == 0)
         audioBuffer = new char[snd_pcm_frames_to_bytes(handle,buffer_frames)];
+    // The audio thread renders the QIODevice modes from the ring buffer only, pull mode
+    // fills it from the device on this thread
+    if (!m_callback && usesAudioThread())
+        m_ringBuffer = std::make_unique<QtPrivate::QAudioRingBuffer<char>>(buffer_size);
     snd_pcm_prepare( handle );
-    snd_pcm_start(handle);
+    // The audio thread starts the playback with the first period it commits
+    if (!usesAudioThread())
+        snd_pcm_start(handle);
 
     // Step 5: Setup timer
     bytesAvailable = bytesFree();
 
-    // Step 6: Start audio processing
-    timer->start(period_time/1000);
-
     elapsedTimeOffset = 0;
     errorState  = QAudio::NoError;
     totalTimeValue = 0;
+    m_xrunCount = 0;
     opened = true;
 
+    // Step 6: Start audio processing
+    if (usesAudioThread()) {
+        // Have the first periods ready when the thread starts
+        if (pullMode && m_ringBuffer) {
+            fillRingBuffer();
+            if (!opened)
+                return false; // the device failed and closed the stream
+        }
+        startAudioThread();
+        if (pullMode && m_ringBuffer)
+            timer->start(period_time/1000);
+    } else {
+        timer->start(period_time/1000);
+    }
+
     return true;
 }
 
 void QAlsaAudioSink::close()
 {
     timer->stop();
+    stopAudioThread();
 
     if ( handle ) {
         snd_pcm_drain( handle );
@@ -418,6 +474,7 @@ void QAlsaAudioSink::close()
         handle = 0;
         delete [] audioBuffer;
         audioBuffer=0;
+        m_ringBuffer.reset();
     }
     if(!pullMode && audioSource) {
         delete audioSource;
@@ -434,6 +491,14 @@ qsizetype QAlsaAudioSink::bytesFree() const
     if(deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
         return 0;
 
+    if (usesAudioThread()) {
+        // Only push mode takes data from the application
+        if (!m_ringBuffer || pullMode)
+            return 0;
+        const int free = m_ringBuffer->free();
+        return free - free % settings.bytesPerFrame();
+    }
+
     int frames = snd_pcm_avail_update(handle);
     if (frames == -EPIPE) {
         // Try and handle buffer underrun
@@ -452,6 +517,29 @@ qsizetype QAlsaAudioSink::bytesFree() const
     return snd_pcm_frames_to_bytes(handle, frames);
 }
 
+QSpan<char> QAlsaAudioSink::beginWrite(qsizetype maxSize)
+{
+    // Only the ring buffer of the audio thread can be lent, snd_pcm_writei() copies anyway
+    if (!m_ringBuffer || pullMode)
+        return {};
+
+    const qsizetype space = bytesFree();
+    if (!space)
+        return {};
+
+    return m_ringBuffer->acquireWriteRegion(int(qMin(maxSize, space)));
+}
+
+void QAlsaAudioSink::commitWrite(qsizetype bytes)
+{
+    if (!m_ringBuffer || bytes <= 0)
+        return;
+
+    // The audio thread renders it, and updates the state
+    resuming = false;
+    m_ringBuffer->releaseWriteRegion(int(bytes));
+}
+
 qint64 QAlsaAudioSink::write( const char *data, qint64 len )
 {
     // Write out some audio data
@@ -467,6 +555,12 @@ qint64 QAlsaAudioSink::write( const char *data, qint64 len )
     if (!space)
         return 0;
 
+    if (m_ringBuffer) {
+        // The audio thread renders it, and updates the state
+        resuming = false;
+        return m_ringBuffer->write(QSpan<const char>(data, qMin<qint64>(len, space)));
+    }
+
     if (len < space)
         space = len;
 
@@ -528,9 +622,11 @@ void QAlsaAudioSink::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            err = snd_pcm_start(handle);
-            if(err < 0)
-                xrun_recovery(err);
+            if (!usesAudioThread()) {
+                err = snd_pcm_start(handle);
+                if(err < 0)
+                    xrun_recovery(err);
+            }
 
             bytesAvailable = (int)snd_pcm_frames_to_bytes(handle, buffer_frames);
         }
@@ -538,7 +634,13 @@ void QAlsaAudioSink::resume()
 
         deviceState = suspendedInState;
         errorState = QAudio::NoError;
-        timer->start(period_time/1000);
+        if (usesAudioThread()) {
+            startAudioThread();
+            if (pullMode && m_ringBuffer)
+                timer->start(period_time/1000);
+        } else {
+            timer->start(period_time/1000);
+        }
         emit stateChanged(deviceState);
     }
 }
@@ -557,6 +659,7 @@ void QAlsaAudioSink::suspend()
 {
     if(deviceState == QAudio::ActiveState || deviceState == QAudio::IdleState || resuming) {
         suspendedInState = deviceState;
+        stopAudioThread();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -569,6 +672,12 @@ void QAlsaAudioSink::userFeed()
 {
     if(deviceState == QAudio::StoppedState || deviceState == QAudio::SuspendedState)
         return;
+
+    if (m_audioThread) {
+        if (pullMode && m_ringBuffer)
+            fillRingBuffer();
+        return;
+    }
 #ifdef DEBUG_AUDIO
     QTime now(QTime::currentTime());
     qDebug()<<now.second()<<"s "<<now.msec()<<"ms :userFeed() OUT";
@@ -653,12 +762,150 @@ bool QAlsaAudioSink::deviceReady()
 
 void QAlsaAudioSink::reset()
 {
+    stopAudioThread();
+
     if(handle)
         snd_pcm_reset(handle);
 
     stop();
 }
 
+quint64 QAlsaAudioSink::xrunCount() const
+{
+    return m_xrunCount + (m_audioThread ? m_audioThread->xrunCount() : 0);
+}
+
+bool QAlsaAudioSink::usesAudioThread() const
+{
+    return m_callback || QAlsaAudioThread::isEnabledForIODevices();
+}
+
+void QAlsaAudioSink::startAudioThread()
+{
+    Q_ASSERT(handle);
+    if (m_audioThread)
+        return;
+
+    m_starved = deviceState == QAudio::IdleState;
+    m_audioThread = std::make_unique<QAlsaAudioThread>(
+            handle, period_frames,
+            [this](char *data, qsizetype bytes) { renderPeriod(data, bytes); },
+            [this] {
+                QMetaObject::invokeMethod(
+                        this, [this, thread = QThread::currentThread()] {
+                            onAudioThreadFailed(thread);
+                        }, Qt::QueuedConnection);
+            });
+    m_audioThread->start(QThread::TimeCriticalPriority);
+}
+
+void QAlsaAudioSink::stopAudioThread()
+{
+    if (!m_audioThread)
+        return;
+
+    m_audioThread->stop();
+    m_xrunCount += m_audioThread->xrunCount();
+    m_audioThread.reset();
+}
+
+void QAlsaAudioSink::fillRingBuffer()
+{
+    // Reads the device of pull mode on this thread, the audio thread only takes from the ring
+    while (true) {
+        const auto region = m_ringBuffer->acquireWriteRegion(m_ringBuffer->free());
+        if (region.isEmpty())
+            return;
+
+        const qint64 read = audioSource->read(region.data(), region.size());
+        if (read < 0) {
+            close();
+            deviceState = QAudio::StoppedState;
+            errorState = QAudio::IOError;
+            emit errorChanged(errorState);
+            emit stateChanged(deviceState);
+            return;
+        }
+        if (read == 0)
+            return;
+
+        resuming = false;
+        m_ringBuffer->releaseWriteRegion(int(read));
+        if (read < region.size())
+            return;
+    }
+}
+
+void QAlsaAudioSink::renderPeriod(char *data, qsizetype bytes)
+{
+    // Runs on the audio thread; the members it uses only change while the thread is stopped.
+    // It doesn't touch the QIODevice of pull mode, which may block or belong to the user.
+    qsizetype filled = 0;
+
+    if (m_callback) {
+        QtAudioPrivate::runAudioCallback(*m_callback, data, bytes);
+        filled = bytes;
+    } else {
+        m_ringBuffer->consume(bytes, [&](QSpan<const char> region) {
+            memcpy(data + filled, region.data(), region.size());
+            filled += region.size();
+        });
+    }
+
+    if (filled < bytes)
+        memset(data + filled, settings.sampleFormat() == QAudioFormat::UInt8 ? 0x80 : 0,
+               bytes - filled);
+
+    const qreal volume = m_volume;
+    if (volume < 1.0f)
+        QAudioHelperInternal::qMultiplySamples(volume, settings, data, data, filled);
+
+    totalTimeValue += snd_pcm_bytes_to_frames(handle, filled);
+
+    const bool starved = filled == 0;
+    if (m_starved.exchange(starved, std::memory_order_relaxed) != starved) {
+        QMetaObject::invokeMethod(
+                this, [this, thread = QThread::currentThread(), starved] {
+                    onAudioThreadStarved(thread, starved);
+                }, Qt::QueuedConnection);
+    }
+}
+
+void QAlsaAudioSink::onAudioThreadStarved(QThread *thread, bool starved)
+{
+    // Ignore the notifications of the threads that have been stopped since
+    if (m_audioThread.get() != thread)
+        return;
+
+    if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+        return;
+
+    if (starved) {
+        const bool atEnd = pullMode && audioSource && audioSource->atEnd();
+        errorState = atEnd ? QAudio::NoError : QAudio::UnderrunError;
+        emit errorChanged(errorState);
+        deviceState = QAudio::IdleState;
+    } else {
+        errorState = QAudio::NoError;
+        deviceState = QAudio::ActiveState;
+    }
+    emit stateChanged(deviceState);
+}
+
+void QAlsaAudioSink::onAudioThreadFailed(QThread *thread)
+{
+    // Ignore the failures of the threads that have been stopped since
+    if (m_audioThread.get() != thread)
+        return;
+
+    close();
+    m_callback.reset();
+    errorState = QAudio::FatalError;
+    emit errorChanged(errorState);
+    deviceState = QAudio::StoppedState;
+    emit stateChanged(deviceState);
+}
+
 AlsaOutputPrivate::AlsaOutputPrivate(QAlsaAudioSink* audio)
 {
     audioDevice = qobject_cast<QAlsaAudioSink*>(audio);
@@ -28,10 +28,17 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodevice.h>
 #include <private/qaudiosystem_p.h>
+#include <private/qaudioringbuffer_p.h>
+
+#include "qalsaaudiothread_p.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
 
 QT_BEGIN_NAMESPACE
 
-class QAlsaAudioSink : public QPlatformAudioSink
+class Q_MULTIMEDIA_EXPORT QAlsaAudioSink : public QPlatformAudioSink
 {
     friend class AlsaOutputPrivate;
     Q_OBJECT
@@ -57,7 +64,11 @@ public:
     QAudioFormat format() const override;
     void setVolume(qreal) override;
     qreal volume() const override;
+    bool startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback) override;
+    QSpan<char> beginWrite(qsizetype maxSize) override;
+    void commitWrite(qsizetype bytes) override;
 
+    quint64 xrunCount() const override;
 
     QIODevice* audioSource = nullptr;
     QAudioFormat settings;
@@ -78,7 +89,7 @@ private:
     bool resuming = false;
     int buffer_size = 0;
     int period_size = 0;
-    qint64 totalTimeValue = 0;
+    std::atomic<qint64> totalTimeValue = 0;
     unsigned int buffer_time = 100000;
     unsigned int period_time = 20000;
     snd_pcm_uframes_t buffer_frames;
@@ -89,6 +100,16 @@ private:
     bool open();
     void close();
 
+    bool usesAudioThread() const;
+    void startAudioThread();
+    void stopAudioThread();
+    // Runs on the owning thread, so the ring buffer covers stalls of that thread in pull mode
+    // only for as long as the data it holds lasts
+    void fillRingBuffer();
+    void renderPeriod(char *data, qsizetype bytes);
+    void onAudioThreadStarved(QThread *thread, bool starved);
+    void onAudioThreadFailed(QThread *thread);
+
     QTimer* timer = nullptr;
     QByteArray m_device;
     int bytesAvailable = 0;
@@ -97,7 +118,17 @@ private:
     snd_pcm_t* handle = nullptr;
     snd_pcm_access_t access = SND_PCM_ACCESS_RW_INTERLEAVED;
     snd_pcm_hw_params_t *hwparams = nullptr;
-    qreal m_volume = 1.0f;
+    std::atomic<qreal> m_volume = 1.0f;
+
+    // Set while started with a callback, which renders the audio on m_audioThread
+    std::optional<QtAudioPrivate::AudioSinkCallback> m_callback;
+    // Runs the callback, and with QT_ALSA_AUDIO_THREAD the QIODevice modes too
+    std::unique_ptr<QAlsaAudioThread> m_audioThread;
+    // Holds the data written in push mode, or read from the device in pull mode, until the
+    // audio thread renders it
+    std::unique_ptr<QtPrivate::QAudioRingBuffer<char>> m_ringBuffer;
+    std::atomic_bool m_starved = false;
+    quint64 m_xrunCount = 0; // of the timer, and of the audio threads that have been stopped
 };
 
 class AlsaOutputPrivate : public QIODevice
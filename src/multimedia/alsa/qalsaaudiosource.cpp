@@ -98,6 +98,7 @@ int QAlsaAudioSource::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        ++m_xrunCount;
         errorState = QAudio::UnderrunError;
         err = snd_pcm_prepare(handle);
         if(err < 0)
@@ -175,6 +176,7 @@ void QAlsaAudioSource::start(QIODevice* device)
     if(!pullMode && audioSource)
         delete audioSource;
 
+    m_callback.reset();
     pullMode = true;
     audioSource = device;
 
@@ -194,6 +196,7 @@ QIODevice* QAlsaAudioSource::start()
     if(!pullMode && audioSource)
         delete audioSource;
 
+    m_callback.reset();
     pullMode = false;
     audioSource = new AlsaInputPrivate(this);
     audioSource->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
@@ -208,6 +211,30 @@ QIODevice* QAlsaAudioSource::start()
     return audioSource;
 }
 
+bool QAlsaAudioSource::startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback)
+{
+    if(deviceState != QAudio::StoppedState)
+        close();
+
+    if(!pullMode && audioSource)
+        delete audioSource;
+
+    m_callback = std::move(callback);
+    pullMode = true;
+    audioSource = nullptr;
+
+    deviceState = QAudio::ActiveState;
+
+    if( !open() ) {
+        m_callback.reset();
+        return true;
+    }
+
+    emit stateChanged(deviceState);
+
+    return true;
+}
+
 void QAlsaAudioSource::stop()
 {
     if(deviceState == QAudio::StoppedState)
@@ -216,6 +243,7 @@ void QAlsaAudioSource::stop()
     deviceState = QAudio::StoppedState;
 
     close();
+    m_callback.reset();
     emit stateChanged(deviceState);
 }
 
@@ -283,7 +311,8 @@ bool QAlsaAudioSource::open()
         }
     }
     if ( !fatal ) {
-        err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        err = usesAudioThread() ? QAlsaAudioThread::setAccess(handle, hwparams)
+                                : snd_pcm_hw_params_set_access( handle, hwparams, access );
         if ( err < 0 ) {
             fatal = true;
             errMessage = QString::fromLatin1("QAudioSource: snd_pcm_hw_params_set_access: err = %1").arg(err);
@@ -363,22 +392,33 @@ bool QAlsaAudioSource::open()
 
     // Step 4: Prepare audio
     ringBuffer.resize(buffer_size);
+    // The audio thread captures the QIODevice modes into the ring buffer only, pull mode
+    // writes it to the device on this thread
+    if (!m_callback && usesAudioThread())
+        m_ringBuffer = std::make_unique<QtPrivate::QAudioRingBuffer<char>>(buffer_size);
     snd_pcm_prepare( handle );
-    snd_pcm_start(handle);
+    // The audio thread starts the capture itself
+    if (!usesAudioThread())
+        snd_pcm_start(handle);
 
     // Step 5: Setup timer
     bytesAvailable = checkBytesReady();
 
-    if(pullMode)
+    if(pullMode && audioSource && !usesAudioThread())
         connect(audioSource, &QIODevice::readyRead, this, &QAlsaAudioSource::userFeed);
 
-    // Step 6: Start audio processing
-    chunks = buffer_size/period_size;
-    timer->start(period_time*chunks/2000);
-
     errorState  = QAudio::NoError;
 
     totalTimeValue = 0;
+    m_xrunCount = 0;
+
+    // Step 6: Start audio processing
+    if (usesAudioThread()) {
+        startAudioThread();
+    } else {
+        chunks = buffer_size/period_size;
+        timer->start(period_time*chunks/2000);
+    }
 
     return true;
 }
@@ -386,11 +426,13 @@ bool QAlsaAudioSource::open()
 void QAlsaAudioSource::close()
 {
     timer->stop();
+    stopAudioThread();
 
     if ( handle ) {
         snd_pcm_drop( handle );
         snd_pcm_close( handle );
         handle = 0;
+        m_ringBuffer.reset();
     }
 }
 
@@ -416,6 +458,8 @@ int QAlsaAudioSource::checkBytesReady()
 
 qsizetype QAlsaAudioSource::bytesReady() const
 {
+    if (m_ringBuffer)
+        return m_ringBuffer->used();
     return qMax(bytesAvailable, 0);
 }
 
@@ -425,6 +469,33 @@ qint64 QAlsaAudioSource::read(char* data, qint64 len)
     if ( !handle )
         return 0;
 
+    if (m_ringBuffer) {
+        Q_ASSERT(!pullMode);
+
+        // The audio thread captures into the ring buffer, pass on whole frames of it
+        if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+            return 0;
+
+        const int bytesPerFrame = settings.bytesPerFrame();
+        const qint64 bytesToRead = qMin<qint64>(len, m_ringBuffer->used());
+        qint64 bytesRead = 0;
+        m_ringBuffer->consume(bytesToRead - bytesToRead % bytesPerFrame,
+                              [&](QSpan<const char> region) {
+            memcpy(data + bytesRead, region.data(), region.size());
+            bytesRead += region.size();
+        });
+
+        if (bytesRead > 0) {
+            resuming = false;
+            if (deviceState != QAudio::ActiveState) {
+                errorState = QAudio::NoError;
+                deviceState = QAudio::ActiveState;
+                emit stateChanged(deviceState);
+            }
+        }
+        return bytesRead;
+    }
+
     int bytesRead = 0;
     int bytesInRingbufferBeforeRead = ringBuffer.bytesOfDataInBuffer();
 
@@ -574,16 +645,22 @@ void QAlsaAudioSource::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            err = snd_pcm_start(handle);
-            if(err < 0)
-                xrun_recovery(err);
+            if (!usesAudioThread()) {
+                err = snd_pcm_start(handle);
+                if(err < 0)
+                    xrun_recovery(err);
+            }
 
             bytesAvailable = buffer_size;
         }
         resuming = true;
         deviceState = QAudio::ActiveState;
-        int chunks = buffer_size/period_size;
-        timer->start(period_time*chunks/2000);
+        if (usesAudioThread()) {
+            startAudioThread();
+        } else {
+            int chunks = buffer_size/period_size;
+            timer->start(period_time*chunks/2000);
+        }
         emit stateChanged(deviceState);
     }
 }
@@ -610,6 +687,7 @@ qint64 QAlsaAudioSource::processedUSecs() const
 void QAlsaAudioSource::suspend()
 {
     if(deviceState == QAudio::ActiveState||resuming) {
+        stopAudioThread();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -619,7 +697,8 @@ void QAlsaAudioSource::suspend()
 
 void QAlsaAudioSource::userFeed()
 {
-    if(deviceState == QAudio::StoppedState || deviceState == QAudio::SuspendedState)
+    if(deviceState == QAudio::StoppedState || deviceState == QAudio::SuspendedState
+       || m_audioThread)
         return;
 #ifdef DEBUG_AUDIO
     QTime now(QTime::currentTime());
@@ -662,12 +741,140 @@ bool QAlsaAudioSource::deviceReady()
 
 void QAlsaAudioSource::reset()
 {
+    stopAudioThread();
     if(handle)
         snd_pcm_reset(handle);
     stop();
     bytesAvailable = 0;
 }
 
+quint64 QAlsaAudioSource::xrunCount() const
+{
+    return m_xrunCount + (m_audioThread ? m_audioThread->xrunCount() : 0);
+}
+
+bool QAlsaAudioSource::usesAudioThread() const
+{
+    return m_callback || QAlsaAudioThread::isEnabledForIODevices();
+}
+
+void QAlsaAudioSource::startAudioThread()
+{
+    Q_ASSERT(handle);
+    if (m_audioThread)
+        return;
+
+    m_capturedPending = false;
+    m_audioThread = std::make_unique<QAlsaAudioThread>(
+            handle, period_frames,
+            [this](char *data, qsizetype bytes) { capturePeriod(data, bytes); },
+            [this] {
+                QMetaObject::invokeMethod(
+                        this, [this, thread = QThread::currentThread()] {
+                            onAudioThreadFailed(thread);
+                        }, Qt::QueuedConnection);
+            });
+    m_audioThread->start(QThread::TimeCriticalPriority);
+}
+
+void QAlsaAudioSource::stopAudioThread()
+{
+    if (!m_audioThread)
+        return;
+
+    m_audioThread->stop();
+    m_xrunCount += m_audioThread->xrunCount();
+    m_audioThread.reset();
+}
+
+void QAlsaAudioSource::capturePeriod(char *data, qsizetype bytes)
+{
+    // Runs on the audio thread; the members it uses only change while the thread is stopped
+    const qreal volume = m_volume;
+    if (volume < 1.0f)
+        QAudioHelperInternal::qMultiplySamples(volume, settings, data, data, bytes);
+
+    if (m_callback) {
+        QtAudioPrivate::runAudioCallback(*m_callback, data, bytes);
+    } else {
+        // What doesn't fit is dropped, as the hardware would on an overrun. The QIODevice of
+        // pull mode, which may block or belong to the user, is written on the owning thread.
+        bytes = m_ringBuffer->write(QSpan<const char>(data, bytes));
+        if (!m_capturedPending.exchange(true, std::memory_order_relaxed)) {
+            QMetaObject::invokeMethod(
+                    this, [this, thread = QThread::currentThread()] {
+                        onAudioThreadCaptured(thread);
+                    }, Qt::QueuedConnection);
+        }
+    }
+
+    totalTimeValue += bytes;
+}
+
+void QAlsaAudioSource::onAudioThreadCaptured(QThread *thread)
+{
+    // Ignore the notifications of the threads that have been stopped since
+    if (m_audioThread.get() != thread)
+        return;
+
+    m_capturedPending = false;
+
+    if (!pullMode) {
+        if (auto *device = qobject_cast<AlsaInputPrivate *>(audioSource))
+            device->trigger();
+        return;
+    }
+
+    if (!flushRingBuffer()) {
+        close();
+        errorState = QAudio::IOError;
+        deviceState = QAudio::StoppedState;
+        emit stateChanged(deviceState);
+    }
+}
+
+bool QAlsaAudioSource::flushRingBuffer()
+{
+    qint64 flushed = 0;
+    while (true) {
+        const auto region = m_ringBuffer->acquireReadRegion(m_ringBuffer->used());
+        if (region.isEmpty())
+            break;
+
+        const qint64 written = audioSource->write(region.data(), region.size());
+        if (written < 0)
+            return false;
+
+        m_ringBuffer->releaseReadRegion(int(written));
+        flushed += written;
+        if (written < region.size())
+            break;
+    }
+
+    if (flushed > 0) {
+        resuming = false;
+        if (deviceState != QAudio::ActiveState) {
+            errorState = QAudio::NoError;
+            deviceState = QAudio::ActiveState;
+            emit stateChanged(deviceState);
+        }
+    }
+    return true;
+}
+
+void QAlsaAudioSource::onAudioThreadFailed(QThread *thread)
+{
+    // Ignore the failures of the threads that have been stopped since
+    if (m_audioThread.get() != thread)
+        return;
+
+    close();
+    m_callback.reset();
+    errorState = QAudio::IOError;
+    deviceState = QAudio::StoppedState;
+    emit stateChanged(deviceState);
+}
+
 void QAlsaAudioSource::drain()
 {
     if(handle)
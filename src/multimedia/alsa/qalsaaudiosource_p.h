@@ -28,8 +28,15 @@
 
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodevice.h>
+#include <private/qaudioringbuffer_p.h>
 #include <private/qaudiosystem_p.h>
 
+#include "qalsaaudiothread_p.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 
@@ -58,7 +65,7 @@ private:
     QByteArray m_data;
 };
 
-class QAlsaAudioSource : public QPlatformAudioSource
+class Q_MULTIMEDIA_EXPORT QAlsaAudioSource : public QPlatformAudioSource
 {
     Q_OBJECT
 public:
@@ -83,9 +90,13 @@ public:
     QAudioFormat format() const override;
     void setVolume(qreal) override;
     qreal volume() const override;
+    bool startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback) override;
+
+    quint64 xrunCount() const override;
+
     bool resuming;
     snd_pcm_t* handle;
-    qint64 totalTimeValue;
+    std::atomic<qint64> totalTimeValue;
     QIODevice* audioSource;
     QAudioFormat settings;
     QAudio::Error errorState;
@@ -103,6 +114,14 @@ private:
     void close();
     void drain();
 
+    bool usesAudioThread() const;
+    void startAudioThread();
+    void stopAudioThread();
+    void capturePeriod(char *data, qsizetype bytes);
+    void onAudioThreadCaptured(QThread *thread);
+    bool flushRingBuffer();
+    void onAudioThreadFailed(QThread *thread);
+
     QTimer* timer;
     qint64 elapsedTimeOffset;
     RingBuffer ringBuffer;
@@ -118,7 +137,18 @@ private:
     snd_pcm_access_t access;
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
-    qreal m_volume;
+    std::atomic<qreal> m_volume;
+
+    // Set while started with a callback, which gets the audio on m_audioThread
+    std::optional<QtAudioPrivate::AudioSourceCallback> m_callback;
+
+    // Runs the callback, or with QT_ALSA_AUDIO_THREAD set the QIODevice modes too. The
+    // ring buffer passes the periods captured by the thread to read() in push mode, and to
+    // the device in pull mode.
+    std::unique_ptr<QAlsaAudioThread> m_audioThread;
+    std::unique_ptr<QtPrivate::QAudioRingBuffer<char>> m_ringBuffer;
+    std::atomic_bool m_capturedPending = false;
+    quint64 m_xrunCount = 0; // of the timer, and of the audio threads that have been stopped
 };
 
 class AlsaInputPrivate : public QIODevice
@@ -0,0 +1,234 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qalsaaudiothread_p.h"
+
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(lcAlsaThread, "qt.multimedia.alsa.thread");
+
+// Leaves room above for the threads of the audio servers and the drivers
+static constexpr int RealtimePriority = 20;
+
+QAlsaAudioThread::QAlsaAudioThread(snd_pcm_t *handle, snd_pcm_uframes_t periodFrames,
+                                   PeriodHandler handler, FailureHandler onFailure)
+    : m_handle(handle),
+      m_playback(snd_pcm_stream(handle) == SND_PCM_STREAM_PLAYBACK),
+      m_periodFrames(periodFrames),
+      m_periodBytes(snd_pcm_frames_to_bytes(handle, periodFrames)),
+      m_handler(std::move(handler)),
+      m_onFailure(std::move(onFailure)),
+      m_buffer(m_periodBytes, Qt::Uninitialized),
+      m_wakeUpFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+    snd_pcm_hw_params_t *hwparams;
+    snd_pcm_hw_params_alloca(&hwparams);
+    snd_pcm_access_t access = SND_PCM_ACCESS_RW_INTERLEAVED;
+    if (snd_pcm_hw_params_current(handle, hwparams) >= 0
+        && snd_pcm_hw_params_get_access(hwparams, &access) >= 0)
+        m_mmap = access == SND_PCM_ACCESS_MMAP_INTERLEAVED;
+
+    setObjectName(m_playback ? QStringLiteral("QAlsaAudioSink")
+                             : QStringLiteral("QAlsaAudioSource"));
+}
+
+QAlsaAudioThread::~QAlsaAudioThread()
+{
+    stop();
+    if (m_wakeUpFd >= 0)
+        ::close(m_wakeUpFd);
+}
+
+bool QAlsaAudioThread::isEnabledForIODevices()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_ALSA_AUDIO_THREAD") != 0;
+    return enabled;
+}
+
+int QAlsaAudioThread::setAccess(snd_pcm_t *handle, snd_pcm_hw_params_t *hwparams)
+{
+    const int err =
+            snd_pcm_hw_params_set_access(handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    if (err >= 0)
+        return err;
+
+    qCDebug(lcAlsaThread) << "No mmap access:" << snd_strerror(err);
+    return snd_pcm_hw_params_set_access(handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED);
+}
+
+void QAlsaAudioThread::stop()
+{
+    if (!isRunning())
+        return;
+
+    m_stopRequested = true;
+    if (m_wakeUpFd >= 0)
+        eventfd_write(m_wakeUpFd, 1);
+    wait();
+}
+
+void QAlsaAudioThread::run()
+{
+    setRealtimePriority();
+
+    const int pcmFdCount = snd_pcm_poll_descriptors_count(m_handle);
+    QVarLengthArray<pollfd, 4> fds(pcmFdCount + 1);
+    snd_pcm_poll_descriptors(m_handle, fds.data(), pcmFdCount);
+    fds[pcmFdCount] = { m_wakeUpFd, POLLIN, 0 };
+
+    // Without the eventfd, stop() relies on the timeout
+    const int timeoutMs = m_wakeUpFd >= 0 ? -1 : 100;
+
+    // Playback starts once the first period is committed, capture needs to be started
+    if (!m_playback && snd_pcm_state(m_handle) == SND_PCM_STATE_PREPARED)
+        snd_pcm_start(m_handle);
+
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        snd_pcm_sframes_t frames = snd_pcm_avail_update(m_handle);
+
+        while (frames >= snd_pcm_sframes_t(m_periodFrames)
+               && !m_stopRequested.load(std::memory_order_relaxed)) {
+            const snd_pcm_sframes_t transferred =
+                    m_mmap ? transferMmapPeriod() : transferPeriod();
+            if (transferred < 0) {
+                frames = transferred;
+                break;
+            }
+            frames -= transferred;
+        }
+
+        if (frames < 0) {
+            if (!recover(frames)) {
+                m_onFailure();
+                return;
+            }
+            continue;
+        }
+
+        if (poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR) {
+            qCWarning(lcAlsaThread) << "poll failed:" << strerror(errno);
+            m_onFailure();
+            return;
+        }
+
+        // Errors show up as negative frame counts of snd_pcm_avail_update() on the next turn
+        unsigned short revents = 0;
+        snd_pcm_poll_descriptors_revents(m_handle, fds.data(), pcmFdCount, &revents);
+    }
+}
+
+void QAlsaAudioThread::setRealtimePriority()
+{
+    sched_param param = {};
+    param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO), RealtimePriority,
+                                  sched_get_priority_max(SCHED_FIFO));
+
+    // Usually needs CAP_SYS_NICE or an RLIMIT_RTPRIO, see ulimit -r
+    if (const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+        qCDebug(lcAlsaThread) << "No real-time scheduling:" << strerror(err);
+}
+
+snd_pcm_sframes_t QAlsaAudioThread::transferPeriod()
+{
+    char *data = m_buffer.data();
+
+    if (m_playback) {
+        m_handler(data, m_periodBytes);
+        return snd_pcm_writei(m_handle, data, m_periodFrames);
+    }
+
+    const snd_pcm_sframes_t frames = snd_pcm_readi(m_handle, data, m_periodFrames);
+    if (frames > 0)
+        m_handler(data, snd_pcm_frames_to_bytes(m_handle, frames));
+    return frames;
+}
+
+snd_pcm_sframes_t QAlsaAudioThread::transferMmapPeriod()
+{
+    const snd_pcm_channel_area_t *areas = nullptr;
+    snd_pcm_uframes_t offset = 0;
+    snd_pcm_uframes_t frames = m_periodFrames;
+
+    int err = snd_pcm_mmap_begin(m_handle, &areas, &offset, &frames);
+    if (err < 0)
+        return err;
+
+    // Interleaved, so the first area covers all the channels
+    auto address = [&] {
+        return static_cast<char *>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+    };
+
+    if (frames == m_periodFrames) {
+        m_handler(address(), m_periodBytes);
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_handle, offset, frames);
+        return committed >= 0 && snd_pcm_uframes_t(committed) != frames ? -EPIPE : committed;
+    }
+
+    // The period wraps around the end of the buffer, so goes through m_buffer in two parts
+    if (m_playback)
+        m_handler(m_buffer.data(), m_periodBytes);
+
+    qsizetype copied = 0;
+    while (true) {
+        const qsizetype bytes = snd_pcm_frames_to_bytes(m_handle, frames);
+        if (m_playback)
+            memcpy(address(), m_buffer.constData() + copied, bytes);
+        else
+            memcpy(m_buffer.data() + copied, address(), bytes);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_handle, offset, frames);
+        if (committed < 0)
+            return committed;
+        if (snd_pcm_uframes_t(committed) != frames)
+            return -EPIPE;
+
+        copied += bytes;
+        if (copied >= m_periodBytes)
+            break;
+
+        frames = snd_pcm_bytes_to_frames(m_handle, m_periodBytes - copied);
+        err = snd_pcm_mmap_begin(m_handle, &areas, &offset, &frames);
+        if (err < 0)
+            return err;
+        if (frames == 0)
+            return -EPIPE;
+    }
+
+    if (!m_playback)
+        m_handler(m_buffer.data(), m_periodBytes);
+
+    return m_periodFrames;
+}
+
+bool QAlsaAudioThread::recover(snd_pcm_sframes_t error)
+{
+    if (error == -EPIPE) {
+        const quint64 count = m_xrunCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        qCDebug(lcAlsaThread) << (m_playback ? "Underrun" : "Overrun") << count;
+    }
+
+    const int err = snd_pcm_recover(m_handle, int(error), 1);
+    if (err < 0) {
+        qCWarning(lcAlsaThread) << "Can't recover from" << snd_strerror(int(error)) << ":"
+                                << snd_strerror(err);
+        return false;
+    }
+
+    if (!m_playback)
+        snd_pcm_start(m_handle);
+
+    return true;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,88 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QALSAAUDIOTHREAD_P_H
+#define QALSAAUDIOTHREAD_P_H
+
+#include <alsa/asoundlib.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qthread.h>
+#include <QtMultimedia/qtmultimediaglobal.h>
+
+#include <atomic>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+/**
+ *  @brief Transfers the periods of an opened PCM on a dedicated thread, waiting on the poll
+ * descriptors of the PCM rather than on a timer of the thread owning the PCM. The thread
+ * asks for SCHED_FIFO scheduling, which succeeds if the process is allowed real-time
+ * priorities, and moves the data with snd_pcm_mmap_begin()/snd_pcm_mmap_commit() if the PCM
+ * has mmap access, so that the handler reads or writes the memory of the device directly.
+ */
+class Q_MULTIMEDIA_EXPORT QAlsaAudioThread : public QThread
+{
+public:
+    // Produces one period of playback into data, or consumes one period of capture from it.
+    // Called on the thread, bytes is the size of a period except for short reads.
+    using PeriodHandler = std::function<void(char *data, qsizetype bytes)>;
+    // Called on the thread if the PCM fails and can't be recovered; the thread finishes then
+    using FailureHandler = std::function<void()>;
+
+    QAlsaAudioThread(snd_pcm_t *handle, snd_pcm_uframes_t periodFrames, PeriodHandler handler,
+                     FailureHandler onFailure);
+    ~QAlsaAudioThread() override;
+
+    // Whether QT_ALSA_AUDIO_THREAD asks for running the QIODevice modes on the thread too
+    static bool isEnabledForIODevices();
+
+    // Sets mmap access if the PCM supports it, and read/write access otherwise
+    static int setAccess(snd_pcm_t *handle, snd_pcm_hw_params_t *hwparams);
+
+    // Stops the thread and waits for it to finish
+    void stop();
+
+    // Underruns of playback, or overruns of capture, so far
+    quint64 xrunCount() const { return m_xrunCount.load(std::memory_order_relaxed); }
+
+protected:
+    void run() override;
+
+private:
+    void setRealtimePriority();
+    snd_pcm_sframes_t transferPeriod();
+    snd_pcm_sframes_t transferMmapPeriod();
+    bool recover(snd_pcm_sframes_t error);
+
+    snd_pcm_t *const m_handle;
+    const bool m_playback;
+    bool m_mmap = false;
+    const snd_pcm_uframes_t m_periodFrames;
+    const qsizetype m_periodBytes;
+    const PeriodHandler m_handler;
+    const FailureHandler m_onFailure;
+
+    // For read/write access, and for the periods that wrap around the end of the mmap buffer
+    QByteArray m_buffer;
+
+    int m_wakeUpFd = -1;
+    std::atomic_bool m_stopRequested = false;
+    std::atomic<quint64> m_xrunCount = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QALSAAUDIOTHREAD_P_H
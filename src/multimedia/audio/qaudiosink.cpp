@@ -10,6 +10,8 @@
 #include <private/qplatformmediadevices_p.h>
 #include <private/qplatformmediaintegration_p.h>
 
+#include <QtCore/qdebug.h>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -144,6 +146,7 @@ void QAudioSink::start(QIODevice* device)
     if (!d)
         return;
     d->elapsedTime.restart();
+    d->lentWriteSize = 0;
     d->start(device);
 }
 
@@ -169,9 +172,59 @@ QIODevice* QAudioSink::start()
     if (!d)
         return nullptr;
     d->elapsedTime.restart();
+    d->lentWriteSize = 0;
     return d->start();
 }
 
+/*!
+    \fn template <typename Callback> void QAudioSink::start(Callback &&callback)
+    \since 6.9
+
+    Starts rendering audio with \a callback, which the backend calls on its
+    audio thread whenever the system's audio output needs the next period of
+    audio data. The callback takes a QSpan of the sample type of format(), that
+    is \c quint8, \c qint16, \c qint32 or \c float, and must fill it with
+    interleaved frames, for instance:
+
+    \code
+    sink.start([phase = 0.f](QSpan<float> samples) mutable {
+        for (float &sample : samples) {
+            sample = std::sin(phase);
+            phase += 0.05f;
+        }
+    });
+    \endcode
+
+    The number of frames in the span is its size divided by the channel count
+    of format(). As the callback runs on a real-time thread, it should not
+    block, allocate memory or wait on locks held by other threads.
+
+    The QAudioSink transitions to QtAudio::ActiveState and stays there until it
+    is stopped; it never becomes idle. If the sample type of the callback
+    doesn't match format(), or if the audio backend doesn't support callbacks,
+    a warning is printed and the QAudioSink remains in QtAudio::StoppedState.
+    Callbacks are currently supported on Linux, with ALSA and PulseAudio.
+
+    \sa start(QIODevice *)
+*/
+
+void QAudioSink::startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback)
+{
+    if (!d)
+        return;
+
+    if (!QtAudioPrivate::callbackMatchesFormat(callback, d->format())) {
+        qWarning() << "QAudioSink::start: the callback is empty or doesn't match the sample"
+                   << "format" << d->format().sampleFormat();
+        return;
+    }
+
+    d->elapsedTime.restart();
+    d->lentWriteSize = 0;
+    if (!d->startWithCallback(std::move(callback)))
+        qWarning() << "QAudioSink::start: the audio backend doesn't support callbacks";
+}
+
 /*!
     Stops the audio output, detaching from the system resource.
 
@@ -186,8 +239,10 @@ QIODevice* QAudioSink::start()
 */
 void QAudioSink::stop()
 {
-    if (d)
-        d->stop();
+    if (!d)
+        return;
+    d->lentWriteSize = 0;
+    d->stop();
 }
 
 /*!
@@ -196,8 +251,10 @@ void QAudioSink::stop()
 */
 void QAudioSink::reset()
 {
-    if (d)
-        d->reset();
+    if (!d)
+        return;
+    d->lentWriteSize = 0;
+    d->reset();
 }
 
 /*!
@@ -236,6 +293,67 @@ qsizetype QAudioSink::bytesFree() const
     return d ? d->bytesFree() : 0;
 }
 
+/*!
+    \since 6.9
+
+    Lends a region of up to \a maxSize bytes of the audio buffer, or of all of
+    its free space if \a maxSize is negative, for the application to write
+    audio data into without an intermediate copy. This is an alternative to
+    writing to the QIODevice returned by start(), for instance to resample or
+    decode straight into the buffer:
+
+    \code
+    QSpan<char> buffer = sink.beginWrite();
+    const qsizetype written = resampler.convert(input, buffer);
+    sink.commitWrite(written);
+    \endcode
+
+    The region holds at most bytesFree() bytes, and may hold less when the free
+    space wraps around the end of the buffer; calling beginWrite() again after
+    commitWrite() returns the rest. It stays valid until commitWrite() is
+    called, which must happen before any other call that writes to the sink.
+
+    Returns an empty span if the sink wasn't started with start(), if the
+    buffer is full, or if the audio backend doesn't lend its buffer, in which
+    case the QIODevice has to be used instead. The buffer is currently lent
+    on Linux, with PulseAudio, PipeWire and the real-time thread of ALSA.
+
+    \sa commitWrite(), bytesFree()
+*/
+QSpan<char> QAudioSink::beginWrite(qsizetype maxSize)
+{
+    if (!d || maxSize == 0)
+        return {};
+
+    Q_ASSERT_X(d->lentWriteSize == 0, "QAudioSink::beginWrite",
+               "the previous region hasn't been committed");
+
+    const QSpan<char> region = d->beginWrite(maxSize < 0 ? d->bytesFree() : maxSize);
+    d->lentWriteSize = region.size();
+    return region;
+}
+
+/*!
+    \since 6.9
+
+    Queues the first \a bytes bytes of the region returned by beginWrite()
+    for playback, like writing them to the QIODevice returned by start()
+    would. The rest of the region is given back to the sink; committing
+    \c 0 bytes gives back all of it.
+
+    \sa beginWrite()
+*/
+void QAudioSink::commitWrite(qsizetype bytes)
+{
+    if (!d || d->lentWriteSize == 0)
+        return;
+
+    Q_ASSERT_X(bytes >= 0 && bytes <= d->lentWriteSize, "QAudioSink::commitWrite",
+               "more bytes than lent by beginWrite()");
+
+    d->commitWrite(qBound(qsizetype(0), bytes, std::exchange(d->lentWriteSize, 0)));
+}
+
 /*!
     Sets the audio buffer size to \a value in bytes.
 
@@ -35,6 +35,16 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+#if defined(Q_QDOC)
+    template <typename Callback>
+    void start(Callback &&callback);
+#else
+    template <typename Callback, QtAudioPrivate::if_audio_sink_callback<Callback> = true>
+    void start(Callback &&callback)
+    {
+        startWithCallback(QtAudioPrivate::AudioSinkCallback(std::forward<Callback>(callback)));
+    }
+#endif
 
     void stop();
     void reset();
@@ -46,6 +56,9 @@ public:
 
     qsizetype bytesFree() const;
 
+    QSpan<char> beginWrite(qsizetype maxSize = -1);
+    void commitWrite(qsizetype bytes);
+
     qint64 processedUSecs() const;
     qint64 elapsedUSecs() const;
 
@@ -65,6 +78,9 @@ Q_SIGNALS:
 
 private:
     Q_DISABLE_COPY(QAudioSink)
+    friend class QPlatformAudioSink;
+
+    void startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback);
 
     QPlatformAudioSink* d;
 };
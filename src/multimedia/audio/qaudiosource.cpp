@@ -10,6 +10,8 @@
 #include <private/qplatformmediadevices_p.h>
 #include <private/qplatformmediaintegration_p.h>
 
+#include <QtCore/qdebug.h>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -174,6 +176,50 @@ QIODevice* QAudioSource::start()
     return d->start();
 }
 
+/*!
+    \fn template <typename Callback> void QAudioSource::start(Callback &&callback)
+    \since 6.9
+
+    Starts capturing audio with \a callback, which the backend calls on its
+    audio thread with the audio data captured from the system's audio input.
+    The callback takes a QSpan of the constant sample type of format(), that is
+    \c{const quint8}, \c{const qint16}, \c{const qint32} or \c{const float},
+    holding interleaved frames; the span is only valid during the call:
+
+    \code
+    source.start([this](QSpan<const qint16> samples) {
+        m_ringBuffer.write(samples);
+    });
+    \endcode
+
+    As the callback runs on a real-time thread, it should not block, allocate
+    memory or wait on locks held by other threads.
+
+    The QAudioSource transitions to QtAudio::ActiveState and stays there until
+    it is stopped. If the sample type of the callback doesn't match format(),
+    or if the audio backend doesn't support callbacks, a warning is printed and
+    the QAudioSource remains in QtAudio::StoppedState. Callbacks are currently
+    supported on Linux, with ALSA and PulseAudio.
+
+    \sa start(QIODevice *)
+*/
+
+void QAudioSource::startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback)
+{
+    if (!d)
+        return;
+
+    if (!QtAudioPrivate::callbackMatchesFormat(callback, d->format())) {
+        qWarning() << "QAudioSource::start: the callback is empty or doesn't match the sample"
+                   << "format" << d->format().sampleFormat();
+        return;
+    }
+
+    d->elapsedTime.start();
+    if (!d->startWithCallback(std::move(callback)))
+        qWarning() << "QAudioSource::start: the audio backend doesn't support callbacks";
+}
+
 /*!
     Returns the QAudioFormat being used.
 */
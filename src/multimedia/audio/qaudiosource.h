@@ -33,6 +33,16 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+#if defined(Q_QDOC)
+    template <typename Callback>
+    void start(Callback &&callback);
+#else
+    template <typename Callback, QtAudioPrivate::if_audio_source_callback<Callback> = true>
+    void start(Callback &&callback)
+    {
+        startWithCallback(QtAudioPrivate::AudioSourceCallback(std::forward<Callback>(callback)));
+    }
+#endif
 
     void stop();
     void reset();
@@ -63,6 +73,9 @@ Q_SIGNALS:
 
 private:
     Q_DISABLE_COPY(QAudioSource)
+    friend class QPlatformAudioSource;
+
+    void startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback);
 
     QPlatformAudioSource *d;
 };
@@ -3,6 +3,8 @@
 
 #include "qaudiosystem_p.h"
 
+#include <QtMultimedia/qaudiosink.h>
+#include <QtMultimedia/qaudiosource.h>
 #include <private/qplatformmediadevices_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -16,8 +18,67 @@ qreal QPlatformAudioSink::volume() const
     return 1.0;
 }
 
+bool QPlatformAudioSink::startWithCallback(QtAudioPrivate::AudioSinkCallback &&)
+{
+    return false;
+}
+
+QSpan<char> QPlatformAudioSink::beginWrite(qsizetype)
+{
+    return {};
+}
+
+void QPlatformAudioSink::commitWrite(qsizetype) { }
+
+quint64 QPlatformAudioSink::xrunCount() const
+{
+    return 0;
+}
+
+QPlatformAudioSink *QPlatformAudioSink::get(const QAudioSink &sink)
+{
+    return sink.d;
+}
+
 QPlatformAudioSource::QPlatformAudioSource(QObject *parent) : QAudioStateChangeNotifier(parent) { }
 
+bool QPlatformAudioSource::startWithCallback(QtAudioPrivate::AudioSourceCallback &&)
+{
+    return false;
+}
+
+quint64 QPlatformAudioSource::xrunCount() const
+{
+    return 0;
+}
+
+QPlatformAudioSource *QPlatformAudioSource::get(const QAudioSource &source)
+{
+    return source.d;
+}
+
+namespace QtAudioPrivate {
+
+static_assert(QAudioFormat::UInt8 == 1 && QAudioFormat::Int16 == 2 && QAudioFormat::Int32 == 3
+                      && QAudioFormat::Float == 4,
+              "The callback alternatives must follow QAudioFormat::SampleFormat");
+
+bool callbackMatchesFormat(const AudioSinkCallback &callback, const QAudioFormat &format)
+{
+    return format.sampleFormat() != QAudioFormat::Unknown
+            && callback.index() + 1 == size_t(format.sampleFormat())
+            && std::visit([](const auto &function) { return bool(function); }, callback);
+}
+
+bool callbackMatchesFormat(const AudioSourceCallback &callback, const QAudioFormat &format)
+{
+    return format.sampleFormat() != QAudioFormat::Unknown
+            && callback.index() + 1 == size_t(format.sampleFormat())
+            && std::visit([](const auto &function) { return bool(function); }, callback);
+}
+
+} // namespace QtAudioPrivate
+
 QT_END_NAMESPACE
 
 #include "moc_qaudiosystem_p.cpp"
@@ -17,7 +17,7 @@
 
 #include <QtMultimedia/qtmultimediaglobal.h>
 
-#include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qtaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
 
@@ -27,6 +27,8 @@
 QT_BEGIN_NAMESPACE
 
 class QIODevice;
+class QAudioSink;
+class QAudioSource;
 
 class Q_MULTIMEDIA_EXPORT QAudioStateChangeNotifier : public QObject
 {
@@ -62,7 +64,25 @@ public:
     virtual void setVolume(qreal) {}
     virtual qreal volume() const;
 
+    // Calls the callback on the audio thread of the backend, once per period, to render the
+    // samples into the buffer of the stream. Returns false if the backend doesn't support it.
+    virtual bool startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback);
+
+    // Lends a region of up to maxSize bytes of the buffer of the stream in push mode, to be
+    // filled without a copy. Returns an empty span if the backend doesn't support it.
+    virtual QSpan<char> beginWrite(qsizetype maxSize);
+    // Queues bytes of the region lent by beginWrite() for playback, 0 gives it back
+    virtual void commitWrite(qsizetype bytes);
+
+    // Underruns of the stream since it was started, for diagnostics; 0 if the backend
+    // doesn't count them
+    virtual quint64 xrunCount() const;
+
+    static QPlatformAudioSink *get(const QAudioSink &sink);
+
     QElapsedTimer elapsedTime;
+    // The size of the region lent by beginWrite(), until commitWrite()
+    qsizetype lentWriteSize = 0;
 };
 
 class Q_MULTIMEDIA_EXPORT QPlatformAudioSource : public QAudioStateChangeNotifier
@@ -88,9 +108,49 @@ public:
     virtual void setVolume(qreal) = 0;
     virtual qreal volume() const = 0;
 
+    // Calls the callback on the audio thread of the backend with the captured samples.
+    // Returns false if the backend doesn't support it.
+    virtual bool startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback);
+
+    // Overruns of the stream since it was started, for diagnostics; 0 if the backend
+    // doesn't count them
+    virtual quint64 xrunCount() const;
+
+    static QPlatformAudioSource *get(const QAudioSource &source);
+
     QElapsedTimer elapsedTime;
 };
 
+namespace QtAudioPrivate {
+
+// Whether the callback is set and takes samples of the sample format of the format
+Q_MULTIMEDIA_EXPORT bool callbackMatchesFormat(const AudioSinkCallback &callback,
+                                               const QAudioFormat &format);
+Q_MULTIMEDIA_EXPORT bool callbackMatchesFormat(const AudioSourceCallback &callback,
+                                               const QAudioFormat &format);
+
+template <typename T, typename Data>
+void invokeAudioCallback(const AudioCallback<T> &function, Data *data, qsizetype bytes)
+{
+    function(QSpan<T>(static_cast<T *>(data), bytes / qsizetype(sizeof(T))));
+}
+
+// Invokes the callback on the samples in the buffer of the given size in bytes
+inline void runAudioCallback(const AudioSinkCallback &callback, void *data, qsizetype bytes)
+{
+    std::visit([&](const auto &function) { invokeAudioCallback(function, data, bytes); },
+               callback);
+}
+
+inline void runAudioCallback(const AudioSourceCallback &callback, const void *data,
+                             qsizetype bytes)
+{
+    std::visit([&](const auto &function) { invokeAudioCallback(function, data, bytes); },
+               callback);
+}
+
+} // namespace QtAudioPrivate
+
 QT_END_NAMESPACE
 
 #endif // QAUDIOSYSTEM_H
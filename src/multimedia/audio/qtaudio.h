@@ -11,8 +11,35 @@
 
 #include <QtMultimedia/qaudio.h>
 
+#include <QtCore/qspan.h>
+
+#include <functional>
+#include <type_traits>
+#include <variant>
+
 QT_BEGIN_NAMESPACE
 
+namespace QtAudioPrivate {
+
+// The alternatives are in the order of QAudioFormat::SampleFormat, skipping Unknown
+template <typename T>
+using AudioCallback = std::function<void(QSpan<T>)>;
+
+using AudioSinkCallback = std::variant<AudioCallback<quint8>, AudioCallback<qint16>,
+                                       AudioCallback<qint32>, AudioCallback<float>>;
+using AudioSourceCallback =
+        std::variant<AudioCallback<const quint8>, AudioCallback<const qint16>,
+                     AudioCallback<const qint32>, AudioCallback<const float>>;
+
+template <typename Callback>
+using if_audio_sink_callback =
+        std::enable_if_t<std::is_constructible_v<AudioSinkCallback, Callback>, bool>;
+template <typename Callback>
+using if_audio_source_callback =
+        std::enable_if_t<std::is_constructible_v<AudioSourceCallback, Callback>, bool>;
+
+} // namespace QtAudioPrivate
+
 QT_END_NAMESPACE
 
 #endif // QTAUDIO_H
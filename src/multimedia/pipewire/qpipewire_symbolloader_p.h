@@ -0,0 +1,28 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIRE_SYMBOLLOADER_P_H
+#define QPIPEWIRE_SYMBOLLOADER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaexports.h>
+
+QT_BEGIN_NAMESPACE
+
+// QtMultimedia exports the pw_* stubs that load libpipewire at runtime; the plugins call them
+// instead of defining their own. Without the library, the stubs do nothing.
+Q_MULTIMEDIA_EXPORT bool isPipeWireLoaded();
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIRE_SYMBOLLOADER_P_H
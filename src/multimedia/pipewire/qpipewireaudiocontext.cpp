@@ -0,0 +1,263 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpipewireaudiocontext_p.h"
+#include "qpipewireaudiodevice_p.h"
+#include "qpipewire_symbolloader_p.h"
+
+#include <QtCore/qloggingcategory.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcPipeWireAudio, "qt.multimedia.pipewire.audio");
+
+// Bounds the time create() waits for the daemon to list the nodes of the graph
+static constexpr int SyncTimeoutSecs = 2;
+
+std::unique_ptr<QPipeWireAudioContext> QPipeWireAudioContext::create()
+{
+    if (!isPipeWireLoaded())
+        return {};
+
+    std::unique_ptr<QPipeWireAudioContext> context(new QPipeWireAudioContext);
+    if (!context->connectToDaemon())
+        return {};
+
+    return context;
+}
+
+QPipeWireAudioContext::QPipeWireAudioContext()
+{
+    pw_init(nullptr, nullptr);
+    m_initialized = true;
+}
+
+QPipeWireAudioContext::~QPipeWireAudioContext()
+{
+    disconnectFromDaemon();
+
+    if (m_initialized)
+        pw_deinit();
+}
+
+bool QPipeWireAudioContext::connectToDaemon()
+{
+    static const pw_core_events coreEvents = {
+        .version = PW_VERSION_CORE_EVENTS,
+        .done = [](void *data, uint32_t id, int seq) {
+            static_cast<QPipeWireAudioContext *>(data)->onCoreDone(id, seq);
+        },
+        .error = [](void *data, uint32_t id, int seq, int res, const char *message) {
+            static_cast<QPipeWireAudioContext *>(data)->onCoreError(id, seq, res, message);
+        },
+    };
+
+    static const pw_registry_events registryEvents = {
+        .version = PW_VERSION_REGISTRY_EVENTS,
+        .global = [](void *data, uint32_t id, uint32_t permissions, const char *type,
+                     uint32_t version, const spa_dict *props) {
+            Q_UNUSED(permissions)
+            Q_UNUSED(version)
+            static_cast<QPipeWireAudioContext *>(data)->onRegistryGlobal(id, type, props);
+        },
+        .global_remove = [](void *data, uint32_t id) {
+            static_cast<QPipeWireAudioContext *>(data)->onRegistryGlobalRemove(id);
+        },
+    };
+
+    m_threadLoop = pw_thread_loop_new("qt-multimedia-pipewire-audio", nullptr);
+    if (!m_threadLoop) {
+        qCWarning(qLcPipeWireAudio) << "pw_thread_loop_new() failed";
+        return false;
+    }
+
+    m_context = pw_context_new(pw_thread_loop_get_loop(m_threadLoop), nullptr, 0);
+    if (!m_context) {
+        qCWarning(qLcPipeWireAudio) << "pw_context_new() failed";
+        return false;
+    }
+
+    m_core = pw_context_connect(m_context, nullptr, 0);
+    if (!m_core) {
+        qCDebug(qLcPipeWireAudio) << "Can't connect to the PipeWire daemon:" << strerror(errno);
+        return false;
+    }
+    pw_core_add_listener(m_core, &m_coreListener, &coreEvents, this);
+
+    m_registry = pw_core_get_registry(m_core, PW_VERSION_REGISTRY, 0);
+    if (!m_registry) {
+        qCWarning(qLcPipeWireAudio) << "pw_core_get_registry() failed";
+        return false;
+    }
+    pw_registry_add_listener(m_registry, &m_registryListener, &registryEvents, this);
+
+    // The daemon answers the sync once it has sent the globals that exist so far
+    m_syncSeq = pw_core_sync(m_core, PW_ID_CORE, 0);
+
+    if (pw_thread_loop_start(m_threadLoop) != 0) {
+        qCWarning(qLcPipeWireAudio) << "pw_thread_loop_start() failed";
+        return false;
+    }
+
+    Locker locker(*this);
+    while (!m_synced) {
+        if (pw_thread_loop_timed_wait(m_threadLoop, SyncTimeoutSecs) != 0)
+            break;
+    }
+
+    return m_synced;
+}
+
+void QPipeWireAudioContext::disconnectFromDaemon()
+{
+    if (m_threadLoop)
+        pw_thread_loop_stop(m_threadLoop);
+
+    if (m_registry) {
+        spa_hook_remove(&m_registryListener);
+        pw_proxy_destroy(reinterpret_cast<pw_proxy *>(m_registry));
+        m_registry = nullptr;
+    }
+
+    if (m_core) {
+        spa_hook_remove(&m_coreListener);
+        pw_core_disconnect(m_core);
+        m_core = nullptr;
+    }
+
+    if (m_context) {
+        pw_context_destroy(m_context);
+        m_context = nullptr;
+    }
+
+    if (m_threadLoop) {
+        pw_thread_loop_destroy(m_threadLoop);
+        m_threadLoop = nullptr;
+    }
+}
+
+QList<QAudioDevice> QPipeWireAudioContext::availableDevices(QAudioDevice::Mode mode) const
+{
+    QList<Node> nodes;
+    {
+        Locker locker(*this);
+        for (const Node &node : m_nodes)
+            if (node.mode == mode)
+                nodes.append(node);
+    }
+
+    // The node with the highest session priority is the one WirePlumber links new streams to
+    std::stable_sort(nodes.begin(), nodes.end(), [](const Node &lhs, const Node &rhs) {
+        return lhs.priority > rhs.priority;
+    });
+
+    QList<QAudioDevice> devices;
+    devices.reserve(nodes.size());
+    for (const Node &node : std::as_const(nodes)) {
+        const bool isDefault = devices.isEmpty();
+        devices.append((new QPipeWireAudioDevice(node.name, node.description, isDefault, mode))
+                               ->create());
+    }
+    return devices;
+}
+
+void QPipeWireAudioContext::onCoreDone(uint32_t id, int seq)
+{
+    if (id != PW_ID_CORE || seq != m_syncSeq)
+        return;
+
+    m_synced = true;
+    pw_thread_loop_signal(m_threadLoop, false);
+}
+
+void QPipeWireAudioContext::onCoreError(uint32_t id, int seq, int res, const char *message)
+{
+    Q_UNUSED(seq)
+
+    qCWarning(qLcPipeWireAudio) << "Error on object" << id << ":" << strerror(-res) << message;
+
+    // The daemon went away
+    if (id == PW_ID_CORE && res == -EPIPE) {
+        pw_thread_loop_signal(m_threadLoop, false);
+        QMetaObject::invokeMethod(this, &QPipeWireAudioContext::contextFailed,
+                                  Qt::QueuedConnection);
+    }
+}
+
+void QPipeWireAudioContext::onRegistryGlobal(uint32_t id, const char *type, const spa_dict *props)
+{
+    if (qstrcmp(type, PW_TYPE_INTERFACE_Node) != 0 || !props)
+        return;
+
+    const char *mediaClass = spa_dict_lookup(props, PW_KEY_MEDIA_CLASS);
+    const char *name = spa_dict_lookup(props, PW_KEY_NODE_NAME);
+    if (!mediaClass || !name)
+        return;
+
+    Node node;
+    if (qstrcmp(mediaClass, "Audio/Sink") == 0)
+        node.mode = QAudioDevice::Output;
+    else if (qstrcmp(mediaClass, "Audio/Source") == 0
+             || qstrcmp(mediaClass, "Audio/Source/Virtual") == 0)
+        node.mode = QAudioDevice::Input;
+    else
+        return;
+
+    const char *description = spa_dict_lookup(props, PW_KEY_NODE_DESCRIPTION);
+    if (!description)
+        description = spa_dict_lookup(props, PW_KEY_NODE_NICK);
+
+    node.name = name;
+    node.description = QString::fromUtf8(description ? description : name);
+    if (const char *priority = spa_dict_lookup(props, PW_KEY_PRIORITY_SESSION))
+        node.priority = atoi(priority);
+
+    qCDebug(qLcPipeWireAudio) << "Added node" << id << node.name << node.mode;
+
+    m_nodes.insert(id, node);
+    notifyDevicesChanged(node.mode);
+}
+
+void QPipeWireAudioContext::onRegistryGlobalRemove(uint32_t id)
+{
+    const auto it = m_nodes.constFind(id);
+    if (it == m_nodes.cend())
+        return;
+
+    qCDebug(qLcPipeWireAudio) << "Removed node" << id << it->name;
+
+    const QAudioDevice::Mode mode = it->mode;
+    m_nodes.erase(it);
+    notifyDevicesChanged(mode);
+}
+
+void QPipeWireAudioContext::notifyDevicesChanged(QAudioDevice::Mode mode)
+{
+    // Runs on the thread loop; the listeners live on the thread of the context
+    QMetaObject::invokeMethod(this, [this, mode] {
+        if (mode == QAudioDevice::Input)
+            emit audioInputsChanged();
+        else
+            emit audioOutputsChanged();
+    }, Qt::QueuedConnection);
+}
+
+QPipeWireAudioContext::Locker::Locker(const QPipeWireAudioContext &context)
+    : m_threadLoop(context.m_threadLoop)
+{
+    pw_thread_loop_lock(m_threadLoop);
+}
+
+QPipeWireAudioContext::Locker::~Locker()
+{
+    pw_thread_loop_unlock(m_threadLoop);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpipewireaudiocontext_p.cpp"
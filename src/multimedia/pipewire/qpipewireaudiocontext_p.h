@@ -0,0 +1,100 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIREAUDIOCONTEXT_P_H
+#define QPIPEWIREAUDIOCONTEXT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtMultimedia/qaudiodevice.h>
+
+#include <pipewire/pipewire.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+/**
+ *  @brief The connection to the PipeWire daemon shared by the streams of the backend: a thread
+ * loop running the core and the registry, which tracks the audio sinks and sources of the graph.
+ * The loop only handles the control of the streams; their samples are processed on the data
+ * thread of PipeWire, without taking the lock of the loop.
+ */
+class QPipeWireAudioContext : public QObject
+{
+    Q_OBJECT
+public:
+    // Returns null if libpipewire can't be loaded or the daemon isn't running
+    static std::unique_ptr<QPipeWireAudioContext> create();
+    ~QPipeWireAudioContext() override;
+
+    QList<QAudioDevice> availableDevices(QAudioDevice::Mode mode) const;
+
+    pw_thread_loop *threadLoop() const { return m_threadLoop; }
+    pw_core *core() const { return m_core; }
+
+    // Locks the thread loop, which is needed to call into the objects of the context
+    class Locker
+    {
+    public:
+        explicit Locker(const QPipeWireAudioContext &context);
+        ~Locker();
+        Q_DISABLE_COPY_MOVE(Locker)
+
+    private:
+        pw_thread_loop *m_threadLoop;
+    };
+
+signals:
+    void audioInputsChanged();
+    void audioOutputsChanged();
+    // The connection to the daemon broke; the streams of the context are dead
+    void contextFailed();
+
+private:
+    QPipeWireAudioContext();
+    bool connectToDaemon();
+    void disconnectFromDaemon();
+
+    void onCoreDone(uint32_t id, int seq);
+    void onCoreError(uint32_t id, int seq, int res, const char *message);
+    void onRegistryGlobal(uint32_t id, const char *type, const spa_dict *props);
+    void onRegistryGlobalRemove(uint32_t id);
+    void notifyDevicesChanged(QAudioDevice::Mode mode);
+
+    struct Node
+    {
+        QByteArray name;
+        QString description;
+        QAudioDevice::Mode mode = QAudioDevice::Output;
+        int priority = 0;
+    };
+
+    bool m_initialized = false;
+    pw_thread_loop *m_threadLoop = nullptr;
+    pw_context *m_context = nullptr;
+    pw_core *m_core = nullptr;
+    pw_registry *m_registry = nullptr;
+    spa_hook m_coreListener = {};
+    spa_hook m_registryListener = {};
+    int m_syncSeq = 0;
+    bool m_synced = false;
+
+    // Guarded by the lock of the thread loop
+    QHash<uint32_t, Node> m_nodes;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIREAUDIOCONTEXT_P_H
@@ -0,0 +1,32 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpipewireaudiodevice_p.h"
+
+#include <spa/param/audio/raw.h>
+
+QT_BEGIN_NAMESPACE
+
+QPipeWireAudioDevice::QPipeWireAudioDevice(const QByteArray &nodeName, const QString &description,
+                                           bool isDefault, QAudioDevice::Mode mode)
+    : QAudioDevicePrivate(nodeName, mode)
+{
+    this->description = description;
+    this->isDefault = isDefault;
+
+    // The streams convert to the format of the node
+    minimumChannelCount = 1;
+    maximumChannelCount = SPA_AUDIO_MAX_CHANNELS;
+    minimumSampleRate = 1;
+    maximumSampleRate = 384000;
+
+    supportedSampleFormats = { QAudioFormat::UInt8, QAudioFormat::Int16, QAudioFormat::Int32,
+                               QAudioFormat::Float };
+
+    // The graph processes float samples at 48 kHz by default
+    preferredFormat.setChannelCount(2);
+    preferredFormat.setSampleRate(48000);
+    preferredFormat.setSampleFormat(QAudioFormat::Float);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,32 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIREAUDIODEVICE_P_H
+#define QPIPEWIREAUDIODEVICE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qaudiodevice_p.h>
+
+QT_BEGIN_NAMESPACE
+
+// A sink or source node of the graph, the id of the device is the name of the node
+class QPipeWireAudioDevice : public QAudioDevicePrivate
+{
+public:
+    QPipeWireAudioDevice(const QByteArray &nodeName, const QString &description, bool isDefault,
+                         QAudioDevice::Mode mode);
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIREAUDIODEVICE_P_H
@@ -0,0 +1,59 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpipewireaudiomediadevices_p.h"
+#include "qpipewireaudiocontext_p.h"
+#include "qpipewireaudiosink_p.h"
+#include "qpipewireaudiosource_p.h"
+
+QT_BEGIN_NAMESPACE
+
+std::unique_ptr<QPipeWireAudioMediaDevices> QPipeWireAudioMediaDevices::create()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_PIPEWIRE_AUDIO") != 0;
+    if (!enabled)
+        return {};
+
+    std::shared_ptr<QPipeWireAudioContext> context = QPipeWireAudioContext::create();
+    if (!context)
+        return {};
+
+    return std::unique_ptr<QPipeWireAudioMediaDevices>(
+            new QPipeWireAudioMediaDevices(std::move(context)));
+}
+
+QPipeWireAudioMediaDevices::QPipeWireAudioMediaDevices(
+        std::shared_ptr<QPipeWireAudioContext> context)
+    : m_context(std::move(context))
+{
+    QObject::connect(m_context.get(), &QPipeWireAudioContext::audioInputsChanged, this,
+                     &QPipeWireAudioMediaDevices::audioInputsChanged, Qt::DirectConnection);
+    QObject::connect(m_context.get(), &QPipeWireAudioContext::audioOutputsChanged, this,
+                     &QPipeWireAudioMediaDevices::audioOutputsChanged, Qt::DirectConnection);
+}
+
+QPipeWireAudioMediaDevices::~QPipeWireAudioMediaDevices() = default;
+
+QList<QAudioDevice> QPipeWireAudioMediaDevices::audioInputs() const
+{
+    return m_context->availableDevices(QAudioDevice::Input);
+}
+
+QList<QAudioDevice> QPipeWireAudioMediaDevices::audioOutputs() const
+{
+    return m_context->availableDevices(QAudioDevice::Output);
+}
+
+QPlatformAudioSource *QPipeWireAudioMediaDevices::createAudioSource(const QAudioDevice &deviceInfo,
+                                                                    QObject *parent)
+{
+    return new QPipeWireAudioSource(m_context, deviceInfo.id(), parent);
+}
+
+QPlatformAudioSink *QPipeWireAudioMediaDevices::createAudioSink(const QAudioDevice &deviceInfo,
+                                                                QObject *parent)
+{
+    return new QPipeWireAudioSink(m_context, deviceInfo.id(), parent);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,49 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIREAUDIOMEDIADEVICES_P_H
+#define QPIPEWIREAUDIOMEDIADEVICES_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qplatformmediadevices_p.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QPipeWireAudioContext;
+
+class QPipeWireAudioMediaDevices : public QPlatformMediaDevices
+{
+public:
+    // Returns null unless QT_PIPEWIRE_AUDIO is set and the daemon can be reached
+    static std::unique_ptr<QPipeWireAudioMediaDevices> create();
+    ~QPipeWireAudioMediaDevices() override;
+
+    QList<QAudioDevice> audioInputs() const override;
+    QList<QAudioDevice> audioOutputs() const override;
+    QPlatformAudioSource *createAudioSource(const QAudioDevice &deviceInfo,
+                                            QObject *parent) override;
+    QPlatformAudioSink *createAudioSink(const QAudioDevice &deviceInfo,
+                                        QObject *parent) override;
+
+private:
+    explicit QPipeWireAudioMediaDevices(std::shared_ptr<QPipeWireAudioContext> context);
+
+    // Shared with the sinks and sources, which may outlive the devices
+    const std::shared_ptr<QPipeWireAudioContext> m_context;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIREAUDIOMEDIADEVICES_P_H
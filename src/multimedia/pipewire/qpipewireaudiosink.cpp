@@ -0,0 +1,427 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpipewireaudiosink_p.h"
+#include "qpipewireaudiocontext_p.h"
+#include "qpipewireaudiostream_p.h"
+
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qthread.h>
+#include <private/qaudiohelpers_p.h>
+
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcPipeWireAudioSink, "qt.multimedia.pipewire.audio.sink");
+
+// About 40 ms at the default quantum
+static constexpr int DefaultQuantaPerBuffer = 4;
+
+// Added to the duration of what is left in the buffer when draining
+static constexpr int DrainMarginMs = 50;
+
+QPipeWireAudioSink::QPipeWireAudioSink(std::shared_ptr<QPipeWireAudioContext> context,
+                                       const QByteArray &device, QObject *parent)
+    : QPlatformAudioSink(parent),
+      m_context(std::move(context)),
+      m_device(device),
+      m_stateMachine(*this)
+{
+}
+
+QPipeWireAudioSink::~QPipeWireAudioSink()
+{
+    if (auto notifier = m_stateMachine.stop())
+        close();
+}
+
+void QPipeWireAudioSink::start(QIODevice *device)
+{
+    reset();
+
+    m_pullMode = true;
+    m_audioSource = device;
+
+    if (!open()) {
+        m_audioSource = nullptr;
+        return;
+    }
+
+    m_stateMachine.start();
+}
+
+QIODevice *QPipeWireAudioSink::start()
+{
+    reset();
+
+    m_pullMode = false;
+    m_audioSource = new PipeWireOutputPrivate(this);
+    m_audioSource->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+    if (!open()) {
+        delete std::exchange(m_audioSource, nullptr);
+        return nullptr;
+    }
+
+    m_stateMachine.start(false);
+
+    return m_audioSource;
+}
+
+bool QPipeWireAudioSink::startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback)
+{
+    reset();
+
+    m_pullMode = false;
+    m_callback = std::move(callback);
+
+    if (!open()) {
+        m_callback.reset();
+        return true;
+    }
+
+    m_stateMachine.start();
+
+    return true;
+}
+
+bool QPipeWireAudioSink::open()
+{
+    if (!m_format.isValid()) {
+        m_stateMachine.stopOrUpdateError(QAudio::OpenError);
+        return false;
+    }
+
+    // The buffer holds whole quanta, at least two so that one is filled while the other plays
+    m_quantumFrames = QPipeWireAudioStream::defaultQuantumFrames(m_format.sampleRate());
+    const qsizetype quantumBytes = m_format.bytesForFrames(m_quantumFrames);
+    const qsizetype requestedSize =
+            m_userBufferSize.value_or(DefaultQuantaPerBuffer * quantumBytes);
+    m_bufferSize =
+            qMax((requestedSize + quantumBytes - 1) / quantumBytes, qsizetype(2)) * quantumBytes;
+
+    if (!m_callback)
+        m_ringBuffer = std::make_unique<QtPrivate::QAudioRingBuffer<char>>(int(m_bufferSize));
+
+    // Have a buffer ready for the first cycle
+    if (m_pullMode)
+        userFeed();
+
+    m_processedFrames = 0;
+    m_starved = !m_pullMode && !m_callback;
+
+    m_stream = std::make_unique<QPipeWireAudioStream>(
+            *m_context, QAudioDevice::Output,
+            [this](char *data, qsizetype bytes) { renderQuantum(data, bytes); },
+            [this] {
+                QMetaObject::invokeMethod(
+                        this, [this, stream = m_stream.get()] { onStreamFailed(stream); },
+                        Qt::QueuedConnection);
+            });
+
+    const QByteArray streamName =
+            QStringLiteral("QtmPipeWireStream-%1-%2").arg(::getpid()).arg(quintptr(this)).toUtf8();
+    if (!m_stream->connect(m_device, m_format, m_quantumFrames, streamName)) {
+        qCWarning(qLcPipeWireAudioSink) << "Can't connect a stream to" << m_device;
+        m_stream.reset();
+        m_ringBuffer.reset();
+        m_stateMachine.stopOrUpdateError(QAudio::OpenError);
+        return false;
+    }
+
+    qCDebug(qLcPipeWireAudioSink) << "Opened stream with a quantum of" << m_quantumFrames
+                                  << "frames and a buffer of" << m_bufferSize << "bytes";
+
+    connect(m_context.get(), &QPipeWireAudioContext::contextFailed, this,
+            &QPipeWireAudioSink::onContextFailed);
+
+    if (m_pullMode) {
+        connect(m_audioSource, &QIODevice::readyRead, this, &QPipeWireAudioSink::userFeed);
+        m_pullTimer.start(pullIntervalMs(), this);
+    }
+
+    return true;
+}
+
+void QPipeWireAudioSink::close()
+{
+    m_pullTimer.stop();
+
+    if (m_stream) {
+        // Stops the processing on the data thread before releasing what it uses
+        m_stream->disconnect();
+        m_stream.reset();
+    }
+
+    disconnect(m_context.get(), &QPipeWireAudioContext::contextFailed, this,
+               &QPipeWireAudioSink::onContextFailed);
+
+    if (m_audioSource) {
+        if (m_pullMode)
+            disconnect(m_audioSource, &QIODevice::readyRead, this, nullptr);
+        else
+            delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    m_ringBuffer.reset();
+    m_callback.reset();
+}
+
+void QPipeWireAudioSink::drain()
+{
+    if (!m_ringBuffer)
+        return;
+
+    // The data thread plays what is left, the last quantum leaves the graph one cycle later
+    const qint64 leftMs = m_format.durationForBytes(m_ringBuffer->used()) / 1000;
+    const QDeadlineTimer deadline(leftMs + DrainMarginMs);
+    while (m_ringBuffer->used() > 0 && !deadline.hasExpired())
+        QThread::msleep(1);
+
+    QThread::usleep(m_format.durationForFrames(m_quantumFrames));
+}
+
+void QPipeWireAudioSink::stop()
+{
+    if (auto notifier = m_stateMachine.stop()) {
+        if (notifier.prevAudioState() != QAudio::SuspendedState)
+            drain();
+        close();
+    }
+}
+
+void QPipeWireAudioSink::reset()
+{
+    if (auto notifier = m_stateMachine.stopOrUpdateError())
+        close();
+}
+
+void QPipeWireAudioSink::suspend()
+{
+    if (auto notifier = m_stateMachine.suspend()) {
+        m_pullTimer.stop();
+        m_stream->setActive(false);
+    }
+}
+
+void QPipeWireAudioSink::resume()
+{
+    if (auto notifier = m_stateMachine.resume()) {
+        m_stream->setActive(true);
+        if (m_pullMode)
+            m_pullTimer.start(pullIntervalMs(), this);
+    }
+}
+
+qsizetype QPipeWireAudioSink::bytesFree() const
+{
+    if (!m_ringBuffer || !m_stateMachine.isActiveOrIdle())
+        return 0;
+
+    return m_ringBuffer->free();
+}
+
+void QPipeWireAudioSink::setBufferSize(qsizetype value)
+{
+    m_userBufferSize = value;
+}
+
+qsizetype QPipeWireAudioSink::bufferSize() const
+{
+    if (m_bufferSize)
+        return m_bufferSize;
+
+    if (m_userBufferSize)
+        return *m_userBufferSize;
+
+    if (!m_format.isValid())
+        return 0;
+
+    const quint32 quantumFrames = QPipeWireAudioStream::defaultQuantumFrames(m_format.sampleRate());
+    return DefaultQuantaPerBuffer * m_format.bytesForFrames(quantumFrames);
+}
+
+qint64 QPipeWireAudioSink::processedUSecs() const
+{
+    if (m_format.sampleRate() <= 0)
+        return 0;
+
+    return qint64(1000000) * m_processedFrames / m_format.sampleRate();
+}
+
+QAudio::Error QPipeWireAudioSink::error() const
+{
+    return m_stateMachine.error();
+}
+
+QAudio::State QPipeWireAudioSink::state() const
+{
+    return m_stateMachine.state();
+}
+
+void QPipeWireAudioSink::setFormat(const QAudioFormat &format)
+{
+    m_format = format;
+}
+
+QAudioFormat QPipeWireAudioSink::format() const
+{
+    return m_format;
+}
+
+void QPipeWireAudioSink::setVolume(qreal volume)
+{
+    m_volume = qBound(qreal(0), volume, qreal(1));
+}
+
+qreal QPipeWireAudioSink::volume() const
+{
+    return m_volume;
+}
+
+qint64 QPipeWireAudioSink::write(const char *data, qint64 len)
+{
+    if (!m_ringBuffer || !m_stateMachine.isActiveOrIdle())
+        return 0;
+
+    // The data thread renders it, and updates the state
+    return m_ringBuffer->write(QSpan<const char>(data, len));
+}
+
+QSpan<char> QPipeWireAudioSink::beginWrite(qsizetype maxSize)
+{
+    if (!m_ringBuffer || m_pullMode || !m_stateMachine.isActiveOrIdle())
+        return {};
+
+    // The data thread copies the region into the buffer of the stream
+    return m_ringBuffer->acquireWriteRegion(int(qMin(maxSize, bytesFree())));
+}
+
+void QPipeWireAudioSink::commitWrite(qsizetype bytes)
+{
+    if (!m_ringBuffer || bytes <= 0)
+        return;
+
+    // The data thread renders it, and updates the state
+    m_ringBuffer->releaseWriteRegion(int(bytes));
+}
+
+void QPipeWireAudioSink::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_pullTimer.timerId())
+        userFeed();
+
+    QPlatformAudioSink::timerEvent(event);
+}
+
+int QPipeWireAudioSink::pullIntervalMs() const
+{
+    // Twice per quantum, so that the buffer is refilled before the data thread runs dry
+    return qMax(int(m_format.durationForFrames(m_quantumFrames) / 2000), 1);
+}
+
+void QPipeWireAudioSink::userFeed()
+{
+    if (!m_ringBuffer || !m_audioSource)
+        return;
+
+    while (true) {
+        const auto region = m_ringBuffer->acquireWriteRegion(m_ringBuffer->free());
+        if (region.isEmpty())
+            break;
+
+        const qint64 read = m_audioSource->read(region.data(), region.size());
+        if (read <= 0)
+            break;
+
+        m_ringBuffer->releaseWriteRegion(int(read));
+        if (read < region.size())
+            break;
+    }
+}
+
+void QPipeWireAudioSink::renderQuantum(char *data, qsizetype bytes)
+{
+    // Runs on the data thread; the members it uses only change while the stream is disconnected
+    qsizetype filled = 0;
+
+    if (m_callback) {
+        QtAudioPrivate::runAudioCallback(*m_callback, data, bytes);
+        filled = bytes;
+    } else {
+        m_ringBuffer->consume(bytes, [&](QSpan<const char> region) {
+            memcpy(data + filled, region.data(), region.size());
+            filled += region.size();
+        });
+    }
+
+    if (filled < bytes)
+        memset(data + filled, m_format.sampleFormat() == QAudioFormat::UInt8 ? 0x80 : 0,
+               bytes - filled);
+
+    const qreal volume = m_volume;
+    if (volume < 1.0f)
+        QAudioHelperInternal::qMultiplySamples(volume, m_format, data, data, filled);
+
+    m_processedFrames.fetch_add(m_format.framesForBytes(filled), std::memory_order_relaxed);
+
+    const bool starved = filled == 0;
+    if (m_starved.exchange(starved, std::memory_order_relaxed) != starved) {
+        QMetaObject::invokeMethod(
+                this, [this, stream = m_stream.get(), starved] {
+                    onStreamStarved(stream, starved);
+                }, Qt::QueuedConnection);
+    }
+}
+
+void QPipeWireAudioSink::onStreamStarved(QPipeWireAudioStream *stream, bool starved)
+{
+    // Ignore the notifications of the streams that have been closed since
+    if (m_stream.get() != stream)
+        return;
+
+    if (!starved) {
+        m_stateMachine.updateActiveOrIdle(true);
+        return;
+    }
+
+    const bool atEnd = m_pullMode && m_audioSource && m_audioSource->atEnd();
+    m_stateMachine.updateActiveOrIdle(false, atEnd ? QAudio::NoError : QAudio::UnderrunError);
+}
+
+void QPipeWireAudioSink::onStreamFailed(QPipeWireAudioStream *stream)
+{
+    if (m_stream.get() != stream)
+        return;
+
+    if (auto notifier = m_stateMachine.stop(QAudio::IOError))
+        close();
+}
+
+void QPipeWireAudioSink::onContextFailed()
+{
+    if (auto notifier = m_stateMachine.stop(QAudio::FatalError))
+        close();
+}
+
+PipeWireOutputPrivate::PipeWireOutputPrivate(QPipeWireAudioSink *audio) : m_audioDevice(audio) { }
+
+qint64 PipeWireOutputPrivate::readData(char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+
+    return 0;
+}
+
+qint64 PipeWireOutputPrivate::writeData(const char *data, qint64 len)
+{
+    return m_audioDevice->write(data, len);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpipewireaudiosink_p.cpp"
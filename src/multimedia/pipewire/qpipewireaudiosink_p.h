@@ -0,0 +1,127 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIREAUDIOSINK_P_H
+#define QPIPEWIREAUDIOSINK_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qbasictimer.h>
+#include <QtCore/qiodevice.h>
+
+#include <private/qaudioringbuffer_p.h>
+#include <private/qaudiostatemachine_p.h>
+#include <private/qaudiosystem_p.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+class QPipeWireAudioContext;
+class QPipeWireAudioStream;
+
+/**
+ *  @brief Plays audio with a pw_stream, rendering one quantum of the graph per cycle on the
+ * data thread of PipeWire. The callback renders into the buffer of the stream directly; the
+ * QIODevice modes fill a ring buffer of whole quanta on the thread of the sink instead.
+ */
+class QPipeWireAudioSink : public QPlatformAudioSink
+{
+    Q_OBJECT
+
+public:
+    QPipeWireAudioSink(std::shared_ptr<QPipeWireAudioContext> context, const QByteArray &device,
+                       QObject *parent);
+    ~QPipeWireAudioSink() override;
+
+    void start(QIODevice *device) override;
+    QIODevice *start() override;
+    void stop() override;
+    void reset() override;
+    void suspend() override;
+    void resume() override;
+    qsizetype bytesFree() const override;
+    void setBufferSize(qsizetype value) override;
+    qsizetype bufferSize() const override;
+    qint64 processedUSecs() const override;
+    QAudio::Error error() const override;
+    QAudio::State state() const override;
+    void setFormat(const QAudioFormat &format) override;
+    QAudioFormat format() const override;
+
+    void setVolume(qreal volume) override;
+    qreal volume() const override;
+    bool startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback) override;
+    QSpan<char> beginWrite(qsizetype maxSize) override;
+    void commitWrite(qsizetype bytes) override;
+
+    qint64 write(const char *data, qint64 len);
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    bool open();
+    void close();
+    void drain();
+    int pullIntervalMs() const;
+    void userFeed();
+
+    void renderQuantum(char *data, qsizetype bytes);
+    void onStreamStarved(QPipeWireAudioStream *stream, bool starved);
+    void onStreamFailed(QPipeWireAudioStream *stream);
+    void onContextFailed();
+
+    const std::shared_ptr<QPipeWireAudioContext> m_context;
+    const QByteArray m_device;
+    QAudioFormat m_format;
+
+    std::unique_ptr<QPipeWireAudioStream> m_stream;
+    quint32 m_quantumFrames = 0;
+    std::optional<qsizetype> m_userBufferSize;
+    qsizetype m_bufferSize = 0;
+
+    // Set while started with a callback, which renders on the data thread
+    std::optional<QtAudioPrivate::AudioSinkCallback> m_callback;
+
+    // Filled on the thread of the sink, consumed on the data thread
+    std::unique_ptr<QtPrivate::QAudioRingBuffer<char>> m_ringBuffer;
+    QIODevice *m_audioSource = nullptr;
+    bool m_pullMode = true;
+    QBasicTimer m_pullTimer;
+
+    std::atomic<qreal> m_volume = 1.0;
+    std::atomic<qint64> m_processedFrames = 0;
+    std::atomic_bool m_starved = false;
+
+    QAudioStateMachine m_stateMachine;
+};
+
+class PipeWireOutputPrivate : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit PipeWireOutputPrivate(QPipeWireAudioSink *audio);
+
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    QPipeWireAudioSink *m_audioDevice;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIREAUDIOSINK_P_H
@@ -0,0 +1,395 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpipewireaudiosource_p.h"
+#include "qpipewireaudiocontext_p.h"
+#include "qpipewireaudiostream_p.h"
+
+#include <QtCore/qloggingcategory.h>
+#include <private/qaudiohelpers_p.h>
+
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcPipeWireAudioSource, "qt.multimedia.pipewire.audio.source");
+
+// About 40 ms at the default quantum
+static constexpr int DefaultQuantaPerBuffer = 4;
+
+QPipeWireAudioSource::QPipeWireAudioSource(std::shared_ptr<QPipeWireAudioContext> context,
+                                           const QByteArray &device, QObject *parent)
+    : QPlatformAudioSource(parent),
+      m_context(std::move(context)),
+      m_device(device),
+      m_stateMachine(*this)
+{
+}
+
+QPipeWireAudioSource::~QPipeWireAudioSource()
+{
+    if (auto notifier = m_stateMachine.stop())
+        close();
+}
+
+void QPipeWireAudioSource::start(QIODevice *device)
+{
+    reset();
+
+    m_pullMode = true;
+    m_audioSource = device;
+
+    if (!open()) {
+        m_audioSource = nullptr;
+        return;
+    }
+
+    m_stateMachine.start();
+}
+
+QIODevice *QPipeWireAudioSource::start()
+{
+    reset();
+
+    m_pullMode = false;
+    m_audioSource = new PipeWireInputPrivate(this);
+    m_audioSource->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    if (!open()) {
+        delete std::exchange(m_audioSource, nullptr);
+        return nullptr;
+    }
+
+    m_stateMachine.start(false);
+
+    return m_audioSource;
+}
+
+bool QPipeWireAudioSource::startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback)
+{
+    reset();
+
+    m_pullMode = false;
+    m_callback = std::move(callback);
+
+    if (!open()) {
+        m_callback.reset();
+        return true;
+    }
+
+    m_stateMachine.start();
+
+    return true;
+}
+
+bool QPipeWireAudioSource::open()
+{
+    if (!m_format.isValid()) {
+        m_stateMachine.stopOrUpdateError(QAudio::OpenError);
+        return false;
+    }
+
+    // The buffer holds whole quanta, at least two so that one is read while the next arrives
+    m_quantumFrames = QPipeWireAudioStream::defaultQuantumFrames(m_format.sampleRate());
+    const qsizetype quantumBytes = m_format.bytesForFrames(m_quantumFrames);
+    const qsizetype requestedSize =
+            m_userBufferSize.value_or(DefaultQuantaPerBuffer * quantumBytes);
+    m_bufferSize =
+            qMax((requestedSize + quantumBytes - 1) / quantumBytes, qsizetype(2)) * quantumBytes;
+
+    if (m_callback)
+        m_volumeBuffer.resize(quantumBytes);
+    else
+        m_ringBuffer = std::make_unique<QtPrivate::QAudioRingBuffer<char>>(int(m_bufferSize));
+
+    m_processedFrames = 0;
+    m_capturedPending = false;
+
+    m_stream = std::make_unique<QPipeWireAudioStream>(
+            *m_context, QAudioDevice::Input,
+            [this](char *data, qsizetype bytes) { captureQuantum(data, bytes); },
+            [this] {
+                QMetaObject::invokeMethod(
+                        this, [this, stream = m_stream.get()] { onStreamFailed(stream); },
+                        Qt::QueuedConnection);
+            });
+
+    const QByteArray streamName =
+            QStringLiteral("QtmPipeWireStream-%1-%2").arg(::getpid()).arg(quintptr(this)).toUtf8();
+    if (!m_stream->connect(m_device, m_format, m_quantumFrames, streamName)) {
+        qCWarning(qLcPipeWireAudioSource) << "Can't connect a stream to" << m_device;
+        m_stream.reset();
+        m_ringBuffer.reset();
+        m_stateMachine.stopOrUpdateError(QAudio::OpenError);
+        return false;
+    }
+
+    qCDebug(qLcPipeWireAudioSource) << "Opened stream with a quantum of" << m_quantumFrames
+                                    << "frames and a buffer of" << m_bufferSize << "bytes";
+
+    connect(m_context.get(), &QPipeWireAudioContext::contextFailed, this,
+            &QPipeWireAudioSource::onContextFailed);
+
+    return true;
+}
+
+void QPipeWireAudioSource::close()
+{
+    if (m_stream) {
+        // Stops the processing on the data thread before releasing what it uses
+        m_stream->disconnect();
+        m_stream.reset();
+    }
+
+    disconnect(m_context.get(), &QPipeWireAudioContext::contextFailed, this,
+               &QPipeWireAudioSource::onContextFailed);
+
+    if (m_audioSource) {
+        if (!m_pullMode)
+            delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    m_ringBuffer.reset();
+    m_callback.reset();
+    m_volumeBuffer.clear();
+}
+
+void QPipeWireAudioSource::stop()
+{
+    if (auto notifier = m_stateMachine.stop()) {
+        // Hand what has been captured to the device before closing
+        if (m_pullMode)
+            flushToDevice();
+        close();
+    }
+}
+
+void QPipeWireAudioSource::reset()
+{
+    if (auto notifier = m_stateMachine.stopOrUpdateError())
+        close();
+}
+
+void QPipeWireAudioSource::suspend()
+{
+    if (auto notifier = m_stateMachine.suspend())
+        m_stream->setActive(false);
+}
+
+void QPipeWireAudioSource::resume()
+{
+    if (auto notifier = m_stateMachine.resume())
+        m_stream->setActive(true);
+}
+
+qsizetype QPipeWireAudioSource::bytesReady() const
+{
+    if (!m_ringBuffer || !m_stateMachine.isActiveOrIdle())
+        return 0;
+
+    return m_ringBuffer->used();
+}
+
+void QPipeWireAudioSource::setBufferSize(qsizetype value)
+{
+    m_userBufferSize = value;
+}
+
+qsizetype QPipeWireAudioSource::bufferSize() const
+{
+    if (m_bufferSize)
+        return m_bufferSize;
+
+    if (m_userBufferSize)
+        return *m_userBufferSize;
+
+    if (!m_format.isValid())
+        return 0;
+
+    const quint32 quantumFrames = QPipeWireAudioStream::defaultQuantumFrames(m_format.sampleRate());
+    return DefaultQuantaPerBuffer * m_format.bytesForFrames(quantumFrames);
+}
+
+qint64 QPipeWireAudioSource::processedUSecs() const
+{
+    if (m_format.sampleRate() <= 0)
+        return 0;
+
+    return qint64(1000000) * m_processedFrames / m_format.sampleRate();
+}
+
+QAudio::Error QPipeWireAudioSource::error() const
+{
+    return m_stateMachine.error();
+}
+
+QAudio::State QPipeWireAudioSource::state() const
+{
+    return m_stateMachine.state();
+}
+
+void QPipeWireAudioSource::setFormat(const QAudioFormat &format)
+{
+    m_format = format;
+}
+
+QAudioFormat QPipeWireAudioSource::format() const
+{
+    return m_format;
+}
+
+void QPipeWireAudioSource::setVolume(qreal volume)
+{
+    m_volume = qBound(qreal(0), volume, qreal(1));
+}
+
+qreal QPipeWireAudioSource::volume() const
+{
+    return m_volume;
+}
+
+qint64 QPipeWireAudioSource::read(char *data, qint64 len)
+{
+    if (!m_ringBuffer || !m_stateMachine.isActiveOrIdle())
+        return 0;
+
+    // Whole frames only, the data thread writes whole frames
+    const qint64 frameBytes = m_format.bytesPerFrame();
+    const qint64 toRead = qMin<qint64>(len, m_ringBuffer->used()) / frameBytes * frameBytes;
+
+    qint64 read = 0;
+    m_ringBuffer->consume(int(toRead), [&](QSpan<const char> region) {
+        memcpy(data + read, region.data(), region.size());
+        read += region.size();
+    });
+
+    if (read > 0)
+        m_stateMachine.activateFromIdle();
+
+    return read;
+}
+
+bool QPipeWireAudioSource::flushToDevice()
+{
+    if (!m_ringBuffer || !m_audioSource)
+        return true;
+
+    while (true) {
+        const auto region = m_ringBuffer->acquireReadRegion(m_ringBuffer->used());
+        if (region.isEmpty())
+            return true;
+
+        const qint64 written = m_audioSource->write(region.data(), region.size());
+        if (written < 0)
+            return false;
+
+        m_ringBuffer->releaseReadRegion(int(written));
+        if (written < region.size())
+            return true;
+    }
+}
+
+void QPipeWireAudioSource::captureQuantum(const char *data, qsizetype bytes)
+{
+    // Runs on the data thread; the members it uses only change while the stream is disconnected
+    const qreal volume = m_volume;
+
+    if (m_callback) {
+        if (volume >= 1.0f) {
+            QtAudioPrivate::runAudioCallback(*m_callback, data, bytes);
+        } else {
+            // The quantum of the graph can exceed the one asked for, scale it in parts
+            char *scaled = m_volumeBuffer.data();
+            for (qsizetype offset = 0; offset < bytes; offset += m_volumeBuffer.size()) {
+                const qsizetype chunk = qMin(bytes - offset, m_volumeBuffer.size());
+                QAudioHelperInternal::qMultiplySamples(volume, m_format, data + offset, scaled,
+                                                       chunk);
+                QtAudioPrivate::runAudioCallback(*m_callback, scaled, chunk);
+            }
+        }
+    } else {
+        // Drops what doesn't fit, like a device overrun
+        qsizetype written = 0;
+        while (written < bytes) {
+            const auto region = m_ringBuffer->acquireWriteRegion(int(bytes - written));
+            if (region.isEmpty())
+                break;
+
+            if (volume < 1.0f)
+                QAudioHelperInternal::qMultiplySamples(volume, m_format, data + written,
+                                                       region.data(), region.size());
+            else
+                memcpy(region.data(), data + written, region.size());
+
+            m_ringBuffer->releaseWriteRegion(int(region.size()));
+            written += region.size();
+        }
+
+        if (written < bytes)
+            qCDebug(qLcPipeWireAudioSource) << "Buffer overrun, dropped" << bytes - written
+                                            << "bytes";
+
+        if (!m_capturedPending.exchange(true, std::memory_order_relaxed)) {
+            QMetaObject::invokeMethod(
+                    this, [this, stream = m_stream.get()] { onStreamCaptured(stream); },
+                    Qt::QueuedConnection);
+        }
+    }
+
+    m_processedFrames.fetch_add(m_format.framesForBytes(bytes), std::memory_order_relaxed);
+}
+
+void QPipeWireAudioSource::onStreamCaptured(QPipeWireAudioStream *stream)
+{
+    // Ignore the notifications of the streams that have been closed since
+    if (m_stream.get() != stream)
+        return;
+
+    m_capturedPending.store(false, std::memory_order_relaxed);
+
+    if (!m_pullMode) {
+        if (m_audioSource)
+            static_cast<PipeWireInputPrivate *>(m_audioSource)->trigger();
+        return;
+    }
+
+    if (!flushToDevice()) {
+        if (auto notifier = m_stateMachine.stop(QAudio::IOError))
+            close();
+    }
+}
+
+void QPipeWireAudioSource::onStreamFailed(QPipeWireAudioStream *stream)
+{
+    if (m_stream.get() != stream)
+        return;
+
+    if (auto notifier = m_stateMachine.stop(QAudio::IOError))
+        close();
+}
+
+void QPipeWireAudioSource::onContextFailed()
+{
+    if (auto notifier = m_stateMachine.stop(QAudio::FatalError))
+        close();
+}
+
+PipeWireInputPrivate::PipeWireInputPrivate(QPipeWireAudioSource *audio) : m_audioDevice(audio) { }
+
+qint64 PipeWireInputPrivate::readData(char *data, qint64 len)
+{
+    return m_audioDevice->read(data, len);
+}
+
+qint64 PipeWireInputPrivate::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+
+    return 0;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpipewireaudiosource_p.cpp"
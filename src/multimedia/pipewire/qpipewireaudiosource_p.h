@@ -0,0 +1,122 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIREAUDIOSOURCE_P_H
+#define QPIPEWIREAUDIOSOURCE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qiodevice.h>
+
+#include <private/qaudioringbuffer_p.h>
+#include <private/qaudiostatemachine_p.h>
+#include <private/qaudiosystem_p.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+class QPipeWireAudioContext;
+class QPipeWireAudioStream;
+
+/**
+ *  @brief Captures audio with a pw_stream, getting one quantum of the graph per cycle on the
+ * data thread of PipeWire. The callback gets the buffer of the stream directly; the QIODevice
+ * modes go through a ring buffer read on the thread of the source instead.
+ */
+class QPipeWireAudioSource : public QPlatformAudioSource
+{
+    Q_OBJECT
+
+public:
+    QPipeWireAudioSource(std::shared_ptr<QPipeWireAudioContext> context, const QByteArray &device,
+                         QObject *parent);
+    ~QPipeWireAudioSource() override;
+
+    void start(QIODevice *device) override;
+    QIODevice *start() override;
+    void stop() override;
+    void reset() override;
+    void suspend() override;
+    void resume() override;
+    qsizetype bytesReady() const override;
+    void setBufferSize(qsizetype value) override;
+    qsizetype bufferSize() const override;
+    qint64 processedUSecs() const override;
+    QAudio::Error error() const override;
+    QAudio::State state() const override;
+    void setFormat(const QAudioFormat &format) override;
+    QAudioFormat format() const override;
+
+    void setVolume(qreal volume) override;
+    qreal volume() const override;
+    bool startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback) override;
+
+    qint64 read(char *data, qint64 len);
+
+private:
+    bool open();
+    void close();
+    bool flushToDevice();
+
+    void captureQuantum(const char *data, qsizetype bytes);
+    void onStreamCaptured(QPipeWireAudioStream *stream);
+    void onStreamFailed(QPipeWireAudioStream *stream);
+    void onContextFailed();
+
+    const std::shared_ptr<QPipeWireAudioContext> m_context;
+    const QByteArray m_device;
+    QAudioFormat m_format;
+
+    std::unique_ptr<QPipeWireAudioStream> m_stream;
+    quint32 m_quantumFrames = 0;
+    std::optional<qsizetype> m_userBufferSize;
+    qsizetype m_bufferSize = 0;
+
+    // Set while started with a callback, which gets the samples on the data thread. The
+    // samples are scaled in m_volumeBuffer if the volume is lowered.
+    std::optional<QtAudioPrivate::AudioSourceCallback> m_callback;
+    QByteArray m_volumeBuffer;
+
+    // Filled on the data thread, read on the thread of the source
+    std::unique_ptr<QtPrivate::QAudioRingBuffer<char>> m_ringBuffer;
+    QIODevice *m_audioSource = nullptr;
+    bool m_pullMode = true;
+    std::atomic_bool m_capturedPending = false;
+
+    std::atomic<qreal> m_volume = 1.0;
+    std::atomic<qint64> m_processedFrames = 0;
+
+    QAudioStateMachine m_stateMachine;
+};
+
+class PipeWireInputPrivate : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit PipeWireInputPrivate(QPipeWireAudioSource *audio);
+
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+    void trigger() { emit readyRead(); }
+
+private:
+    QPipeWireAudioSource *m_audioDevice;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIREAUDIOSOURCE_P_H
@@ -0,0 +1,301 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpipewireaudiostream_p.h"
+#include "qpipewireaudiocontext_p.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qmath.h>
+
+#include <spa/param/audio/format-utils.h>
+
+#include <iterator>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcPipeWireAudioStream, "qt.multimedia.pipewire.audio.stream");
+
+// Bounds the time connect() waits for the session manager to link the stream
+static constexpr int ConnectTimeoutSecs = 2;
+
+static constexpr quint32 DefaultQuantumMs = 10;
+
+static spa_audio_format toSpaAudioFormat(QAudioFormat::SampleFormat format)
+{
+    switch (format) {
+    case QAudioFormat::UInt8:
+        return SPA_AUDIO_FORMAT_U8;
+    case QAudioFormat::Int16:
+        return SPA_AUDIO_FORMAT_S16;
+    case QAudioFormat::Int32:
+        return SPA_AUDIO_FORMAT_S32;
+    case QAudioFormat::Float:
+        return SPA_AUDIO_FORMAT_F32;
+    default:
+        return SPA_AUDIO_FORMAT_UNKNOWN;
+    }
+}
+
+static spa_audio_info_raw toSpaAudioInfo(const QAudioFormat &format)
+{
+    // Indexed by QAudioFormat::AudioChannelPosition
+    static constexpr spa_audio_channel positions[] = {
+        SPA_AUDIO_CHANNEL_UNKNOWN,
+        SPA_AUDIO_CHANNEL_FL,
+        SPA_AUDIO_CHANNEL_FR,
+        SPA_AUDIO_CHANNEL_FC,
+        SPA_AUDIO_CHANNEL_LFE,
+        SPA_AUDIO_CHANNEL_RL,
+        SPA_AUDIO_CHANNEL_RR,
+        SPA_AUDIO_CHANNEL_FLC,
+        SPA_AUDIO_CHANNEL_FRC,
+        SPA_AUDIO_CHANNEL_RC,
+        SPA_AUDIO_CHANNEL_SL,
+        SPA_AUDIO_CHANNEL_SR,
+        SPA_AUDIO_CHANNEL_TC,
+        SPA_AUDIO_CHANNEL_TFL,
+        SPA_AUDIO_CHANNEL_TFC,
+        SPA_AUDIO_CHANNEL_TFR,
+        SPA_AUDIO_CHANNEL_TRL,
+        SPA_AUDIO_CHANNEL_TRC,
+        SPA_AUDIO_CHANNEL_TRR,
+        SPA_AUDIO_CHANNEL_LFE2,
+        SPA_AUDIO_CHANNEL_TSL,
+        SPA_AUDIO_CHANNEL_TSR,
+        SPA_AUDIO_CHANNEL_BC,
+        SPA_AUDIO_CHANNEL_BLC,
+        SPA_AUDIO_CHANNEL_BRC,
+    };
+    static_assert(std::size(positions) == QAudioFormat::NChannelPositions);
+
+    spa_audio_info_raw info = {};
+    info.format = toSpaAudioFormat(format.sampleFormat());
+    info.rate = format.sampleRate();
+    info.channels = qMin<int>(format.channelCount(), SPA_AUDIO_MAX_CHANNELS);
+
+    auto config = format.channelConfig();
+    if (config == QAudioFormat::ChannelConfigUnknown)
+        config = QAudioFormat::defaultChannelConfigForChannelCount(format.channelCount());
+
+    // The samples of the channels are interleaved in the order of the positions
+    if (config == QAudioFormat::ChannelConfigMono) {
+        info.position[0] = SPA_AUDIO_CHANNEL_MONO;
+    } else if (qPopulationCount(quint32(config)) == info.channels) {
+        uint32_t channel = 0;
+        for (int position = 1; position < QAudioFormat::NChannelPositions; ++position) {
+            const auto bit =
+                    QAudioFormat::channelConfig(QAudioFormat::AudioChannelPosition(position));
+            if (config & bit)
+                info.position[channel++] = positions[position];
+        }
+    } else {
+        info.flags = SPA_AUDIO_FLAG_UNPOSITIONED;
+    }
+
+    return info;
+}
+
+QPipeWireAudioStream::QPipeWireAudioStream(QPipeWireAudioContext &context,
+                                           QAudioDevice::Mode mode, ProcessHandler process,
+                                           FailureHandler onFailure)
+    : m_context(context),
+      m_mode(mode),
+      m_process(std::move(process)),
+      m_onFailure(std::move(onFailure))
+{
+}
+
+QPipeWireAudioStream::~QPipeWireAudioStream()
+{
+    disconnect();
+}
+
+quint32 QPipeWireAudioStream::defaultQuantumFrames(int sampleRate)
+{
+    const quint32 frames = qMax(quint32(sampleRate) * DefaultQuantumMs / 1000, 2u);
+    return qNextPowerOfTwo(frames - 1);
+}
+
+bool QPipeWireAudioStream::connect(const QByteArray &nodeName, const QAudioFormat &format,
+                                   quint32 quantumFrames, const QByteArray &streamName)
+{
+    static const pw_stream_events streamEvents = {
+        .version = PW_VERSION_STREAM_EVENTS,
+        .state_changed = [](void *data, pw_stream_state old, pw_stream_state state,
+                            const char *error) {
+            Q_UNUSED(old)
+            static_cast<QPipeWireAudioStream *>(data)->onStateChanged(state, error);
+        },
+        .process = [](void *data) {
+            static_cast<QPipeWireAudioStream *>(data)->process();
+        },
+    };
+
+    Q_ASSERT(!m_stream);
+
+    const spa_audio_info_raw info = toSpaAudioInfo(format);
+    if (info.format == SPA_AUDIO_FORMAT_UNKNOWN || info.rate == 0 || info.channels == 0)
+        return false;
+
+    m_bytesPerFrame = format.bytesPerFrame();
+
+    // The graph runs at the smallest quantum the linked streams ask for
+    const QByteArray latency =
+            QByteArray::number(quantumFrames) + '/' + QByteArray::number(format.sampleRate());
+    const QByteArray appName = QCoreApplication::applicationName().toUtf8();
+
+    spa_dict_item items[5];
+    uint32_t itemCount = 0;
+    items[itemCount++] = SPA_DICT_ITEM_INIT(PW_KEY_MEDIA_TYPE, "Audio");
+    items[itemCount++] = SPA_DICT_ITEM_INIT(
+            PW_KEY_MEDIA_CATEGORY, m_mode == QAudioDevice::Output ? "Playback" : "Capture");
+    items[itemCount++] = SPA_DICT_ITEM_INIT(PW_KEY_NODE_LATENCY, latency.constData());
+    items[itemCount++] = SPA_DICT_ITEM_INIT(PW_KEY_APP_NAME, appName.constData());
+    if (!nodeName.isEmpty()) {
+#ifdef PW_KEY_TARGET_OBJECT
+        items[itemCount++] = SPA_DICT_ITEM_INIT(PW_KEY_TARGET_OBJECT, nodeName.constData());
+#else
+        items[itemCount++] = SPA_DICT_ITEM_INIT(PW_KEY_NODE_TARGET, nodeName.constData());
+#endif
+    }
+    const spa_dict dict = SPA_DICT_INIT(items, itemCount);
+
+    uint8_t buffer[1024];
+    spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+    spa_audio_info_raw mutableInfo = info;
+    const spa_pod *params[] = {
+        spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &mutableInfo),
+    };
+
+    QPipeWireAudioContext::Locker locker(m_context);
+
+    m_stream = pw_stream_new(m_context.core(), streamName.constData(),
+                             pw_properties_new_dict(&dict));
+    if (!m_stream) {
+        qCWarning(qLcPipeWireAudioStream) << "pw_stream_new() failed";
+        return false;
+    }
+
+    m_listener = {};
+    m_state = PW_STREAM_STATE_UNCONNECTED;
+    pw_stream_add_listener(m_stream, &m_listener, &streamEvents, this);
+
+    const auto flags = pw_stream_flags(PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS
+                                       | PW_STREAM_FLAG_RT_PROCESS);
+    const auto direction =
+            m_mode == QAudioDevice::Output ? PW_DIRECTION_OUTPUT : PW_DIRECTION_INPUT;
+    if (pw_stream_connect(m_stream, direction, PW_ID_ANY, flags, params, std::size(params)) != 0) {
+        qCWarning(qLcPipeWireAudioStream) << "pw_stream_connect() failed";
+        destroyStream();
+        return false;
+    }
+
+    // Ready once the format is negotiated with the node
+    while (m_state != PW_STREAM_STATE_PAUSED && m_state != PW_STREAM_STATE_STREAMING
+           && m_state != PW_STREAM_STATE_ERROR) {
+        if (pw_thread_loop_timed_wait(m_context.threadLoop(), ConnectTimeoutSecs) != 0)
+            break;
+    }
+
+    if (m_state != PW_STREAM_STATE_PAUSED && m_state != PW_STREAM_STATE_STREAMING) {
+        qCWarning(qLcPipeWireAudioStream) << "The stream couldn't be linked to a node";
+        destroyStream();
+        return false;
+    }
+
+    return true;
+}
+
+void QPipeWireAudioStream::disconnect()
+{
+    if (!m_stream)
+        return;
+
+    // Waits for the data thread, the process handler isn't called once this returns
+    QPipeWireAudioContext::Locker locker(m_context);
+    destroyStream();
+}
+
+void QPipeWireAudioStream::destroyStream()
+{
+    spa_hook_remove(&m_listener);
+    pw_stream_disconnect(m_stream);
+    pw_stream_destroy(m_stream);
+    m_stream = nullptr;
+    m_state = PW_STREAM_STATE_UNCONNECTED;
+    m_quantumFrames = 0;
+}
+
+void QPipeWireAudioStream::setActive(bool active)
+{
+    if (!m_stream)
+        return;
+
+    QPipeWireAudioContext::Locker locker(m_context);
+    pw_stream_set_active(m_stream, active);
+}
+
+void QPipeWireAudioStream::process()
+{
+    pw_buffer *buffer = pw_stream_dequeue_buffer(m_stream);
+    if (!buffer)
+        return; // all the buffers are queued, the node is late
+
+    spa_data &data = buffer->buffer->datas[0];
+    if (!data.data || !data.chunk) {
+        pw_stream_queue_buffer(m_stream, buffer);
+        return;
+    }
+
+    char *samples = static_cast<char *>(data.data);
+
+    if (m_mode == QAudioDevice::Output) {
+        // Fill exactly the quantum the graph asks for, so that no samples are queued ahead
+        uint64_t frames = data.maxsize / m_bytesPerFrame;
+#if PW_CHECK_VERSION(0, 3, 49)
+        if (buffer->requested)
+            frames = qMin(buffer->requested, frames);
+#endif
+        const qsizetype bytes = frames * m_bytesPerFrame;
+        m_quantumFrames.store(quint32(frames), std::memory_order_relaxed);
+
+        m_process(samples, bytes);
+
+        data.chunk->offset = 0;
+        data.chunk->stride = m_bytesPerFrame;
+        data.chunk->size = bytes;
+    } else {
+        const quint32 offset = qMin(data.chunk->offset, data.maxsize);
+        const quint32 size = qMin(data.chunk->size, data.maxsize - offset);
+        const qsizetype bytes = size - size % m_bytesPerFrame;
+        m_quantumFrames.store(bytes / m_bytesPerFrame, std::memory_order_relaxed);
+
+        if (bytes > 0)
+            m_process(samples + offset, bytes);
+    }
+
+    pw_stream_queue_buffer(m_stream, buffer);
+}
+
+void QPipeWireAudioStream::onStateChanged(pw_stream_state state, const char *error)
+{
+    qCDebug(qLcPipeWireAudioStream) << "Stream state:" << pw_stream_state_as_string(state)
+                                    << (error ? error : "");
+
+    const bool failed = state == PW_STREAM_STATE_ERROR && m_state != PW_STREAM_STATE_ERROR;
+    const bool connecting = m_state == PW_STREAM_STATE_CONNECTING
+            || m_state == PW_STREAM_STATE_UNCONNECTED;
+    m_state = state;
+
+    // Wakes up connect()
+    pw_thread_loop_signal(m_context.threadLoop(), false);
+
+    // Failures while connecting are reported by connect()
+    if (failed && !connecting) {
+        qCWarning(qLcPipeWireAudioStream) << "Stream error:" << (error ? error : "");
+        m_onFailure();
+    }
+}
+
+QT_END_NAMESPACE
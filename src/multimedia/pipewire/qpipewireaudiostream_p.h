@@ -0,0 +1,86 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPIPEWIREAUDIOSTREAM_P_H
+#define QPIPEWIREAUDIOSTREAM_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudioformat.h>
+
+#include <pipewire/pipewire.h>
+
+#include <atomic>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class QPipeWireAudioContext;
+
+/**
+ *  @brief A pw_stream of interleaved samples, connected to a sink or source node. The stream
+ * is created with PW_STREAM_FLAG_RT_PROCESS, so that its process callback runs on the real-time
+ * data thread of PipeWire, once per cycle of the graph, without taking the lock of the thread
+ * loop of the context. Each call processes one quantum of the graph in the buffer of the stream.
+ */
+class QPipeWireAudioStream
+{
+public:
+    // Renders bytes of playback into data, or consumes bytes of capture from it. Called on the
+    // data thread, bytes is whole frames: the quantum of the graph, or what was captured of it.
+    using ProcessHandler = std::function<void(char *data, qsizetype bytes)>;
+    // Called on the thread loop if the stream fails
+    using FailureHandler = std::function<void()>;
+
+    QPipeWireAudioStream(QPipeWireAudioContext &context, QAudioDevice::Mode mode,
+                         ProcessHandler process, FailureHandler onFailure);
+    ~QPipeWireAudioStream();
+    Q_DISABLE_COPY_MOVE(QPipeWireAudioStream)
+
+    // A power of two frames of about 10 ms, like the quanta the graph runs at
+    static quint32 defaultQuantumFrames(int sampleRate);
+
+    // Connects to the node of the device, or to the default one if nodeName is empty, asking
+    // the graph for a quantum of quantumFrames. Waits until the stream is ready to process;
+    // on failure, the stream is destroyed again, so that connect() can be retried.
+    bool connect(const QByteArray &nodeName, const QAudioFormat &format, quint32 quantumFrames,
+                 const QByteArray &streamName);
+    void disconnect();
+
+    // Pauses or resumes the processing; a paused stream keeps its link to the node
+    void setActive(bool active);
+
+    // The quantum of the last cycle, in frames
+    quint32 quantumFrames() const { return m_quantumFrames.load(std::memory_order_relaxed); }
+
+private:
+    // Needs the lock of the thread loop
+    void destroyStream();
+    void process();
+    void onStateChanged(pw_stream_state state, const char *error);
+
+    QPipeWireAudioContext &m_context;
+    const QAudioDevice::Mode m_mode;
+    const ProcessHandler m_process;
+    const FailureHandler m_onFailure;
+
+    pw_stream *m_stream = nullptr;
+    spa_hook m_listener = {};
+    pw_stream_state m_state = PW_STREAM_STATE_UNCONNECTED;
+    qsizetype m_bytesPerFrame = 0;
+    std::atomic<quint32> m_quantumFrames = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPIPEWIREAUDIOSTREAM_P_H
@@ -24,11 +24,19 @@
 #include <private/qwasmmediadevices_p.h>
 #endif
 
+#if QT_CONFIG(pipewire)
+#include <qpipewireaudiomediadevices_p.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
 std::unique_ptr<QPlatformMediaDevices> QPlatformMediaDevices::create()
 {
+#if QT_CONFIG(pipewire)
+    if (auto devices = QPipeWireAudioMediaDevices::create())
+        return devices;
+#endif
+
 #ifdef Q_OS_DARWIN
     return std::make_unique<QDarwinMediaDevices>();
 #elif defined(Q_OS_WINDOWS) && QT_CONFIG(wmf)
@@ -19,11 +19,15 @@
 #include <QtMultimedia/qmediatimerange.h>
 #include <QtMultimedia/qaudiodevice.h>
 #include <QtMultimedia/qmediametadata.h>
+#include <QtMultimedia/private/qplaybackbufferingpolicy_p.h>
+#include <QtMultimedia/private/qplaybackstatistics_p.h>
 
 #include <QtCore/qpair.h>
 #include <QtCore/private/qglobal_p.h>
 #include <QtCore/qobject.h>
 
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 class QMediaStreamsControl;
@@ -71,6 +75,20 @@ public:
 
     virtual void setVideoSink(QVideoSink * /*sink*/) = 0;
 
+    // Backends that buffer demuxed data ahead of the playback position may
+    // override it; std::nullopt restores the backend's default policy.
+    virtual void setBufferingPolicy(const std::optional<QPlaybackBufferingPolicy> &) { }
+
+    // In the scrubbing mode, backends may cache decoded video frames in order to serve
+    // repeated or nearby seeks of a paused player without decoding.
+    virtual void setScrubbingMode(bool) { }
+
+    // Backends that track late and dropped video frames report them here
+    virtual QPlaybackVideoFrameStatistics videoFrameStatistics() const { return {}; }
+
+    // Backends with an inspectable playback pipeline report its state here
+    virtual QPlaybackStatistics playbackStatistics() const { return {}; }
+
     // media streams
     enum TrackType : uint8_t { VideoStream, AudioStream, SubtitleStream, NTrackTypes };
 
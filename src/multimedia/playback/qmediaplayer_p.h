@@ -22,6 +22,8 @@
 #include "qaudiobufferoutput.h"
 #include <private/qplatformmediaplayer_p.h>
 #include <private/qerrorinfo_p.h>
+#include <private/qplaybackbufferingpolicy_p.h>
+#include <private/qplaybackstatistics_p.h>
 
 #include "private/qobject_p.h"
 #include <QtCore/qobject.h>
@@ -31,6 +33,7 @@
 #include <QtCore/qtimer.h>
 
 #include <memory>
+#include <optional>
 
 QT_BEGIN_NAMESPACE
 
@@ -60,6 +63,8 @@ public:
 
     QMediaPlayer::PlaybackState state = QMediaPlayer::StoppedState;
     QErrorInfo<QMediaPlayer::Error> error;
+    std::optional<QPlaybackBufferingPolicy> bufferingPolicy;
+    bool scrubbingMode = false;
 
     void setMedia(const QUrl &media, QIODevice *stream = nullptr);
 
@@ -69,6 +74,36 @@ public:
     void setStatus(QMediaPlayer::MediaStatus status);
     void setError(QMediaPlayer::Error error, const QString &errorString);
 
+    void setBufferingPolicy(std::optional<QPlaybackBufferingPolicy> policy)
+    {
+        if (policy)
+            policy = policy->normalized();
+        if (policy == bufferingPolicy)
+            return;
+        bufferingPolicy = policy;
+        if (control)
+            control->setBufferingPolicy(policy);
+    }
+
+    void setScrubbingMode(bool enabled)
+    {
+        if (enabled == scrubbingMode)
+            return;
+        scrubbingMode = enabled;
+        if (control)
+            control->setScrubbingMode(enabled);
+    }
+
+    QPlaybackVideoFrameStatistics videoFrameStatistics() const
+    {
+        return control ? control->videoFrameStatistics() : QPlaybackVideoFrameStatistics{};
+    }
+
+    QPlaybackStatistics playbackStatistics() const
+    {
+        return control ? control->playbackStatistics() : QPlaybackStatistics{};
+    }
+
     void setVideoSink(QVideoSink *sink)
     {
         Q_Q(QMediaPlayer);
@@ -0,0 +1,182 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPLAYBACKBUFFERINGPOLICY_P_H
+#define QPLAYBACKBUFFERINGPOLICY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+/* Describes how much demuxed data a media player backend keeps ahead of
+ * the playback position.
+ *
+ * Each track type has its own budget. The backend stops reading the source as soon
+ * as any stream reaches the high watermark (duration or size), and resumes when
+ * the stream gets below the low watermark. Equal watermarks give continuous
+ * reading; a lower low watermark makes the reading happen in bursts.
+ *
+ * In the Adaptive mode, the budgets are scaled within [minScale, maxScale]
+ * depending on how fast the source is read compared to its bitrate:
+ * slow sources get deeper buffers, fast ones get shallower buffers.
+ *
+ * Policies coming from the user are normalized() before the backend uses them.
+ */
+struct QPlaybackBufferingPolicy
+{
+    enum Mode { Fixed, Adaptive };
+
+    enum SourceType { LocalSource, NetworkSource };
+
+    struct Budget
+    {
+        std::chrono::microseconds highWatermarkDuration{};
+        std::chrono::microseconds lowWatermarkDuration{};
+        qint64 highWatermarkSize = 0;
+        qint64 lowWatermarkSize = 0;
+
+        friend bool operator==(const Budget &a, const Budget &b)
+        {
+            return a.highWatermarkDuration == b.highWatermarkDuration
+                    && a.lowWatermarkDuration == b.lowWatermarkDuration
+                    && a.highWatermarkSize == b.highWatermarkSize
+                    && a.lowWatermarkSize == b.lowWatermarkSize;
+        }
+        friend bool operator!=(const Budget &a, const Budget &b) { return !(a == b); }
+    };
+
+    Mode mode = Fixed;
+
+    // indexed by QPlatformMediaPlayer::TrackType
+    std::array<Budget, 3> budgets;
+
+    float minScale = 1.f;
+    float maxScale = 1.f;
+
+    // If the source is read less than SlowReadSpeedFactor times faster than it's played,
+    // the Adaptive mode grows the budgets by ScaleStep; above FastReadSpeedFactor, it
+    // shrinks them.
+    static constexpr float SlowReadSpeedFactor = 2.f;
+    static constexpr float FastReadSpeedFactor = 8.f;
+    static constexpr float ScaleStep = 1.25f;
+
+    static QPlaybackBufferingPolicy defaultPolicy(SourceType sourceType)
+    {
+        using namespace std::chrono_literals;
+        constexpr qint64 MiB = 1024 * 1024;
+
+        QPlaybackBufferingPolicy result;
+
+        if (sourceType == LocalSource) {
+            // Local sources are read much faster than played, the limits of the
+            // demuxer from before the policy existed are kept for them.
+            result.budgets[0] = { 4s, 4s, 32 * MiB, 32 * MiB }; // video
+            result.budgets[1] = { 4s, 4s, 32 * MiB, 32 * MiB }; // audio
+            result.budgets[2] = { 4s, 4s, 32 * MiB, 32 * MiB }; // subtitles
+        } else {
+            // Network sources need deeper buffers to absorb jitter;
+            // refilling from the half lets the connection idle in between.
+            result.mode = Adaptive;
+            result.budgets[0] = { 8s, 4s, 64 * MiB, 32 * MiB }; // video
+            result.budgets[1] = { 8s, 4s, 8 * MiB, 4 * MiB }; // audio
+            result.budgets[2] = { 8s, 4s, 2 * MiB, 1 * MiB }; // subtitles
+            result.minScale = 0.5f;
+            result.maxScale = 4.f;
+        }
+
+        return result;
+    }
+
+    // Returns the policy with positive watermarks, low watermarks not above the high
+    // ones, and a positive scale range with minScale <= maxScale.
+    // Zero or negative values mean "use the built-in default": high watermarks fall back
+    // to the ones of the local source policy, low watermarks to the high ones. Otherwise,
+    // a default constructed policy would limit every stream before anything is buffered.
+    QPlaybackBufferingPolicy normalized() const
+    {
+        using std::chrono::microseconds;
+
+        const QPlaybackBufferingPolicy defaults = defaultPolicy(LocalSource);
+        QPlaybackBufferingPolicy result = *this;
+
+        for (size_t i = 0; i < result.budgets.size(); ++i) {
+            Budget &budget = result.budgets[i];
+            const Budget &defaultBudget = defaults.budgets[i];
+
+            if (budget.highWatermarkDuration <= microseconds{})
+                budget.highWatermarkDuration = defaultBudget.highWatermarkDuration;
+            if (budget.lowWatermarkDuration <= microseconds{})
+                budget.lowWatermarkDuration = budget.highWatermarkDuration;
+            budget.lowWatermarkDuration =
+                    std::min(budget.lowWatermarkDuration, budget.highWatermarkDuration);
+
+            if (budget.highWatermarkSize <= 0)
+                budget.highWatermarkSize = defaultBudget.highWatermarkSize;
+            if (budget.lowWatermarkSize <= 0)
+                budget.lowWatermarkSize = budget.highWatermarkSize;
+            budget.lowWatermarkSize = std::min(budget.lowWatermarkSize, budget.highWatermarkSize);
+        }
+
+        auto isValidScale = [](float scale) { return std::isfinite(scale) && scale > 0.f; };
+        if (!isValidScale(result.minScale))
+            result.minScale = 1.f;
+        if (!isValidScale(result.maxScale))
+            result.maxScale = 1.f;
+        if (result.minScale > result.maxScale)
+            std::swap(result.minScale, result.maxScale);
+
+        return result;
+    }
+
+    // Expects a normalized() policy
+    float boundedScale(float scale) const
+    {
+        Q_ASSERT(minScale <= maxScale);
+        return std::clamp(scale, minScale, maxScale);
+    }
+
+    // Returns the scale after one measurement of how many times faster than the playback
+    // the source has been read
+    float adaptedScale(float scale, float readSpeedFactor) const
+    {
+        if (mode != Adaptive)
+            return boundedScale(scale);
+
+        if (readSpeedFactor < SlowReadSpeedFactor)
+            scale *= ScaleStep;
+        else if (readSpeedFactor > FastReadSpeedFactor)
+            scale /= ScaleStep;
+
+        return boundedScale(scale);
+    }
+
+    friend bool operator==(const QPlaybackBufferingPolicy &a, const QPlaybackBufferingPolicy &b)
+    {
+        return a.mode == b.mode && a.budgets == b.budgets && a.minScale == b.minScale
+                && a.maxScale == b.maxScale;
+    }
+    friend bool operator!=(const QPlaybackBufferingPolicy &a, const QPlaybackBufferingPolicy &b)
+    {
+        return !(a == b);
+    }
+};
+
+QT_END_NAMESPACE
+
+#endif // QPLAYBACKBUFFERINGPOLICY_P_H
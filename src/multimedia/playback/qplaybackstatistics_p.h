@@ -0,0 +1,90 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPLAYBACKSTATISTICS_P_H
+#define QPLAYBACKSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+
+#include <array>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+/* Counters of the video frames handled by the renderer since the media was loaded.
+ *
+ * A frame is late if it's presented noticeably after its presentation time;
+ * dropped frames were decoded but never presented because the renderer
+ * had fallen behind the playback clock.
+ */
+struct QPlaybackVideoFrameStatistics
+{
+    quint64 presentedFrames = 0; // including the late ones
+    quint64 lateFrames = 0;
+    quint64 droppedFrames = 0;
+
+    bool operator==(const QPlaybackVideoFrameStatistics &other) const
+    {
+        return presentedFrames == other.presentedFrames && lateFrames == other.lateFrames
+                && droppedFrames == other.droppedFrames;
+    }
+
+    bool operator!=(const QPlaybackVideoFrameStatistics &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/* A snapshot of the state of a media player's playback pipeline, meant for
+ * monitoring and tuning of players in the field. Durations are in microseconds.
+ *
+ * Backends fill in what they can measure; the rest stays zero.
+ */
+struct QPlaybackStatistics
+{
+    // Upper bounds of the buckets of the decoding time histogram; the last bucket
+    // counts the packets that took longer than the last bound.
+    static constexpr std::array<qint64, 7> DecodingTimeBucketBounds = {
+        1'000, 2'000, 4'000, 8'000, 16'000, 33'000, 66'000
+    };
+
+    struct Stream
+    {
+        // Demuxed data that hasn't been decoded yet
+        qint64 bufferedDuration = 0;
+        qint64 bufferedBytes = 0;
+        qint64 bufferedPackets = 0;
+
+        // Decoded frames that haven't been released by the renderer yet
+        qint64 pendingFrames = 0;
+
+        std::array<quint64, DecodingTimeBucketBounds.size() + 1> decodingTimeHistogram = {};
+    };
+
+    // Indexed by QPlatformMediaPlayer::TrackType
+    std::array<Stream, 3> streams = {};
+
+    QPlaybackVideoFrameStatistics videoFrames;
+
+    // How far the presented video is ahead of the audible audio; negative if it's behind.
+    // Empty unless both audio and video are being rendered.
+    std::optional<qint64> audioVideoOffset;
+
+    // The audio data written to the audio sink and not played yet
+    qint64 audioBufferLoad = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPLAYBACKSTATISTICS_P_H
@@ -12,6 +12,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <mutex> // for std::lock_guard
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
@@ -20,15 +21,28 @@ static constexpr uint DefaultBufferLengthMs = 100;
 
 #define LOW_LATENCY_CATEGORY_NAME "game"
 
+static qint64 operator-(timeval t1, timeval t2)
+{
+    constexpr qint64 secsToUSecs = 1000000;
+    return (t1.tv_sec - t2.tv_sec) * secsToUSecs + (t1.tv_usec - t2.tv_usec);
+}
+
 static void outputStreamWriteCallback(pa_stream *stream, size_t length, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
     qCDebug(qLcPulseAudioOut) << "Write callback:" << length;
+    static_cast<QPulseAudioSink *>(userdata)->streamWriteCallback();
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
 
+static void outputStreamRenderCallback(pa_stream *stream, size_t length, void *userdata)
+{
+    Q_UNUSED(stream);
+    qCDebug(qLcPulseAudioOut) << "Render callback:" << length;
+    static_cast<QPulseAudioSink *>(userdata)->streamRenderCallback();
+}
+
 static void outputStreamStateCallback(pa_stream *stream, void *userdata)
 {
     Q_UNUSED(userdata);
@@ -69,7 +83,6 @@ static void outputStreamOverflowCallback(pa_stream *stream, void *userdata)
 static void outputStreamLatencyCallback(pa_stream *stream, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
 
     if (Q_UNLIKELY(qLcPulseAudioOut().isEnabled(QtDebugMsg))) {
         const pa_timing_info *info = pa_stream_get_timing_info(stream);
@@ -82,6 +95,8 @@ static void outputStreamLatencyCallback(pa_stream *stream, void *userdata)
         qCDebug(qLcPulseAudioOut) << "\tSink usec: " << info->sink_usec;
         qCDebug(qLcPulseAudioOut) << "\tConfigured sink usec: " << info->configured_sink_usec;
     }
+
+    static_cast<QPulseAudioSink *>(userdata)->streamLatencyCallback();
 }
 
 static void outputStreamSuccessCallback(pa_stream *stream, int success, void *userdata)
@@ -146,7 +161,13 @@ QAudio::State QPulseAudioSink::state() const
 
 void QPulseAudioSink::streamUnderflowCallback()
 {
-    bool atEnd = m_audioSource && m_audioSource->atEnd();
+    // The callback keeps the stream active, it catches up with the next request
+    if (m_callback)
+        return;
+
+    // What the ring buffer holds still has to be played
+    bool atEnd = m_audioSource && m_audioSource->atEnd()
+            && (!m_ringBuffer || m_ringBuffer->used() < int(pa_frame_size(&m_spec)));
     if (atEnd && m_stateMachine.state() != QAudio::StoppedState) {
         qCDebug(qLcPulseAudioOut) << "Draining stream at end of buffer";
         exchangeDrainOperation(pa_stream_drain(m_stream, outputStreamDrainComplete, this));
@@ -162,6 +183,202 @@ void QPulseAudioSink::streamDrainedCallback()
         return;
 }
 
+void QPulseAudioSink::streamWriteCallback()
+{
+    // Runs on the mainloop thread with the lock held
+    if (m_ringBuffer)
+        flushRingBuffer();
+}
+
+void QPulseAudioSink::flushRingBuffer()
+{
+    using namespace QPulseAudioInternal;
+
+    // Called with the lock held, hands whole frames of the ring buffer to the server as long
+    // as it asks for data
+    const size_t frameSize = pa_frame_size(&m_spec);
+    size_t writableSize = pa_stream_writable_size(m_stream);
+    writableSize -= writableSize % frameSize;
+
+    while (writableSize > 0) {
+        size_t available = size_t(m_ringBuffer->used());
+        if (available < frameSize) {
+            // Let a write flush the ring buffer once it holds what the server asks for, up to
+            // its minimum request; the server doesn't ask again until it gets data. Check the
+            // ring buffer again in case a write has just missed the request.
+            size_t requested = writableSize;
+            if (const pa_buffer_attr *attr = pa_stream_get_buffer_attr(m_stream))
+                requested = qMin(requested, size_t(attr->minreq));
+            requested = qMax(requested - requested % frameSize, frameSize);
+            m_flushRequestedBytes.store(qsizetype(requested), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            available = size_t(m_ringBuffer->used());
+            if (available < frameSize)
+                return;
+        }
+
+        void *dest = nullptr;
+        size_t nbytes = qMin(writableSize, available - available % frameSize);
+
+        if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
+            qCWarning(qLcPulseAudioOut) << "pa_stream_begin_write error:"
+                                        << currentError(QPulseAudioEngine::instance()->context());
+            return;
+        }
+
+        nbytes -= nbytes % frameSize;
+        if (nbytes == 0) {
+            pa_stream_cancel_write(m_stream);
+            return;
+        }
+
+        size_t copied = 0;
+        m_ringBuffer->consume(int(nbytes), [&](QSpan<const char> region) {
+            memcpy(static_cast<char *>(dest) + copied, region.data(), region.size());
+            copied += region.size();
+        });
+
+        // Don't use PulseAudio volume, as it might affect all other streams of the same category
+        // or even affect the system volume if flat volumes are enabled
+        const qreal volume = m_volume;
+        if (volume < 1.0f)
+            QAudioHelperInternal::qMultiplySamples(volume, m_format, dest, dest, int(copied));
+
+        if (pa_stream_write(m_stream, dest, copied, nullptr, 0, PA_SEEK_RELATIVE) < 0) {
+            qCWarning(qLcPulseAudioOut) << "pa_stream_write error:"
+                                        << currentError(QPulseAudioEngine::instance()->context());
+            QMetaObject::invokeMethod(this, [this] {
+                m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        m_totalTimeValue += copied;
+        writableSize -= copied;
+    }
+}
+
+void QPulseAudioSink::flushIfRequested(bool force)
+{
+    // Pairs with the fence in flushRingBuffer(): either this sees the request, or the mainloop
+    // sees what has just been written to the ring buffer
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const qsizetype requested = m_flushRequestedBytes.load(std::memory_order_relaxed);
+    if (requested == 0 || !m_ringBuffer)
+        return;
+
+    // Nothing to hand over; the request stays until data is written
+    const qsizetype used = m_ringBuffer->used();
+    if (used == 0)
+        return;
+
+    // Small writes gather in the ring buffer instead of taking the lock one by one; a queued
+    // flush hands them over after the current event loop iteration
+    if (!force && used < requested) {
+        if (!std::exchange(m_flushQueued, true)) {
+            QMetaObject::invokeMethod(this, [this] {
+                m_flushQueued = false;
+                flushIfRequested(true);
+            }, Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    if (m_flushRequestedBytes.exchange(0) == 0)
+        return;
+
+    std::lock_guard lock(*QPulseAudioEngine::instance());
+    if (m_stream)
+        flushRingBuffer();
+}
+
+void QPulseAudioSink::streamLatencyCallback()
+{
+    // Runs on the mainloop thread with the lock held
+    const pa_timing_info *info = pa_stream_get_timing_info(m_stream);
+    if (!info)
+        return;
+
+    // if the info changed, update our cached data, and recalculate the average latency
+    if (info->timestamp - lastTimingInfo > 0) {
+        lastTimingInfo.tv_sec = info->timestamp.tv_sec;
+        lastTimingInfo.tv_usec = info->timestamp.tv_usec;
+        averageLatency =
+                0; // also use that as long as we don't have valid data from the timing info
+
+        // Only use timing values when playing, otherwise the latency numbers can be way off
+        if (info->since_underrun >= 0
+            && pa_bytes_to_usec(info->since_underrun, &m_spec) > info->sink_usec) {
+            latencyList.append(info->sink_usec);
+            // Average over the last X timing infos to keep numbers more stable.
+            // 10 seems to be a decent number that keeps values relatively stable but doesn't make
+            // the list too big
+            const int latencyListMaxSize = 10;
+            if (latencyList.size() > latencyListMaxSize)
+                latencyList.pop_front();
+            for (const auto l : latencyList)
+                averageLatency += l;
+            averageLatency /= latencyList.size();
+            if (averageLatency < 0)
+                averageLatency = 0;
+        }
+    }
+
+    const qint64 usecsRead = info->read_index < 0 ? 0 : pa_bytes_to_usec(info->read_index, &m_spec);
+    const qint64 usecsWritten =
+            info->write_index < 0 ? 0 : pa_bytes_to_usec(info->write_index, &m_spec);
+
+    // processed data is the amount read by the server minus its latency, processedUSecs()
+    // adds the time since the update
+    m_timingBaseUSecs.store(usecsRead - averageLatency - (info->timestamp - timeval{}),
+                            std::memory_order_relaxed);
+    m_writtenUSecs.store(usecsWritten, std::memory_order_relaxed);
+}
+
+void QPulseAudioSink::streamRenderCallback()
+{
+    using namespace QPulseAudioInternal;
+
+    // Runs on the mainloop thread with the lock held, and renders whole periods only,
+    // so that the callback always gets m_pullingPeriodSize bytes
+    const size_t periodSize = m_pullingPeriodSize;
+    size_t writableSize = pa_stream_writable_size(m_stream);
+
+    for (; writableSize >= periodSize; writableSize -= periodSize) {
+        void *dest = nullptr;
+        size_t nbytes = periodSize;
+
+        if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
+            qCWarning(qLcPulseAudioOut) << "pa_stream_begin_write error:"
+                                        << currentError(QPulseAudioEngine::instance()->context());
+            break;
+        }
+
+        // Render straight into the memory of PulseAudio if it fits a period
+        if (nbytes < periodSize) {
+            pa_stream_cancel_write(m_stream);
+            dest = m_audioBuffer.data();
+        }
+
+        QtAudioPrivate::runAudioCallback(*m_callback, dest, periodSize);
+
+        const qreal volume = m_volume;
+        if (volume < 1.0f)
+            QAudioHelperInternal::qMultiplySamples(volume, m_format, dest, dest, periodSize);
+
+        if (pa_stream_write(m_stream, dest, periodSize, nullptr, 0, PA_SEEK_RELATIVE) < 0) {
+            qCWarning(qLcPulseAudioOut) << "pa_stream_write error:"
+                                        << currentError(QPulseAudioEngine::instance()->context());
+            QMetaObject::invokeMethod(this, [this] {
+                m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+            }, Qt::QueuedConnection);
+            break;
+        }
+
+        m_totalTimeValue += periodSize;
+    }
+}
+
 void QPulseAudioSink::start(QIODevice *device)
 {
     reset();
@@ -174,10 +391,6 @@ void QPulseAudioSink::start(QIODevice *device)
         return;
     }
 
-    // ensure we only process timing infos that are up to date
-    gettimeofday(&lastTimingInfo, nullptr);
-    lastProcessedUSecs = 0;
-
     connect(m_audioSource, &QIODevice::readyRead, this, &QPulseAudioSink::startPulling);
 
     m_stateMachine.start();
@@ -210,15 +423,28 @@ QIODevice *QPulseAudioSink::start()
     m_audioSource = new PulseOutputPrivate(this);
     m_audioSource->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
 
-    // ensure we only process timing infos that are up to date
-    gettimeofday(&lastTimingInfo, nullptr);
-    lastProcessedUSecs = 0;
-
     m_stateMachine.start(false);
 
     return m_audioSource;
 }
 
+bool QPulseAudioSink::startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback)
+{
+    reset();
+
+    m_pullMode = false;
+    m_callback = std::move(callback);
+
+    if (!open()) {
+        m_callback.reset();
+        return true;
+    }
+
+    m_stateMachine.start();
+
+    return true;
+}
+
 bool QPulseAudioSink::open()
 {
     if (m_opened)
@@ -258,6 +484,14 @@ bool QPulseAudioSink::open()
 
     pulseEngine->lock();
 
+    // ensure we only process timing infos that are up to date
+    gettimeofday(&lastTimingInfo, nullptr);
+    latencyList.clear();
+    averageLatency = 0;
+    lastProcessedUSecs = 0;
+    m_timingBaseUSecs = 0;
+    m_writtenUSecs = 0;
+
     pa_proplist *propList = pa_proplist_new();
 #if 0
     qint64 bytesPerSecond = m_format.sampleRate() * m_format.bytesPerFrame();
@@ -292,17 +526,17 @@ bool QPulseAudioSink::open()
     }
 
     pa_stream_set_state_callback(m_stream, outputStreamStateCallback, this);
-    pa_stream_set_write_callback(m_stream, outputStreamWriteCallback, this);
-
     pa_stream_set_underflow_callback(m_stream, outputStreamUnderflowCallback, this);
     pa_stream_set_overflow_callback(m_stream, outputStreamOverflowCallback, this);
     pa_stream_set_latency_update_callback(m_stream, outputStreamLatencyCallback, this);
 
     pa_buffer_attr requestedBuffer;
-    // Request a target buffer size
+    // Request a target buffer size. Writes go through a ring buffer in front of the stream,
+    // which takes half of it, so that the latency stays the same.
     auto targetBufferSize = m_userBufferSize ? *m_userBufferSize : defaultBufferSize();
+    const qsizetype streamBufferSize = m_callback ? targetBufferSize : targetBufferSize / 2;
     requestedBuffer.tlength =
-            targetBufferSize ? static_cast<uint32_t>(targetBufferSize) : static_cast<uint32_t>(-1);
+            streamBufferSize ? static_cast<uint32_t>(streamBufferSize) : static_cast<uint32_t>(-1);
     // Rest should be determined by PulseAudio
     requestedBuffer.fragsize = static_cast<uint32_t>(-1);
     requestedBuffer.maxlength = static_cast<uint32_t>(-1);
@@ -328,7 +562,17 @@ bool QPulseAudioSink::open()
     const pa_buffer_attr *buffer = pa_stream_get_buffer_attr(m_stream);
     m_bufferSize = buffer->tlength;
 
-    if (m_pullMode) {
+    if (!m_callback) {
+        const qsizetype frameSize = pa_frame_size(&m_spec);
+        const qsizetype ringBufferSize =
+                qMax(qsizetype(targetBufferSize) - m_bufferSize, qsizetype(buffer->minreq));
+        m_ringBuffer = std::make_unique<QtPrivate::QAudioRingBuffer<char>>(
+                int(ringBufferSize - ringBufferSize % frameSize));
+        m_bufferSize += m_ringBuffer->size();
+        m_flushRequestedBytes = 0;
+    }
+
+    if (m_pullMode || m_callback) {
         // Adjust period time to reduce chance of it being higher than amount of bytes requested by
         // PulseAudio server
         m_pullingPeriodTime =
@@ -347,6 +591,16 @@ bool QPulseAudioSink::open()
                                                   streamAdjustPrebufferCallback, nullptr));
     }
 
+    // Set once the period or the ring buffer is known; the initial request has been missed,
+    // so serve it here
+    if (m_callback) {
+        pa_stream_set_write_callback(m_stream, outputStreamRenderCallback, this);
+        streamRenderCallback();
+    } else {
+        pa_stream_set_write_callback(m_stream, outputStreamWriteCallback, this);
+        streamWriteCallback();
+    }
+
     if (Q_UNLIKELY(qLcPulseAudioOut().isEnabled(QtDebugMsg))) {
         qCDebug(qLcPulseAudioOut) << "Buffering info:";
         qCDebug(qLcPulseAudioOut) << "\tMax length: " << buffer->maxlength;
@@ -415,6 +669,8 @@ void QPulseAudioSink::close()
 
     m_opened = false;
     m_audioBuffer.clear();
+    m_ringBuffer.reset();
+    m_callback.reset();
 }
 
 void QPulseAudioSink::timerEvent(QTimerEvent *event)
@@ -427,38 +683,42 @@ void QPulseAudioSink::timerEvent(QTimerEvent *event)
 
 void QPulseAudioSink::userFeed()
 {
-    int writableSize = bytesFree();
-
-    if (writableSize == 0) {
-        // PulseAudio server doesn't want any more data
-        m_stateMachine.activateFromIdle();
+    if (!m_ringBuffer || !m_audioSource)
         return;
-    }
 
-    // Write up to writableSize
-    const int inputSize =
-            std::min({ m_pullingPeriodSize, static_cast<int>(m_audioBuffer.size()), writableSize });
+    // Read what fits into the ring buffer, the write callback hands it to the server
+    qint64 audioBytesPulled = 0;
+    bool bufferFull = false;
+    while (true) {
+        const auto region = m_ringBuffer->acquireWriteRegion(m_ringBuffer->free());
+        if (region.isEmpty()) {
+            bufferFull = true;
+            break;
+        }
 
-    Q_ASSERT(!m_audioBuffer.empty());
-    int audioBytesPulled = m_audioSource->read(m_audioBuffer.data(), inputSize);
-    Q_ASSERT(audioBytesPulled <= inputSize);
+        const qint64 read = m_audioSource->read(region.data(), region.size());
+        if (read <= 0)
+            break;
 
-    if (audioBytesPulled > 0) {
-        if (audioBytesPulled > inputSize) {
+        if (read > region.size()) {
             qCWarning(qLcPulseAudioOut)
-                    << "Invalid audio data size provided by pull source:" << audioBytesPulled
-                    << "should be less than" << inputSize;
-            audioBytesPulled = inputSize;
+                    << "Invalid audio data size provided by pull source:" << read
+                    << "should be less than" << region.size();
+            m_ringBuffer->releaseWriteRegion(int(region.size()));
+        } else {
+            m_ringBuffer->releaseWriteRegion(int(read));
         }
-        auto bytesWritten = write(m_audioBuffer.data(), audioBytesPulled);
-        if (bytesWritten != audioBytesPulled)
-            qWarning() << "Unfinished write:" << bytesWritten << "vs" << audioBytesPulled;
 
-        m_stateMachine.activateFromIdle();
+        audioBytesPulled += read;
+        if (read < region.size())
+            break;
+    }
 
-        if (inputSize < writableSize) // PulseAudio needs more data.
-            QMetaObject::invokeMethod(this, &QPulseAudioSink::userFeed, Qt::QueuedConnection);
-    } else if (audioBytesPulled == 0) {
+    flushIfRequested();
+
+    if (audioBytesPulled > 0 || bufferFull) {
+        m_stateMachine.activateFromIdle();
+    } else {
         stopTimer();
         const auto atEnd = m_audioSource->atEnd();
         qCDebug(qLcPulseAudioOut) << "No more data available, source is done:" << atEnd;
@@ -467,48 +727,37 @@ void QPulseAudioSink::userFeed()
 
 qint64 QPulseAudioSink::write(const char *data, qint64 len)
 {
-    using namespace QPulseAudioInternal;
-
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-
-    pulseEngine->lock();
-
-    size_t nbytes = len;
-    void *dest = nullptr;
-
-    if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
-        pulseEngine->unlock();
-        qCWarning(qLcPulseAudioOut)
-                << "pa_stream_begin_write error:" << currentError(pulseEngine->context());
-        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+    if (!m_ringBuffer)
         return 0;
-    }
 
-    len = qMin(len, qint64(nbytes));
+    // Doesn't take the lock of the engine, unless the server waits for this data
+    const qint64 written = m_ringBuffer->write(
+            QSpan<const char>(data, qMin(len, qint64(std::numeric_limits<int>::max()))));
+    flushIfRequested();
 
-    if (m_volume < 1.0f) {
-        // Don't use PulseAudio volume, as it might affect all other streams of the same category
-        // or even affect the system volume if flat volumes are enabled
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
-    } else {
-        memcpy(dest, data, len);
-    }
+    if (written > 0)
+        m_stateMachine.updateActiveOrIdle(true);
+    return written;
+}
 
-    data = reinterpret_cast<char *>(dest);
+QSpan<char> QPulseAudioSink::beginWrite(qsizetype maxSize)
+{
+    if (!m_ringBuffer || m_pullMode || !m_stateMachine.isActiveOrIdle())
+        return {};
 
-    if ((pa_stream_write(m_stream, data, len, nullptr, 0, PA_SEEK_RELATIVE)) < 0) {
-        pulseEngine->unlock();
-        qCWarning(qLcPulseAudioOut)
-                << "pa_stream_write error:" << currentError(pulseEngine->context());
-        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
-        return 0;
-    }
+    // A region of the ring buffer, the write callback moves it into the memory of the server
+    return m_ringBuffer->acquireWriteRegion(int(qMin(maxSize, bytesFree())));
+}
 
-    pulseEngine->unlock();
-    m_totalTimeValue += len;
+void QPulseAudioSink::commitWrite(qsizetype bytes)
+{
+    if (!m_ringBuffer || bytes <= 0)
+        return;
+
+    m_ringBuffer->releaseWriteRegion(int(bytes));
+    flushIfRequested();
 
     m_stateMachine.updateActiveOrIdle(true);
-    return len;
 }
 
 void QPulseAudioSink::stop()
@@ -522,6 +771,21 @@ void QPulseAudioSink::stop()
                 // cancel the draining callback that is not relevant already
                 pa_operation_cancel(prevOp.get());
 
+            // the callback would keep filling the buffer that is being drained
+            if (m_callback)
+                pa_stream_set_write_callback(m_stream, nullptr, nullptr);
+
+            // hand what is left in the ring buffer to the server, as it asks for it
+            if (m_ringBuffer && notifier.prevAudioState() != QAudio::SuspendedState) {
+                const int frameSize = pa_frame_size(&m_spec);
+                while (m_ringBuffer->used() >= frameSize
+                       && pa_stream_get_state(m_stream) == PA_STREAM_READY) {
+                    flushRingBuffer();
+                    if (m_ringBuffer->used() >= frameSize)
+                        pa_threaded_mainloop_wait(pulseEngine->mainloop());
+                }
+            }
+
             PAOperationUPtr drainOp(pa_stream_drain(m_stream, outputStreamDrainComplete, nullptr));
             pulseEngine->wait(drainOp.get());
         }
@@ -532,11 +796,10 @@ void QPulseAudioSink::stop()
 
 qsizetype QPulseAudioSink::bytesFree() const
 {
-    if (!m_stateMachine.isActiveOrIdle())
+    if (!m_ringBuffer || !m_stateMachine.isActiveOrIdle())
         return 0;
 
-    std::lock_guard lock(*QPulseAudioEngine::instance());
-    return pa_stream_writable_size(m_stream);
+    return m_ringBuffer->free();
 }
 
 void QPulseAudioSink::setBufferSize(qsizetype value)
@@ -555,12 +818,6 @@ qsizetype QPulseAudioSink::bufferSize() const
     return defaultBufferSize();
 }
 
-static qint64 operator-(timeval t1, timeval t2)
-{
-    constexpr qint64 secsToUSecs = 1000000;
-    return (t1.tv_sec - t2.tv_sec) * secsToUSecs + (t1.tv_usec - t2.tv_usec);
-}
-
 qint64 QPulseAudioSink::processedUSecs() const
 {
     const auto state = this->state();
@@ -569,51 +826,16 @@ qint64 QPulseAudioSink::processedUSecs() const
     if (state == QAudio::SuspendedState)
         return lastProcessedUSecs;
 
-    auto info = pa_stream_get_timing_info(m_stream);
-    if (!info)
-        return lastProcessedUSecs;
-
-    // if the info changed, update our cached data, and recalculate the average latency
-    if (info->timestamp - lastTimingInfo > 0) {
-        lastTimingInfo.tv_sec = info->timestamp.tv_sec;
-        lastTimingInfo.tv_usec = info->timestamp.tv_usec;
-        averageLatency =
-                0; // also use that as long as we don't have valid data from the timing info
-
-        // Only use timing values when playing, otherwise the latency numbers can be way off
-        if (info->since_underrun >= 0
-            && pa_bytes_to_usec(info->since_underrun, &m_spec) > info->sink_usec) {
-            latencyList.append(info->sink_usec);
-            // Average over the last X timing infos to keep numbers more stable.
-            // 10 seems to be a decent number that keeps values relatively stable but doesn't make
-            // the list too big
-            const int latencyListMaxSize = 10;
-            if (latencyList.size() > latencyListMaxSize)
-                latencyList.pop_front();
-            for (const auto l : latencyList)
-                averageLatency += l;
-            averageLatency /= latencyList.size();
-            if (averageLatency < 0)
-                averageLatency = 0;
-        }
-    }
-
-    const qint64 usecsRead = info->read_index < 0 ? 0 : pa_bytes_to_usec(info->read_index, &m_spec);
-    const qint64 usecsWritten =
-            info->write_index < 0 ? 0 : pa_bytes_to_usec(info->write_index, &m_spec);
-
-    // processed data is the amount read by the server minus its latency
-    qint64 usecs = usecsRead - averageLatency;
-
+    // The timing info is mirrored by the latency callback, not read here, so that this
+    // doesn't take the lock of the engine
     timeval tv;
     gettimeofday(&tv, nullptr);
 
-    // and now adjust for the time since the last update
-    qint64 timeSinceUpdate = tv - info->timestamp;
-    if (timeSinceUpdate > 0)
-        usecs += timeSinceUpdate;
+    // adjust for the time since the last update
+    qint64 usecs = m_timingBaseUSecs.load(std::memory_order_relaxed) + (tv - timeval{});
 
     // We can never have processed more than we've written to the sink
+    const qint64 usecsWritten = m_writtenUSecs.load(std::memory_order_relaxed);
     if (usecs > usecsWritten)
         usecs = usecsWritten;
 
@@ -26,10 +26,14 @@
 #include "qaudiodevice.h"
 #include "pulseaudio/qpulsehelpers_p.h"
 
+#include <private/qaudioringbuffer_p.h>
 #include <private/qaudiosystem_p.h>
 #include <private/qaudiostatemachine_p.h>
 #include <pulse/pulseaudio.h>
 
+#include <atomic>
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 class QPulseAudioSink : public QPlatformAudioSink
@@ -58,9 +62,15 @@ public:
 
     void setVolume(qreal volume) override;
     qreal volume() const override;
+    bool startWithCallback(QtAudioPrivate::AudioSinkCallback &&callback) override;
+    QSpan<char> beginWrite(qsizetype maxSize) override;
+    void commitWrite(qsizetype bytes) override;
 
+    void streamWriteCallback();
     void streamUnderflowCallback();
     void streamDrainedCallback();
+    void streamRenderCallback();
+    void streamLatencyCallback();
 
 protected:
     void timerEvent(QTimerEvent *event) override;
@@ -72,6 +82,10 @@ private:
     bool open();
     void close();
     qint64 write(const char *data, qint64 len);
+    void flushRingBuffer();
+    // Flushes the ring buffer if the server asked for data and the ring buffer holds some: once
+    // it holds what the server asked for, or right away with force
+    void flushIfRequested(bool force = false);
 
 private Q_SLOTS:
     void userFeed();
@@ -83,10 +97,11 @@ private:
     qsizetype defaultBufferSize() const;
 
     pa_sample_spec m_spec = {};
-    // calculate timing manually, as pulseaudio doesn't give us good enough data
-    mutable timeval lastTimingInfo = {};
+    // calculate timing manually, as pulseaudio doesn't give us good enough data.
+    // Updated on the mainloop thread, when the timing info changes.
+    timeval lastTimingInfo = {};
 
-    mutable QList<qint64> latencyList; // last latency values
+    QList<qint64> latencyList; // last latency values
 
     QByteArray m_device;
     QByteArray m_streamName;
@@ -97,11 +112,24 @@ private:
     pa_stream *m_stream = nullptr;
     std::vector<char> m_audioBuffer;
 
+    // Filled on the thread of the sink, flushed into the stream on the mainloop thread, so
+    // that writing doesn't take the lock of the engine
+    std::unique_ptr<QtPrivate::QAudioRingBuffer<char>> m_ringBuffer;
+    // Set when the server asked for more than the ring buffer had: how much the ring buffer
+    // has to hold before a write flushes it
+    std::atomic<qsizetype> m_flushRequestedBytes = 0;
+    // A forced flush of gathered small writes is pending on the thread of the sink
+    bool m_flushQueued = false;
+
     qint64 m_totalTimeValue = 0;
     qint64 m_elapsedTimeOffset = 0;
-    mutable qint64 averageLatency = 0; // average latency
+    qint64 averageLatency = 0; // average latency
     mutable qint64 lastProcessedUSecs = 0;
-    qreal m_volume = 1.0;
+    // Mirrored from the timing info for processedUSecs(): the processed time minus the time
+    // of day, and the time written to the server
+    std::atomic<qint64> m_timingBaseUSecs = 0;
+    std::atomic<qint64> m_writtenUSecs = 0;
+    std::atomic<qreal> m_volume = 1.0;
 
     std::atomic<pa_operation *> m_drainOperation = nullptr;
     qsizetype m_bufferSize = 0;
@@ -111,6 +139,9 @@ private:
     bool m_pullMode = true;
     bool m_opened = false;
 
+    // Set while started with a callback, which renders the audio on the mainloop thread
+    std::optional<QtAudioPrivate::AudioSinkCallback> m_callback;
+
     QAudioStateMachine m_stateMachine;
 };
 
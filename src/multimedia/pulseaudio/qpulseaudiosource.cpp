@@ -4,6 +4,7 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qmath.h>
+#include <QtCore/qscopeguard.h>
 #include <private/qaudiohelpers_p.h>
 
 #include "qpulseaudiosource_p.h"
@@ -20,13 +21,20 @@ const int SourcePeriodTimeMs = 50;
 
 static void inputStreamReadCallback(pa_stream *stream, size_t length, void *userdata)
 {
-    Q_UNUSED(userdata);
     Q_UNUSED(length);
     Q_UNUSED(stream);
+    static_cast<QPulseAudioSource *>(userdata)->streamReadCallback();
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
 
+static void inputStreamCaptureCallback(pa_stream *stream, size_t length, void *userdata)
+{
+    Q_UNUSED(stream);
+    Q_UNUSED(length);
+    static_cast<QPulseAudioSource *>(userdata)->streamCaptureCallback();
+}
+
 static void inputStreamStateCallback(pa_stream *stream, void *userdata)
 {
     using namespace QPulseAudioInternal;
@@ -164,6 +172,83 @@ QIODevice *QPulseAudioSource::start()
     return m_audioSource;
 }
 
+bool QPulseAudioSource::startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback)
+{
+    reset();
+
+    m_pullMode = false;
+    m_audioSource = nullptr;
+    m_callback = std::move(callback);
+
+    if (!open()) {
+        m_callback.reset();
+        return true;
+    }
+
+    m_stateMachine.start();
+
+    return true;
+}
+
+void QPulseAudioSource::updateReadableSize()
+{
+    // Called with the lock held
+    const size_t readableSize = pa_stream_readable_size(m_stream);
+    m_readableSize.store(readableSize == size_t(-1) ? 0 : qsizetype(readableSize),
+                         std::memory_order_relaxed);
+}
+
+void QPulseAudioSource::streamReadCallback()
+{
+    // Runs on the mainloop thread with the lock held
+    updateReadableSize();
+
+    // Nothing newer than the last fragment can have been read
+    pa_usec_t usecs = 0;
+    if (pa_stream_get_time(m_stream, &usecs) == 0)
+        m_processedUSecs.store(usecs, std::memory_order_relaxed);
+}
+
+void QPulseAudioSource::streamCaptureCallback()
+{
+    using namespace QPulseAudioInternal;
+
+    // Runs on the mainloop thread with the lock held
+    while (pa_stream_readable_size(m_stream) > 0) {
+        const void *data = nullptr;
+        size_t length = 0;
+
+        if (pa_stream_peek(m_stream, &data, &length) < 0) {
+            qWarning() << "pa_stream_peek() failed:" << currentError(m_stream);
+            return;
+        }
+
+        if (length == 0)
+            return;
+
+        // A null buffer is a hole in the stream, which has no samples to pass on
+        if (data) {
+            const qreal volume = m_volume;
+            if (volume < 1.f) {
+                if (m_tempBuffer.size() < qsizetype(length))
+                    m_tempBuffer.resize(length);
+                QAudioHelperInternal::qMultiplySamples(volume, m_format, data,
+                                                       m_tempBuffer.data(), length);
+                data = m_tempBuffer.constData();
+            }
+
+            QtAudioPrivate::runAudioCallback(*m_callback, data, length);
+            m_totalTimeValue += length;
+        }
+
+        pa_stream_drop(m_stream);
+    }
+
+    pa_usec_t usecs = 0;
+    if (pa_stream_get_time(m_stream, &usecs) == 0)
+        m_processedUSecs.store(usecs, std::memory_order_relaxed);
+}
+
 void QPulseAudioSource::stop()
 {
     if (auto notifier = m_stateMachine.stop())
@@ -212,10 +297,16 @@ bool QPulseAudioSource::open()
 
     pulseEngine->lock();
 
+    m_readableSize = 0;
+    m_processedUSecs = 0;
+    m_pullBuffer.clear();
+
     m_stream = pa_stream_new(pulseEngine->context(), m_streamName.constData(), &spec, &channel_map);
 
     pa_stream_set_state_callback(m_stream, inputStreamStateCallback, this);
-    pa_stream_set_read_callback(m_stream, inputStreamReadCallback, this);
+    pa_stream_set_read_callback(m_stream,
+                                m_callback ? inputStreamCaptureCallback : inputStreamReadCallback,
+                                this);
 
     pa_stream_set_underflow_callback(m_stream, inputStreamUnderflowCallback, this);
     pa_stream_set_overflow_callback(m_stream, inputStreamOverflowCallback, this);
@@ -271,7 +362,8 @@ bool QPulseAudioSource::open()
             &QPulseAudioSource::onPulseContextFailed);
 
     m_opened = true;
-    m_timer.start(m_periodTime, this);
+    if (!m_callback)
+        m_timer.start(m_periodTime, this);
 
     m_elapsedTimeOffset = 0;
     m_totalTimeValue = 0;
@@ -309,6 +401,7 @@ void QPulseAudioSource::close()
         m_audioSource = nullptr;
     }
     m_opened = false;
+    m_callback.reset();
 }
 
 qsizetype QPulseAudioSource::bytesReady() const
@@ -318,15 +411,7 @@ qsizetype QPulseAudioSource::bytesReady() const
     if (!m_stateMachine.isActiveOrIdle())
         return 0;
 
-    std::lock_guard lock(*QPulseAudioEngine::instance());
-
-    int bytes = pa_stream_readable_size(m_stream);
-    if (bytes < 0) {
-        qWarning() << "pa_stream_readable_size() failed:" << currentError(m_stream);
-        return 0;
-    }
-
-    return static_cast<qsizetype>(bytes);
+    return m_readableSize.load(std::memory_order_relaxed);
 }
 
 qint64 QPulseAudioSource::read(char *data, qint64 len)
@@ -336,9 +421,13 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
     Q_ASSERT(data != nullptr || len == 0);
 
     m_stateMachine.updateActiveOrIdle(true, QAudio::NoError);
+
+    if (m_pullMode)
+        return flushToDevice();
+
     int readBytes = 0;
 
-    if (!m_pullMode && !m_tempBuffer.isEmpty()) {
+    if (!m_tempBuffer.isEmpty()) {
         readBytes = qMin(static_cast<int>(len), m_tempBuffer.size());
         if (readBytes)
             memcpy(data, m_tempBuffer.constData(), readBytes);
@@ -352,18 +441,18 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         m_tempBuffer.clear();
     }
 
-    while (pa_stream_readable_size(m_stream) > 0) {
-        size_t readLength = 0;
+    // Nothing has arrived since the last read, don't take the lock
+    if (m_readableSize.load(std::memory_order_relaxed) == 0)
+        return readBytes;
 
-        if (Q_UNLIKELY(qLcPulseAudioIn().isEnabled(QtDebugMsg))) {
-            auto readableSize = pa_stream_readable_size(m_stream);
-            qCDebug(qLcPulseAudioIn) << "QPulseAudioSource::read -- " << readableSize
-                                     << " bytes available from pulse audio";
-        }
+    // Take the lock once for all the fragments that are ready; they are only copied under it
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    std::lock_guard lock(*pulseEngine);
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-        pulseEngine->lock();
+    auto readableSizeGuard = qScopeGuard([this] { updateReadableSize(); });
 
+    while (readBytes < len && pa_stream_readable_size(m_stream) > 0) {
+        size_t readLength = 0;
         const void *audioBuffer;
 
         // Second and third parameters (audioBuffer and length) to pa_stream_peek are output
@@ -371,39 +460,24 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         // the length is set to the length of this data.
         if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0) {
             qWarning() << "pa_stream_peek() failed:" << currentError(m_stream);
-            pulseEngine->unlock();
             return 0;
         }
 
-        qint64 actualLength = 0;
-        if (m_pullMode) {
-            QByteArray adjusted(readLength, Qt::Uninitialized);
-            applyVolume(audioBuffer, adjusted.data(), readLength);
-            actualLength = m_audioSource->write(adjusted);
-
-            if (actualLength < qint64(readLength)) {
-                pulseEngine->unlock();
-                m_stateMachine.updateActiveOrIdle(false, QAudio::UnderrunError);
-                return actualLength;
-            }
-        } else {
-            actualLength = qMin(static_cast<int>(len - readBytes), static_cast<int>(readLength));
-            applyVolume(audioBuffer, data + readBytes, actualLength);
-        }
+        const qint64 actualLength = qMin(len - readBytes, qint64(readLength));
+        applyVolume(audioBuffer, data + readBytes, actualLength);
 
         qCDebug(qLcPulseAudioIn) << "QPulseAudioSource::read -- wrote " << actualLength
                                  << " to client";
 
         if (actualLength < qint64(readLength)) {
             int diff = readLength - actualLength;
-            int oldSize = m_tempBuffer.size();
 
             qCDebug(qLcPulseAudioIn) << "QPulseAudioSource::read -- appending " << diff
                                      << " bytes of data to temp buffer";
 
-            m_tempBuffer.resize(m_tempBuffer.size() + diff);
+            m_tempBuffer.resize(diff);
             applyVolume(static_cast<const char *>(audioBuffer) + actualLength,
-                        m_tempBuffer.data() + oldSize, diff);
+                        m_tempBuffer.data(), diff);
             QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
         }
 
@@ -411,10 +485,6 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
         readBytes += actualLength;
 
         pa_stream_drop(m_stream);
-        pulseEngine->unlock();
-
-        if (!m_pullMode && readBytes >= len)
-            break;
     }
 
     qCDebug(qLcPulseAudioIn) << "QPulseAudioSource::read -- returning after reading " << readBytes
@@ -423,6 +493,58 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
     return readBytes;
 }
 
+qint64 QPulseAudioSource::flushToDevice()
+{
+    using namespace QPulseAudioInternal;
+
+    // Only fetch more from the server once the QIODevice took what was fetched before
+    if (m_pullBuffer.isEmpty()) {
+        if (m_readableSize.load(std::memory_order_relaxed) == 0)
+            return 0;
+
+        // The lock is only held to copy the fragments, not while the QIODevice is written
+        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+        std::lock_guard lock(*pulseEngine);
+
+        while (pa_stream_readable_size(m_stream) > 0) {
+            size_t readLength = 0;
+            const void *audioBuffer;
+            if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0) {
+                qWarning() << "pa_stream_peek() failed:" << currentError(m_stream);
+                break;
+            }
+
+            // A null buffer is a hole in the stream, which is dropped
+            if (audioBuffer) {
+                const qsizetype offset = m_pullBuffer.size();
+                m_pullBuffer.resize(offset + qsizetype(readLength));
+                applyVolume(audioBuffer, m_pullBuffer.data() + offset, int(readLength));
+            }
+            pa_stream_drop(m_stream);
+        }
+
+        updateReadableSize();
+    }
+
+    if (m_pullBuffer.isEmpty())
+        return 0;
+
+    const qint64 written = m_audioSource->write(m_pullBuffer);
+    qCDebug(qLcPulseAudioIn) << "QPulseAudioSource::read -- wrote " << written << " of "
+                             << m_pullBuffer.size() << " bytes to the device";
+
+    if (written > 0) {
+        m_totalTimeValue += written;
+        m_pullBuffer.remove(0, written);
+    }
+
+    // The rest is written on the next feed
+    if (!m_pullBuffer.isEmpty())
+        m_stateMachine.updateActiveOrIdle(false, QAudio::UnderrunError);
+
+    return qMax(written, qint64(0));
+}
+
 void QPulseAudioSource::applyVolume(const void *src, void *dest, int len)
 {
     Q_ASSERT((src && dest) || len == 0);
@@ -445,7 +567,8 @@ void QPulseAudioSource::resume()
             pulseEngine->wait(operation.get());
         }
 
-        m_timer.start(m_periodTime, this);
+        if (!m_callback)
+            m_timer.start(m_periodTime, this);
     }
 }
 
@@ -476,13 +599,8 @@ qint64 QPulseAudioSource::processedUSecs() const
 {
     if (!m_stream)
         return 0;
-    pa_usec_t usecs = 0;
-    int result = pa_stream_get_time(m_stream, &usecs);
-    Q_UNUSED(result);
-    //if (result != 0)
-    //    qWarning() << "no timing info from pulse";
 
-    return usecs;
+    return m_processedUSecs.load(std::memory_order_relaxed);
 }
 
 void QPulseAudioSource::suspend()
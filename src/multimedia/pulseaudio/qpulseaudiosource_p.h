@@ -29,6 +29,9 @@
 
 #include <pulse/pulseaudio.h>
 
+#include <atomic>
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 class PulseInputPrivate;
@@ -60,11 +63,15 @@ public:
 
     void setVolume(qreal volume) override;
     qreal volume() const override;
+    bool startWithCallback(QtAudioPrivate::AudioSourceCallback &&callback) override;
+
+    void streamReadCallback();
+    void streamCaptureCallback();
 
     qint64 m_totalTimeValue;
     QIODevice *m_audioSource;
     QAudioFormat m_format;
-    qreal m_volume;
+    std::atomic<qreal> m_volume;
 
 protected:
     void timerEvent(QTimerEvent *event) override;
@@ -75,6 +82,9 @@ private slots:
 
 private:
     void applyVolume(const void *src, void *dest, int len);
+    void updateReadableSize();
+    // Writes what was captured to the QIODevice of pull mode, without holding the lock
+    qint64 flushToDevice();
 
     bool open();
     void close();
@@ -90,8 +100,18 @@ private:
     QByteArray m_streamName;
     QByteArray m_device;
     QByteArray m_tempBuffer;
+    // Captured in pull mode, but not taken by the QIODevice yet
+    QByteArray m_pullBuffer;
     pa_sample_spec m_spec;
 
+    // Mirrored from the stream on the mainloop thread, so that bytesReady() and
+    // processedUSecs() don't take the lock of the engine
+    std::atomic<qsizetype> m_readableSize = 0;
+    std::atomic<qint64> m_processedUSecs = 0;
+
+    // Set while started with a callback, which gets the audio on the mainloop thread
+    std::optional<QtAudioPrivate::AudioSourceCallback> m_callback;
+
     QAudioStateMachine m_stateMachine;
 };
 
@@ -10,6 +10,7 @@ struct buf
     float width;
     float masteringWhite;
     float maxLum;
+    float packed10Bit;
 };
 
 uniform buf ubuf;
@@ -5,6 +5,7 @@
 #include "colortransfer.glsl"
 #include "colorconvert.glsl"
 #include "hdrtonemapper.glsl"
+#include "packed10.glsl"
 
 layout(location = 0) in vec2 texCoord;
 layout(location = 0) out vec4 fragColor;
@@ -21,8 +22,9 @@ layout(binding = 2) uniform sampler2D plane2Texture;
 // operate in HLG space here.
 void main()
 {
-    float Y = texture(plane1Texture, texCoord).r;
-    vec2 UV = texture(plane2Texture, texCoord).rg;
+    vec3 YUV = sampleSemiPlanarYUV(plane1Texture, plane2Texture, texCoord);
+    float Y = YUV.x;
+    vec2 UV = YUV.yz;
     // map to Rec.2020 color space
     fragColor = vec4(Y, UV.x, UV.y, 1.);
     fragColor = ubuf.colorMatrix * fragColor;
@@ -0,0 +1,26 @@
+#version 440
+#extension GL_GOOGLE_include_directive : enable
+
+#include "uniformbuffer.glsl"
+#include "colortransfer.glsl"
+#include "packed10.glsl"
+
+layout(location = 0) in vec2 texCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 1) uniform sampler2D plane1Texture;
+layout(binding = 2) uniform sampler2D plane2Texture;
+
+void main()
+{
+    vec4 color = vec4(sampleSemiPlanarYUV(plane1Texture, plane2Texture, texCoord), 1.);
+    fragColor = ubuf.colorMatrix * color * ubuf.opacity;
+
+#ifdef QMM_OUTPUTSURFACE_LINEAR
+    fragColor = convertSRGBToLinear(fragColor);
+#endif
+
+    // Clamp output to valid range to account for out-of-range
+    // input values and numerical inaccuracies in YUV->RGB conversion
+    fragColor = clamp(fragColor, 0.0, 1.0);
+}
@@ -0,0 +1,51 @@
+// Memory frames of the 10-bit formats may be uploaded with three samples per RGB10A2 texel,
+// which ubuf.packed10Bit signals, see QVideoTextureHelper::usesPacked10BitUpload.
+// The texels are sampled at their centers, so that the linear filtering doesn't mix the
+// samples of neighboring texels, and the samples are interpolated here instead.
+
+bool isPacked10Bit()
+{
+    return ubuf.packed10Bit > 0.5;
+}
+
+// Divides by 3, staying exact with the limited float precision of the GPUs
+float packedTexelIndex(float sampleIndex)
+{
+    return floor((sampleIndex + 0.5) / 3.0);
+}
+
+float packed10Sample(sampler2D tex, float textureWidth, float sampleIndex, float y)
+{
+    float texel = packedTexelIndex(sampleIndex);
+    float component = sampleIndex - texel * 3.0;
+    vec3 samples = texture(tex, vec2((texel + 0.5) / textureWidth, y)).rgb;
+    return component < 0.5 ? samples.r : (component < 1.5 ? samples.g : samples.b);
+}
+
+// Interpolates the component of the pixels around texCoord, in a row of pixelCount pixels
+// of componentCount interleaved components
+float packed10Component(sampler2D tex, float pixelCount, float componentCount, float component,
+                        vec2 texCoord)
+{
+    float textureWidth = packedTexelIndex(pixelCount * componentCount + 2.0);
+    float x = clamp(texCoord.x * pixelCount - 0.5, 0.0, pixelCount - 1.0);
+    float first = floor(x);
+    float second = min(first + 1.0, pixelCount - 1.0);
+    return mix(packed10Sample(tex, textureWidth, first * componentCount + component, texCoord.y),
+               packed10Sample(tex, textureWidth, second * componentCount + component, texCoord.y),
+               x - first);
+}
+
+// Samples the Y and the UV planes of P010 and P016
+vec3 sampleSemiPlanarYUV(sampler2D yTexture, sampler2D uvTexture, vec2 texCoord)
+{
+    if (isPacked10Bit()) {
+        float width = ubuf.width;
+        float chromaWidth = floor(width / 2.0);
+        return vec3(packed10Component(yTexture, width, 1.0, 0.0, texCoord),
+                    packed10Component(uvTexture, chromaWidth, 2.0, 0.0, texCoord),
+                    packed10Component(uvTexture, chromaWidth, 2.0, 1.0, texCoord));
+    }
+
+    return vec3(texture(yTexture, texCoord).r, texture(uvTexture, texCoord).rg);
+}
@@ -8,4 +8,6 @@ layout(std140, binding = 0) uniform buf {
     // HDR metadata required for tonemapping
     float masteringWhite; // in PQ or HLG values
     float maxLum; // in PQ or HLG values
+    // 1.0 if the 10-bit planes are packed, see packed10.glsl
+    float packed10Bit;
 } ubuf;
@@ -3,6 +3,7 @@
 
 #include "uniformbuffer.glsl"
 #include "colortransfer.glsl"
+#include "packed10.glsl"
 
 layout(location = 0) in vec2 texCoord;
 layout(location = 0) out vec4 fragColor;
@@ -13,10 +14,19 @@ layout(binding = 3) uniform sampler2D plane3Texture;
 
 void main()
 {
-    float Y = texture(plane1Texture, texCoord).r * 64;
-    float U = texture(plane2Texture, texCoord).r * 64;
-    float V = texture(plane3Texture, texCoord).r * 64;
-    vec4 color = vec4(Y, U, V, 1.);
+    vec4 color;
+    if (isPacked10Bit()) {
+        float width = ubuf.width;
+        float chromaWidth = floor(width / 2.0);
+        color = vec4(packed10Component(plane1Texture, width, 1.0, 0.0, texCoord),
+                     packed10Component(plane2Texture, chromaWidth, 1.0, 0.0, texCoord),
+                     packed10Component(plane3Texture, chromaWidth, 1.0, 0.0, texCoord), 1.);
+    } else {
+        float Y = texture(plane1Texture, texCoord).r * 64;
+        float U = texture(plane2Texture, texCoord).r * 64;
+        float V = texture(plane3Texture, texCoord).r * 64;
+        color = vec4(Y, U, V, 1.);
+    }
     fragColor = ubuf.colorMatrix * color * ubuf.opacity;
 
 #ifdef QMM_OUTPUTSURFACE_LINEAR
@@ -0,0 +1,286 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qhdrtonemapper_p.h"
+
+#include <QtCore/qglobal.h>
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// The transfer functions are sampled at LutSize + 1 points over [0, 1] and
+// interpolated linearly, which keeps the output within one 8-bit step of the shaders
+constexpr int LutSize = 4096;
+
+// See shaders/colortransfer.glsl
+constexpr float SdrLevel = 100.f;
+
+float pqToLinear(float sig)
+{
+    const float one_over_m1 = 8192.f/1305.f;
+    const float one_over_m2 = 32.f/2523.f;
+    const float c1 = 107.f/128.f;
+    const float c2 = 2413.f/128.f;
+    const float c3 = 2392.f/128.f;
+
+    const float e = std::pow(sig, one_over_m2);
+    const float num = std::max(e - c1, 0.f);
+    const float den = c2 - c3*e;
+    return std::pow(num/den, one_over_m1)*10000.f/SdrLevel;
+}
+
+// Without the OOTF, which depends on the luminance of the pixel
+float hlgToLinear(float sig)
+{
+    const float a = 0.17883277f;
+    const float b = 0.28466892f; // = 1 - 4a
+    const float c = 0.55991073f; // = 0.5 - a ln(4a)
+
+    if (sig < 0.5f)
+        return sig*sig/3.f;
+    return (std::exp((sig - c)/a) + b)/12.f;
+}
+
+float sRGBFromLinear(float sig)
+{
+    // https://en.wikipedia.org/wiki/SRGB
+    if (sig <= 0.0031308f)
+        return sig*12.92f;
+    return 1.055f*std::pow(sig, 1.f/2.4f) - 0.055f;
+}
+
+struct ToneMappingLuts
+{
+    ToneMappingLuts()
+    {
+        for (int i = 0; i <= LutSize; ++i) {
+            const float x = float(i)/LutSize;
+            pq[i] = pqToLinear(x);
+            hlg[i] = hlgToLinear(x);
+            hlgGamma[i] = std::pow(x, 0.2f); // gamma-1 with gamma = 1.2
+            sRGB[i] = sRGBFromLinear(x)*255.f;
+        }
+    }
+
+    float pq[LutSize + 1];
+    float hlg[LutSize + 1];
+    float hlgGamma[LutSize + 1];
+    float sRGB[LutSize + 1]; // scaled to [0, 255]
+};
+
+const ToneMappingLuts &luts()
+{
+    static const ToneMappingLuts instance;
+    return instance;
+}
+
+inline float lookup(const float *lut, float x)
+{
+    const float position = std::clamp(x, 0.f, 1.f)*LutSize;
+    const int index = std::min(int(position), LutSize - 1);
+    const float fraction = position - index;
+    return lut[index] + (lut[index + 1] - lut[index])*fraction;
+}
+
+#if defined(__SSE2__)
+// The SSE2 counterpart of lookup(); only reading the table is done per element
+inline __m128 lookup(const float *lut, __m128 x)
+{
+    // _mm_max_ps returns the second operand for NaN, which keeps the index in range
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    const __m128 position = _mm_mul_ps(clamped, _mm_set1_ps(float(LutSize)));
+    // At 1, interpolates the last interval with a fraction of 1
+    const __m128i index = _mm_cvttps_epi32(_mm_min_ps(position, _mm_set1_ps(LutSize - 1)));
+    const __m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+
+    alignas(16) int indices[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(indices), index);
+    const __m128 low = _mm_setr_ps(lut[indices[0]], lut[indices[1]], lut[indices[2]],
+                                   lut[indices[3]]);
+    const __m128 high = _mm_setr_ps(lut[indices[0] + 1], lut[indices[1] + 1],
+                                    lut[indices[2] + 1], lut[indices[3] + 1]);
+    return _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), fraction));
+}
+
+// The SSE2 counterpart of QHdrToneMapper::toneMappingScale()
+inline __m128 toneMappingScaleSse2(__m128 y, float masteringWhite, float maxLum)
+{
+    const float ksValue = 1.5f*maxLum - 0.5f;
+    const __m128 ks = _mm_set1_ps(ksValue);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 two = _mm_set1_ps(2.f);
+    const __m128 three = _mm_set1_ps(3.f);
+    const __m128 white = _mm_set1_ps(masteringWhite);
+
+    const __m128 p = _mm_div_ps(y, white);
+    const __m128 t = _mm_div_ps(_mm_sub_ps(p, ks), _mm_set1_ps(1.f - ksValue));
+    const __m128 t2 = _mm_mul_ps(t, t);
+    const __m128 t3 = _mm_mul_ps(t, t2);
+
+    // The Hermite spline of the roll-off
+    const __m128 h00 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, t3), _mm_mul_ps(three, t2)), one);
+    const __m128 h10 = _mm_add_ps(_mm_sub_ps(t3, _mm_mul_ps(two, t2)), t);
+    const __m128 h01 = _mm_sub_ps(_mm_mul_ps(three, t2), _mm_mul_ps(two, t3));
+    const __m128 mapped = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(h00, ks), _mm_mul_ps(h10, _mm_set1_ps(1.f - ksValue))),
+            _mm_mul_ps(h01, _mm_set1_ps(maxLum)));
+    const __m128 scale = _mm_div_ps(_mm_mul_ps(mapped, white), y);
+
+    // Below the knee the pixels are kept; the lanes of the others may divide by 0
+    const __m128 rolledOff = _mm_cmpge_ps(p, ks);
+    return _mm_or_ps(_mm_and_ps(rolledOff, scale), _mm_andnot_ps(rolledOff, one));
+}
+#endif
+
+} // namespace
+
+bool QHdrToneMapper::isHdr(const QVideoFrameFormat &format)
+{
+    return format.colorTransfer() == QVideoFrameFormat::ColorTransfer_ST2084
+            || format.colorTransfer() == QVideoFrameFormat::ColorTransfer_STD_B67;
+}
+
+QHdrToneMapper::QHdrToneMapper(const QVideoFrameFormat &format, float maxNits)
+    : m_hlg(format.colorTransfer() == QVideoFrameFormat::ColorTransfer_STD_B67)
+{
+    // Same as the uniforms of the shaders, see QVideoTextureHelper::updateUniformData()
+    const auto fromLinear = m_hlg ? hlgFromLinear : pqFromLinear;
+    m_masteringWhite = fromLinear(format.maxLuminance()/SdrLevel);
+    m_maxLum = fromLinear(maxNits/SdrLevel);
+}
+
+// See shaders/hdrtonemapper.glsl
+float QHdrToneMapper::toneMappingScale(float y) const
+{
+    float p = y/m_masteringWhite;
+
+    const float ks = 1.5f*m_maxLum - 0.5f;
+
+    if (p < ks)
+        return 1.f;
+
+    const float t = (p - ks)/(1.f - ks);
+    const float t2 = t*t;
+    const float t3 = t*t2;
+
+    p = (2*t3 - 3*t2 + 1)*ks + (t3 - 2*t2 + t)*(1.f - ks) + (-2*t3 + 3*t2)*m_maxLum;
+
+    const float newY = p*m_masteringWhite;
+    return newY/y;
+}
+
+void QHdrToneMapper::mapToARGB32(const float *luma, const float *r, const float *g,
+                                 const float *b, quint32 *argb, int count) const
+{
+    const ToneMappingLuts &tables = luts();
+    const float *toLinear = m_hlg ? tables.hlg : tables.pq;
+
+    int i = 0;
+
+#if defined(__SSE2__)
+    const __m128 lumaOffset = _mm_set1_ps(16.f/256.f);
+    const __m128 lumaScale = _mm_set1_ps(256.f/219.f);
+    const __m128 maxLum = _mm_set1_ps(m_maxLum);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i alpha = _mm_set1_epi32(int(0xff000000u));
+
+    for (; i + 4 <= count; i += 4) {
+        // Like the shaders, assumes video range luma (16...235)
+        const __m128 y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(luma + i), lumaOffset), lumaScale);
+        const __m128 scale = toneMappingScaleSse2(y, m_masteringWhite, m_maxLum);
+
+        __m128 lr = lookup(toLinear, _mm_mul_ps(_mm_loadu_ps(r + i), scale));
+        __m128 lg = lookup(toLinear, _mm_mul_ps(_mm_loadu_ps(g + i), scale));
+        __m128 lb = lookup(toLinear, _mm_mul_ps(_mm_loadu_ps(b + i), scale));
+
+        if (m_hlg) {
+            const __m128 lum = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.2627f), lr),
+                               _mm_mul_ps(_mm_set1_ps(0.6780f), lg)),
+                    _mm_mul_ps(_mm_set1_ps(0.0593f), lb));
+            const __m128 ootf = _mm_mul_ps(lookup(tables.hlgGamma, lum), maxLum);
+            lr = _mm_mul_ps(lr, ootf);
+            lg = _mm_mul_ps(lg, ootf);
+            lb = _mm_mul_ps(lb, ootf);
+        }
+
+        const auto toSRGB = [&](float cr, float cg, float cb) {
+            const __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(cr), lr),
+                                                   _mm_mul_ps(_mm_set1_ps(cg), lg)),
+                                        _mm_mul_ps(_mm_set1_ps(cb), lb));
+            return _mm_cvttps_epi32(_mm_add_ps(lookup(tables.sRGB, c), half));
+        };
+
+        // BT.2020 to sRGB primaries, see shaders/colorconvert.glsl
+        const __m128i red = toSRGB(1.6605f, -0.5876f, -0.0728f);
+        const __m128i green = toSRGB(-0.1246f, 1.1329f, -0.0083f);
+        const __m128i blue = toSRGB(-0.0182f, -0.1006f, 1.1187f);
+
+        const __m128i pixels = _mm_or_si128(
+                _mm_or_si128(alpha, _mm_slli_epi32(red, 16)),
+                _mm_or_si128(_mm_slli_epi32(green, 8), blue));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(argb + i), pixels);
+    }
+#endif
+
+    // leftovers
+    for (; i < count; ++i) {
+        // Like the shaders, assumes video range luma (16...235)
+        const float scale = toneMappingScale((luma[i] - 16.f/256.f)*256.f/219.f);
+        float lr = lookup(toLinear, r[i]*scale);
+        float lg = lookup(toLinear, g[i]*scale);
+        float lb = lookup(toLinear, b[i]*scale);
+
+        if (m_hlg) {
+            const float lum = 0.2627f*lr + 0.6780f*lg + 0.0593f*lb;
+            const float ootf = lookup(tables.hlgGamma, lum)*m_maxLum;
+            lr *= ootf;
+            lg *= ootf;
+            lb *= ootf;
+        }
+
+        // BT.2020 to sRGB primaries, see shaders/colorconvert.glsl
+        const float sr = 1.6605f*lr - 0.5876f*lg - 0.0728f*lb;
+        const float sg = -0.1246f*lr + 1.1329f*lg - 0.0083f*lb;
+        const float sb = -0.0182f*lr - 0.1006f*lg + 1.1187f*lb;
+        argb[i] = 0xff000000
+                | uint(lookup(tables.sRGB, sr) + 0.5f) << 16
+                | uint(lookup(tables.sRGB, sg) + 0.5f) << 8
+                | uint(lookup(tables.sRGB, sb) + 0.5f);
+    }
+}
+
+// PQ transfer function, see also https://en.wikipedia.org/wiki/Perceptual_quantizer
+// or https://ieeexplore.ieee.org/document/7291452
+float QHdrToneMapper::pqFromLinear(float sig)
+{
+    const float m1 = 1305.f/8192.f;
+    const float m2 = 2523.f/32.f;
+    const float c1 = 107.f/128.f;
+    const float c2 = 2413.f/128.f;
+    const float c3 = 2392.f/128.f;
+
+    sig *= SdrLevel/10000.f;
+    float psig = powf(sig, m1);
+    float num = c1 + c2*psig;
+    float den = 1 + c3*psig;
+    return powf(num/den, m2);
+}
+
+float QHdrToneMapper::hlgFromLinear(float sig)
+{
+    const float a = 0.17883277f;
+    const float b = 0.28466892f; // = 1 - 4a
+    const float c = 0.55991073f; // = 0.5 - a ln(4a)
+
+    if (sig < 1.f/12.f)
+        return sqrtf(3.f*sig);
+    return a*logf(12.f*sig - b) + c;
+}
+
+QT_END_NAMESPACE
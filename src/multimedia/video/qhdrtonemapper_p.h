@@ -0,0 +1,56 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QHDRTONEMAPPER_P_H
+#define QHDRTONEMAPPER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qvideoframeformat.h"
+
+QT_BEGIN_NAMESPACE
+
+/**
+ *  @brief The CPU counterpart of the tone mapping in the nv12_bt2020_pq and nv12_bt2020_hlg
+ * shaders: maps BT.2020 R'G'B' encoded with the PQ or HLG transfer function to sRGB, cutting
+ * off the HDR peaks as described in BT.2390. The transfer functions are applied with lookup
+ * tables shared by all the instances.
+ */
+class Q_MULTIMEDIA_EXPORT QHdrToneMapper
+{
+public:
+    // Whether the transfer function of the format needs tone mapping
+    static bool isHdr(const QVideoFrameFormat &format);
+
+    // maxNits is the luminance of the brightest output, 100 nits being SDR white
+    explicit QHdrToneMapper(const QVideoFrameFormat &format, float maxNits = 100.f);
+
+    // Maps count pixels to opaque ARGB32, 4 at a time with SSE2. The samples are normalized
+    // to [0, 1]; luma holds the Y' samples the pixels were computed from.
+    void mapToARGB32(const float *luma, const float *r, const float *g, const float *b,
+                     quint32 *argb, int count) const;
+
+    // The inverse transfer functions, taking luminance relative to SDR white
+    static float pqFromLinear(float sig);
+    static float hlgFromLinear(float sig);
+
+private:
+    float toneMappingScale(float luma) const;
+
+    bool m_hlg = false;
+    float m_masteringWhite = 1.f;
+    float m_maxLum = 1.f;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHDRTONEMAPPER_P_H
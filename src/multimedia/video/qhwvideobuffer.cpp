@@ -3,8 +3,12 @@
 
 #include "qhwvideobuffer_p.h"
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
+static std::atomic<quint64> s_readBackCount = 0;
+
 QVideoFrameTextures::~QVideoFrameTextures() = default;
 
 QHwVideoBuffer::QHwVideoBuffer(QVideoFrame::HandleType type, QRhi *rhi) : m_type(type), m_rhi(rhi)
@@ -14,4 +18,14 @@ QHwVideoBuffer::QHwVideoBuffer(QVideoFrame::HandleType type, QRhi *rhi) : m_type
 // must be out-of-line to ensure correct working of dynamic_cast when QHwVideoBuffer is created in tests
 QHwVideoBuffer::~QHwVideoBuffer() = default;
 
+quint64 QHwVideoBuffer::readBackCount()
+{
+    return s_readBackCount.load(std::memory_order_relaxed);
+}
+
+void QHwVideoBuffer::countReadBack()
+{
+    s_readBackCount.fetch_add(1, std::memory_order_relaxed);
+}
+
 QT_END_NAMESPACE
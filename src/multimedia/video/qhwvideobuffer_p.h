@@ -48,7 +48,14 @@ public:
     virtual quint64 textureHandle(QRhi *, int /*plane*/) const { return 0; }
     virtual QMatrix4x4 externalTextureMatrix() const { return {}; }
 
+    // How many hardware frames map() has copied to system memory in this process; lets tests
+    // check that the frames imported as textures aren't read back for rendering
+    static quint64 readBackCount();
+
 protected:
+    // Called by the backends for each copy of a hardware frame to system memory
+    static void countReadBack();
+
     QVideoFrame::HandleType m_type;
     QRhi *m_rhi = nullptr;
 };
@@ -2,57 +2,44 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qvideoframeconversionhelper_p.h"
+#include "qhdrtonemapper_p.h"
 #include "qrgb.h"
 
+#include <QtCore/qendian.h>
+
+#include <algorithm>
 #include <mutex>
 
 QT_BEGIN_NAMESPACE
 
-#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
-
-#define EXPAND_UV(u, v) \
-    int uu = u - 128; \
-    int vv = v - 128; \
-    int rv = 409 * vv + 128; \
-    int guv = 100 * uu + 208 * vv + 128; \
-    int bu = 516 * uu + 128; \
-
-static inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, int a = 0xff)
+template<int YStep, int UVStep>
+static void QT_FASTCALL convertYUVLine(const uchar *y, const uchar *u, const uchar *v,
+                                       quint32 *rgb, int width, const YUVToRGBCoefficients &c)
 {
-    int yy = (y - 16) * 298;
-    return (a << 24)
-            | CLAMP((yy + rv) >> 8) << 16
-            | CLAMP((yy - guv) >> 8) << 8
-            | CLAMP((yy + bu) >> 8);
+    qt_convert_YUV_line_to_ARGB32<YStep, UVStep>(y, u, v, rgb, width, c);
 }
 
+static YUVLineConvertFunc qYUVLineFuncs[int(YUVLineLayout::Count)] = {
+    /* Planar */                        convertYUVLine<1, 1>,
+    /* SemiPlanar */                    convertYUVLine<1, 2>,
+    /* Interleaved */                   convertYUVLine<2, 4>,
+};
+
 static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
-                                          int uvPixelStride,
+                                          YUVLineLayout layout,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &coefficients)
 {
+    const YUVLineConvertFunc convertLine = qYUVLineFuncs[int(layout)];
+
     height &= ~1;
 
     for (int j = 0; j + 1 < height; j += 2) {
-        const uchar *lineY0 = y;
-        const uchar *lineY1 = y + yStride;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
-
-        quint32 *rgb0 = rgb;
-        quint32 *rgb1 = rgb + width;
-        for (int i = 0; i + 1 < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
-
-            rgb0[i] = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            rgb0[i + 1] = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            rgb1[i] = qYUVToARGB32(*lineY1++, rv, guv, bu);
-            rgb1[i + 1] = qYUVToARGB32(*lineY1++, rv, guv, bu);
-        }
+        convertLine(y, u, v, rgb, width, coefficients);
+        convertLine(y + yStride, u, v, rgb + width, width, coefficients);
 
         y += yStride << 1; // stride * 2
         u += uStride;
@@ -64,25 +51,17 @@ static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
 static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
-                                          int uvPixelStride,
+                                          YUVLineLayout layout,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &coefficients)
 {
-    for (int j = 0; j < height; ++j) {
-        const uchar *lineY0 = y;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
+    const YUVLineConvertFunc convertLine = qYUVLineFuncs[int(layout)];
 
-        for (int i = 0; i + 1 < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
-
-            rgb[i]   = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            rgb[i+1] = qYUVToARGB32(*lineY0++, rv, guv, bu);
-        }
+    for (int j = 0; j < height; ++j) {
+        convertLine(y, u, v, rgb, width, coefficients);
 
-        y += yStride; // stride * 2
+        y += yStride;
         u += uStride;
         v += vStride;
         rgb += width;
@@ -95,9 +74,10 @@ static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, u
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane3, plane3Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -106,9 +86,10 @@ static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, u
     planarYUV422_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane3, plane3Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 
@@ -118,9 +99,10 @@ static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane3, plane3Stride,
                            plane2, plane2Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -128,6 +110,7 @@ static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, ucha
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
+    const auto coefficients = qYUVToRGBCoefficients(frame.surfaceFormat());
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -139,9 +122,7 @@ static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, ucha
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
-
-            *rgb++ = qPremultiply(qYUVToARGB32(y, rv, guv, bu, a));
+            *rgb++ = qPremultiply(qYUVToARGB32(y, u, v, coefficients, a));
         }
 
         src += stride;
@@ -153,6 +134,7 @@ static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFram
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
+    const auto coefficients = qYUVToRGBCoefficients(frame.surfaceFormat());
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -164,9 +146,7 @@ static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFram
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
-
-            *rgb++ = qYUVToARGB32(y, rv, guv, bu, a);
+            *rgb++ = qYUVToARGB32(y, u, v, coefficients, a);
         }
 
         src += stride;
@@ -178,21 +158,12 @@ static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, ucha
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
+    const auto coefficients = qYUVToRGBCoefficients(frame.surfaceFormat());
+    const YUVLineConvertFunc convertLine = qYUVLineFuncs[int(YUVLineLayout::Interleaved)];
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
-        const uchar *lineSrc = src;
-        for (int j = 0; j + 1 < width; j += 2) {
-            int u = *lineSrc++;
-            int y0 = *lineSrc++;
-            int v = *lineSrc++;
-            int y1 = *lineSrc++;
-
-            EXPAND_UV(u, v);
-
-            rgb[j] = qYUVToARGB32(y0, rv, guv, bu);
-            rgb[j+1] = qYUVToARGB32(y1, rv, guv, bu);
-        }
+        convertLine(src + 1, src, src + 2, rgb, width, coefficients);
 
         src += stride;
         rgb += width;
@@ -204,21 +175,12 @@ static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, ucha
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
+    const auto coefficients = qYUVToRGBCoefficients(frame.surfaceFormat());
+    const YUVLineConvertFunc convertLine = qYUVLineFuncs[int(YUVLineLayout::Interleaved)];
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
-        const uchar *lineSrc = src;
-        for (int j = 0; j + 1 < width; j += 2) {
-            int y0 = *lineSrc++;
-            int u = *lineSrc++;
-            int y1 = *lineSrc++;
-            int v = *lineSrc++;
-
-            EXPAND_UV(u, v);
-
-            rgb[j] = qYUVToARGB32(y0, rv, guv, bu);
-            rgb[j+1] = qYUVToARGB32(y1, rv, guv, bu);
-        }
+        convertLine(src, src + 1, src + 3, rgb, width, coefficients);
 
         src += stride;
         rgb += width;
@@ -231,9 +193,10 @@ static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane2 + 1, plane2Stride,
-                           2,
+                           YUVLineLayout::SemiPlanar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -242,9 +205,10 @@ static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2 + 1, plane2Stride,
                            plane2, plane2Stride,
-                           2,
+                           YUVLineLayout::SemiPlanar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -256,9 +220,10 @@ static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane3, plane3Stride,
                            plane2, plane2Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -269,9 +234,10 @@ static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2 + (plane1Stride >> 1), plane1Stride,
                            plane2, plane1Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -283,9 +249,10 @@ static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane3, plane3Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, uchar *output)
@@ -296,9 +263,10 @@ static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, ucha
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane1Stride,
                            plane2 + (plane1Stride >> 1), plane1Stride,
-                           1,
+                           YUVLineLayout::Planar,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 
@@ -370,57 +338,69 @@ static void QT_FASTCALL qt_convert_premultiplied_to_ARGB32(const QVideoFrame &fr
     }
 }
 
-static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
-                                                const uchar *u, int uStride,
-                                                const uchar *v, int vStride,
-                                                int uvPixelStride,
-                                                quint32 *rgb,
-                                                int width, int height)
+// Converts the full 16-bit samples, and tone maps them to SDR like the shaders do for HDR
+static void QT_FASTCALL qt_convert_P016_HDR_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
-    height &= ~1;
-
-    for (int j = 0; j + 1 < height; j += 2) {
-        const uchar *lineY0 = y;
-        const uchar *lineY1 = y + yStride;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
-
-        quint32 *rgb0 = rgb;
-        quint32 *rgb1 = rgb + width;
-
-        for (int i = 0; i + 1 < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
-
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
-            lineY0 += 2;
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
-            lineY0 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
-            lineY1 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
-            lineY1 += 2;
+    FETCH_INFO_BIPLANAR(frame)
+    const QHdrToneMapper toneMapper(frame.surfaceFormat());
+    const YUVToRGBCoefficients c = qYUVToRGBCoefficients(frame.surfaceFormat());
+
+    // The coefficients apply to samples on the 8-bit scale, with 8 fractional bits
+    const float scale = 1.f / (256.f * 255.f);
+    const float yOffset = c.yOffset;
+    const float yScale = c.y * scale;
+    const float rv = c.rv * scale;
+    const float gu = c.gu * scale;
+    const float gv = c.gv * scale;
+    const float bu = c.bu * scale;
+
+    // Small enough to stay in L1 until the tone mapper reads it
+    constexpr int Chunk = 64;
+    float luma[Chunk];
+    float r[Chunk];
+    float g[Chunk];
+    float b[Chunk];
+
+    quint32 *argb = reinterpret_cast<quint32 *>(output);
+    for (int j = 0; j < height; ++j) {
+        const auto *y = reinterpret_cast<const quint16 *>(plane1 + j * plane1Stride);
+        const auto *uv = reinterpret_cast<const quint16 *>(plane2 + j / 2 * plane2Stride);
+
+        for (int x0 = 0; x0 < width; x0 += Chunk) {
+            const int count = std::min(Chunk, width - x0);
+            for (int i = 0; i < count; ++i) {
+                const int x = x0 + i;
+                const quint16 ySample = qFromLittleEndian(y[x]);
+                const float yy = (ySample / 257.f - yOffset) * yScale;
+                const float uu = qFromLittleEndian(uv[x & ~1]) / 257.f - 128.f;
+                const float vv = qFromLittleEndian(uv[x | 1]) / 257.f - 128.f;
+                luma[i] = ySample / 65535.f;
+                r[i] = yy + rv * vv;
+                g[i] = yy - gu * uu - gv * vv;
+                b[i] = yy + bu * uu;
+            }
+            toneMapper.mapToARGB32(luma, r, g, b, argb + x0, count);
         }
-
-        y += yStride << 1; // stride * 2
-        u += uStride;
-        v += vStride;
-        rgb += width * 2;
+        argb += width;
     }
 }
 
-
 static void QT_FASTCALL qt_convert_P016_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
+    if (QHdrToneMapper::isHdr(frame.surfaceFormat())) {
+        qt_convert_P016_HDR_to_ARGB32(frame, output);
+        return;
+    }
+
+    // Only the high bytes of the samples are converted
     FETCH_INFO_BIPLANAR(frame)
-    planarYUV420_16bit_to_ARGB32(plane1 + 1, plane1Stride,
+    planarYUV420_to_ARGB32(plane1 + 1, plane1Stride,
                            plane2 + 1, plane2Stride,
                            plane2 + 3, plane2Stride,
-                           4,
+                           YUVLineLayout::Interleaved,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
-
+                           width, height,
+                           qYUVToRGBCoefficients(frame.surfaceFormat()));
 }
 
 template <typename Y>
@@ -544,12 +524,25 @@ static void qInitFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_RGBX8888] = qt_convert_RGBA8888_to_ARGB32_ssse3;
     }
 #endif
+#ifdef QT_COMPILER_SUPPORTS_SSE4_1
+    extern void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_sse4(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_sse4(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_sse4(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    if (qCpuHasFeature(SSE4_1)) {
+        qYUVLineFuncs[int(YUVLineLayout::Planar)] = qt_convert_YUV_planar_line_to_ARGB32_sse4;
+        qYUVLineFuncs[int(YUVLineLayout::SemiPlanar)] = qt_convert_YUV_semiplanar_line_to_ARGB32_sse4;
+        qYUVLineFuncs[int(YUVLineLayout::Interleaved)] = qt_convert_YUV_interleaved_line_to_ARGB32_sse4;
+    }
+#endif
 #ifdef QT_COMPILER_SUPPORTS_AVX2
     extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_copy_pixels_with_mask_avx2(uint32_t * dst, const uint32_t *src, size_t size, uint32_t mask);
+    extern void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_avx2(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_avx2(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_avx2(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
     if (qCpuHasFeature(AVX2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_avx2;
@@ -563,6 +556,30 @@ static void qInitFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_RGBX8888] = qt_convert_RGBA8888_to_ARGB32_avx2;
 
         qPixelsCopyFunc = qt_copy_pixels_with_mask_avx2;
+
+        qYUVLineFuncs[int(YUVLineLayout::Planar)] = qt_convert_YUV_planar_line_to_ARGB32_avx2;
+        qYUVLineFuncs[int(YUVLineLayout::SemiPlanar)] = qt_convert_YUV_semiplanar_line_to_ARGB32_avx2;
+        qYUVLineFuncs[int(YUVLineLayout::Interleaved)] = qt_convert_YUV_interleaved_line_to_ARGB32_avx2;
+    }
+#endif
+#ifdef QT_COMPILER_SUPPORTS_AVX512F
+    extern void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_avx512(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_avx512(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_avx512(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    if (qCpuHasFeature(ArchSkyLakeAvx512)) {
+        qYUVLineFuncs[int(YUVLineLayout::Planar)] = qt_convert_YUV_planar_line_to_ARGB32_avx512;
+        qYUVLineFuncs[int(YUVLineLayout::SemiPlanar)] = qt_convert_YUV_semiplanar_line_to_ARGB32_avx512;
+        qYUVLineFuncs[int(YUVLineLayout::Interleaved)] = qt_convert_YUV_interleaved_line_to_ARGB32_avx512;
+    }
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    extern void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_neon(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_neon(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    extern void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_neon(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width, const YUVToRGBCoefficients &c);
+    if (qCpuHasFeature(NEON)) {
+        qYUVLineFuncs[int(YUVLineLayout::Planar)] = qt_convert_YUV_planar_line_to_ARGB32_neon;
+        qYUVLineFuncs[int(YUVLineLayout::SemiPlanar)] = qt_convert_YUV_semiplanar_line_to_ARGB32_neon;
+        qYUVLineFuncs[int(YUVLineLayout::Interleaved)] = qt_convert_YUV_interleaved_line_to_ARGB32_neon;
     }
 #endif
 }
@@ -575,6 +592,63 @@ VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format)
     return convert;
 }
 
+YUVLineConvertFunc qYUVLineConverter(YUVLineLayout layout)
+{
+    std::call_once(InitFuncsAsmFlag, &qInitFuncsAsm);
+
+    return qYUVLineFuncs[int(layout)];
+}
+
+QVideoFrameFormat::ColorSpace qEffectiveColorSpace(const QVideoFrameFormat &format)
+{
+    // Same choice as in the color matrices of QVideoTextureHelper
+    const auto colorSpace = format.colorSpace();
+    if (colorSpace != QVideoFrameFormat::ColorSpace_Undefined)
+        return colorSpace;
+
+    return format.frameHeight() > 576 ? QVideoFrameFormat::ColorSpace_BT709
+                                      : QVideoFrameFormat::ColorSpace_BT601;
+}
+
+YUVToRGBCoefficients qYUVToRGBCoefficients(const QVideoFrameFormat &format)
+{
+    const auto colorSpace = qEffectiveColorSpace(format);
+    bool fullRange = format.colorRange() == QVideoFrameFormat::ColorRange_Full;
+
+    // Luma weights of red and blue
+    double kr = 0.299;
+    double kb = 0.114;
+
+    switch (colorSpace) {
+    case QVideoFrameFormat::ColorSpace_BT709:
+        kr = 0.2126;
+        kb = 0.0722;
+        break;
+    case QVideoFrameFormat::ColorSpace_BT2020:
+        kr = 0.2627;
+        kb = 0.0593;
+        break;
+    case QVideoFrameFormat::ColorSpace_AdobeRgb:
+        fullRange = true;
+        break;
+    default:
+        break;
+    }
+
+    const double kg = 1. - kr - kb;
+    const double yScale = fullRange ? 256. : 256. * 255. / 219.;
+    const double uvScale = fullRange ? 256. : 256. * 255. / 224.;
+
+    YUVToRGBCoefficients result;
+    result.yOffset = fullRange ? 0 : 16;
+    result.y = qRound(yScale);
+    result.rv = qRound(uvScale * 2. * (1. - kr));
+    result.gu = qRound(uvScale * 2. * (1. - kb) * kb / kg);
+    result.gv = qRound(uvScale * 2. * (1. - kr) * kr / kg);
+    result.bu = qRound(uvScale * 2. * (1. - kb));
+    return result;
+}
+
 void Q_MULTIMEDIA_EXPORT qCopyPixelsWithAlphaMask(uint32_t *dst,
                                                   const uint32_t *src,
                                                   size_t pixCount,
@@ -130,6 +130,130 @@ void QT_FASTCALL qt_copy_pixels_with_mask_avx2(uint32_t *dst, const uint32_t *sr
         *(dst++) = *(src++) | mask;
 }
 
+namespace {
+
+// Loads 8 samples that are Step bytes apart to 32 bit lanes
+template<int Step>
+__m256i loadSamples(const uchar *src)
+{
+    if constexpr (Step == 1) {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src)));
+    } else if constexpr (Step == 2) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        return _mm256_and_si256(_mm256_cvtepu16_epi32(data), _mm256_set1_epi32(0xff));
+    } else {
+        static_assert(Step == 4);
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        return _mm256_and_si256(data, _mm256_set1_epi32(0xff));
+    }
+}
+
+struct Coefficients
+{
+    explicit Coefficients(const YUVToRGBCoefficients &c)
+        : yOffset(_mm256_set1_epi32(c.yOffset)),
+          y(_mm256_set1_epi32(c.y)),
+          rv(_mm256_set1_epi32(c.rv)),
+          gu(_mm256_set1_epi32(c.gu)),
+          gv(_mm256_set1_epi32(c.gv)),
+          bu(_mm256_set1_epi32(c.bu))
+    {
+    }
+
+    __m256i yOffset;
+    __m256i y;
+    __m256i rv;
+    __m256i gu;
+    __m256i gv;
+    __m256i bu;
+};
+
+// Same arithmetic as qYUVToARGB32, so the results are bit exact
+inline __m256i convertPixels(__m256i y, __m256i u, __m256i v, const Coefficients &c)
+{
+    const __m256i half = _mm256_set1_epi32(128);
+    const __m256i uu = _mm256_sub_epi32(u, half);
+    const __m256i vv = _mm256_sub_epi32(v, half);
+    const __m256i yy = _mm256_mullo_epi32(_mm256_sub_epi32(y, c.yOffset), c.y);
+
+    const __m256i rv = _mm256_add_epi32(_mm256_mullo_epi32(vv, c.rv), half);
+    const __m256i guv = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(uu, c.gu), _mm256_mullo_epi32(vv, c.gv)), half);
+    const __m256i bu = _mm256_add_epi32(_mm256_mullo_epi32(uu, c.bu), half);
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi32(255);
+    auto clamp = [&](__m256i n) {
+        return _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(n, 8), zero), max);
+    };
+
+    const __m256i r = clamp(_mm256_add_epi32(yy, rv));
+    const __m256i g = clamp(_mm256_sub_epi32(yy, guv));
+    const __m256i b = clamp(_mm256_add_epi32(yy, bu));
+
+    return _mm256_or_si256(
+            _mm256_or_si256(_mm256_set1_epi32(int(0xff000000)), _mm256_slli_epi32(r, 16)),
+            _mm256_or_si256(_mm256_slli_epi32(g, 8), b));
+}
+
+template<int YStep, int UVStep>
+void convertLine_avx2(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width,
+                      const YUVToRGBCoefficients &c)
+{
+    const Coefficients coefficients(c);
+    const __m256i firstHalf = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i secondHalf = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+    int x = 0;
+    // The loads may touch the next pair of pixels, so it's left to the leftovers
+    for (; x + 16 + 1 < width; x += 16) {
+        const int uvOffset = x / 2 * UVStep;
+        const __m256i us = loadSamples<UVStep>(u + uvOffset);
+        const __m256i vs = loadSamples<UVStep>(v + uvOffset);
+
+        const __m256i y0 = loadSamples<YStep>(y + x * YStep);
+        const __m256i y1 = loadSamples<YStep>(y + (x + 8) * YStep);
+
+        const __m256i rgb0 = convertPixels(y0, _mm256_permutevar8x32_epi32(us, firstHalf),
+                                           _mm256_permutevar8x32_epi32(vs, firstHalf),
+                                           coefficients);
+        const __m256i rgb1 = convertPixels(y1, _mm256_permutevar8x32_epi32(us, secondHalf),
+                                           _mm256_permutevar8x32_epi32(vs, secondHalf),
+                                           coefficients);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb + x), rgb0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb + x + 8), rgb1);
+    }
+
+    // leftovers
+    qt_convert_YUV_line_to_ARGB32<YStep, UVStep>(y, u, v, rgb, width, c, x);
+}
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_avx2(const uchar *y, const uchar *u,
+                                                          const uchar *v, quint32 *rgb, int width,
+                                                          const YUVToRGBCoefficients &c)
+{
+    convertLine_avx2<1, 1>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_avx2(const uchar *y, const uchar *u,
+                                                              const uchar *v, quint32 *rgb,
+                                                              int width,
+                                                              const YUVToRGBCoefficients &c)
+{
+    convertLine_avx2<1, 2>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_avx2(const uchar *y, const uchar *u,
+                                                               const uchar *v, quint32 *rgb,
+                                                               int width,
+                                                               const YUVToRGBCoefficients &c)
+{
+    convertLine_avx2<2, 4>(y, u, v, rgb, width, c);
+}
+
 QT_END_NAMESPACE
 
 #endif
@@ -0,0 +1,137 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qvideoframeconversionhelper_p.h"
+
+#ifdef QT_COMPILER_SUPPORTS_AVX512F
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Loads 16 samples that are Step bytes apart to 32 bit lanes
+template<int Step>
+__m512i loadSamples(const uchar *src)
+{
+    if constexpr (Step == 1) {
+        return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+    } else if constexpr (Step == 2) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        return _mm512_and_si512(_mm512_cvtepu16_epi32(data), _mm512_set1_epi32(0xff));
+    } else {
+        static_assert(Step == 4);
+        return _mm512_and_si512(_mm512_loadu_si512(src), _mm512_set1_epi32(0xff));
+    }
+}
+
+struct Coefficients
+{
+    explicit Coefficients(const YUVToRGBCoefficients &c)
+        : yOffset(_mm512_set1_epi32(c.yOffset)),
+          y(_mm512_set1_epi32(c.y)),
+          rv(_mm512_set1_epi32(c.rv)),
+          gu(_mm512_set1_epi32(c.gu)),
+          gv(_mm512_set1_epi32(c.gv)),
+          bu(_mm512_set1_epi32(c.bu))
+    {
+    }
+
+    __m512i yOffset;
+    __m512i y;
+    __m512i rv;
+    __m512i gu;
+    __m512i gv;
+    __m512i bu;
+};
+
+// Same arithmetic as qYUVToARGB32, so the results are bit exact
+inline __m512i convertPixels(__m512i y, __m512i u, __m512i v, const Coefficients &c)
+{
+    const __m512i half = _mm512_set1_epi32(128);
+    const __m512i uu = _mm512_sub_epi32(u, half);
+    const __m512i vv = _mm512_sub_epi32(v, half);
+    const __m512i yy = _mm512_mullo_epi32(_mm512_sub_epi32(y, c.yOffset), c.y);
+
+    const __m512i rv = _mm512_add_epi32(_mm512_mullo_epi32(vv, c.rv), half);
+    const __m512i guv = _mm512_add_epi32(
+            _mm512_add_epi32(_mm512_mullo_epi32(uu, c.gu), _mm512_mullo_epi32(vv, c.gv)), half);
+    const __m512i bu = _mm512_add_epi32(_mm512_mullo_epi32(uu, c.bu), half);
+
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i max = _mm512_set1_epi32(255);
+    auto clamp = [&](__m512i n) {
+        return _mm512_min_epi32(_mm512_max_epi32(_mm512_srai_epi32(n, 8), zero), max);
+    };
+
+    const __m512i r = clamp(_mm512_add_epi32(yy, rv));
+    const __m512i g = clamp(_mm512_sub_epi32(yy, guv));
+    const __m512i b = clamp(_mm512_add_epi32(yy, bu));
+
+    return _mm512_or_si512(
+            _mm512_or_si512(_mm512_set1_epi32(int(0xff000000)), _mm512_slli_epi32(r, 16)),
+            _mm512_or_si512(_mm512_slli_epi32(g, 8), b));
+}
+
+template<int YStep, int UVStep>
+void convertLine_avx512(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width,
+                        const YUVToRGBCoefficients &c)
+{
+    const Coefficients coefficients(c);
+    const __m512i firstHalf = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    const __m512i secondHalf =
+            _mm512_setr_epi32(8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15);
+
+    int x = 0;
+    // The loads may touch the next pair of pixels, so it's left to the leftovers
+    for (; x + 32 + 1 < width; x += 32) {
+        const int uvOffset = x / 2 * UVStep;
+        const __m512i us = loadSamples<UVStep>(u + uvOffset);
+        const __m512i vs = loadSamples<UVStep>(v + uvOffset);
+
+        const __m512i y0 = loadSamples<YStep>(y + x * YStep);
+        const __m512i y1 = loadSamples<YStep>(y + (x + 16) * YStep);
+
+        const __m512i rgb0 = convertPixels(y0, _mm512_permutexvar_epi32(firstHalf, us),
+                                           _mm512_permutexvar_epi32(firstHalf, vs),
+                                           coefficients);
+        const __m512i rgb1 = convertPixels(y1, _mm512_permutexvar_epi32(secondHalf, us),
+                                           _mm512_permutexvar_epi32(secondHalf, vs),
+                                           coefficients);
+
+        _mm512_storeu_si512(rgb + x, rgb0);
+        _mm512_storeu_si512(rgb + x + 16, rgb1);
+    }
+
+    // leftovers
+    qt_convert_YUV_line_to_ARGB32<YStep, UVStep>(y, u, v, rgb, width, c, x);
+}
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_avx512(const uchar *y, const uchar *u,
+                                                            const uchar *v, quint32 *rgb,
+                                                            int width,
+                                                            const YUVToRGBCoefficients &c)
+{
+    convertLine_avx512<1, 1>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_avx512(const uchar *y, const uchar *u,
+                                                                const uchar *v, quint32 *rgb,
+                                                                int width,
+                                                                const YUVToRGBCoefficients &c)
+{
+    convertLine_avx512<1, 2>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_avx512(const uchar *y, const uchar *u,
+                                                                 const uchar *v, quint32 *rgb,
+                                                                 int width,
+                                                                 const YUVToRGBCoefficients &c)
+{
+    convertLine_avx512<2, 4>(y, u, v, rgb, width, c);
+}
+
+QT_END_NAMESPACE
+
+#endif
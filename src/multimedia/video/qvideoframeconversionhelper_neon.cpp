@@ -0,0 +1,158 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qvideoframeconversionhelper_p.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Loads 8 samples that are Step bytes apart
+template<int Step>
+uint8x8_t loadSamples(const uchar *src)
+{
+    if constexpr (Step == 1) {
+        return vld1_u8(src);
+    } else if constexpr (Step == 2) {
+        return vld2_u8(src).val[0];
+    } else {
+        static_assert(Step == 4);
+        return vld4_u8(src).val[0];
+    }
+}
+
+// Loads 16 samples that are Step bytes apart
+template<int Step>
+uint8x16_t loadSamplesQ(const uchar *src)
+{
+    if constexpr (Step == 1) {
+        return vld1q_u8(src);
+    } else {
+        static_assert(Step == 2);
+        return vld2q_u8(src).val[0];
+    }
+}
+
+struct Coefficients
+{
+    explicit Coefficients(const YUVToRGBCoefficients &c)
+        : yOffset(vdupq_n_s32(c.yOffset)),
+          y(vdupq_n_s32(c.y)),
+          rv(vdupq_n_s32(c.rv)),
+          gu(vdupq_n_s32(c.gu)),
+          gv(vdupq_n_s32(c.gv)),
+          bu(vdupq_n_s32(c.bu))
+    {
+    }
+
+    int32x4_t yOffset;
+    int32x4_t y;
+    int32x4_t rv;
+    int32x4_t gu;
+    int32x4_t gv;
+    int32x4_t bu;
+};
+
+inline int32x4_t toInt32(uint16x4_t v)
+{
+    return vreinterpretq_s32_u32(vmovl_u16(v));
+}
+
+// Same arithmetic as qYUVToARGB32, so the results are bit exact
+inline uint32x4_t convertPixels(int32x4_t y, int32x4_t u, int32x4_t v, const Coefficients &c)
+{
+    const int32x4_t half = vdupq_n_s32(128);
+    const int32x4_t uu = vsubq_s32(u, half);
+    const int32x4_t vv = vsubq_s32(v, half);
+    const int32x4_t yy = vmulq_s32(vsubq_s32(y, c.yOffset), c.y);
+
+    const int32x4_t rv = vmlaq_s32(half, vv, c.rv);
+    const int32x4_t guv = vmlaq_s32(vmlaq_s32(half, uu, c.gu), vv, c.gv);
+    const int32x4_t bu = vmlaq_s32(half, uu, c.bu);
+
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t max = vdupq_n_s32(255);
+    auto clamp = [&](int32x4_t n) {
+        return vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(vshrq_n_s32(n, 8), zero), max));
+    };
+
+    const uint32x4_t r = clamp(vaddq_s32(yy, rv));
+    const uint32x4_t g = clamp(vsubq_s32(yy, guv));
+    const uint32x4_t b = clamp(vaddq_s32(yy, bu));
+
+    return vorrq_u32(vorrq_u32(vdupq_n_u32(0xff000000), vshlq_n_u32(r, 16)),
+                     vorrq_u32(vshlq_n_u32(g, 8), b));
+}
+
+// Converts 8 pixels
+inline void convertPixels(uint8x8_t y, uint8x8_t u, uint8x8_t v, quint32 *rgb,
+                          const Coefficients &c)
+{
+    const uint16x8_t y16 = vmovl_u8(y);
+    const uint16x8_t u16 = vmovl_u8(u);
+    const uint16x8_t v16 = vmovl_u8(v);
+
+    vst1q_u32(rgb,
+              convertPixels(toInt32(vget_low_u16(y16)), toInt32(vget_low_u16(u16)),
+                            toInt32(vget_low_u16(v16)), c));
+    vst1q_u32(rgb + 4,
+              convertPixels(toInt32(vget_high_u16(y16)), toInt32(vget_high_u16(u16)),
+                            toInt32(vget_high_u16(v16)), c));
+}
+
+template<int YStep, int UVStep>
+void convertLine_neon(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width,
+                      const YUVToRGBCoefficients &c)
+{
+    const Coefficients coefficients(c);
+
+    int x = 0;
+    // The loads may touch the next pair of pixels, so it's left to the leftovers
+    for (; x + 16 + 1 < width; x += 16) {
+        const int uvOffset = x / 2 * UVStep;
+
+        // Each chroma sample is shared by a pair of pixels
+        const uint8x8_t u8 = loadSamples<UVStep>(u + uvOffset);
+        const uint8x8_t v8 = loadSamples<UVStep>(v + uvOffset);
+        const uint8x8x2_t us = vzip_u8(u8, u8);
+        const uint8x8x2_t vs = vzip_u8(v8, v8);
+        const uint8x16_t ys = loadSamplesQ<YStep>(y + x * YStep);
+
+        convertPixels(vget_low_u8(ys), us.val[0], vs.val[0], rgb + x, coefficients);
+        convertPixels(vget_high_u8(ys), us.val[1], vs.val[1], rgb + x + 8, coefficients);
+    }
+
+    // leftovers
+    qt_convert_YUV_line_to_ARGB32<YStep, UVStep>(y, u, v, rgb, width, c, x);
+}
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_neon(const uchar *y, const uchar *u,
+                                                          const uchar *v, quint32 *rgb, int width,
+                                                          const YUVToRGBCoefficients &c)
+{
+    convertLine_neon<1, 1>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_neon(const uchar *y, const uchar *u,
+                                                              const uchar *v, quint32 *rgb,
+                                                              int width,
+                                                              const YUVToRGBCoefficients &c)
+{
+    convertLine_neon<1, 2>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_neon(const uchar *y, const uchar *u,
+                                                               const uchar *v, quint32 *rgb,
+                                                               int width,
+                                                               const YUVToRGBCoefficients &c)
+{
+    convertLine_neon<2, 4>(y, u, v, rgb, width, c);
+}
+
+QT_END_NAMESPACE
+
+#endif
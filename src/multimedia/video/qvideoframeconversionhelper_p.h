@@ -24,7 +24,7 @@ QT_BEGIN_NAMESPACE
 typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const QVideoFrame &frame, uchar *output);
 typedef void(QT_FASTCALL *PixelsCopyFunc)(uint32_t *dst, const uint32_t *src, size_t size, uint32_t mask);
 
-VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format);
+VideoFrameConvertFunc Q_MULTIMEDIA_EXPORT qConverterForFormat(QVideoFrameFormat::PixelFormat format);
 
 void Q_MULTIMEDIA_EXPORT qCopyPixelsWithAlphaMask(uint32_t *dst,
                                                   const uint32_t *src,
@@ -36,6 +36,85 @@ void Q_MULTIMEDIA_EXPORT qCopyPixelsWithMask(uint32_t *dst, const uint32_t *src,
 
 uint32_t Q_MULTIMEDIA_EXPORT qAlphaMask(QVideoFrameFormat::PixelFormat format);
 
+// Fixed point coefficients of the YUV to RGB conversion, with 8 fractional bits
+struct YUVToRGBCoefficients
+{
+    int yOffset = 16;
+    int y = 298;
+    int rv = 409;
+    int gu = 100;
+    int gv = 208;
+    int bu = 516;
+};
+
+// The color space assumed for the format, the same as QVideoTextureHelper's
+// choice for frames with undefined color space
+QVideoFrameFormat::ColorSpace qEffectiveColorSpace(const QVideoFrameFormat &format);
+
+// Honors the color space and the color range of the format
+YUVToRGBCoefficients Q_MULTIMEDIA_EXPORT qYUVToRGBCoefficients(const QVideoFrameFormat &format);
+
+// Layouts of the lines of YUV formats with horizontally subsampled chroma
+enum class YUVLineLayout {
+    Planar, // YUV420P, YUV422P, YV12, IMC1-4
+    SemiPlanar, // NV12, NV21; the chroma samples are 2 bytes apart
+    Interleaved, // UYVY, YUYV and high bytes of P010, P016; luma samples are 2 bytes apart,
+                 // chroma samples are 4 bytes apart
+    Count
+};
+
+// Converts a line of YUV samples to ARGB32; each pair of pixels shares the chroma samples.
+// The last pixel of an odd width is left untouched.
+typedef void(QT_FASTCALL *YUVLineConvertFunc)(const uchar *y, const uchar *u, const uchar *v,
+                                               quint32 *rgb, int width,
+                                               const YUVToRGBCoefficients &coefficients);
+
+YUVLineConvertFunc Q_MULTIMEDIA_EXPORT qYUVLineConverter(YUVLineLayout layout);
+
+inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, const YUVToRGBCoefficients &c,
+                            int a = 0xff)
+{
+    const int yy = (y - c.yOffset) * c.y;
+    const auto clamp = [](int n) { return n > 255 ? 255 : (n < 0 ? 0 : n); };
+    return (a << 24)
+            | clamp((yy + rv) >> 8) << 16
+            | clamp((yy - guv) >> 8) << 8
+            | clamp((yy + bu) >> 8);
+}
+
+inline quint32 qYUVToARGB32(int y, int u, int v, const YUVToRGBCoefficients &c, int a = 0xff)
+{
+    const int uu = u - 128;
+    const int vv = v - 128;
+    return qYUVToARGB32(y, c.rv * vv + 128, c.gu * uu + c.gv * vv + 128, c.bu * uu + 128, c, a);
+}
+
+// The scalar reference of the line conversion; the vectorized versions
+// use it for the leftovers starting from the even pixel 'from'.
+template<int YStep, int UVStep>
+inline void qt_convert_YUV_line_to_ARGB32(const uchar *y, const uchar *u, const uchar *v,
+                                          quint32 *rgb, int width,
+                                          const YUVToRGBCoefficients &c, int from = 0)
+{
+    y += from * YStep;
+    u += from / 2 * UVStep;
+    v += from / 2 * UVStep;
+
+    for (int i = from; i + 1 < width; i += 2) {
+        const int uu = *u - 128;
+        const int vv = *v - 128;
+        const int rv = c.rv * vv + 128;
+        const int guv = c.gu * uu + c.gv * vv + 128;
+        const int bu = c.bu * uu + 128;
+        u += UVStep;
+        v += UVStep;
+
+        rgb[i] = qYUVToARGB32(*y, rv, guv, bu, c);
+        rgb[i + 1] = qYUVToARGB32(y[YStep], rv, guv, bu, c);
+        y += YStep * 2;
+    }
+}
+
 template<int a, int r, int g, int b>
 struct ArgbPixel
 {
@@ -0,0 +1,135 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qvideoframeconversionhelper_p.h"
+
+#ifdef QT_COMPILER_SUPPORTS_SSE4_1
+
+#include <QtCore/qendian.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Loads 4 samples that are Step bytes apart to 32 bit lanes
+template<int Step>
+__m128i loadSamples(const uchar *src)
+{
+    if constexpr (Step == 1) {
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(qFromUnaligned<int>(src)));
+    } else if constexpr (Step == 2) {
+        const __m128i data = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src));
+        return _mm_and_si128(_mm_cvtepu16_epi32(data), _mm_set1_epi32(0xff));
+    } else {
+        static_assert(Step == 4);
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        return _mm_and_si128(data, _mm_set1_epi32(0xff));
+    }
+}
+
+struct Coefficients
+{
+    explicit Coefficients(const YUVToRGBCoefficients &c)
+        : yOffset(_mm_set1_epi32(c.yOffset)),
+          y(_mm_set1_epi32(c.y)),
+          rv(_mm_set1_epi32(c.rv)),
+          gu(_mm_set1_epi32(c.gu)),
+          gv(_mm_set1_epi32(c.gv)),
+          bu(_mm_set1_epi32(c.bu))
+    {
+    }
+
+    __m128i yOffset;
+    __m128i y;
+    __m128i rv;
+    __m128i gu;
+    __m128i gv;
+    __m128i bu;
+};
+
+// Same arithmetic as qYUVToARGB32, so the results are bit exact
+inline __m128i convertPixels(__m128i y, __m128i u, __m128i v, const Coefficients &c)
+{
+    const __m128i half = _mm_set1_epi32(128);
+    const __m128i uu = _mm_sub_epi32(u, half);
+    const __m128i vv = _mm_sub_epi32(v, half);
+    const __m128i yy = _mm_mullo_epi32(_mm_sub_epi32(y, c.yOffset), c.y);
+
+    const __m128i rv = _mm_add_epi32(_mm_mullo_epi32(vv, c.rv), half);
+    const __m128i guv = _mm_add_epi32(
+            _mm_add_epi32(_mm_mullo_epi32(uu, c.gu), _mm_mullo_epi32(vv, c.gv)), half);
+    const __m128i bu = _mm_add_epi32(_mm_mullo_epi32(uu, c.bu), half);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi32(255);
+    auto clamp = [&](__m128i n) {
+        return _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(n, 8), zero), max);
+    };
+
+    const __m128i r = clamp(_mm_add_epi32(yy, rv));
+    const __m128i g = clamp(_mm_sub_epi32(yy, guv));
+    const __m128i b = clamp(_mm_add_epi32(yy, bu));
+
+    return _mm_or_si128(_mm_or_si128(_mm_set1_epi32(int(0xff000000)), _mm_slli_epi32(r, 16)),
+                        _mm_or_si128(_mm_slli_epi32(g, 8), b));
+}
+
+template<int YStep, int UVStep>
+void convertLine_sse4(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb, int width,
+                      const YUVToRGBCoefficients &c)
+{
+    const Coefficients coefficients(c);
+
+    int x = 0;
+    // The loads may touch the next pair of pixels, so it's left to the leftovers
+    for (; x + 8 + 1 < width; x += 8) {
+        const int uvOffset = x / 2 * UVStep;
+        const __m128i us = loadSamples<UVStep>(u + uvOffset);
+        const __m128i vs = loadSamples<UVStep>(v + uvOffset);
+
+        const __m128i y0 = loadSamples<YStep>(y + x * YStep);
+        const __m128i y1 = loadSamples<YStep>(y + (x + 4) * YStep);
+
+        const __m128i rgb0 = convertPixels(y0, _mm_shuffle_epi32(us, _MM_SHUFFLE(1, 1, 0, 0)),
+                                           _mm_shuffle_epi32(vs, _MM_SHUFFLE(1, 1, 0, 0)),
+                                           coefficients);
+        const __m128i rgb1 = convertPixels(y1, _mm_shuffle_epi32(us, _MM_SHUFFLE(3, 3, 2, 2)),
+                                           _mm_shuffle_epi32(vs, _MM_SHUFFLE(3, 3, 2, 2)),
+                                           coefficients);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + x), rgb0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + x + 4), rgb1);
+    }
+
+    // leftovers
+    qt_convert_YUV_line_to_ARGB32<YStep, UVStep>(y, u, v, rgb, width, c, x);
+}
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV_planar_line_to_ARGB32_sse4(const uchar *y, const uchar *u,
+                                                          const uchar *v, quint32 *rgb, int width,
+                                                          const YUVToRGBCoefficients &c)
+{
+    convertLine_sse4<1, 1>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_semiplanar_line_to_ARGB32_sse4(const uchar *y, const uchar *u,
+                                                              const uchar *v, quint32 *rgb,
+                                                              int width,
+                                                              const YUVToRGBCoefficients &c)
+{
+    convertLine_sse4<1, 2>(y, u, v, rgb, width, c);
+}
+
+void QT_FASTCALL qt_convert_YUV_interleaved_line_to_ARGB32_sse4(const uchar *y, const uchar *u,
+                                                               const uchar *v, quint32 *rgb,
+                                                               int width,
+                                                               const YUVToRGBCoefficients &c)
+{
+    convertLine_sse4<2, 4>(y, u, v, rgb, width, c);
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -11,8 +11,13 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qsize.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qpromise.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qthreadstorage.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qsemaphore.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qoffscreensurface.h>
 #include <qpa/qplatformintegration.h>
@@ -20,6 +25,14 @@
 #include <private/qguiapplication_p.h>
 #include <rhi/qrhi.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+
 #ifdef Q_OS_DARWIN
 #include <QtCore/private/qcore_mac_p.h>
 #endif
@@ -30,6 +43,54 @@ Q_STATIC_LOGGING_CATEGORY(qLcVideoFrameConverter, "qt.multimedia.video.frameconv
 
 namespace {
 
+// The RHI objects of the GPU conversion on a QRhi; they're kept between the conversions
+// on a thread, so that repeated conversions only upload the frame textures and draw.
+struct ConversionResources
+{
+    struct Target
+    {
+        std::unique_ptr<QRhiTexture> texture;
+        std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
+    };
+
+    struct Pipeline
+    {
+        std::unique_ptr<QRhiShaderResourceBindings> bindings;
+        std::unique_ptr<QRhiGraphicsPipeline> pipeline;
+    };
+
+    // Bilinear sampling averages 2x2 pixels at most, so stronger downscales convert the frame
+    // at a multiple of the target size and halve the image pass by pass, see downsampleLevels()
+    struct DownsampleChain
+    {
+        struct Pass
+        {
+            Target source; // the image of the previous pass
+            std::unique_ptr<QRhiBuffer> vertexBuffer;
+            std::unique_ptr<QRhiBuffer> uniformBuffer;
+            std::unique_ptr<QRhiShaderResourceBindings> bindings;
+        };
+
+        std::vector<QSize> levels; // the sizes of the sources of the passes
+        std::vector<Pass> passes;
+        std::unique_ptr<QRhiGraphicsPipeline> pipeline;
+    };
+
+    using PipelineKey = std::pair<QVideoFrameFormat::PixelFormat, QVideoFrameFormat::ColorTransfer>;
+    using TargetKey = std::pair<int, int>;
+
+    explicit ConversionResources(QRhi *rhi) : rhi(rhi) { }
+
+    QRhi *rhi = nullptr;
+    std::unique_ptr<QRhiBuffer> vertexBuffer;
+    std::unique_ptr<QRhiBuffer> uniformBuffer;
+    std::unique_ptr<QRhiSampler> textureSampler;
+    std::unique_ptr<QRhiRenderPassDescriptor> renderPass;
+    std::map<PipelineKey, Pipeline> pipelines;
+    std::map<TargetKey, Target> targets;
+    std::unique_ptr<DownsampleChain> downsampleChain;
+};
+
 struct State
 {
     QRhi *rhi = nullptr;
@@ -40,11 +101,22 @@ struct State
 #if defined(Q_OS_ANDROID)
     QMetaObject::Connection appStateChangedConnection;
 #endif
+    // The resources of the recently used QRhis, the most recent first.
+    // Shared, as QThreadStorage copies the state.
+    std::vector<std::shared_ptr<ConversionResources>> resources;
+
     ~State() {
         resetRhi();
     }
 
+    void resetResources() {
+        for (const auto &entry : resources)
+            entry->rhi->removeCleanupCallback(this);
+        resources.clear();
+    }
+
     void resetRhi() {
+        resetResources();
         delete rhi;
         rhi = nullptr;
 #if QT_CONFIG(opengl)
@@ -116,6 +188,20 @@ static QShader vfcGetShader(const QString &name)
     return shader;
 }
 
+// Crops the texture coordinates of the quad of the rotation to the normalized source rect
+static std::array<float, 16> conversionQuad(int rotationIndex, const QRectF &textureRect)
+{
+    const float *rotationQuad = g_quad + 16 * rotationIndex;
+    std::array<float, 16> quad;
+    for (int i = 0; i < 16; i += 4) {
+        quad[i] = rotationQuad[i];
+        quad[i + 1] = rotationQuad[i + 1];
+        quad[i + 2] = textureRect.x() + rotationQuad[i + 2] * textureRect.width();
+        quad[i + 3] = textureRect.y() + rotationQuad[i + 3] * textureRect.height();
+    }
+    return quad;
+}
+
 static void rasterTransform(QImage &image, NormalizedFrameTransformation transformation)
 {
     QTransform t;
@@ -191,64 +277,256 @@ static QRhi *initializeRHI(QRhi *videoFrameRhi)
     return g_state.localData().rhi;
 }
 
-static bool updateTextures(QRhi *rhi,
-                           std::unique_ptr<QRhiBuffer> &uniformBuffer,
-                           std::unique_ptr<QRhiSampler> &textureSampler,
-                           std::unique_ptr<QRhiShaderResourceBindings> &shaderResourceBindings,
-                           std::unique_ptr<QRhiGraphicsPipeline> &graphicsPipeline,
-                           std::unique_ptr<QRhiRenderPassDescriptor> &renderPass,
-                           QVideoFrame &frame,
-                           const std::unique_ptr<QVideoFrameTextures> &videoFrameTextures)
+// Frames of more sizes than that at a time are unlikely, e.g. with thumbnails of various videos
+static constexpr size_t MaxCachedConversionTargets = 4;
+
+// Frames of a few QRhis may come alternately, e.g. from the windows of several video sinks
+static constexpr size_t MaxCachedConversionRhis = 4;
+
+static ConversionResources *conversionResources(QRhi *rhi)
 {
-    auto format = frame.surfaceFormat();
-    auto pixelFormat = format.pixelFormat();
+    State &state = g_state.localData();
+    auto &cache = state.resources;
+
+    auto it = std::find_if(cache.begin(), cache.end(),
+                           [rhi](const auto &entry) { return entry->rhi == rhi; });
+    if (it != cache.end()) {
+        std::rotate(cache.begin(), it, std::next(it));
+        return cache.front().get();
+    }
+
+    if (cache.size() >= MaxCachedConversionRhis) {
+        cache.back()->rhi->removeCleanupCallback(&state);
+        cache.pop_back();
+    }
+
+    auto resources = std::make_shared<ConversionResources>(rhi);
+
+    resources->vertexBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer, 16 * sizeof(float)));
+    resources->uniformBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer,
+                                                  sizeof(QVideoTextureHelper::UniformData)));
+    resources->textureSampler.reset(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                                    QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
+
+    if (!resources->vertexBuffer->create() || !resources->uniformBuffer->create()
+        || !resources->textureSampler->create())
+        return nullptr;
+
+    // The rhi of the frame's textures belongs to whoever renders them, e.g. the window of
+    // a video sink, and may be destroyed before the thread's state. The thread's own rhi
+    // drops the resources in resetRhi() instead.
+    rhi->addCleanupCallback(&state, [&state](QRhi *rhi) {
+        auto &cache = state.resources;
+        cache.erase(std::remove_if(cache.begin(), cache.end(),
+                                   [rhi](const auto &entry) { return entry->rhi == rhi; }),
+                    cache.end());
+    });
+
+    cache.insert(cache.begin(), std::move(resources));
+    return cache.front().get();
+}
+
+static bool createTarget(ConversionResources &resources, QSize size,
+                         ConversionResources::Target &target)
+{
+    QRhi *rhi = resources.rhi;
+
+    target.texture.reset(rhi->newTexture(QRhiTexture::RGBA8, size, 1, QRhiTexture::RenderTarget));
+    if (!target.texture->create())
+        return false;
+
+    target.renderTarget.reset(rhi->newTextureRenderTarget({ { target.texture.get() } }));
+
+    // All the targets have the same format, so they share the render pass
+    if (!resources.renderPass)
+        resources.renderPass.reset(target.renderTarget->newCompatibleRenderPassDescriptor());
+
+    target.renderTarget->setRenderPassDescriptor(resources.renderPass.get());
+    return target.renderTarget->create();
+}
+
+static ConversionResources::Target *conversionTarget(ConversionResources &resources, QSize size)
+{
+    const ConversionResources::TargetKey key{ size.width(), size.height() };
+
+    auto it = resources.targets.find(key);
+    if (it != resources.targets.end())
+        return &it->second;
+
+    if (resources.targets.size() >= MaxCachedConversionTargets)
+        resources.targets.clear();
+
+    ConversionResources::Target target;
+    if (!createTarget(resources, size, target))
+        return nullptr;
+
+    return &resources.targets.emplace(key, std::move(target)).first->second;
+}
+
+// The sizes to convert the source at and to halve down to the target size, the largest first.
+// Empty if the source is at most twice as large as the target.
+static std::vector<QSize> downsampleLevels(QSize sourceSize, QSize targetSize)
+{
+    std::vector<QSize> levels;
+    QSize level = targetSize;
+    while (level.width() * 2 < sourceSize.width() || level.height() * 2 < sourceSize.height()) {
+        if (level.width() * 2 < sourceSize.width())
+            level.rwidth() *= 2;
+        if (level.height() * 2 < sourceSize.height())
+            level.rheight() *= 2;
+        levels.insert(levels.begin(), level);
+    }
+    return levels;
+}
+
+static QRhiVertexInputLayout conversionInputLayout()
+{
+    QRhiVertexInputLayout inputLayout;
+    inputLayout.setBindings({
+        { 4 * sizeof(float) }
+    });
+    inputLayout.setAttributes({
+        { 0, 0, QRhiVertexInputAttribute::Float2, 0 },
+        { 0, 1, QRhiVertexInputAttribute::Float2, 2 * sizeof(float) }
+    });
+    return inputLayout;
+}
+
+// The chain is kept for the last levels only; repeated conversions usually have the same sizes
+static ConversionResources::DownsampleChain *
+downsampleChain(ConversionResources &resources, const std::vector<QSize> &levels)
+{
+    auto &chain = resources.downsampleChain;
+    if (chain && chain->levels == levels)
+        return chain.get();
+
+    chain.reset();
+
+    // The passes sample the RGBA images of the previous passes
+    const QVideoFrameFormat imageFormat(levels.front(), QVideoFrameFormat::Format_RGBA8888);
+    QShader vs = vfcGetShader(QVideoTextureHelper::vertexShaderFileName(imageFormat));
+    if (!vs.isValid())
+        return nullptr;
 
-    auto textureDesc = QVideoTextureHelper::textureDescription(pixelFormat);
+    QShader fs = vfcGetShader(QVideoTextureHelper::fragmentShaderFileName(imageFormat));
+    if (!fs.isValid())
+        return nullptr;
+
+    QRhi *rhi = resources.rhi;
+    auto newChain = std::make_unique<ConversionResources::DownsampleChain>();
+    newChain->levels = levels;
+
+    for (QSize level : levels) {
+        ConversionResources::DownsampleChain::Pass pass;
+        if (!createTarget(resources, level, pass.source))
+            return nullptr;
+
+        pass.vertexBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer,
+                                               16 * sizeof(float)));
+        pass.uniformBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer,
+                                                sizeof(QVideoTextureHelper::UniformData)));
+        if (!pass.vertexBuffer->create() || !pass.uniformBuffer->create())
+            return nullptr;
+
+        const auto uniformStages =
+                QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage;
+        pass.bindings.reset(rhi->newShaderResourceBindings());
+        pass.bindings->setBindings({
+            QRhiShaderResourceBinding::uniformBuffer(0, uniformStages, pass.uniformBuffer.get()),
+            QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage,
+                                                      pass.source.texture.get(),
+                                                      resources.textureSampler.get())
+        });
+        if (!pass.bindings->create())
+            return nullptr;
+
+        newChain->passes.push_back(std::move(pass));
+    }
+
+    // The bindings of all the passes have the same layout, so they share the pipeline
+    newChain->pipeline.reset(rhi->newGraphicsPipeline());
+    newChain->pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    newChain->pipeline->setShaderStages({
+        { QRhiShaderStage::Vertex, vs },
+        { QRhiShaderStage::Fragment, fs }
+    });
+    newChain->pipeline->setVertexInputLayout(conversionInputLayout());
+    newChain->pipeline->setShaderResourceBindings(newChain->passes.front().bindings.get());
+    newChain->pipeline->setRenderPassDescriptor(resources.renderPass.get());
+    if (!newChain->pipeline->create())
+        return nullptr;
+
+    chain = std::move(newChain);
+    return chain.get();
+}
+
+static void setBindings(QRhiShaderResourceBindings &shaderResourceBindings,
+                        const ConversionResources &resources, const QVideoFrame &frame,
+                        const QVideoFrameTextures &videoFrameTextures)
+{
+    auto textureDesc = QVideoTextureHelper::textureDescription(frame.pixelFormat());
 
     QRhiShaderResourceBinding bindings[4];
     auto *b = bindings;
     *b++ = QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage,
-                                                    uniformBuffer.get());
+                                                    resources.uniformBuffer.get());
     for (int i = 0; i < textureDesc->nplanes; ++i)
         *b++ = QRhiShaderResourceBinding::sampledTexture(i + 1, QRhiShaderResourceBinding::FragmentStage,
-                                                         videoFrameTextures->texture(i), textureSampler.get());
-    shaderResourceBindings->setBindings(bindings, b);
-    shaderResourceBindings->create();
+                                                         videoFrameTextures.texture(i), resources.textureSampler.get());
+    shaderResourceBindings.setBindings(bindings, b);
+}
+
+// The pipelines differ in the shaders, which depend on the pixel format and the color transfer.
+// The cached shader resource bindings get the textures of each frame. The layout stays
+// the same, so they're updated in place rather than recreated under the created pipeline.
+static ConversionResources::Pipeline *
+conversionPipeline(ConversionResources &resources, const QVideoFrame &frame,
+                   const QVideoFrameTextures &videoFrameTextures)
+{
+    auto format = frame.surfaceFormat();
+    const ConversionResources::PipelineKey key{ format.pixelFormat(), format.colorTransfer() };
 
-    graphicsPipeline.reset(rhi->newGraphicsPipeline());
-    graphicsPipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    auto it = resources.pipelines.find(key);
+    if (it != resources.pipelines.end()) {
+        setBindings(*it->second.bindings, resources, frame, videoFrameTextures);
+        it->second.bindings->updateResources();
+        return &it->second;
+    }
 
     QShader vs = vfcGetShader(QVideoTextureHelper::vertexShaderFileName(format));
     if (!vs.isValid())
-        return false;
+        return nullptr;
 
     QShader fs = vfcGetShader(QVideoTextureHelper::fragmentShaderFileName(format));
     if (!fs.isValid())
-        return false;
+        return nullptr;
 
-    graphicsPipeline->setShaderStages({
+    QRhi *rhi = resources.rhi;
+    ConversionResources::Pipeline pipeline;
+
+    pipeline.bindings.reset(rhi->newShaderResourceBindings());
+    setBindings(*pipeline.bindings, resources, frame, videoFrameTextures);
+    if (!pipeline.bindings->create())
+        return nullptr;
+
+    pipeline.pipeline.reset(rhi->newGraphicsPipeline());
+    pipeline.pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+
+    pipeline.pipeline->setShaderStages({
         { QRhiShaderStage::Vertex, vs },
         { QRhiShaderStage::Fragment, fs }
     });
 
-    QRhiVertexInputLayout inputLayout;
-    inputLayout.setBindings({
-        { 4 * sizeof(float) }
-    });
-    inputLayout.setAttributes({
-        { 0, 0, QRhiVertexInputAttribute::Float2, 0 },
-        { 0, 1, QRhiVertexInputAttribute::Float2, 2 * sizeof(float) }
-    });
+    pipeline.pipeline->setVertexInputLayout(conversionInputLayout());
+    pipeline.pipeline->setShaderResourceBindings(pipeline.bindings.get());
+    pipeline.pipeline->setRenderPassDescriptor(resources.renderPass.get());
+    if (!pipeline.pipeline->create())
+        return nullptr;
 
-    graphicsPipeline->setVertexInputLayout(inputLayout);
-    graphicsPipeline->setShaderResourceBindings(shaderResourceBindings.get());
-    graphicsPipeline->setRenderPassDescriptor(renderPass.get());
-    graphicsPipeline->create();
-
-    return true;
+    return &resources.pipelines.emplace(key, std::move(pipeline)).first->second;
 }
 
-static QImage convertJPEG(const QVideoFrame &frame)
+static QImage convertJPEG(const QVideoFrame &frame, const QRect &sourceRect, QSize scaledSize)
 {
     QVideoFrame varFrame = frame;
     if (!varFrame.map(QVideoFrame::ReadOnly)) {
@@ -258,11 +536,188 @@ static QImage convertJPEG(const QVideoFrame &frame)
     QImage image;
     image.loadFromData(varFrame.bits(0), varFrame.mappedBytes(0), "JPG");
     varFrame.unmap();
+    if (sourceRect != image.rect())
+        image = image.copy(sourceRect);
+    if (image.size() != scaledSize)
+        image = image.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
     rasterTransform(image, qNormalizedFrameTransformation(frame));
     return image;
 }
 
-static QImage convertCPU(const QVideoFrame &frame)
+namespace {
+
+// Exposes a band of rows of a mapped frame as a frame of its own,
+// so that the converters can process the bands independently.
+class FrameBandBuffer : public QAbstractVideoBuffer
+{
+public:
+    FrameBandBuffer(const QVideoFrame &mappedFrame, int firstRow, int rowCount)
+        : m_format(mappedFrame.surfaceFormat())
+    {
+        // The color space of undefined ones depends on the frame height
+        m_format.setColorSpace(qEffectiveColorSpace(m_format));
+        m_format.setFrameSize(mappedFrame.width(), rowCount);
+
+        const auto *description = QVideoTextureHelper::textureDescription(m_format.pixelFormat());
+
+        m_mapData.planeCount = mappedFrame.planeCount();
+        for (int plane = 0; plane < m_mapData.planeCount; ++plane) {
+            const int bytesPerLine = mappedFrame.bytesPerLine(plane);
+            const int offset = firstRow / description->sizeScale[plane].y * bytesPerLine;
+            m_mapData.bytesPerLine[plane] = bytesPerLine;
+            // The frame is mapped read-only, and so is the band
+            m_mapData.data[plane] = const_cast<uchar *>(mappedFrame.bits(plane)) + offset;
+            m_mapData.dataSize[plane] = mappedFrame.mappedBytes(plane) - offset;
+        }
+    }
+
+    MapData map(QVideoFrame::MapMode) override { return m_mapData; }
+
+    QVideoFrameFormat format() const override { return m_format; }
+
+private:
+    QVideoFrameFormat m_format;
+    MapData m_mapData;
+};
+
+// Shared with the conversion tasks, which may start after the conversion is done
+struct ParallelConversion
+{
+    const QVideoFrame *frame = nullptr;
+    VideoFrameConvertFunc convert = nullptr;
+    uchar *output = nullptr;
+    int outputBytesPerLine = 0;
+    int rowsPerBand = 0;
+    int bandCount = 0;
+
+    std::atomic_int nextBand = 0;
+    QSemaphore convertedBands;
+
+    void convertBands()
+    {
+        for (int band = nextBand++; band < bandCount; band = nextBand++) {
+            const int firstRow = band * rowsPerBand;
+            const int rowCount = std::min(rowsPerBand, frame->height() - firstRow);
+
+            QVideoFrame bandFrame(std::make_unique<FrameBandBuffer>(*frame, firstRow, rowCount));
+            if (bandFrame.map(QVideoFrame::ReadOnly)) {
+                convert(bandFrame, output + firstRow * outputBytesPerLine);
+                bandFrame.unmap();
+            }
+
+            convertedBands.release();
+        }
+    }
+};
+
+// Converts the rows of a mapped frame on demand. The rows are converted in pairs,
+// as vertically subsampled formats need, and the last two pairs are kept.
+class FrameRowConverter
+{
+public:
+    FrameRowConverter(const QVideoFrame &mappedFrame, VideoFrameConvertFunc convert,
+                      QImage::Format format)
+        : m_frame(mappedFrame), m_convert(convert)
+    {
+        for (Band &band : m_bands)
+            band.image = QImage(mappedFrame.width(), 2, format);
+    }
+
+    const quint32 *row(int y)
+    {
+        const int firstRow = y & ~1;
+        Band &band = m_bands[(firstRow / 2) % 2];
+        if (band.firstRow != firstRow) {
+            const int rowCount = std::min(2, m_frame.height() - firstRow);
+            QVideoFrame bandFrame(std::make_unique<FrameBandBuffer>(m_frame, firstRow, rowCount));
+            if (bandFrame.map(QVideoFrame::ReadOnly)) {
+                m_convert(bandFrame, band.image.bits());
+                bandFrame.unmap();
+            }
+            band.firstRow = firstRow;
+        }
+        return reinterpret_cast<const quint32 *>(band.image.constScanLine(y - firstRow));
+    }
+
+private:
+    struct Band
+    {
+        QImage image;
+        int firstRow = -1;
+    };
+
+    const QVideoFrame &m_frame;
+    VideoFrameConvertFunc m_convert;
+    Band m_bands[2];
+};
+
+// The weights of the source pixels on an axis, which sum up to WeightOne for each
+// target pixel. Downscaling averages the source pixels covered by the target pixel, so that
+// strong downscales don't alias; upscaling interpolates the two nearest source pixels.
+struct ScaleFilter
+{
+    static constexpr int WeightBits = 12;
+    static constexpr int WeightOne = 1 << WeightBits;
+
+    struct Taps
+    {
+        int first = 0; // the first source pixel
+        int count = 0;
+        int weightsOffset = 0;
+    };
+
+    ScaleFilter(int sourceStart, int sourceLength, int targetLength);
+
+    std::vector<Taps> taps;
+    std::vector<int> weights;
+};
+
+}
+
+// Frames smaller than that are converted faster than the threads are woken up
+static constexpr qint64 MinParallelConversionArea = 1280 * 720;
+
+// Each band should take long enough to pay off scheduling a task for it
+static constexpr qint64 MinConversionBandArea = 640 * 360;
+
+Q_GLOBAL_STATIC(QThreadPool, g_conversionThreadPool)
+
+static int conversionBandCount(const QVideoFrame &frame, int maxThreadCount)
+{
+    const qint64 area = qint64(frame.width()) * frame.height();
+    if (area < MinParallelConversionArea)
+        return 1;
+
+    if (maxThreadCount <= 0)
+        maxThreadCount = QThread::idealThreadCount();
+
+    return qBound(1, int(area / MinConversionBandArea), maxThreadCount);
+}
+
+static void convertInBands(const QVideoFrame &mappedFrame, VideoFrameConvertFunc convert,
+                           QImage &image, int bandCount)
+{
+    // Vertically subsampled planes need bands of even rows
+    const int rowsPerBand = ((mappedFrame.height() + bandCount - 1) / bandCount + 1) & ~1;
+
+    auto conversion = std::make_shared<ParallelConversion>();
+    conversion->frame = &mappedFrame;
+    conversion->convert = convert;
+    conversion->output = image.bits();
+    conversion->outputBytesPerLine = image.bytesPerLine();
+    conversion->rowsPerBand = rowsPerBand;
+    conversion->bandCount = (mappedFrame.height() + rowsPerBand - 1) / rowsPerBand;
+
+    // The calling thread converts bands as well, and takes over the bands of the
+    // tasks that haven't started yet, so a busy pool can't stall the conversion.
+    for (int i = 1; i < conversion->bandCount; ++i)
+        g_conversionThreadPool->start([conversion] { conversion->convertBands(); });
+
+    conversion->convertBands();
+    conversion->convertedBands.acquire(conversion->bandCount);
+}
+
+static QImage convertCPU(const QVideoFrame &frame, int maxThreadCount = 0)
 {
     VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
     if (!convert) {
@@ -276,14 +731,150 @@ static QImage convertCPU(const QVideoFrame &frame)
         }
         auto format = pixelFormatHasAlpha(varFrame.pixelFormat()) ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
         QImage image = QImage(varFrame.width(), varFrame.height(), format);
-        convert(varFrame, image.bits());
+
+        const int bandCount = conversionBandCount(varFrame, maxThreadCount);
+        if (bandCount > 1)
+            convertInBands(varFrame, convert, image, bandCount);
+        else
+            convert(varFrame, image.bits());
+
         varFrame.unmap();
         rasterTransform(image, qNormalizedFrameTransformation(frame));
         return image;
     }
 }
 
-QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
+ScaleFilter::ScaleFilter(int sourceStart, int sourceLength, int targetLength)
+    : taps(targetLength)
+{
+    const qreal scale = qreal(sourceLength) / targetLength;
+    const int end = sourceStart + sourceLength;
+
+    for (int i = 0; i < targetLength; ++i) {
+        Taps &pixel = taps[i];
+        pixel.weightsOffset = int(weights.size());
+
+        if (scale <= 1.) {
+            const qreal position = sourceStart + (i + 0.5) * scale - 0.5;
+            pixel.first = qBound(sourceStart, qFloor(position), end - 1);
+            const int weight =
+                    qBound(0, qRound((position - pixel.first) * WeightOne), WeightOne);
+            pixel.count = pixel.first + 1 < end ? 2 : 1;
+            weights.push_back(pixel.count == 2 ? WeightOne - weight : WeightOne);
+            if (pixel.count == 2)
+                weights.push_back(weight);
+            continue;
+        }
+
+        // The box of the target pixel in the source pixels
+        const qreal boxStart = sourceStart + i * scale;
+        const qreal boxEnd = boxStart + scale;
+        pixel.first = qFloor(boxStart);
+        pixel.count = std::min(qCeil(boxEnd), end) - pixel.first;
+
+        int sum = 0;
+        int largest = pixel.weightsOffset;
+        for (int j = pixel.first; j < pixel.first + pixel.count; ++j) {
+            const qreal coverage = std::min<qreal>(boxEnd, j + 1) - std::max<qreal>(boxStart, j);
+            const int weight = qRound(coverage / scale * WeightOne);
+            weights.push_back(weight);
+            sum += weight;
+            if (weight > weights[largest])
+                largest = int(weights.size()) - 1;
+        }
+
+        // Keep the brightness exact despite the rounding
+        weights[largest] += WeightOne - sum;
+    }
+}
+
+// Filters a row of ARGB32 pixels horizontally; the channels of the output pixels
+// have 8 fractional bits.
+static void filterRow(const quint32 *row, const ScaleFilter &filter, quint32 *output)
+{
+    constexpr int Shift = ScaleFilter::WeightBits - 8;
+    constexpr quint32 Rounding = 1 << (Shift - 1);
+
+    for (const ScaleFilter::Taps &pixel : filter.taps) {
+        const int *weight = filter.weights.data() + pixel.weightsOffset;
+        const quint32 *source = row + pixel.first;
+        quint32 a = 0, r = 0, g = 0, b = 0;
+        for (int i = 0; i < pixel.count; ++i, ++weight, ++source) {
+            a += qAlpha(*source) * *weight;
+            r += qRed(*source) * *weight;
+            g += qGreen(*source) * *weight;
+            b += qBlue(*source) * *weight;
+        }
+        *output++ = (a + Rounding) >> Shift;
+        *output++ = (r + Rounding) >> Shift;
+        *output++ = (g + Rounding) >> Shift;
+        *output++ = (b + Rounding) >> Shift;
+    }
+}
+
+// Converts the source rect of the frame and scales it to the scaled size in one pass,
+// with a separable filter, see ScaleFilter. Only the rows being sampled are converted.
+static QImage convertCPU(const QVideoFrame &frame, const QRect &sourceRect, QSize scaledSize)
+{
+    if (sourceRect == QRect(QPoint(), frame.size()) && scaledSize == frame.size())
+        return convertCPU(frame);
+
+    VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
+    if (!convert) {
+        qCDebug(qLcVideoFrameConverter) << Q_FUNC_INFO << ": unsupported pixel format" << frame.pixelFormat();
+        return {};
+    }
+
+    QVideoFrame varFrame = frame;
+    if (!varFrame.map(QVideoFrame::ReadOnly)) {
+        qCDebug(qLcVideoFrameConverter) << Q_FUNC_INFO << ": frame mapping failed";
+        return {};
+    }
+
+    auto format = pixelFormatHasAlpha(varFrame.pixelFormat()) ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    QImage image = QImage(scaledSize, format);
+
+    FrameRowConverter rows(varFrame, convert, format);
+    const ScaleFilter columns(sourceRect.x(), sourceRect.width(), scaledSize.width());
+    const ScaleFilter lines(sourceRect.y(), sourceRect.height(), scaledSize.height());
+
+    // 4 channels per pixel: the filtered row and the sums of the filtered rows
+    std::vector<quint32> filteredRow(scaledSize.width() * 4);
+    std::vector<quint32> sums(scaledSize.width() * 4);
+
+    // The sums have 8 + WeightBits fractional bits
+    constexpr int Shift = 8 + ScaleFilter::WeightBits;
+    constexpr quint32 Rounding = 1 << (Shift - 1);
+
+    for (int y = 0; y < scaledSize.height(); ++y) {
+        const ScaleFilter::Taps &line = lines.taps[y];
+        std::fill(sums.begin(), sums.end(), 0);
+
+        // The rows are requested in ascending order, the boundary row of the previous
+        // target row first, so the kept pairs of rows are reused
+        for (int i = 0; i < line.count; ++i) {
+            filterRow(rows.row(line.first + i), columns, filteredRow.data());
+            const quint32 weight = lines.weights[line.weightsOffset + i];
+            for (size_t j = 0; j < sums.size(); ++j)
+                sums[j] += filteredRow[j] * weight;
+        }
+
+        auto *dst = reinterpret_cast<quint32 *>(image.scanLine(y));
+        for (size_t j = 0; j < sums.size(); j += 4) {
+            const auto channel = [&](size_t index) {
+                return std::min<quint32>((sums[index] + Rounding) >> Shift, 255);
+            };
+            *dst++ = qRgba(channel(j + 1), channel(j + 2), channel(j + 3), channel(j));
+        }
+    }
+
+    varFrame.unmap();
+    rasterTransform(image, qNormalizedFrameTransformation(frame));
+    return image;
+}
+
+static QImage convertFrame(const QVideoFrame &frame, const QRect &sourceRect, QSize scaledSize,
+                           bool forceCpu)
 {
 #ifdef Q_OS_DARWIN
     QMacAutoReleasePool releasePool;
@@ -292,23 +883,14 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
     if (!g_state.hasLocalData())
         g_state.setLocalData({});
 
-    std::unique_ptr<QRhiRenderPassDescriptor> renderPass;
-    std::unique_ptr<QRhiBuffer> vertexBuffer;
-    std::unique_ptr<QRhiBuffer> uniformBuffer;
-    std::unique_ptr<QRhiTexture> targetTexture;
-    std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
-    std::unique_ptr<QRhiSampler> textureSampler;
-    std::unique_ptr<QRhiShaderResourceBindings> shaderResourceBindings;
-    std::unique_ptr<QRhiGraphicsPipeline> graphicsPipeline;
-
     if (frame.size().isEmpty() || frame.pixelFormat() == QVideoFrameFormat::Format_Invalid)
         return {};
 
     if (frame.pixelFormat() == QVideoFrameFormat::Format_Jpeg)
-        return convertJPEG(frame);
+        return convertJPEG(frame, sourceRect, scaledSize);
 
     if (forceCpu) // For test purposes
-        return convertCPU(frame);
+        return convertCPU(frame, sourceRect, scaledSize);
 
     QRhi *rhi = nullptr;
 
@@ -319,60 +901,71 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
         rhi = initializeRHI(rhi);
 
     if (!rhi || rhi->isRecordingFrame())
-        return convertCPU(frame);
+        return convertCPU(frame, sourceRect, scaledSize);
 
     // Do conversion using shaders
 
-    const QSize frameSize = qRotatedFrameSize(frame);
-
-    vertexBuffer.reset(rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(g_quad)));
-    vertexBuffer->create();
-
-    uniformBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 64 + 64 + 4 + 4 + 4 + 4));
-    uniformBuffer->create();
-
-    textureSampler.reset(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
-                                         QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
-    textureSampler->create();
+    const NormalizedFrameTransformation transformation = qNormalizedFrameTransformation(frame);
+    const QSize targetSize = qRotatedFrameSize(scaledSize, transformation.rotation);
 
-    shaderResourceBindings.reset(rhi->newShaderResourceBindings());
+    ConversionResources *resources = conversionResources(rhi);
+    if (!resources) {
+        qCDebug(qLcVideoFrameConverter) << "Failed to create conversion resources. Using CPU conversion.";
+        return convertCPU(frame, sourceRect, scaledSize);
+    }
 
-    targetTexture.reset(rhi->newTexture(QRhiTexture::RGBA8, frameSize, 1, QRhiTexture::RenderTarget));
-    if (!targetTexture->create()) {
+    ConversionResources::Target *target = conversionTarget(*resources, targetSize);
+    if (!target) {
         qCDebug(qLcVideoFrameConverter) << "Failed to create target texture. Using CPU conversion.";
-        return convertCPU(frame);
+        return convertCPU(frame, sourceRect, scaledSize);
     }
 
-    renderTarget.reset(rhi->newTextureRenderTarget({ { targetTexture.get() } }));
-    renderPass.reset(renderTarget->newCompatibleRenderPassDescriptor());
-    renderTarget->setRenderPassDescriptor(renderPass.get());
-    renderTarget->create();
+    const std::vector<QSize> levels = downsampleLevels(
+            qRotatedFrameSize(sourceRect.size(), transformation.rotation), targetSize);
+    ConversionResources::DownsampleChain *chain = nullptr;
+    if (!levels.empty()) {
+        chain = downsampleChain(*resources, levels);
+        if (!chain) {
+            qCDebug(qLcVideoFrameConverter)
+                    << "Failed to create downsampling passes. Using CPU conversion.";
+            return convertCPU(frame, sourceRect, scaledSize);
+        }
+    }
 
     QRhiCommandBuffer *cb = nullptr;
     QRhi::FrameOpResult r = rhi->beginOffscreenFrame(&cb);
     if (r != QRhi::FrameOpSuccess) {
         qCDebug(qLcVideoFrameConverter) << "Failed to set up offscreen frame. Using CPU conversion.";
-        return convertCPU(frame);
+        return convertCPU(frame, sourceRect, scaledSize);
     }
 
     QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
 
-    rub->uploadStaticBuffer(vertexBuffer.get(), g_quad);
-
     QVideoFrame frameTmp = frame;
     auto videoFrameTextures = QVideoTextureHelper::createTextures(frameTmp, rhi, rub, {});
     if (!videoFrameTextures) {
         qCDebug(qLcVideoFrameConverter) << "Failed obtain textures. Using CPU conversion.";
-        return convertCPU(frame);
+        rub->release();
+        rhi->endOffscreenFrame();
+        return convertCPU(frame, sourceRect, scaledSize);
     }
 
-    if (!updateTextures(rhi, uniformBuffer, textureSampler, shaderResourceBindings,
-                        graphicsPipeline, renderPass, frameTmp, videoFrameTextures)) {
+    ConversionResources::Pipeline *pipeline =
+            conversionPipeline(*resources, frameTmp, *videoFrameTextures);
+    if (!pipeline) {
         qCDebug(qLcVideoFrameConverter) << "Failed to update textures. Using CPU conversion.";
-        return convertCPU(frame);
+        rub->release();
+        rhi->endOffscreenFrame();
+        return convertCPU(frame, sourceRect, scaledSize);
     }
 
-    const NormalizedFrameTransformation transformation = qNormalizedFrameTransformation(frame);
+    // The quad samples the source rect only; the viewport scales it to the target size
+    const QRectF textureRect(qreal(sourceRect.x()) / frame.width(),
+                             qreal(sourceRect.y()) / frame.height(),
+                             qreal(sourceRect.width()) / frame.width(),
+                             qreal(sourceRect.height()) / frame.height());
+    const auto quad = conversionQuad(transformation.rotationIndex, textureRect);
+    rub->updateDynamicBuffer(resources->vertexBuffer.get(), 0, sizeof(quad), quad.data());
 
     float xScale = transformation.xMirrorredAfterRotation ? -1.0 : 1.0;
     float yScale = 1.f;
@@ -383,22 +976,63 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
     QMatrix4x4 transform;
     transform.scale(xScale, yScale);
 
-    QByteArray uniformData(64 + 64 + 4 + 4, Qt::Uninitialized);
-    QVideoTextureHelper::updateUniformData(&uniformData, frame.surfaceFormat(), frame, transform, 1.f);
-    rub->updateDynamicBuffer(uniformBuffer.get(), 0, uniformData.size(), uniformData.constData());
+    QByteArray uniformData(sizeof(QVideoTextureHelper::UniformData), Qt::Uninitialized);
+    QVideoTextureHelper::updateUniformData(&uniformData, rhi, frame.surfaceFormat(), frame,
+                                           transform, 1.f);
+    rub->updateDynamicBuffer(resources->uniformBuffer.get(), 0, uniformData.size(), uniformData.constData());
 
-    cb->beginPass(renderTarget.get(), Qt::black, { 1.0f, 0 }, rub);
-    cb->setGraphicsPipeline(graphicsPipeline.get());
+    // With downsampling, the frame is converted at the size of the first level
+    const QSize conversionSize = chain ? levels.front() : targetSize;
+    cb->beginPass(chain ? chain->passes.front().source.renderTarget.get()
+                        : target->renderTarget.get(),
+                  Qt::black, { 1.0f, 0 }, rub);
+    cb->setGraphicsPipeline(pipeline->pipeline.get());
 
-    cb->setViewport({ 0, 0, float(frameSize.width()), float(frameSize.height()) });
-    cb->setShaderResources(shaderResourceBindings.get());
+    cb->setViewport({ 0, 0, float(conversionSize.width()), float(conversionSize.height()) });
+    cb->setShaderResources(pipeline->bindings.get());
 
-    const quint32 vertexOffset = quint32(sizeof(float)) * 16 * transformation.rotationIndex;
-    const QRhiCommandBuffer::VertexInput vbufBinding(vertexBuffer.get(), vertexOffset);
+    const QRhiCommandBuffer::VertexInput vbufBinding(resources->vertexBuffer.get(), 0);
     cb->setVertexInput(0, 1, &vbufBinding);
     cb->draw(4);
 
-    QRhiReadbackDescription readDesc(targetTexture.get());
+    if (chain) {
+        // The frame is transformed already; the passes only keep the orientation
+        const auto passQuad = conversionQuad(0, QRectF(0, 0, 1, 1));
+        QMatrix4x4 passTransform;
+        passTransform.scale(1.f, yScale);
+        const QVideoFrameFormat imageFormat(conversionSize, QVideoFrameFormat::Format_RGBA8888);
+        QByteArray passUniformData(sizeof(QVideoTextureHelper::UniformData),
+                                   Qt::Uninitialized);
+        QVideoTextureHelper::updateUniformData(&passUniformData, rhi, imageFormat, {},
+                                               passTransform, 1.f);
+
+        for (size_t i = 0; i < chain->passes.size(); ++i) {
+            cb->endPass();
+
+            const auto &pass = chain->passes[i];
+            const bool isLast = i + 1 == chain->passes.size();
+            const QSize passSize = isLast ? targetSize : levels[i + 1];
+
+            rub = rhi->nextResourceUpdateBatch();
+            rub->updateDynamicBuffer(pass.vertexBuffer.get(), 0, sizeof(passQuad),
+                                     passQuad.data());
+            rub->updateDynamicBuffer(pass.uniformBuffer.get(), 0, passUniformData.size(),
+                                     passUniformData.constData());
+
+            cb->beginPass(isLast ? target->renderTarget.get()
+                                 : chain->passes[i + 1].source.renderTarget.get(),
+                          Qt::black, { 1.0f, 0 }, rub);
+            cb->setGraphicsPipeline(chain->pipeline.get());
+            cb->setViewport({ 0, 0, float(passSize.width()), float(passSize.height()) });
+            cb->setShaderResources(pass.bindings.get());
+
+            const QRhiCommandBuffer::VertexInput passBinding(pass.vertexBuffer.get(), 0);
+            cb->setVertexInput(0, 1, &passBinding);
+            cb->draw(4);
+        }
+    }
+
+    QRhiReadbackDescription readDesc(target->texture.get());
     QRhiReadbackResult readResult;
     bool readCompleted = false;
 
@@ -413,7 +1047,7 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
 
     if (!readCompleted) {
         qCDebug(qLcVideoFrameConverter) << "Failed to read back texture. Using CPU conversion.";
-        return convertCPU(frame);
+        return convertCPU(frame, sourceRect, scaledSize);
     }
 
     QByteArray *imageData = new QByteArray(readResult.data);
@@ -423,6 +1057,89 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
                   QImage::Format_RGBA8888_Premultiplied, imageCleanupHandler, imageData);
 }
 
+QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu)
+{
+    return convertFrame(frame, QRect(QPoint(), frame.size()), frame.size(), forceCpu);
+}
+
+QImage qImageFromVideoFrame(const QVideoFrame &frame, const QRect &sourceRect, QSize targetSize,
+                            QImage::Format targetFormat, bool forceCpu)
+{
+    const QRect frameRect(QPoint(), frame.size());
+    const QRect rect = sourceRect.isValid() ? sourceRect & frameRect : frameRect;
+    if (rect.isEmpty())
+        return {};
+
+    // The target size is transformed, while the frame is scaled before the transformation
+    const QtVideo::Rotation rotation = qNormalizedFrameTransformation(frame).rotation;
+    const QSize scaledSize =
+            targetSize.isEmpty() ? rect.size() : qRotatedFrameSize(targetSize, rotation);
+
+    QImage image = convertFrame(frame, rect, scaledSize, forceCpu);
+    if (targetFormat != QImage::Format_Invalid)
+        image.convertTo(targetFormat);
+    return image;
+}
+
+QImage qImageFromVideoFrameOnCpu(const QVideoFrame &frame, int maxThreadCount)
+{
+    if (frame.size().isEmpty() || frame.pixelFormat() == QVideoFrameFormat::Format_Invalid)
+        return {};
+
+    if (frame.pixelFormat() == QVideoFrameFormat::Format_Jpeg)
+        return convertJPEG(frame, QRect(QPoint(), frame.size()), frame.size());
+
+    return convertCPU(frame, maxThreadCount);
+}
+
+QVideoFrameAsyncConverter::QVideoFrameAsyncConverter(int maxFramesInFlight)
+    : m_context(std::make_unique<QObject>()), m_freeSlots(qMax(1, maxFramesInFlight))
+{
+    m_thread.setObjectName(QStringLiteral("QVideoFrameAsyncConverter"));
+    m_context->moveToThread(&m_thread);
+    m_thread.start();
+}
+
+QVideoFrameAsyncConverter::~QVideoFrameAsyncConverter()
+{
+    // Quit after the conversions queued before, so that all the futures get their images.
+    // The thread storage releases the conversion resources in the converter thread.
+    QMetaObject::invokeMethod(m_context.get(), [this] { m_thread.quit(); },
+                              Qt::QueuedConnection);
+    m_thread.wait();
+
+    // The conversions have released their slots and no events are pending for the context,
+    // so it's deleted before the thread it lives in, then the semaphore goes.
+    m_context.reset();
+}
+
+QFuture<QImage> QVideoFrameAsyncConverter::convert(const QVideoFrame &frame)
+{
+    auto promise = std::make_shared<QPromise<QImage>>();
+    QFuture<QImage> future = promise->future();
+    promise->start();
+
+    // Waiting for a slot would stall the producer for the whole conversion; drop the frame
+    if (!m_freeSlots.tryAcquire()) {
+        future.cancel();
+        promise->finish();
+        return future;
+    }
+
+    QMetaObject::invokeMethod(
+            m_context.get(),
+            [this, promise, frame]() mutable {
+                promise->addResult(qImageFromVideoFrame(frame));
+                // Let the producer reuse the frame right away
+                frame = {};
+                promise->finish();
+                m_freeSlots.release();
+            },
+            Qt::QueuedConnection);
+
+    return future;
+}
+
 QImage videoFramePlaneAsImage(QVideoFrame &frame, int plane, QImage::Format targetFormat,
                               QSize targetSize)
 {
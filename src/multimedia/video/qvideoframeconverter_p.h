@@ -16,11 +16,63 @@
 //
 
 #include <qvideoframe.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthread.h>
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
 Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrame(const QVideoFrame &frame, bool forceCpu = false);
 
+/**
+ *  @brief Converts the \a sourceRect of the video frame to an image of \a targetSize and
+ * \a targetFormat in one pass, without converting the whole frame first. The source rect is
+ * in the frame coordinates, before the rotation and the mirroring, while the target size is
+ * of the transformed image. An invalid source rect means the whole frame, an empty target
+ * size means the transformed size of the source rect, and Format_Invalid means the format
+ * of the conversion, as with qImageFromVideoFrame.
+ */
+Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrame(const QVideoFrame &frame, const QRect &sourceRect,
+                                                QSize targetSize,
+                                                QImage::Format targetFormat = QImage::Format_Invalid,
+                                                bool forceCpu = false);
+
+/**
+ *  @brief Converts the video frame on the CPU. Large frames are split into bands of rows,
+ * which are converted by up to \a maxThreadCount threads in parallel; 0 means as many threads
+ * as the frame size justifies, up to the number of cores.
+ */
+Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrameOnCpu(const QVideoFrame &frame,
+                                                     int maxThreadCount = 0);
+
+/**
+ *  @brief Converts video frames to images in a dedicated thread, so that consumers pulling
+ * images at the frame rate don't stall on the GPU synchronization.
+ *
+ * QRhi completes offscreen frames synchronously, so the converter thread keeps its own
+ * cached conversion resources, see qImageFromVideoFrame, and up to maxFramesInFlight frames
+ * are queued to it. If that many frames are pending, convert() drops the frame and returns
+ * a canceled future right away.
+ */
+class Q_MULTIMEDIA_EXPORT QVideoFrameAsyncConverter
+{
+public:
+    explicit QVideoFrameAsyncConverter(int maxFramesInFlight = 2);
+    ~QVideoFrameAsyncConverter(); // finishes the pending conversions
+
+    Q_DISABLE_COPY_MOVE(QVideoFrameAsyncConverter)
+
+    QFuture<QImage> convert(const QVideoFrame &frame);
+
+private:
+    QThread m_thread;
+    std::unique_ptr<QObject> m_context; // lives in m_thread; the destructor deletes it first
+    QSemaphore m_freeSlots;
+};
+
 /**
  *  @brief Maps the video frame and returns an image having a shared ownership for the video frame
  * and referencing to its mapped data.
@@ -752,7 +752,8 @@ QString QVideoFrameFormat::fragmentShaderFileName() const
 */
 void QVideoFrameFormat::updateUniformData(QByteArray *dst, const QVideoFrame &frame, const QMatrix4x4 &transform, float opacity) const
 {
-    QVideoTextureHelper::updateUniformData(dst, *this, frame, transform, opacity);
+    // Without a rhi, the data matches the textures uploaded as usual
+    QVideoTextureHelper::updateUniformData(dst, nullptr, *this, frame, transform, opacity);
 }
 
 /*!
@@ -0,0 +1,156 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qvideoframepool_p.h"
+#include "qvideoframe_p.h"
+#include "qvideotexturehelper_p.h"
+
+#include <QtCore/qdebug.h>
+#include <QtCore/qmalloc.h>
+#include <QtCore/qmutex.h>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Suits the SIMD conversions and the texture uploads
+constexpr size_t BufferAlignment = 64;
+
+struct AlignedDeleter
+{
+    void operator()(uchar *data) const { qFreeAligned(data); }
+};
+
+using BufferMemory = std::unique_ptr<uchar, AlignedDeleter>;
+
+}
+
+class QVideoFramePoolPrivate
+{
+public:
+    explicit QVideoFramePoolPrivate(int maxFreeBuffers) : m_maxFreeBuffers(maxFreeBuffers) { }
+
+    BufferMemory acquire(qsizetype size)
+    {
+        std::vector<BufferMemory> droppedBuffers;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (size == m_bufferSize && !m_freeBuffers.empty()) {
+                BufferMemory memory = std::move(m_freeBuffers.back());
+                m_freeBuffers.pop_back();
+                return memory;
+            }
+
+            if (size != m_bufferSize) {
+                droppedBuffers.swap(m_freeBuffers);
+                m_bufferSize = size;
+            }
+        }
+
+        return BufferMemory(static_cast<uchar *>(qMallocAligned(size, BufferAlignment)));
+    }
+
+    void release(BufferMemory memory, qsizetype size)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (size == m_bufferSize && int(m_freeBuffers.size()) < m_maxFreeBuffers)
+            m_freeBuffers.push_back(std::move(memory));
+    }
+
+    int freeBufferCount() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return int(m_freeBuffers.size());
+    }
+
+private:
+    const int m_maxFreeBuffers;
+    mutable QMutex m_mutex;
+    qsizetype m_bufferSize = 0;
+    std::vector<BufferMemory> m_freeBuffers;
+};
+
+namespace {
+
+class QPooledVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    QPooledVideoBuffer(const std::shared_ptr<QVideoFramePoolPrivate> &pool, qsizetype size,
+                       int bytesPerLine)
+        : m_pool(pool), m_memory(pool->acquire(size)), m_size(size), m_bytesPerLine(bytesPerLine)
+    {
+    }
+
+    ~QPooledVideoBuffer() override
+    {
+        if (std::shared_ptr<QVideoFramePoolPrivate> pool = m_pool.lock())
+            pool->release(std::move(m_memory), m_size);
+    }
+
+    bool isAllocated() const { return bool(m_memory); }
+
+    MapData map(QVideoFrame::MapMode) override
+    {
+        MapData mapData;
+        mapData.planeCount = 1;
+        mapData.bytesPerLine[0] = m_bytesPerLine;
+        mapData.data[0] = m_memory.get();
+        mapData.dataSize[0] = m_size;
+        return mapData;
+    }
+
+    QVideoFrameFormat format() const override { return {}; }
+
+private:
+    std::weak_ptr<QVideoFramePoolPrivate> m_pool;
+    BufferMemory m_memory;
+    qsizetype m_size = 0;
+    int m_bytesPerLine = 0;
+};
+
+}
+
+QVideoFramePool::QVideoFramePool(int maxFreeBuffers)
+    : d(std::make_shared<QVideoFramePoolPrivate>(maxFreeBuffers))
+{
+}
+
+QVideoFramePool::~QVideoFramePool() = default;
+
+QVideoFrame QVideoFramePool::createFrame(const QVideoFrameFormat &format)
+{
+    auto *textureDescription = QVideoTextureHelper::textureDescription(format.pixelFormat());
+    const qsizetype bytes = textureDescription->bytesForSize(format.frameSize());
+    if (bytes <= 0)
+        return {};
+
+    auto buffer = createBuffer(bytes, textureDescription->strideForWidth(format.frameWidth()));
+    if (!buffer)
+        return {};
+
+    return QVideoFramePrivate::createFrame(std::move(buffer), format);
+}
+
+std::unique_ptr<QAbstractVideoBuffer> QVideoFramePool::createBuffer(qsizetype size,
+                                                                    int bytesPerLine)
+{
+    if (size <= 0)
+        return {};
+
+    auto buffer = std::make_unique<QPooledVideoBuffer>(d, size, bytesPerLine);
+    if (!buffer->isAllocated()) {
+        qWarning() << "Cannot allocate a video frame buffer of" << size << "bytes";
+        return {};
+    }
+
+    return buffer;
+}
+
+int QVideoFramePool::freeBufferCount() const
+{
+    return d->freeBufferCount();
+}
+
+QT_END_NAMESPACE
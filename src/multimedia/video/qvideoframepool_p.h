@@ -0,0 +1,57 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QVIDEOFRAMEPOOL_P_H
+#define QVIDEOFRAMEPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qabstractvideobuffer.h"
+#include "qvideoframe.h"
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QVideoFramePoolPrivate;
+
+/**
+ *  @brief Recycles the memory of video frames. The memory returns to the pool when the last
+ * QVideoFrame referencing it is destroyed, so producers of frames of a fixed size don't
+ * allocate in the steady state. Requesting another size drops the free memory.
+ *
+ * The pool is thread-safe, and the frames may outlive it.
+ */
+class Q_MULTIMEDIA_EXPORT QVideoFramePool
+{
+public:
+    explicit QVideoFramePool(int maxFreeBuffers = 4);
+    ~QVideoFramePool();
+
+    Q_DISABLE_COPY_MOVE(QVideoFramePool)
+
+    // A frame with the memory layout of QVideoFrame(format)
+    QVideoFrame createFrame(const QVideoFrameFormat &format);
+
+    // A single plane buffer for producers filling the memory before creating the frame,
+    // e.g. by a driver; see QVideoFramePrivate::createFrame
+    std::unique_ptr<QAbstractVideoBuffer> createBuffer(qsizetype size, int bytesPerLine);
+
+    int freeBufferCount() const;
+
+private:
+    std::shared_ptr<QVideoFramePoolPrivate> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QVIDEOFRAMEPOOL_P_H
@@ -6,9 +6,18 @@
 #include "qvideotexturehelper_p.h"
 #include "qvideoframeconverter_p.h"
 #include "qvideoframe_p.h"
+#include "qhdrtonemapper_p.h"
 
 #include <qpainter.h>
 #include <qloggingcategory.h>
+#include <QtCore/qmutex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
@@ -310,8 +319,9 @@ QString fragmentShaderFileName(const QVideoFrameFormat &format, QRhiSwapChain::F
             shader = "nv12_bt2020_hlg";
             break;
         }
-        // Fall through, should be bt709
-        Q_FALLTHROUGH();
+        // Should be bt709; unlike nv12, p010 handles packed uploads
+        shader = "p010";
+        break;
     case QVideoFrameFormat::Format_NV12:
         shader = "nv12";
         break;
@@ -442,41 +452,12 @@ static QMatrix4x4 colorMatrix(const QVideoFrameFormat &format)
 }
 // clang-format on
 
-// PQ transfer function, see also https://en.wikipedia.org/wiki/Perceptual_quantizer
-// or https://ieeexplore.ieee.org/document/7291452
-static float convertPQFromLinear(float sig)
-{
-    const float m1 = 1305.f/8192.f;
-    const float m2 = 2523.f/32.f;
-    const float c1 = 107.f/128.f;
-    const float c2 = 2413.f/128.f;
-    const float c3 = 2392.f/128.f;
-
-    const float SDR_LEVEL = 100.f;
-    sig *= SDR_LEVEL/10000.f;
-    float psig = powf(sig, m1);
-    float num = c1 + c2*psig;
-    float den = 1 + c3*psig;
-    return powf(num/den, m2);
-}
-
-float convertHLGFromLinear(float sig)
-{
-    const float a = 0.17883277f;
-    const float b = 0.28466892f; // = 1 - 4a
-    const float c = 0.55991073f; // = 0.5 - a ln(4a)
-
-    if (sig < 1.f/12.f)
-        return sqrtf(3.f*sig);
-    return a*logf(12.f*sig - b) + c;
-}
-
 static float convertSDRFromLinear(float sig)
 {
     return sig;
 }
 
-void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const QVideoFrame &frame, const QMatrix4x4 &transform, float opacity, float maxNits)
+void updateUniformData(QByteArray *dst, QRhi *rhi, const QVideoFrameFormat &format, const QVideoFrame &frame, const QMatrix4x4 &transform, float opacity, float maxNits)
 {
 #ifndef Q_OS_ANDROID
     Q_UNUSED(frame);
@@ -543,10 +524,10 @@ void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const Q
     auto fromLinear = convertSDRFromLinear;
     switch (format.colorTransfer()) {
     case QVideoFrameFormat::ColorTransfer_ST2084:
-        fromLinear = convertPQFromLinear;
+        fromLinear = QHdrToneMapper::pqFromLinear;
         break;
     case QVideoFrameFormat::ColorTransfer_STD_B67:
-        fromLinear = convertHLGFromLinear;
+        fromLinear = QHdrToneMapper::hlgFromLinear;
         break;
     default:
         break;
@@ -562,6 +543,208 @@ void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const Q
     ud->width = float(format.frameWidth());
     ud->masteringWhite = fromLinear(float(format.maxLuminance())/100.f);
     ud->maxLum = fromLinear(float(maxNits)/100.f);
+    ud->packed10Bit = usesPacked10BitUpload(frame, rhi) ? 1.f : 0.f;
+}
+
+namespace {
+
+// Recycles the textures of memory video frames between the video sinks of a QRhi, so that
+// sinks switching between frame sizes, or being created and destroyed, don't reallocate
+// the textures all the time. Returning a texture to the pool only ends its use by the sink;
+// QRhi orders the next upload after the draws of the previous frames.
+class TexturePool
+{
+public:
+    // Enough for the planes of a few 4K frames, or of many small ones
+    static constexpr qint64 MaxPooledBytes = 64 * 1024 * 1024;
+
+    std::unique_ptr<QRhiTexture> acquire(QRhi *rhi, QRhiTexture::Format format, QSize size)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            // The most recently released textures are the most likely to be needed
+            for (auto it = m_textures.rbegin(); it != m_textures.rend(); ++it) {
+                if ((*it)->format() == format && (*it)->pixelSize() == size) {
+                    std::unique_ptr<QRhiTexture> texture = std::move(*it);
+                    m_textures.erase(std::next(it).base());
+                    m_pooledBytes -= textureBytes(*texture);
+                    return texture;
+                }
+            }
+        }
+
+        std::unique_ptr<QRhiTexture> texture(rhi->newTexture(format, size, 1, {}));
+        if (!texture || !texture->create()) {
+            qWarning("Failed to create texture (size %dx%d)", size.width(), size.height());
+            return {};
+        }
+        return texture;
+    }
+
+    void release(std::unique_ptr<QRhiTexture> texture)
+    {
+        if (!texture)
+            return;
+
+        const qint64 bytes = textureBytes(*texture);
+        if (bytes > MaxPooledBytes)
+            return;
+
+        // Deleted after unlocking
+        std::vector<std::unique_ptr<QRhiTexture>> evicted;
+        QMutexLocker locker(&m_mutex);
+
+        // The least recently released textures go first, whatever their size,
+        // until the budget fits the new one
+        while (m_pooledBytes + bytes > MaxPooledBytes) {
+            m_pooledBytes -= textureBytes(*m_textures.front());
+            evicted.push_back(std::move(m_textures.front()));
+            m_textures.pop_front();
+        }
+
+        m_textures.push_back(std::move(texture));
+        m_pooledBytes += bytes;
+    }
+
+private:
+    static qint64 textureBytes(const QRhiTexture &texture)
+    {
+        int bytesPerPixel = 4;
+        switch (texture.format()) {
+        case QRhiTexture::R8:
+            bytesPerPixel = 1;
+            break;
+        case QRhiTexture::RG8:
+        case QRhiTexture::R16:
+            bytesPerPixel = 2;
+            break;
+        case QRhiTexture::RG16:
+        case QRhiTexture::RGBA8:
+        case QRhiTexture::BGRA8:
+        case QRhiTexture::RGB10A2:
+            bytesPerPixel = 4;
+            break;
+        default:
+            break;
+        }
+
+        const QSize size = texture.pixelSize();
+        return qint64(size.width()) * size.height() * bytesPerPixel;
+    }
+
+    QMutex m_mutex;
+    std::deque<std::unique_ptr<QRhiTexture>> m_textures; // the least recently released first
+    qint64 m_pooledBytes = 0;
+};
+
+struct TexturePools
+{
+    QMutex mutex;
+    std::map<QRhi *, std::shared_ptr<TexturePool>> pools;
+};
+
+}
+
+Q_GLOBAL_STATIC(TexturePools, g_texturePools)
+
+static std::shared_ptr<TexturePool> texturePool(QRhi *rhi)
+{
+    TexturePools *texturePools = g_texturePools();
+    QMutexLocker locker(&texturePools->mutex);
+
+    std::shared_ptr<TexturePool> &pool = texturePools->pools[rhi];
+    if (!pool) {
+        pool = std::make_shared<TexturePool>();
+        // The textures have to go before the rhi. The textures still in use by the sinks
+        // are deleted by them, as they only keep weak references to the pool.
+        rhi->addCleanupCallback(pool.get(), [](QRhi *rhi) {
+            std::shared_ptr<TexturePool> pool;
+            if (TexturePools *texturePools = g_texturePools()) {
+                QMutexLocker locker(&texturePools->mutex);
+                auto it = texturePools->pools.find(rhi);
+                if (it != texturePools->pools.end()) {
+                    pool = std::move(it->second);
+                    texturePools->pools.erase(it);
+                }
+            }
+        });
+    }
+
+    return pool;
+}
+
+static std::atomic_bool &packed10BitUploadEnabled()
+{
+    static std::atomic_bool enabled{ qEnvironmentVariableIntValue("QT_MEDIA_PACKED_10BIT_UPLOAD")
+                                     != 0 };
+    return enabled;
+}
+
+void setPacked10BitUploadEnabled(bool enabled)
+{
+    packed10BitUploadEnabled() = enabled;
+}
+
+bool isPacked10BitUploadEnabled()
+{
+    return packed10BitUploadEnabled();
+}
+
+bool usesPacked10BitUpload(const QVideoFrame &frame, QRhi *rhi)
+{
+    if (!packed10BitUploadEnabled() || !rhi
+        || !rhi->isTextureFormatSupported(QRhiTexture::RGB10A2))
+        return false;
+
+    // P016 may carry more than 10 bits
+    const auto pixelFormat = frame.pixelFormat();
+    if (pixelFormat != QVideoFrameFormat::Format_P010
+        && pixelFormat != QVideoFrameFormat::Format_YUV420P10)
+        return false;
+
+    // Hardware frames keep their textures, even if they have to be uploaded from memory
+    return !QVideoFramePrivate::hwBuffer(frame);
+}
+
+// Packs three 10-bit samples in the R, G and B of an RGB10A2 texel; P010 has the samples
+// in the high bits, and YUV420P10 in the low ones. The last texel of a row is padded with
+// the last sample.
+template <int Shift>
+static void packSamplesTo10Bit(const uchar *src, int srcStride, int samplesPerRow, int rows,
+                               quint32 *dst)
+{
+    const auto sample = [](const quint16 *row, int i) { return quint32(row[i] >> Shift) & 0x3ff; };
+
+    for (int y = 0; y < rows; ++y) {
+        const auto *row = reinterpret_cast<const quint16 *>(src + y * srcStride);
+        for (int i = 0; i < samplesPerRow; i += 3) {
+            const int last = samplesPerRow - 1;
+            *dst++ = sample(row, i) | sample(row, std::min(i + 1, last)) << 10
+                    | sample(row, std::min(i + 2, last)) << 20 | 3u << 30;
+        }
+    }
+}
+
+// The data is reused between the frames; the upload of the previous frame has been
+// submitted by then, so it no longer shares the data and the buffer isn't reallocated.
+void packPlaneTo10Bit(const QVideoFrame &frame, int plane, QByteArray &data)
+{
+    Q_ASSERT(frame.isMapped());
+
+    const TextureDescription &texDesc = descriptions[frame.pixelFormat()];
+    const QSize planeSize(frame.width() / texDesc.sizeScale[plane].x,
+                          frame.height() / texDesc.sizeScale[plane].y);
+    const int samplesPerTexel = texDesc.textureFormat[plane] == QRhiTexture::RG16 ? 2 : 1;
+    const int samplesPerRow = planeSize.width() * samplesPerTexel;
+    data.resize(qsizetype((samplesPerRow + 2) / 3) * planeSize.height() * 4);
+    auto *dst = reinterpret_cast<quint32 *>(data.data());
+
+    if (frame.pixelFormat() == QVideoFrameFormat::Format_P010)
+        packSamplesTo10Bit<6>(frame.bits(plane), frame.bytesPerLine(plane), samplesPerRow,
+                              planeSize.height(), dst);
+    else
+        packSamplesTo10Bit<0>(frame.bits(plane), frame.bytesPerLine(plane), samplesPerRow,
+                              planeSize.height(), dst);
 }
 
 enum class UpdateTextureWithMapResult : uint8_t {
@@ -572,7 +755,8 @@ enum class UpdateTextureWithMapResult : uint8_t {
 
 static UpdateTextureWithMapResult updateTextureWithMap(const QVideoFrame &frame, QRhi *rhi,
                                                        QRhiResourceUpdateBatch *rub, int plane,
-                                                       std::unique_ptr<QRhiTexture> &tex)
+                                                       std::unique_ptr<QRhiTexture> &tex,
+                                                       QByteArray &packedData, TexturePool &pool)
 {
     Q_ASSERT(frame.isMapped());
 
@@ -583,22 +767,22 @@ static UpdateTextureWithMapResult updateTextureWithMap(const QVideoFrame &frame,
     const TextureDescription &texDesc = descriptions[pixelFormat];
     QSize planeSize(size.width()/texDesc.sizeScale[plane].x, size.height()/texDesc.sizeScale[plane].y);
 
-    bool needsRebuild = !tex || tex->pixelSize() != planeSize || tex->format() != texDesc.textureFormat[plane];
-    if (!tex) {
-        tex.reset(rhi->newTexture(texDesc.textureFormat[plane], planeSize, 1, {}));
-        if (!tex) {
-            qWarning("Failed to create new texture (size %dx%d)", planeSize.width(), planeSize.height());
-            return UpdateTextureWithMapResult::Failed;
-        }
+    QRhiTexture::Format textureFormat = texDesc.textureFormat[plane];
+    QSize textureSize = planeSize;
+    const bool packed = usesPacked10BitUpload(frame, rhi);
+    const int samplesPerTexel = textureFormat == QRhiTexture::RG16 ? 2 : 1;
+    if (packed) {
+        textureFormat = QRhiTexture::RGB10A2;
+        textureSize.setWidth((planeSize.width() * samplesPerTexel + 2) / 3);
     }
 
+    bool needsRebuild = !tex || tex->pixelSize() != textureSize || tex->format() != textureFormat;
     if (needsRebuild) {
-        tex->setFormat(texDesc.textureFormat[plane]);
-        tex->setPixelSize(planeSize);
-        if (!tex->create()) {
-            qWarning("Failed to create texture (size %dx%d)", planeSize.width(), planeSize.height());
+        // Another sink may need the texture of the previous size
+        pool.release(std::move(tex));
+        tex = pool.acquire(rhi, textureFormat, textureSize);
+        if (!tex)
             return UpdateTextureWithMapResult::Failed;
-        }
     }
 
     auto result = UpdateTextureWithMapResult::UpdatedWithDataCopy;
@@ -621,6 +805,9 @@ static UpdateTextureWithMapResult updateTextureWithMap(const QVideoFrame &frame,
         image.convertTo(QImage::Format_ARGB32);
         subresDesc.setImage(image);
 
+    } else if (packed) {
+        packPlaneTo10Bit(frame, plane, packedData);
+        subresDesc.setData(packedData);
     } else {
         // Note, QByteArray::fromRawData creare QByteArray as a view without data copying
         subresDesc.setData(QByteArray::fromRawData(
@@ -676,8 +863,14 @@ class QVideoFrameTexturesArray : public QVideoFrameTextures
 {
 public:
     using TextureArray = std::array<std::unique_ptr<QRhiTexture>, TextureDescription::maxPlanes>;
-    QVideoFrameTexturesArray(TextureArray &&textures, QVideoFrame mappedFrame = {})
-        : m_textures(std::move(textures)), m_mappedFrame(std::move(mappedFrame))
+    using PackedDataArray = std::array<QByteArray, TextureDescription::maxPlanes>;
+    QVideoFrameTexturesArray(TextureArray &&textures, QVideoFrame mappedFrame = {},
+                             std::weak_ptr<TexturePool> pool = {},
+                             PackedDataArray &&packedData = {})
+        : m_textures(std::move(textures)),
+          m_mappedFrame(std::move(mappedFrame)),
+          m_pool(std::move(pool)),
+          m_packedData(std::move(packedData))
     {
         Q_ASSERT(!m_mappedFrame.isValid() || m_mappedFrame.isReadable());
     }
@@ -687,7 +880,16 @@ public:
     // unsig videoFramePlaneAsImage, however, the OpenGL rendering pipeline in QRhi
     // may keep QImage, and consequently the mapped QVideoFrame,
     // even after the target texture is deleted: QTBUG-123174.
-    ~QVideoFrameTexturesArray() { m_mappedFrame.unmap(); }
+    ~QVideoFrameTexturesArray()
+    {
+        m_mappedFrame.unmap();
+
+        // The textures wrapping native ones have no pool
+        if (std::shared_ptr<TexturePool> pool = m_pool.lock()) {
+            for (auto &texture : m_textures)
+                pool->release(std::move(texture));
+        }
+    }
 
     QRhiTexture *texture(uint plane) const override
     {
@@ -696,9 +898,15 @@ public:
 
     TextureArray takeTextures() { return std::move(m_textures); }
 
+    PackedDataArray takePackedData() { return std::move(m_packedData); }
+
+    bool isPooled() const { return !m_pool.expired(); }
+
 private:
     TextureArray m_textures;
     QVideoFrame m_mappedFrame;
+    std::weak_ptr<TexturePool> m_pool;
+    PackedDataArray m_packedData; // the scratch buffers of the packed uploads
 };
 
 static std::unique_ptr<QVideoFrameTextures> createTexturesFromHandles(const QVideoFrame &frame, QRhi *rhi)
@@ -720,9 +928,13 @@ static std::unique_ptr<QVideoFrameTextures> createTexturesFromMemory(QVideoFrame
 {
     const TextureDescription &texDesc = descriptions[frame.surfaceFormat().pixelFormat()];
     QVideoFrameTexturesArray::TextureArray textures;
+    QVideoFrameTexturesArray::PackedDataArray packedData;
+    // Only the textures of memory frames are reused; the others wrap native ones
     auto oldArray = dynamic_cast<QVideoFrameTexturesArray *>(old);
-    if (oldArray)
+    if (oldArray && oldArray->isPooled()) {
         textures = oldArray->takeTextures();
+        packedData = oldArray->takePackedData();
+    }
 
     if (!frame.map(QVideoFrame::ReadOnly)) {
         qWarning() << "Cannot map a video frame in ReadOnly mode!";
@@ -731,9 +943,12 @@ static std::unique_ptr<QVideoFrameTextures> createTexturesFromMemory(QVideoFrame
 
     auto unmapFrameGuard = qScopeGuard([&frame] { frame.unmap(); });
 
+    std::shared_ptr<TexturePool> pool = texturePool(rhi);
+
     bool shouldKeepMapping = false;
     for (quint8 plane = 0; plane < texDesc.nplanes; ++plane) {
-        const auto result = updateTextureWithMap(frame, rhi, rub, plane, textures[plane]);
+        const auto result = updateTextureWithMap(frame, rhi, rub, plane, textures[plane],
+                                                 packedData[plane], *pool);
         if (result == UpdateTextureWithMapResult::Failed)
             return {};
 
@@ -743,7 +958,8 @@ static std::unique_ptr<QVideoFrameTextures> createTexturesFromMemory(QVideoFrame
 
     // as QVideoFrame::unmap does nothing with null frames, we just move the frame to the result
     return std::make_unique<QVideoFrameTexturesArray>(
-            std::move(textures), shouldKeepMapping ? std::move(frame) : QVideoFrame());
+            std::move(textures), shouldKeepMapping ? std::move(frame) : QVideoFrame(), pool,
+            std::move(packedData));
 }
 
 std::unique_ptr<QVideoFrameTextures> createTextures(QVideoFrame &frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, std::unique_ptr<QVideoFrameTextures> &&oldTextures)
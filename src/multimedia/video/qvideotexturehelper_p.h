@@ -18,13 +18,14 @@
 #include <qvideoframeformat.h>
 #include <rhi/qrhi.h>
 
+#include "qhwvideobuffer_p.h"
+
 #include <QtGui/qtextlayout.h>
 
 QT_BEGIN_NAMESPACE
 
 class QVideoFrame;
 class QTextLayout;
-class QVideoFrameTextures;
 
 namespace QVideoTextureHelper
 {
@@ -62,8 +63,20 @@ Q_MULTIMEDIA_EXPORT const TextureDescription *textureDescription(QVideoFrameForm
 
 Q_MULTIMEDIA_EXPORT QString vertexShaderFileName(const QVideoFrameFormat &format);
 Q_MULTIMEDIA_EXPORT QString fragmentShaderFileName(const QVideoFrameFormat &format, QRhiSwapChain::Format surfaceFormat = QRhiSwapChain::SDR);
-Q_MULTIMEDIA_EXPORT void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const QVideoFrame &frame,
+// The rhi is the one the frame's textures are created with, see usesPacked10BitUpload()
+Q_MULTIMEDIA_EXPORT void updateUniformData(QByteArray *dst, QRhi *rhi, const QVideoFrameFormat &format, const QVideoFrame &frame,
                                            const QMatrix4x4 &transform, float opacity, float maxNits = 100);
+// With QT_MEDIA_PACKED_10BIT_UPLOAD=1, memory frames of the 10-bit formats P010 and
+// YUV420P10 are uploaded with three samples per RGB10A2 texel, which the shaders unpack.
+// This needs RGB10A2 textures, so not OpenGL ES 2; without them or without a rhi,
+// the frames are uploaded as usual.
+Q_MULTIMEDIA_EXPORT bool usesPacked10BitUpload(const QVideoFrame &frame, QRhi *rhi);
+// Overrides QT_MEDIA_PACKED_10BIT_UPLOAD, e.g. in tests
+Q_MULTIMEDIA_EXPORT void setPacked10BitUploadEnabled(bool enabled);
+Q_MULTIMEDIA_EXPORT bool isPacked10BitUploadEnabled();
+// Packs the samples of a plane of a mapped P010 or YUV420P10 frame as the packed upload does,
+// three per RGB10A2 texel, padding the last texel of a row with the last sample
+Q_MULTIMEDIA_EXPORT void packPlaneTo10Bit(const QVideoFrame &frame, int plane, QByteArray &data);
 Q_MULTIMEDIA_EXPORT std::unique_ptr<QVideoFrameTextures> createTextures(QVideoFrame &frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, std::unique_ptr<QVideoFrameTextures> &&oldTextures);
 
 struct UniformData {
@@ -73,6 +86,8 @@ struct UniformData {
     float width;
     float masteringWhite;
     float maxLum;
+    float packed10Bit;
+    float padding[3]; // std140 rounds the size of the uniform block up to 16 bytes
 };
 
 struct Q_MULTIMEDIA_EXPORT SubtitleLayout
@@ -176,7 +176,7 @@ bool QSGVideoMaterialRhiShader::updateUniformData(RenderState &state, QSGMateria
             maxNits = m_hdrInfo.limits.luminanceInNits.maxLuminance;
     }
 
-    QVideoTextureHelper::updateUniformData(state.uniformData(), m_videoFormat,
+    QVideoTextureHelper::updateUniformData(state.uniformData(), state.rhi(), m_videoFormat,
         m->m_currentFrame, state.combinedMatrix(), state.opacity(), maxNits);
 
     return true;
@@ -153,6 +153,11 @@ AudioRenderer::RenderingResult AudioRenderer::pushFrameToOutput(const Frame &fra
             return { time.count() == 0, time };
         }
 
+        if (resampleIntoSink(frame)) {
+            updateSynchronization(syncStamp, frame);
+            return {};
+        }
+
         m_bufferedData = { m_resampler->resample(frame.avFrame()) };
     }
 
@@ -179,6 +184,26 @@ AudioRenderer::RenderingResult AudioRenderer::pushFrameToOutput(const Frame &fra
     return {};
 }
 
+bool AudioRenderer::resampleIntoSink(const Frame &frame)
+{
+    // Resample straight into the buffer of the sink if the whole frame fits there, which
+    // saves the intermediate QAudioBuffer and the copy from it
+    const qsizetype maxBytes =
+            m_sinkFormat.bytesForFrames(m_resampler->maxOutputFrames(frame.avFrame()));
+    if (maxBytes <= 0 || m_sink->bytesFree() < maxBytes)
+        return false;
+
+    const QSpan<char> buffer = m_sink->beginWrite(maxBytes);
+    if (buffer.size() < maxBytes) {
+        // Not supported by the backend, or the free space wraps around the end of the buffer
+        m_sink->commitWrite(0);
+        return false;
+    }
+
+    m_sink->commitWrite(m_resampler->resample(frame.avFrame(), buffer));
+    return true;
+}
+
 void AudioRenderer::pushFrameToBufferOutput(const Frame &frame)
 {
     if (!m_bufferOutput)
@@ -313,6 +338,15 @@ void AudioRenderer::updateSynchronization(const SynchronizationStamp &stamp, con
     const auto writtenTime = durationForBytes(stamp.bufferBytesWritten);
     const auto soundDelay = currentFrameDelay + bufferLoadingTime - writtenTime;
 
+    if (auto reporter = statisticsReporter()) {
+        // The sink plays the buffered data that ends with the written part of the frame
+        const auto audiblePosition = frame.absolutePts()
+                + qint64((writtenTime - bufferLoadingTime).count() * playbackRate());
+        reporter->setPresentedPosition(QPlatformMediaPlayer::AudioStream, audiblePosition,
+                                       stamp.timePoint);
+        reporter->setAudioBufferLoad(bufferLoadingTime);
+    }
+
     auto synchronize = [&](microseconds fixedDelay, microseconds targetSoundDelay) {
         // TODO: investigate if we need sample compensation here
 
@@ -78,6 +78,8 @@ protected:
 
     RenderingResult pushFrameToOutput(const Frame &frame);
 
+    bool resampleIntoSink(const Frame &frame);
+
     void pushFrameToBufferOutput(const Frame &frame);
 
     void onPlaybackRateChanged() override;
@@ -0,0 +1,124 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegavobjectpool_p.h"
+
+#include <qloggingcategory.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+Q_STATIC_LOGGING_CATEGORY(qLcAVObjectPool, "qt.multimedia.ffmpeg.avobjectpool");
+
+// Log the counters each time the number of allocations gets a multiple of the value
+static constexpr quint64 CountersLoggingPeriod = 1000;
+
+static QDebug operator<<(QDebug dbg, const AVObjectPool::Counters &counters)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "allocated: " << counters.allocated << ", reused: " << counters.reused
+                  << ", recycled: " << counters.recycled;
+    return dbg;
+}
+
+template <typename UPtr>
+UPtr AVObjectPool::Storage<UPtr>::take()
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (!objects.empty()) {
+            UPtr result = std::move(objects.back());
+            objects.pop_back();
+            reused.fetchAndAddRelaxed(1);
+            return result;
+        }
+    }
+
+    allocated.fetchAndAddRelaxed(1);
+    return {};
+}
+
+template <typename UPtr>
+void AVObjectPool::Storage<UPtr>::put(UPtr object)
+{
+    QMutexLocker locker(&mutex);
+    if (qsizetype(objects.size()) < maxSize) {
+        objects.push_back(std::move(object));
+        recycled.fetchAndAddRelaxed(1);
+    }
+
+    // otherwise, the object is freed by its deleter
+}
+
+template <typename UPtr>
+AVObjectPool::Counters AVObjectPool::Storage<UPtr>::counters() const
+{
+    return { allocated.loadRelaxed(), reused.loadRelaxed(), recycled.loadRelaxed() };
+}
+
+AVObjectPool::AVObjectPool(qsizetype maxPooledPackets, qsizetype maxPooledFrames)
+{
+    m_packets.maxSize = maxPooledPackets;
+    m_frames.maxSize = maxPooledFrames;
+}
+
+AVObjectPool::~AVObjectPool()
+{
+    qCDebug(qLcAVObjectPool) << "Delete AV object pool. Packets:" << packetCounters()
+                             << "frames:" << frameCounters();
+}
+
+AVPacketUPtr AVObjectPool::acquirePacket()
+{
+    if (auto packet = m_packets.take())
+        return packet;
+
+    if (m_packets.allocated.loadRelaxed() % CountersLoggingPeriod == 0)
+        qCDebug(qLcAVObjectPool) << "Packets:" << packetCounters();
+
+    return AVPacketUPtr(av_packet_alloc());
+}
+
+void AVObjectPool::recyclePacket(AVPacketUPtr packet)
+{
+    if (!packet)
+        return;
+
+    av_packet_unref(packet.get());
+    m_packets.put(std::move(packet));
+}
+
+AVFrameUPtr AVObjectPool::acquireFrame()
+{
+    if (auto frame = m_frames.take())
+        return frame;
+
+    if (m_frames.allocated.loadRelaxed() % CountersLoggingPeriod == 0)
+        qCDebug(qLcAVObjectPool) << "Frames:" << frameCounters();
+
+    return makeAVFrame();
+}
+
+void AVObjectPool::recycleFrame(AVFrameUPtr frame)
+{
+    if (!frame)
+        return;
+
+    av_frame_unref(frame.get());
+    m_frames.put(std::move(frame));
+}
+
+AVObjectPool::Counters AVObjectPool::packetCounters() const
+{
+    return m_packets.counters();
+}
+
+AVObjectPool::Counters AVObjectPool::frameCounters() const
+{
+    return m_frames.counters();
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
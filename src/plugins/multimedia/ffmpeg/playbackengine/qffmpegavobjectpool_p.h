@@ -0,0 +1,91 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGAVOBJECTPOOL_P_H
+#define QFFMPEGAVOBJECTPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* Recycles AVPacket and AVFrame shells between the playback engine objects.
+ *
+ * Packets and frames are allocated in one thread (demuxer, stream decoders) and
+ * released in another one (stream decoders, renderers), so the pool is thread-safe.
+ * Recycled objects are unreferenced, so the pool keeps no media data alive;
+ * decoded frame data is already recycled by the codecs' internal buffer pools.
+ *
+ * The pool is shared between the engine and the objects, as the objects
+ * and the packets/frames may outlive the engine.
+ */
+class AVObjectPool
+{
+public:
+    struct Counters
+    {
+        quint64 allocated = 0;
+        quint64 reused = 0;
+        quint64 recycled = 0;
+    };
+
+    explicit AVObjectPool(qsizetype maxPooledPackets = 128, qsizetype maxPooledFrames = 32);
+
+    ~AVObjectPool();
+
+    AVPacketUPtr acquirePacket();
+
+    void recyclePacket(AVPacketUPtr packet);
+
+    AVFrameUPtr acquireFrame();
+
+    void recycleFrame(AVFrameUPtr frame);
+
+    Counters packetCounters() const;
+
+    Counters frameCounters() const;
+
+private:
+    template <typename UPtr>
+    struct Storage
+    {
+        mutable QMutex mutex;
+        std::vector<UPtr> objects;
+        qsizetype maxSize = 0;
+        QAtomicInteger<quint64> allocated = 0;
+        QAtomicInteger<quint64> reused = 0;
+        QAtomicInteger<quint64> recycled = 0;
+
+        UPtr take();
+        void put(UPtr object);
+        Counters counters() const;
+    };
+
+    Storage<AVPacketUPtr> m_packets;
+    Storage<AVFrameUPtr> m_frames;
+};
+
+using AVObjectPoolPtr = std::shared_ptr<AVObjectPool>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGAVOBJECTPOOL_P_H
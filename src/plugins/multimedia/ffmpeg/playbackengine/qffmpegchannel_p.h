@@ -0,0 +1,265 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGCHANNEL_P_H
+#define QFFMPEGCHANNEL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "playbackengine/qffmpegframe_p.h"
+#include "playbackengine/qffmpegpacket_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qqueue.h>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Bounded single-producer, single-consumer wait-free queue.
+// Unlike QtPrivate::QAudioRingBuffer, slots are cleared on pop so that
+// reference-counted payloads (packets, frames) are released as soon as
+// they are consumed.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(qsizetype capacity) : m_slots(capacity + 1) { Q_ASSERT(capacity > 0); }
+
+    // Producer side. The value is moved from only if the push succeeds.
+    bool push(T &&value)
+    {
+        const qsizetype tail = m_tail.loadRelaxed();
+        const qsizetype next = increment(tail);
+        if (next == m_head.loadAcquire())
+            return false;
+
+        m_slots[tail] = std::move(value);
+        m_tail.storeRelease(next);
+        return true;
+    }
+
+    // Consumer side
+    std::optional<T> pop()
+    {
+        const qsizetype head = m_head.loadRelaxed();
+        if (head == m_tail.loadAcquire())
+            return {};
+
+        std::optional<T> result = std::exchange(m_slots[head], T{});
+        m_head.storeRelease(increment(head));
+        return result;
+    }
+
+    // CAVEAT: the result may be outdated by the time it's checked
+    bool isEmpty() const { return m_head.loadAcquire() == m_tail.loadAcquire(); }
+
+    qsizetype capacity() const { return qsizetype(m_slots.size()) - 1; }
+
+private:
+    qsizetype increment(qsizetype index) const
+    {
+        return ++index == qsizetype(m_slots.size()) ? 0 : index;
+    }
+
+private:
+    std::vector<T> m_slots;
+    QAtomicInteger<qsizetype> m_head = 0;
+    QAtomicInteger<qsizetype> m_tail = 0;
+};
+
+/* Channel links two playback engine objects living in different threads
+ * without going through queued signals for every item.
+ *
+ * - Items flow from the producer to the consumer through a bounded wait-free queue;
+ *   processed items flow back the same way, so that the producer can update its
+ *   buffering metrics.
+ * - Wakeups are coalesced: an event is posted to the peer object only if the peer
+ *   hasn't been notified since it last looked at the channel. With a steady data flow,
+ *   this gives one event per batch instead of one per item.
+ * - If a queue is full, pushed items are kept in a backlog of the pushing side, which is
+ *   flushed as soon as the other side frees some space. For items, isSaturated() reports
+ *   it; the producer is expected to stop producing until the consumer releases items.
+ *   This is the backpressure mechanism.
+ * - Only the wakeup target registration is guarded by a mutex, as the target may be
+ *   unset from its own thread on deletion; data transfers are lock-free.
+ */
+template <typename T>
+class Channel : public std::enable_shared_from_this<Channel<T>>
+{
+public:
+    using Handler = std::function<void()>;
+
+    explicit Channel(qsizetype capacity) : m_items(capacity), m_released(capacity * 2) { }
+
+    // Producer side
+
+    void push(T item)
+    {
+        m_items.push(std::move(item));
+        notify(m_consumer);
+    }
+
+    bool isSaturated() const { return m_items.hasBacklog(); }
+
+    template <typename Functor>
+    void takeReleased(Functor &&handler)
+    {
+        if (m_items.flush())
+            notify(m_consumer);
+
+        bool released = false;
+        while (auto item = m_released.queue.pop()) {
+            handler(*item);
+            released = true;
+        }
+
+        // the consumer has to be woken up to flush its backlog into the freed space
+        if (released && m_released.backlogged.loadAcquire())
+            notify(m_consumer);
+    }
+
+    void setProducer(QObject *context, Handler handler)
+    {
+        setEndpoint(m_producer, context, std::move(handler));
+    }
+
+    // Consumer side
+
+    std::optional<T> pop()
+    {
+        if (m_released.flush())
+            notify(m_producer);
+
+        auto result = m_items.queue.pop();
+        if (result && m_items.backlogged.loadAcquire())
+            notify(m_producer);
+
+        return result;
+    }
+
+    bool hasItems() const { return !m_items.queue.isEmpty(); }
+
+    void release(T item)
+    {
+        m_released.push(std::move(item));
+        notify(m_producer);
+    }
+
+    void setConsumer(QObject *context, Handler handler)
+    {
+        setEndpoint(m_consumer, context, std::move(handler));
+    }
+
+private:
+    // The queue with a backlog accessed by the pushing side only
+    struct BackloggedQueue
+    {
+        explicit BackloggedQueue(qsizetype capacity) : queue(capacity) { }
+
+        void push(T &&item)
+        {
+            flush();
+            if (!backlog.empty() || !queue.push(std::move(item))) {
+                backlog.enqueue(std::move(item));
+                backlogged.storeRelease(true);
+            }
+        }
+
+        bool flush()
+        {
+            bool flushed = false;
+            while (!backlog.empty() && queue.push(std::move(backlog.head()))) {
+                backlog.dequeue();
+                flushed = true;
+            }
+
+            if (flushed && backlog.empty())
+                backlogged.storeRelease(false);
+
+            return flushed;
+        }
+
+        bool hasBacklog() const { return !backlog.empty(); }
+
+        SpscQueue<T> queue;
+        QQueue<T> backlog;
+        QAtomicInteger<bool> backlogged = false;
+    };
+
+    struct Endpoint
+    {
+        Endpoint(BackloggedQueue &ownQueue) : ownQueue(ownQueue) { }
+
+        QMutex mutex;
+        QObject *context = nullptr;
+        Handler handler;
+        QAtomicInteger<bool> notified = false;
+        BackloggedQueue &ownQueue; // the queue the endpoint pushes to
+    };
+
+    void setEndpoint(Endpoint &endpoint, QObject *context, Handler handler)
+    {
+        QMutexLocker locker(&endpoint.mutex);
+        endpoint.context = context;
+        endpoint.handler = std::move(handler);
+        // Re-arm the notification; the new endpoint is expected to look at the channel
+        // right after the registration.
+        endpoint.notified.storeRelease(false);
+    }
+
+    void notify(Endpoint &endpoint)
+    {
+        if (!endpoint.notified.testAndSetAcquire(false, true))
+            return;
+
+        QMutexLocker locker(&endpoint.mutex);
+        if (!endpoint.context)
+            return; // the flag stays raised until a new endpoint is set
+
+        auto wakeup = [self = this->shared_from_this(), &endpoint]() {
+            endpoint.notified.storeRelease(false);
+            if (endpoint.ownQueue.flush())
+                self->notify(&endpoint == &self->m_producer ? self->m_consumer
+                                                            : self->m_producer);
+            if (endpoint.handler)
+                endpoint.handler();
+        };
+
+        QMetaObject::invokeMethod(endpoint.context, std::move(wakeup), Qt::QueuedConnection);
+    }
+
+private:
+    BackloggedQueue m_items;
+    BackloggedQueue m_released;
+
+    Endpoint m_producer{ m_items };
+    Endpoint m_consumer{ m_released };
+};
+
+using PacketChannel = Channel<Packet>;
+using FrameChannel = Channel<Frame>;
+
+using PacketChannelPtr = std::shared_ptr<PacketChannel>;
+using FrameChannelPtr = std::shared_ptr<FrameChannel>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGCHANNEL_P_H
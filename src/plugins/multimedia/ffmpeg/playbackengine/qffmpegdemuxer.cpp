@@ -4,13 +4,14 @@
 #include "playbackengine/qffmpegdemuxer_p.h"
 #include <qloggingcategory.h>
 
-QT_BEGIN_NAMESPACE
+#include <algorithm>
+#include <chrono>
 
-// 4 sec for buffering. TODO: maybe move to env var customization
-static constexpr qint64 MaxBufferedDurationUs = 4'000'000;
+QT_BEGIN_NAMESPACE
 
-// around 4 sec of hdr video
-static constexpr qint64 MaxBufferedSize = 32 * 1024 * 1024;
+// The adaptive buffering re-evaluates the read throughput each time
+// the given media duration has been demuxed.
+static constexpr qint64 ThroughputMeasurementDurationUs = 1'000'000;
 
 namespace QFFmpeg {
 
@@ -44,8 +45,14 @@ static bool isPacketWithinStreamDuration(const AVFormatContext *context, const P
 }
 
 Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-                 const StreamIndexes &streamIndexes, int loops)
-    : m_context(context), m_posWithOffset(posWithOffset), m_loops(loops)
+                 const StreamIndexes &streamIndexes, int loops, AVObjectPoolPtr pool,
+                 const QPlaybackBufferingPolicy &bufferingPolicy)
+    : m_context(context),
+      m_posWithOffset(posWithOffset),
+      m_loops(loops),
+      m_pool(std::move(pool)),
+      m_bufferingPolicy(bufferingPolicy.normalized()),
+      m_bufferingScale(m_bufferingPolicy.boundedScale(1.f))
 {
     qCDebug(qLcDemuxer) << "Create demuxer."
                         << "pos:" << posWithOffset.pos << "loop offset:" << posWithOffset.offset.pos
@@ -62,13 +69,25 @@ Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffs
     }
 }
 
+Demuxer::~Demuxer()
+{
+    for (auto &[index, streamData] : m_streams)
+        if (streamData.channel)
+            streamData.channel->setProducer(nullptr, {});
+}
+
 void Demuxer::doNextStep()
 {
     ensureSeeked();
 
-    Packet packet(m_posWithOffset.offset, AVPacketUPtr{ av_packet_alloc() }, id());
-    if (av_read_frame(m_context, packet.avPacket()) < 0
-        || !isPacketWithinStreamDuration(m_context, packet)) {
+    Packet packet(m_posWithOffset.offset, m_pool->acquirePacket(), id(), m_pool);
+
+    const auto readStartTime = std::chrono::steady_clock::now();
+    const bool readFailed = av_read_frame(m_context, packet.avPacket()) < 0;
+    const auto readTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - readStartTime);
+
+    if (readFailed || !isPacketWithinStreamDuration(m_context, packet)) {
         ++m_posWithOffset.offset.index;
 
         const auto loops = m_loops.loadAcquire();
@@ -78,6 +97,12 @@ void Demuxer::doNextStep()
             if (!std::exchange(m_buffered, true))
                 emit packetsBuffered();
 
+            // Channels deliver the final packet in order with the other ones,
+            // signals use atEnd() instead.
+            for (auto &[index, streamData] : m_streams)
+                if (streamData.channel)
+                    streamData.channel->push({});
+
             setAtEnd(true);
         } else {
             m_seeked = false;
@@ -106,14 +131,24 @@ void Demuxer::doNextStep()
         auto &streamData = it->second;
 
         const auto endPos = packetEndPos(stream, packet);
-        m_maxPacketsEndPos = qMax(m_maxPacketsEndPos, endPos);
+        const auto prevMaxPacketsEndPos = std::exchange(m_maxPacketsEndPos,
+                                                        qMax(m_maxPacketsEndPos, endPos));
+
+        if (m_bufferingPolicy.mode == QPlaybackBufferingPolicy::Adaptive)
+            updateReadThroughput(readTime, prevMaxPacketsEndPos);
+
+        if (m_videoKeyframeIndex && streamData.trackType == QPlatformMediaPlayer::VideoStream
+            && (avPacket.flags & AV_PKT_FLAG_KEY) && avPacket.pts != AV_NOPTS_VALUE)
+            m_videoKeyframeIndex->addKeyframe(streamTimeToUs(stream, avPacket.pts));
 
         // Increase buffered metrics as the packet has been processed.
 
         streamData.bufferedDuration += streamTimeToUs(stream, avPacket.duration);
         streamData.bufferedSize += avPacket.size;
+        ++streamData.bufferedPackets;
         streamData.maxSentPacketsPos = qMax(streamData.maxSentPacketsPos, endPos);
         updateStreamDataLimitFlag(streamData);
+        reportBufferedData(streamData);
 
         if (!m_buffered && streamData.isDataLimitReached) {
             m_buffered = true;
@@ -126,8 +161,7 @@ void Demuxer::doNextStep()
             emit firstPacketFound(std::chrono::steady_clock::now(), pos);
         }
 
-        auto signal = signalByTrackType(it->second.trackType);
-        emit (this->*signal)(packet);
+        sendPacket(streamData, std::move(packet));
     }
 
     scheduleNextStep(false);
@@ -140,35 +174,73 @@ void Demuxer::onPacketProcessed(Packet packet)
     if (packet.sourceId() != id())
         return;
 
-    auto &avPacket = *packet.avPacket();
-
-    const auto streamIndex = avPacket.stream_index;
-    const auto stream = m_context->streams[streamIndex];
-    auto it = m_streams.find(streamIndex);
-
-    if (it != m_streams.end()) {
-        auto &streamData = it->second;
+    auto it = m_streams.find(packet.avPacket()->stream_index);
 
-        // Decrease buffered metrics as new data (the packet) has been received (buffered)
+    if (it != m_streams.end())
+        updateStreamDataProcessed(it->second, packet);
 
-        streamData.bufferedDuration -= streamTimeToUs(stream, avPacket.duration);
-        streamData.bufferedSize -= avPacket.size;
-        streamData.maxProcessedPacketPos =
-                qMax(streamData.maxProcessedPacketPos, packetEndPos(stream, packet));
+    scheduleNextStep();
+}
 
-        Q_ASSERT(it->second.bufferedDuration >= 0);
-        Q_ASSERT(it->second.bufferedSize >= 0);
+void Demuxer::sendPacket(StreamData &streamData, Packet packet)
+{
+    if (streamData.channel) {
+        streamData.channel->push(std::move(packet));
+    } else {
+        auto signal = signalByTrackType(streamData.trackType);
+        emit (this->*signal)(packet);
+    }
+}
 
-        updateStreamDataLimitFlag(streamData);
+void Demuxer::onPacketsReleased()
+{
+    for (auto &[index, streamData] : m_streams) {
+        if (!streamData.channel)
+            continue;
+
+        streamData.channel->takeReleased([&](const Packet &packet) {
+            if (packet.sourceId() == id())
+                updateStreamDataProcessed(streamData, packet);
+        });
     }
 
     scheduleNextStep();
 }
 
+void Demuxer::updateStreamDataProcessed(StreamData &streamData, const Packet &packet)
+{
+    auto &avPacket = *packet.avPacket();
+    const auto stream = m_context->streams[avPacket.stream_index];
+
+    // Decrease buffered metrics as new data (the packet) has been received (buffered)
+
+    streamData.bufferedDuration -= streamTimeToUs(stream, avPacket.duration);
+    streamData.bufferedSize -= avPacket.size;
+    --streamData.bufferedPackets;
+    streamData.maxProcessedPacketPos =
+            qMax(streamData.maxProcessedPacketPos, packetEndPos(stream, packet));
+
+    Q_ASSERT(streamData.bufferedDuration >= 0);
+    Q_ASSERT(streamData.bufferedSize >= 0);
+    Q_ASSERT(streamData.bufferedPackets >= 0);
+
+    updateStreamDataLimitFlag(streamData);
+    reportBufferedData(streamData);
+}
+
+void Demuxer::reportBufferedData(const StreamData &streamData) const
+{
+    if (auto reporter = statisticsReporter())
+        reporter->setBufferedData(streamData.trackType, streamData.bufferedDuration,
+                                  streamData.bufferedSize, streamData.bufferedPackets);
+}
+
 bool Demuxer::canDoNextStep() const
 {
     auto isDataLimitReached = [](const auto &streamIndexToData) {
-        return streamIndexToData.second.isDataLimitReached;
+        const auto &streamData = streamIndexToData.second;
+        return streamData.isDataLimitReached
+                || (streamData.channel && streamData.channel->isSaturated());
     };
 
     // Demuxer waits:
@@ -176,6 +248,7 @@ bool Demuxer::canDoNextStep() const
     //     - if the end has been reached
     //     - if streams are empty (probably, should be handled on the initialization)
     //     - if at least one of the streams has reached the data limit (duration or size)
+    //       or its channel is saturated
 
     return PlaybackEngineObject::canDoNextStep() && !isAtEnd() && !m_streams.empty()
             && std::none_of(m_streams.begin(), m_streams.end(), isDataLimitReached);
@@ -201,9 +274,27 @@ void Demuxer::ensureSeeked()
         }
     }
 
+    // Containers may load their indexes on seeking
+    updateKeyframeIndex();
+
     setAtEnd(false);
 }
 
+void Demuxer::setVideoKeyframeIndex(KeyframeIndexPtr index)
+{
+    m_videoKeyframeIndex = std::move(index);
+}
+
+void Demuxer::updateKeyframeIndex()
+{
+    if (!m_videoKeyframeIndex)
+        return;
+
+    for (auto &[index, streamData] : m_streams)
+        if (streamData.trackType == QPlatformMediaPlayer::VideoStream)
+            m_videoKeyframeIndex->importStreamEntries(m_context->streams[index]);
+}
+
 Demuxer::RequestingSignal Demuxer::signalByTrackType(QPlatformMediaPlayer::TrackType trackType)
 {
     switch (trackType) {
@@ -226,13 +317,85 @@ void Demuxer::setLoops(int loopsCount)
     m_loops.storeRelease(loopsCount);
 }
 
+void Demuxer::setPacketChannel(QPlatformMediaPlayer::TrackType trackType,
+                               PacketChannelPtr channel)
+{
+    for (auto &[index, streamData] : m_streams) {
+        if (streamData.trackType != trackType)
+            continue;
+
+        channel->setProducer(this, [this]() { onPacketsReleased(); });
+        streamData.channel = std::move(channel);
+        return;
+    }
+}
+
+void Demuxer::setBufferingPolicy(const QPlaybackBufferingPolicy &policy)
+{
+    QMetaObject::invokeMethod(this, [this, policy]() {
+        qCDebug(qLcDemuxer) << "Set buffering policy, mode:" << policy.mode;
+
+        m_bufferingPolicy = policy.normalized();
+        m_bufferingScale = m_bufferingPolicy.boundedScale(m_bufferingScale);
+        updateAllStreamDataLimitFlags();
+        scheduleNextStep();
+    });
+}
+
+void Demuxer::updateReadThroughput(std::chrono::microseconds readTime, qint64 prevMaxPacketsEndPos)
+{
+    m_readTime += readTime;
+    m_readMediaDuration += m_maxPacketsEndPos - prevMaxPacketsEndPos;
+
+    if (m_readMediaDuration < ThroughputMeasurementDurationUs)
+        return;
+
+    // How many times faster than the playback the source is read
+    const float readSpeedFactor = m_readTime.count() > 0
+            ? float(m_readMediaDuration) / float(m_readTime.count())
+            : QPlaybackBufferingPolicy::FastReadSpeedFactor;
+
+    m_readTime = {};
+    m_readMediaDuration = 0;
+
+    const float prevScale = std::exchange(
+            m_bufferingScale, m_bufferingPolicy.adaptedScale(m_bufferingScale, readSpeedFactor));
+
+    if (!qFuzzyCompare(prevScale, m_bufferingScale)) {
+        qCDebug(qLcDemuxer) << "Read speed factor:" << readSpeedFactor
+                            << "buffering scale:" << m_bufferingScale;
+        updateAllStreamDataLimitFlags();
+    }
+}
+
+void Demuxer::updateAllStreamDataLimitFlags()
+{
+    for (auto &[index, streamData] : m_streams)
+        updateStreamDataLimitFlag(streamData);
+}
+
 void Demuxer::updateStreamDataLimitFlag(StreamData &streamData)
 {
+    const auto &budget = m_bufferingPolicy.budgets[size_t(streamData.trackType)];
+    // The watermarks of a normalized policy are positive; the scaled ones must stay positive
+    // too, or the stream would be limited with nothing buffered.
+    const auto scaled = [this](auto value) {
+        return std::max(qint64(value * m_bufferingScale), qint64(1));
+    };
+
+    // Once the high watermark is reached, the stream stays limited
+    // until the buffered data gets below the low watermark.
+    const qint64 maxDuration = scaled(streamData.isDataLimitReached
+                                              ? budget.lowWatermarkDuration.count()
+                                              : budget.highWatermarkDuration.count());
+    const qint64 maxSize = scaled(streamData.isDataLimitReached ? budget.lowWatermarkSize
+                                                                : budget.highWatermarkSize);
+
     const auto packetsPosDiff = streamData.maxSentPacketsPos - streamData.maxProcessedPacketPos;
     streamData.isDataLimitReached =
-           streamData.bufferedDuration >= MaxBufferedDurationUs
-        || (streamData.bufferedDuration == 0 && packetsPosDiff >= MaxBufferedDurationUs)
-        || streamData.bufferedSize >= MaxBufferedSize;
+           streamData.bufferedDuration >= maxDuration
+        || (streamData.bufferedDuration == 0 && packetsPosDiff >= maxDuration)
+        || streamData.bufferedSize >= maxSize;
 }
 
 } // namespace QFFmpeg
@@ -16,9 +16,13 @@
 
 #include "playbackengine/qffmpegplaybackengineobject_p.h"
 #include "private/qplatformmediaplayer_p.h"
+#include "private/qplaybackbufferingpolicy_p.h"
 #include "playbackengine/qffmpegpacket_p.h"
+#include "playbackengine/qffmpegchannel_p.h"
+#include "playbackengine/qffmpegkeyframeindex_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
 
+#include <chrono>
 #include <unordered_map>
 
 QT_BEGIN_NAMESPACE
@@ -30,13 +34,26 @@ class Demuxer : public PlaybackEngineObject
     Q_OBJECT
 public:
     Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-            const StreamIndexes &streamIndexes, int loops);
+            const StreamIndexes &streamIndexes, int loops, AVObjectPoolPtr pool,
+            const QPlaybackBufferingPolicy &bufferingPolicy);
+
+    ~Demuxer() override;
 
     using RequestingSignal = void (Demuxer::*)(Packet);
     static RequestingSignal signalByTrackType(QPlatformMediaPlayer::TrackType trackType);
 
     void setLoops(int loopsCount);
 
+    void setBufferingPolicy(const QPlaybackBufferingPolicy &policy);
+
+    // Replaces the requesting signal of the track type with the channel.
+    // Must be called before the demuxer is unpaused.
+    void setPacketChannel(QPlatformMediaPlayer::TrackType trackType, PacketChannelPtr channel);
+
+    // Sets the index to be filled with the keyframes of the video stream.
+    // Must be called before the demuxer is unpaused.
+    void setVideoKeyframeIndex(KeyframeIndexPtr index);
+
 public slots:
     void onPacketProcessed(Packet);
 
@@ -54,21 +71,38 @@ private:
 
     void ensureSeeked();
 
+    void onPacketsReleased();
+
 private:
     struct StreamData
     {
         QPlatformMediaPlayer::TrackType trackType = QPlatformMediaPlayer::TrackType::NTrackTypes;
         qint64 bufferedDuration = 0;
         qint64 bufferedSize = 0;
+        qint64 bufferedPackets = 0;
 
         qint64 maxSentPacketsPos = 0;
         qint64 maxProcessedPacketPos = 0;
 
         bool isDataLimitReached = false;
+
+        PacketChannelPtr channel;
     };
 
     void updateStreamDataLimitFlag(StreamData &streamData);
 
+    void reportBufferedData(const StreamData &streamData) const;
+
+    void updateStreamDataProcessed(StreamData &streamData, const Packet &packet);
+
+    void updateReadThroughput(std::chrono::microseconds readTime, qint64 prevMaxPacketsEndPos);
+
+    void updateAllStreamDataLimitFlags();
+
+    void updateKeyframeIndex();
+
+    void sendPacket(StreamData &streamData, Packet packet);
+
 private:
     AVFormatContext *m_context = nullptr;
     bool m_seeked = false;
@@ -77,6 +111,15 @@ private:
     PositionWithOffset m_posWithOffset;
     qint64 m_maxPacketsEndPos = 0;
     QAtomicInt m_loops = QMediaPlayer::Once;
+    AVObjectPoolPtr m_pool;
+    KeyframeIndexPtr m_videoKeyframeIndex;
+
+    QPlaybackBufferingPolicy m_bufferingPolicy;
+    float m_bufferingScale = 1.f;
+
+    // Read throughput measurement for the adaptive buffering
+    std::chrono::microseconds m_readTime{ 0 };
+    qint64 m_readMediaDuration = 0;
     bool m_buffered = false;
 };
 
@@ -18,6 +18,7 @@
 #include "qffmpeg_p.h"
 #include "playbackengine/qffmpegcodec_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "playbackengine/qffmpegavobjectpool_p.h"
 #include "QtCore/qsharedpointer.h"
 #include "qpointer.h"
 #include "qobject.h"
@@ -32,8 +33,13 @@ struct Frame
 {
     struct Data
     {
-        Data(const LoopOffset &offset, AVFrameUPtr f, const Codec &codec, qint64, quint64 sourceId)
-            : loopOffset(offset), codec(codec), frame(std::move(f)), sourceId(sourceId)
+        Data(const LoopOffset &offset, AVFrameUPtr f, const Codec &codec, qint64, quint64 sourceId,
+             AVObjectPoolPtr pool)
+            : loopOffset(offset),
+              codec(codec),
+              frame(std::move(f)),
+              sourceId(sourceId),
+              pool(std::move(pool))
         {
             Q_ASSERT(frame);
             if (frame->pts != AV_NOPTS_VALUE)
@@ -57,6 +63,13 @@ struct Frame
         {
         }
 
+        ~Data()
+        {
+            // the frame might have been taken by a renderer
+            if (pool)
+                pool->recycleFrame(std::move(frame));
+        }
+
         QAtomicInt ref;
         LoopOffset loopOffset;
         std::optional<Codec> codec;
@@ -65,12 +78,13 @@ struct Frame
         qint64 pts = -1;
         qint64 duration = -1;
         quint64 sourceId = 0;
+        AVObjectPoolPtr pool;
     };
     Frame() = default;
 
     Frame(const LoopOffset &offset, AVFrameUPtr f, const Codec &codec, qint64 pts,
-          quint64 sourceIndex)
-        : d(new Data(offset, std::move(f), codec, pts, sourceIndex))
+          quint64 sourceIndex, AVObjectPoolPtr pool = {})
+        : d(new Data(offset, std::move(f), codec, pts, sourceIndex, std::move(pool)))
     {
     }
     Frame(const LoopOffset &offset, const QString &text, qint64 pts, qint64 duration,
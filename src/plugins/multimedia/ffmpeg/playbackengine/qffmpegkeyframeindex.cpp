@@ -0,0 +1,114 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegkeyframeindex_p.h"
+
+#include <qloggingcategory.h>
+
+#include <algorithm>
+#include <iterator>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcKeyframeIndex, "qt.multimedia.ffmpeg.keyframeindex");
+
+namespace QFFmpeg {
+
+void KeyframeIndex::addKeyframe(qint64 pos)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Keyframes are mostly met in order, so check the end first
+    if (m_positions.empty() || m_positions.back() < pos) {
+        m_positions.push_back(pos);
+        return;
+    }
+
+    const auto it = std::lower_bound(m_positions.begin(), m_positions.end(), pos);
+    if (*it != pos)
+        m_positions.insert(it, pos);
+}
+
+void KeyframeIndex::importStreamEntries(const AVStream *stream)
+{
+    Q_ASSERT(stream);
+
+#if QT_FFMPEG_HAS_INDEX_ENTRIES_API
+    const int count = avformat_index_get_entries_count(stream);
+#else
+    const int count = stream->nb_index_entries;
+#endif
+
+    if (count == m_importedStreamEntriesCount)
+        return;
+
+    m_importedStreamEntriesCount = count;
+
+    std::vector<qint64> positions;
+    positions.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+#if QT_FFMPEG_HAS_INDEX_ENTRIES_API
+        const AVIndexEntry *entry = avformat_index_get_entry(const_cast<AVStream *>(stream), i);
+#else
+        const AVIndexEntry *entry = &stream->index_entries[i];
+#endif
+        if (!entry || !(entry->flags & AVINDEX_KEYFRAME))
+            continue;
+
+        if (const auto pos = timeStampUs(entry->timestamp, stream->time_base))
+            positions.push_back(*pos);
+    }
+
+    std::sort(positions.begin(), positions.end());
+
+    QMutexLocker locker(&m_mutex);
+
+    std::vector<qint64> merged;
+    merged.reserve(positions.size() + m_positions.size());
+    std::set_union(positions.begin(), positions.end(), m_positions.begin(), m_positions.end(),
+                   std::back_inserter(merged));
+    merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+    m_positions = std::move(merged);
+
+    qCDebug(qLcKeyframeIndex) << "Imported" << count << "stream index entries, keyframes:"
+                              << m_positions.size();
+}
+
+std::optional<qint64> KeyframeIndex::keyframeBefore(qint64 pos) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = std::upper_bound(m_positions.begin(), m_positions.end(), pos);
+    if (it == m_positions.begin())
+        return {};
+
+    return *std::prev(it);
+}
+
+std::optional<qint64> KeyframeIndex::nearestKeyframe(qint64 pos) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_positions.empty())
+        return {};
+
+    auto it = std::lower_bound(m_positions.begin(), m_positions.end(), pos);
+    if (it == m_positions.end())
+        return m_positions.back();
+    if (it == m_positions.begin())
+        return *it;
+
+    const auto prev = std::prev(it);
+    return pos - *prev <= *it - pos ? *prev : *it;
+}
+
+qsizetype KeyframeIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return qsizetype(m_positions.size());
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
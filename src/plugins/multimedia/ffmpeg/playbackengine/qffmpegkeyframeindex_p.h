@@ -0,0 +1,65 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGKEYFRAMEINDEX_P_H
+#define QFFMPEGKEYFRAMEINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qmutex.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* Sorted positions (in microseconds, without loop offsets) of the keyframes of a stream.
+ *
+ * The index is built lazily: the demuxer imports the entries that the container has
+ * provided (e.g. mp4 sample tables, mkv cues after a seek) and adds the keyframes it meets
+ * while reading, so that the index grows as the media is played.
+ * The demuxer fills the index in its thread, the playback engine reads it in its thread.
+ */
+class KeyframeIndex
+{
+public:
+    void addKeyframe(qint64 pos);
+
+    // Imports the keyframe entries of the stream's internal index, if the count changed
+    // since the last import. Must be called from the thread that reads the stream.
+    void importStreamEntries(const AVStream *stream);
+
+    // The position of the last keyframe not after pos
+    std::optional<qint64> keyframeBefore(qint64 pos) const;
+
+    // The position of the keyframe closest to pos
+    std::optional<qint64> nearestKeyframe(qint64 pos) const;
+
+    qsizetype size() const;
+
+private:
+    mutable QMutex m_mutex;
+    std::vector<qint64> m_positions;
+    int m_importedStreamEntriesCount = 0; // accessed from the demuxer thread only
+};
+
+using KeyframeIndexPtr = std::shared_ptr<KeyframeIndex>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGKEYFRAMEINDEX_P_H
@@ -0,0 +1,108 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpeglateframecontroller_p.h"
+
+#include <QtCore/qnumeric.h>
+#include <qloggingcategory.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcLateFrameController, "qt.multimedia.ffmpeg.lateframecontroller");
+
+namespace QFFmpeg {
+
+using namespace std::chrono_literals;
+
+// Frames presented later than that are counted as late
+static constexpr auto LateFrameThreshold = 20ms;
+
+// Keep the video alive even if the renderer can't catch up at all
+static constexpr int MaxConsecutiveDrops = 8;
+
+// The average lateness thresholds of switching the decoder's skip_frame.
+// The upper and the lower ones differ to avoid flapping between the levels.
+static constexpr auto SkipNonRefEnterLateness = 50ms;
+static constexpr auto SkipNonRefLeaveLateness = 10ms;
+static constexpr auto SkipNonKeyEnterLateness = 250ms;
+static constexpr auto SkipNonKeyLeaveLateness = 100ms;
+
+bool LateFrameController::onFrame(std::chrono::microseconds lateness,
+                                  std::chrono::microseconds frameDuration, float playbackRate)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // The frame is displayed for its duration divided by the rate
+    const std::chrono::microseconds displayInterval = playbackRate > 0.f
+            ? std::chrono::microseconds(qRound64(frameDuration.count() / double(playbackRate)))
+            : frameDuration;
+
+    lateness = std::max(lateness, 0us);
+
+    // Only key frames are decoded while skipping non-key ones,
+    // so each of them should count more.
+    const int smoothing = m_skipFrame == AVDISCARD_NONKEY ? 2 : 8;
+    m_averageLateness += (lateness - m_averageLateness) / smoothing;
+
+    updateSkipFrame();
+
+    const bool shouldDrop = m_hasPresentedFrame && m_consecutiveDrops < MaxConsecutiveDrops
+            && lateness > std::max(displayInterval, std::chrono::microseconds(LateFrameThreshold));
+
+    if (shouldDrop) {
+        ++m_consecutiveDrops;
+        ++m_statistics.droppedFrames;
+        qCDebug(qLcLateFrameController) << "Drop late frame, lateness:" << lateness.count()
+                                        << "average:" << m_averageLateness.count();
+        return true;
+    }
+
+    m_consecutiveDrops = 0;
+    m_hasPresentedFrame = true;
+    ++m_statistics.presentedFrames;
+    if (lateness > LateFrameThreshold)
+        ++m_statistics.lateFrames;
+
+    return false;
+}
+
+void LateFrameController::resetLateness()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_averageLateness = 0us;
+    m_hasPresentedFrame = false;
+    m_consecutiveDrops = 0;
+    updateSkipFrame();
+}
+
+QPlaybackVideoFrameStatistics LateFrameController::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+void LateFrameController::updateSkipFrame()
+{
+    const AVDiscard current = m_skipFrame;
+    AVDiscard skipFrame = current;
+
+    if (m_averageLateness > SkipNonKeyEnterLateness)
+        skipFrame = AVDISCARD_NONKEY;
+    else if (m_averageLateness > SkipNonRefEnterLateness && current == AVDISCARD_DEFAULT)
+        skipFrame = AVDISCARD_NONREF;
+    else if (m_averageLateness < SkipNonRefLeaveLateness)
+        skipFrame = AVDISCARD_DEFAULT;
+    else if (m_averageLateness < SkipNonKeyLeaveLateness && current == AVDISCARD_NONKEY)
+        skipFrame = AVDISCARD_NONREF;
+
+    if (skipFrame != current) {
+        qCDebug(qLcLateFrameController) << "Set skip_frame:" << skipFrame
+                                        << "average lateness:" << m_averageLateness.count();
+        m_skipFrame = skipFrame;
+    }
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
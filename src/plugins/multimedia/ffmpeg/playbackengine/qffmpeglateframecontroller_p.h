@@ -0,0 +1,77 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGLATEFRAMECONTROLLER_P_H
+#define QFFMPEGLATEFRAMECONTROLLER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpegdefs_p.h"
+
+#include <QtMultimedia/private/qplaybackstatistics_p.h>
+#include <QtCore/qmutex.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* Handles video frames when the video renderer falls behind the playback clock.
+ *
+ * The video renderer reports the lateness of each frame before presenting it.
+ * Frames that have missed their whole display interval are dropped before
+ * they're uploaded. As the smoothed lateness grows, the video stream decoder
+ * is told to skip non-reference frames, and then non-key frames, until the video
+ * catches up again.
+ *
+ * The controller lives as long as the media is loaded, and it's shared between
+ * the video renderer and the video stream decoders, which run in different threads.
+ */
+class LateFrameController
+{
+public:
+    // Returns true if the frame should be dropped instead of being presented.
+    // The lateness is measured on the wall clock, the duration on the media timeline.
+    bool onFrame(std::chrono::microseconds lateness, std::chrono::microseconds frameDuration,
+                 float playbackRate = 1.f);
+
+    // Forgets the lateness of the previous frames, e.g. after seeking;
+    // the statistics are kept.
+    void resetLateness();
+
+    // The decoders apply it to the next packets
+    AVDiscard skipFrame() const { return m_skipFrame.load(std::memory_order_relaxed); }
+
+    QPlaybackVideoFrameStatistics statistics() const;
+
+private:
+    void updateSkipFrame();
+
+private:
+    mutable QMutex m_mutex;
+    std::chrono::microseconds m_averageLateness{ 0 };
+    bool m_hasPresentedFrame = false;
+    int m_consecutiveDrops = 0;
+    QPlaybackVideoFrameStatistics m_statistics;
+
+    std::atomic<AVDiscard> m_skipFrame = AVDISCARD_DEFAULT;
+};
+
+using LateFrameControllerPtr = std::shared_ptr<LateFrameController>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGLATEFRAMECONTROLLER_P_H
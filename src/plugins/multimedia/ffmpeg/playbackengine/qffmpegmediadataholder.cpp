@@ -214,6 +214,21 @@ loadMedia(const QUrl &mediaUrl, QIODevice *stream, const std::shared_ptr<ICancel
     return context;
 }
 
+QPlaybackBufferingPolicy::SourceType sourceType(const QUrl &url, const QIODevice *stream)
+{
+    // sequential devices are typically network replies or pipes
+    if (stream)
+        return stream->isSequential() ? QPlaybackBufferingPolicy::NetworkSource
+                                      : QPlaybackBufferingPolicy::LocalSource;
+
+    const QString scheme = url.scheme();
+    if (url.isLocalFile() || scheme.isEmpty() || scheme == u"qrc" || scheme == u"content"
+        || scheme == u"assets")
+        return QPlaybackBufferingPolicy::LocalSource;
+
+    return QPlaybackBufferingPolicy::NetworkSource;
+}
+
 } // namespace
 
 MediaDataHolder::Maybe MediaDataHolder::create(const QUrl &url, QIODevice *stream,
@@ -222,7 +237,10 @@ MediaDataHolder::Maybe MediaDataHolder::create(const QUrl &url, QIODevice *strea
     QMaybe context = loadMedia(url, stream, cancelToken);
     if (context) {
         // MediaDataHolder is wrapped in a shared pointer to interop with signal/slot mechanism
-        return QSharedPointer<MediaDataHolder>{ new MediaDataHolder{ std::move(context.value()), cancelToken } };
+        QSharedPointer<MediaDataHolder> result{ new MediaDataHolder{ std::move(context.value()),
+                                                                     cancelToken } };
+        result->m_sourceType = sourceType(url, stream);
+        return result;
     }
     return context.error();
 }
@@ -367,11 +385,25 @@ bool MediaDataHolder::setActiveTrack(QPlatformMediaPlayer::TrackType type, int s
     // TODO: maybe add additional verifications
     m_currentAVStreamIndex[type] = avStreamIndex;
 
+    if (type == QPlatformMediaPlayer::VideoStream)
+        m_videoKeyframeIndex.reset();
+
     updateMetaData();
 
     return true;
 }
 
+KeyframeIndexPtr MediaDataHolder::videoKeyframeIndex()
+{
+    if (currentStreamIndex(QPlatformMediaPlayer::VideoStream) < 0)
+        return {};
+
+    if (!m_videoKeyframeIndex)
+        m_videoKeyframeIndex = std::make_shared<KeyframeIndex>();
+
+    return m_videoKeyframeIndex;
+}
+
 int MediaDataHolder::activeTrack(QPlatformMediaPlayer::TrackType type) const
 {
     return type < QPlatformMediaPlayer::NTrackTypes ? m_requestedStreams[type] : -1;
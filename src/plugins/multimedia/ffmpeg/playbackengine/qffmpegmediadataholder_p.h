@@ -18,8 +18,10 @@
 #include "qmediametadata.h"
 #include "private/qplatformmediaplayer_p.h"
 #include "qffmpeg_p.h"
+#include "playbackengine/qffmpegkeyframeindex_p.h"
 #include "qvideoframe.h"
 #include <private/qmultimediautils_p.h>
+#include <private/qplaybackbufferingpolicy_p.h>
 
 #include <array>
 #include <optional>
@@ -70,12 +72,18 @@ public:
 
     bool isSeekable() const { return m_isSeekable; }
 
+    QPlaybackBufferingPolicy::SourceType sourceType() const { return m_sourceType; }
+
     QtVideo::Rotation rotation() const;
 
     AVFormatContext *avContext();
 
     int currentStreamIndex(QPlatformMediaPlayer::TrackType trackType) const;
 
+    // The keyframe index of the current video stream; it's created on the first request
+    // and filled in by the demuxers. Returns null if there is no video stream.
+    KeyframeIndexPtr videoKeyframeIndex();
+
     using Maybe = QMaybe<QSharedPointer<MediaDataHolder>, ContextError>;
     static Maybe create(const QUrl &url, QIODevice *stream,
                         const std::shared_ptr<ICancelToken> &cancelToken);
@@ -91,6 +99,7 @@ private:
     AVFormatContextUPtr m_context;
 
     bool m_isSeekable = false;
+    QPlaybackBufferingPolicy::SourceType m_sourceType = QPlaybackBufferingPolicy::LocalSource;
 
     StreamIndexes m_currentAVStreamIndex = { -1, -1, -1 };
     StreamsMap m_streamMap;
@@ -98,6 +107,7 @@ private:
     qint64 m_duration = 0;
     QMediaMetaData m_metaData;
     std::optional<QImage> m_cachedThumbnail;
+    KeyframeIndexPtr m_videoKeyframeIndex;
 };
 
 } // namespace QFFmpeg
@@ -18,6 +18,7 @@
 #include "qffmpeg_p.h"
 #include "QtCore/qsharedpointer.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "playbackengine/qffmpegavobjectpool_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -27,19 +28,26 @@ struct Packet
 {
     struct Data
     {
-        Data(const LoopOffset &offset, AVPacketUPtr p, quint64 sourceId)
-            : loopOffset(offset), packet(std::move(p)), sourceId(sourceId)
+        Data(const LoopOffset &offset, AVPacketUPtr p, quint64 sourceId, AVObjectPoolPtr pool)
+            : loopOffset(offset), packet(std::move(p)), sourceId(sourceId), pool(std::move(pool))
         {
         }
 
+        ~Data()
+        {
+            if (pool)
+                pool->recyclePacket(std::move(packet));
+        }
+
         QAtomicInt ref;
         LoopOffset loopOffset;
         AVPacketUPtr packet;
         quint64 sourceId;
+        AVObjectPoolPtr pool;
     };
     Packet() = default;
-    Packet(const LoopOffset &offset, AVPacketUPtr p, quint64 sourceId)
-        : d(new Data(offset, std::move(p), sourceId))
+    Packet(const LoopOffset &offset, AVPacketUPtr p, quint64 sourceId, AVObjectPoolPtr pool = {})
+        : d(new Data(offset, std::move(p), sourceId, std::move(pool)))
     {
     }
 
@@ -41,6 +41,15 @@ PlaybackEngineObject::Id PlaybackEngineObject::id() const
     return m_id;
 }
 
+void PlaybackEngineObject::setStatisticsCollector(StatisticsCollectorPtr collector)
+{
+    Q_ASSERT(thread() == QThread::currentThread());
+    if (collector)
+        m_statisticsReporter.emplace(std::move(collector));
+    else
+        m_statisticsReporter.reset();
+}
+
 void PlaybackEngineObject::setPaused(bool isPaused)
 {
     if (m_paused.testAndSetRelease(!isPaused, isPaused))
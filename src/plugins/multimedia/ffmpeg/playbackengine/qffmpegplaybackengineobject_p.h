@@ -15,6 +15,7 @@
 //
 
 #include "playbackengine/qffmpegplaybackenginedefs_p.h"
+#include "playbackengine/qffmpegstatisticscollector_p.h"
 #include "qthread.h"
 #include "qatomic.h"
 
@@ -46,6 +47,9 @@ public:
 
     Id id() const;
 
+    // Must be set before the object is moved to its thread
+    void setStatisticsCollector(StatisticsCollectorPtr collector);
+
 signals:
     void atEnd();
 
@@ -66,11 +70,18 @@ protected:
 
     virtual void doNextStep() { }
 
+    // Null if the engine doesn't collect statistics
+    const StatisticsReporter *statisticsReporter() const
+    {
+        return m_statisticsReporter ? &*m_statisticsReporter : nullptr;
+    }
+
 private slots:
     void onTimeout();
 
 private:
     std::unique_ptr<QTimer> m_timer;
+    std::optional<StatisticsReporter> m_statisticsReporter;
 
     QAtomicInteger<bool> m_paused = true;
     QAtomicInteger<bool> m_atEnd = false;
@@ -0,0 +1,139 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegplaybackenginethreadpool_p.h"
+
+#include <qloggingcategory.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+Q_STATIC_LOGGING_CATEGORY(qLcPlaybackEngineThreadPool,
+                          "qt.multimedia.ffmpeg.playbackenginethreadpool");
+
+static const char *roleName(PlaybackEngineThreadPool::Role role)
+{
+    switch (role) {
+    case PlaybackEngineThreadPool::Demuxing:
+        return "Demuxing";
+    case PlaybackEngineThreadPool::Decoding:
+        return "Decoding";
+    case PlaybackEngineThreadPool::Rendering:
+        return "Rendering";
+    default:
+        Q_UNREACHABLE_RETURN("");
+    }
+}
+
+PlaybackEngineThreadPool &PlaybackEngineThreadPool::instance()
+{
+    static PlaybackEngineThreadPool pool;
+    return pool;
+}
+
+PlaybackEngineThreadPool::PlaybackEngineThreadPool()
+{
+    const int idealThreadCount = std::max(QThread::idealThreadCount(), 1);
+
+    m_roles[Demuxing].maxThreadCount = std::max(idealThreadCount / 2, 1);
+    m_roles[Decoding].maxThreadCount = idealThreadCount;
+    m_roles[Rendering].maxThreadCount = std::max(idealThreadCount / 2, 1);
+    m_roles[Rendering].priority = QThread::HighPriority;
+}
+
+PlaybackEngineThreadPool::~PlaybackEngineThreadPool()
+{
+    for (auto &role : m_roles)
+        for (auto &data : role.threads)
+            data.thread->quit();
+
+    for (auto &role : m_roles)
+        for (auto &data : role.threads)
+            data.thread->wait();
+}
+
+QThread *PlaybackEngineThreadPool::acquire(Role role, const std::vector<QThread *> &engineThreads)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto &roleData = m_roles[role];
+
+    auto isEngineThread = [&](const ThreadData &data) {
+        return std::find(engineThreads.begin(), engineThreads.end(), data.thread.get())
+                != engineThreads.end();
+    };
+
+    auto less = [&](const ThreadData &a, const ThreadData &b) {
+        return std::make_pair(isEngineThread(a), a.load)
+                < std::make_pair(isEngineThread(b), b.load);
+    };
+
+    auto it = std::min_element(roleData.threads.begin(), roleData.threads.end(), less);
+
+    const bool needNewThread = it == roleData.threads.end()
+            || (int(roleData.threads.size()) < roleData.maxThreadCount
+                && (it->load > 0 || isEngineThread(*it)));
+
+    if (needNewThread) {
+        auto thread = std::make_unique<QThread>();
+        thread->setObjectName(QStringLiteral("QFFmpeg%1Thread%2")
+                                      .arg(QLatin1StringView(roleName(role)))
+                                      .arg(roleData.threads.size()));
+        auto context = std::make_unique<QObject>();
+        context->moveToThread(thread.get());
+        thread->start(roleData.priority);
+
+        qCDebug(qLcPlaybackEngineThreadPool) << "Create thread" << thread->objectName();
+
+        roleData.threads.push_back({ std::move(thread), std::move(context), 0 });
+        it = std::prev(roleData.threads.end());
+    }
+
+    ++it->load;
+    return it->thread.get();
+}
+
+void PlaybackEngineThreadPool::release(QThread *thread)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (auto &role : m_roles) {
+        auto it = std::find_if(role.threads.begin(), role.threads.end(),
+                               [thread](const ThreadData &data) {
+                                   return data.thread.get() == thread;
+                               });
+        if (it != role.threads.end()) {
+            Q_ASSERT(it->load > 0);
+            --it->load;
+            return;
+        }
+    }
+
+    Q_ASSERT(!"Unknown thread released to the pool");
+}
+
+void PlaybackEngineThreadPool::waitForPostedEvents(QThread *thread)
+{
+    Q_ASSERT(thread != QThread::currentThread());
+
+    QObject *context = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto &role : m_roles)
+            for (auto &data : role.threads)
+                if (data.thread.get() == thread)
+                    context = data.context.get();
+    }
+
+    // Pool threads are never removed, so the context outlives the call. Posted events,
+    // including deferred deletions posted from other threads, are handled in order.
+    if (context)
+        QMetaObject::invokeMethod(context, [] {}, Qt::BlockingQueuedConnection);
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,84 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGPLAYBACKENGINETHREADPOOL_P_H
+#define QFFMPEGPLAYBACKENGINETHREADPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qthread.h"
+#include "qmutex.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* Process-wide set of threads shared by playback engines.
+ *
+ * Playback engine objects are QObjects driven by timers and queued invocations,
+ * so they are bound to a thread with an event loop and cannot migrate between
+ * threads per step. Instead of a thread per object, the pool assigns each object
+ * to the least loaded thread of its role and keeps it there during the object's
+ * lifetime. The number of threads depends on the number of cores, not on the number
+ * of players.
+ *
+ * - Demuxers, that may block on I/O, are kept apart from decoders.
+ * - Renderers get threads with a higher priority to keep the presentation smooth.
+ * - Threads that already host objects of the requesting engine are avoided
+ *   if possible, so that a single engine still decodes its tracks in parallel.
+ */
+class PlaybackEngineThreadPool
+{
+public:
+    enum Role { Demuxing, Decoding, Rendering, NRoles };
+
+    static PlaybackEngineThreadPool &instance();
+
+    ~PlaybackEngineThreadPool();
+
+    QThread *acquire(Role role, const std::vector<QThread *> &engineThreads);
+
+    void release(QThread *thread);
+
+    // Blocks until the events posted to the pool thread so far, e.g. the deferred deletions
+    // of playback engine objects, have been processed. Does nothing for other threads.
+    void waitForPostedEvents(QThread *thread);
+
+private:
+    PlaybackEngineThreadPool();
+
+    struct ThreadData
+    {
+        std::unique_ptr<QThread> thread;
+        std::unique_ptr<QObject> context; // lives in the thread, receives the sync calls
+        int load = 0;
+    };
+
+    struct RoleData
+    {
+        std::vector<ThreadData> threads;
+        int maxThreadCount = 1;
+        QThread::Priority priority = QThread::InheritPriority;
+    };
+
+    QMutex m_mutex;
+    std::array<RoleData, NRoles> m_roles;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGPLAYBACKENGINETHREADPOOL_P_H
@@ -18,6 +18,12 @@ Renderer::Renderer(const TimeController &tc, const std::chrono::microseconds &se
 {
 }
 
+Renderer::~Renderer()
+{
+    if (m_frameChannel)
+        m_frameChannel->setConsumer(nullptr, {});
+}
+
 void Renderer::syncSoft(TimePoint tp, qint64 trackTime)
 {
     QMetaObject::invokeMethod(this, [this, tp, trackTime]() {
@@ -66,6 +72,37 @@ bool Renderer::isStepForced() const
     return m_isStepForced;
 }
 
+void Renderer::setFrameChannel(FrameChannelPtr channel)
+{
+    QMetaObject::invokeMethod(this, [this, channel = std::move(channel)]() mutable {
+        if (m_frameChannel)
+            m_frameChannel->setConsumer(nullptr, {});
+
+        m_frameChannel = std::move(channel);
+
+        if (m_frameChannel) {
+            m_frameChannel->setConsumer(this, [this]() { onFramesAvailable(); });
+            onFramesAvailable();
+        }
+    });
+}
+
+void Renderer::onFramesAvailable()
+{
+    // The frames queue is limited by StreamDecoder::maxQueueSize,
+    // so it's fine to take all the frames at once.
+    while (auto frame = m_frameChannel->pop())
+        render(std::move(*frame));
+}
+
+void Renderer::releaseFrame(Frame frame)
+{
+    if (m_frameChannel)
+        m_frameChannel->release(std::move(frame));
+    else
+        emit frameProcessed(frame);
+}
+
 void Renderer::setInitialPosition(TimePoint tp, qint64 trackPos)
 {
     QMetaObject::invokeMethod(this, [this, tp, trackPos]() {
@@ -92,7 +129,7 @@ void Renderer::render(Frame frame)
     if (isFrameOutdated) {
         qCDebug(qLcRenderer) << "frame outdated! absEnd:" << frame.absoluteEnd() << "absPts"
                              << frame.absolutePts() << "seekPos:" << seekPosition();
-        emit frameProcessed(frame);
+        releaseFrame(std::move(frame));
         return;
     }
 
@@ -182,7 +219,7 @@ void Renderer::doNextStep()
                 emit loopChanged(id(), frame.loopOffset().pos, m_loopIndex);
             }
 
-            emit frameProcessed(frame);
+            releaseFrame(frame);
         } else {
             m_lastPosition.storeRelease(std::max(m_lastFrameEnd, lastPosition()));
         }
@@ -17,6 +17,7 @@
 #include "playbackengine/qffmpegplaybackengineobject_p.h"
 #include "playbackengine/qffmpegtimecontroller_p.h"
 #include "playbackengine/qffmpegframe_p.h"
+#include "playbackengine/qffmpegchannel_p.h"
 
 #include <QtCore/qpointer.h>
 
@@ -34,6 +35,8 @@ public:
     using Clock = TimeController::Clock;
     Renderer(const TimeController &tc, const std::chrono::microseconds &seekPosTimeOffset = {});
 
+    ~Renderer() override;
+
     void syncSoft(TimePoint tp, qint64 trackPos);
 
     qint64 seekPosition() const;
@@ -46,6 +49,11 @@ public:
 
     bool isStepForced() const;
 
+    // Replaces the signal/slot connections with the stream decoder.
+    // The renderer may outlive decoders, so the channel can be reset at any time;
+    // a null channel switches the renderer back to signals and slots.
+    void setFrameChannel(FrameChannelPtr channel);
+
 public slots:
     void setInitialPosition(TimePoint tp, qint64 trackPos);
 
@@ -105,6 +113,10 @@ protected:
 private:
     void doNextStep() override;
 
+    void onFramesAvailable();
+
+    void releaseFrame(Frame frame);
+
 private:
     TimeController m_timeController;
     qint64 m_lastFrameEnd = 0;
@@ -113,6 +125,7 @@ private:
 
     int m_loopIndex = 0;
     QQueue<Frame> m_frames;
+    FrameChannelPtr m_frameChannel;
 
     QAtomicInteger<bool> m_isStepForced = false;
     std::optional<TimePoint> m_explicitNextFrameTime;
@@ -0,0 +1,119 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegstatisticscollector_p.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+using namespace std::chrono;
+
+// Positions presented earlier than that are too old to tell the current A/V offset
+static constexpr auto MaxPresentedPositionAge = 1s;
+
+void StatisticsCollector::setBufferedData(Generation generation, TrackType trackType,
+                                          qint64 duration, qint64 bytes, qint64 packets)
+{
+    QMutexLocker locker(&m_mutex);
+    if (generation != m_generation)
+        return;
+
+    auto &stream = m_statistics.streams[trackType];
+    stream.bufferedDuration = duration;
+    stream.bufferedBytes = bytes;
+    stream.bufferedPackets = packets;
+}
+
+void StatisticsCollector::addDecodingTime(Generation generation, TrackType trackType,
+                                          microseconds time)
+{
+    const auto &bounds = QPlaybackStatistics::DecodingTimeBucketBounds;
+    const auto bucket = std::lower_bound(bounds.begin(), bounds.end(), time.count()) - bounds.begin();
+
+    QMutexLocker locker(&m_mutex);
+    if (generation != m_generation)
+        return;
+    ++m_statistics.streams[trackType].decodingTimeHistogram[bucket];
+}
+
+void StatisticsCollector::setPendingFrames(Generation generation, TrackType trackType,
+                                           qint64 count)
+{
+    QMutexLocker locker(&m_mutex);
+    if (generation != m_generation)
+        return;
+    m_statistics.streams[trackType].pendingFrames = count;
+}
+
+void StatisticsCollector::setPresentedPosition(Generation generation, TrackType trackType,
+                                               qint64 position, TimePoint timePoint)
+{
+    QMutexLocker locker(&m_mutex);
+    if (generation != m_generation)
+        return;
+
+    if (trackType == QPlatformMediaPlayer::AudioStream)
+        m_presentedAudio = PresentedPosition{ position, timePoint };
+    else if (trackType == QPlatformMediaPlayer::VideoStream)
+        m_presentedVideo = PresentedPosition{ position, timePoint };
+}
+
+void StatisticsCollector::setAudioBufferLoad(Generation generation, microseconds load)
+{
+    QMutexLocker locker(&m_mutex);
+    if (generation != m_generation)
+        return;
+    m_statistics.audioBufferLoad = load.count();
+}
+
+StatisticsCollector::Generation StatisticsCollector::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void StatisticsCollector::resetObjectsState()
+{
+    QMutexLocker locker(&m_mutex);
+
+    ++m_generation;
+
+    for (auto &stream : m_statistics.streams) {
+        stream.bufferedDuration = 0;
+        stream.bufferedBytes = 0;
+        stream.bufferedPackets = 0;
+        stream.pendingFrames = 0;
+    }
+
+    m_statistics.audioBufferLoad = 0;
+    m_presentedAudio.reset();
+    m_presentedVideo.reset();
+}
+
+QPlaybackStatistics StatisticsCollector::statistics(float playbackRate, TimePoint now) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QPlaybackStatistics result = m_statistics;
+
+    auto isRecent = [&](const std::optional<PresentedPosition> &presented) {
+        return presented && now - presented->timePoint < MaxPresentedPositionAge;
+    };
+
+    if (isRecent(m_presentedAudio) && isRecent(m_presentedVideo)) {
+        // Bring both positions to the same time point
+        const auto timeDiff =
+                duration_cast<microseconds>(m_presentedVideo->timePoint - m_presentedAudio->timePoint);
+        result.audioVideoOffset = m_presentedVideo->position - m_presentedAudio->position
+                - qint64(timeDiff.count() * playbackRate);
+    }
+
+    return result;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
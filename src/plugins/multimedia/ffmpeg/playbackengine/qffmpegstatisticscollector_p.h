@@ -0,0 +1,136 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGSTATISTICSCOLLECTOR_P_H
+#define QFFMPEGSTATISTICSCOLLECTOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "private/qplatformmediaplayer_p.h"
+#include "private/qplaybackstatistics_p.h"
+
+#include <QtCore/qmutex.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* Gathers the statistics of the playback engine objects.
+ *
+ * The objects report their state from their own threads as it changes; the engine
+ * takes snapshots in its thread. The collector is kept as long as the media is loaded,
+ * so the counters survive seeking and the recreation of the objects.
+ *
+ * Each report is tagged with the generation the reporting object was created in.
+ * Killed objects may still report from their threads until they're deleted;
+ * their reports are dropped, so that they don't overwrite the state that has been reset.
+ */
+class StatisticsCollector
+{
+public:
+    using TrackType = QPlatformMediaPlayer::TrackType;
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Generation = quint64;
+
+    // Demuxer
+    void setBufferedData(Generation generation, TrackType trackType, qint64 duration,
+                         qint64 bytes, qint64 packets);
+
+    // Stream decoders
+    void addDecodingTime(Generation generation, TrackType trackType,
+                         std::chrono::microseconds time);
+
+    void setPendingFrames(Generation generation, TrackType trackType, qint64 count);
+
+    // Renderers; the position is the one presented to the user at the time point
+    void setPresentedPosition(Generation generation, TrackType trackType, qint64 position,
+                              TimePoint timePoint);
+
+    void setAudioBufferLoad(Generation generation, std::chrono::microseconds load);
+
+    // The generation of the objects created since the last reset
+    Generation generation() const;
+
+    // Forgets the state reported by the objects when they're recreated and starts
+    // a new generation; the accumulated counters are kept.
+    void resetObjectsState();
+
+    QPlaybackStatistics statistics(float playbackRate, TimePoint now) const;
+
+private:
+    struct PresentedPosition
+    {
+        qint64 position = 0;
+        TimePoint timePoint;
+    };
+
+    mutable QMutex m_mutex;
+    Generation m_generation = 0;
+    QPlaybackStatistics m_statistics;
+    std::optional<PresentedPosition> m_presentedAudio;
+    std::optional<PresentedPosition> m_presentedVideo;
+};
+
+using StatisticsCollectorPtr = std::shared_ptr<StatisticsCollector>;
+
+// Reports the state of a single object to the collector, tagged with
+// the generation the object was registered in.
+class StatisticsReporter
+{
+public:
+    using TrackType = StatisticsCollector::TrackType;
+    using TimePoint = StatisticsCollector::TimePoint;
+
+    explicit StatisticsReporter(StatisticsCollectorPtr collector)
+        : m_collector(std::move(collector)), m_generation(m_collector->generation())
+    {
+    }
+
+    void setBufferedData(TrackType trackType, qint64 duration, qint64 bytes,
+                         qint64 packets) const
+    {
+        m_collector->setBufferedData(m_generation, trackType, duration, bytes, packets);
+    }
+
+    void addDecodingTime(TrackType trackType, std::chrono::microseconds time) const
+    {
+        m_collector->addDecodingTime(m_generation, trackType, time);
+    }
+
+    void setPendingFrames(TrackType trackType, qint64 count) const
+    {
+        m_collector->setPendingFrames(m_generation, trackType, count);
+    }
+
+    void setPresentedPosition(TrackType trackType, qint64 position, TimePoint timePoint) const
+    {
+        m_collector->setPresentedPosition(m_generation, trackType, position, timePoint);
+    }
+
+    void setAudioBufferLoad(std::chrono::microseconds load) const
+    {
+        m_collector->setAudioBufferLoad(m_generation, load);
+    }
+
+private:
+    StatisticsCollectorPtr m_collector;
+    StatisticsCollector::Generation m_generation;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGSTATISTICSCOLLECTOR_P_H
@@ -4,6 +4,7 @@
 #include "playbackengine/qffmpegstreamdecoder_p.h"
 #include "playbackengine/qffmpegmediadataholder_p.h"
 #include <qloggingcategory.h>
+#include <qscopeguard.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -11,9 +12,12 @@ Q_STATIC_LOGGING_CATEGORY(qLcStreamDecoder, "qt.multimedia.ffmpeg.streamdecoder"
 
 namespace QFFmpeg {
 
-StreamDecoder::StreamDecoder(const Codec &codec, qint64 absSeekPos)
+StreamDecoder::StreamDecoder(const Codec &codec, qint64 absSeekPos, AVObjectPoolPtr pool,
+                             LateFrameControllerPtr lateFrameController)
     : m_codec(codec),
       m_absSeekPos(absSeekPos),
+      m_pool(std::move(pool)),
+      m_lateFrameController(std::move(lateFrameController)),
       m_trackType(MediaDataHolder::trackTypeFromMediaType(codec.context()->codec_type))
 {
     qCDebug(qLcStreamDecoder) << "Create stream decoder, trackType" << m_trackType
@@ -23,6 +27,13 @@ StreamDecoder::StreamDecoder(const Codec &codec, qint64 absSeekPos)
 
 StreamDecoder::~StreamDecoder()
 {
+    if (m_packetChannel)
+        m_packetChannel->setConsumer(nullptr, {});
+    if (m_frameChannel)
+        m_frameChannel->setProducer(nullptr, {});
+
+    // The codec is shared with the next decoder of the track
+    m_codec.context()->skip_frame = AVDISCARD_DEFAULT;
     avcodec_flush_buffers(m_codec.context());
 }
 
@@ -43,9 +54,37 @@ void StreamDecoder::decode(Packet packet)
     scheduleNextStep();
 }
 
+void StreamDecoder::setPacketChannel(PacketChannelPtr channel)
+{
+    channel->setConsumer(this, [this]() { scheduleNextStep(); });
+    m_packetChannel = std::move(channel);
+}
+
+void StreamDecoder::setFrameChannel(FrameChannelPtr channel)
+{
+    channel->setProducer(this, [this]() { onFramesReleased(); });
+    m_frameChannel = std::move(channel);
+}
+
+Packet StreamDecoder::takePacket()
+{
+    if (!m_packets.empty())
+        return m_packets.dequeue();
+
+    Q_ASSERT(m_packetChannel);
+    auto packet = m_packetChannel->pop();
+    Q_ASSERT(packet);
+    return std::move(*packet);
+}
+
+bool StreamDecoder::hasPackets() const
+{
+    return !m_packets.empty() || (m_packetChannel && m_packetChannel->hasItems());
+}
+
 void StreamDecoder::doNextStep()
 {
-    auto packet = m_packets.dequeue();
+    auto packet = takePacket();
 
     auto decodePacket = [this](Packet packet) {
         if (trackType() == QPlatformMediaPlayer::SubtitleStream)
@@ -65,10 +104,17 @@ void StreamDecoder::doNextStep()
 
     decodePacket(packet);
 
+    if (!packet.isValid() && m_frameChannel)
+        m_frameChannel->push({});
+
     setAtEnd(!packet.isValid());
 
-    if (packet.isValid())
-        emit packetProcessed(packet);
+    if (packet.isValid()) {
+        if (m_packetChannel)
+            m_packetChannel->release(std::move(packet));
+        else
+            emit packetProcessed(packet);
+    }
 
     scheduleNextStep(false);
 }
@@ -100,15 +146,36 @@ void StreamDecoder::onFrameProcessed(Frame frame)
 
     --m_pendingFramesCount;
     Q_ASSERT(m_pendingFramesCount >= 0);
+    reportPendingFrames();
+
+    scheduleNextStep();
+}
+
+void StreamDecoder::onFramesReleased()
+{
+    m_frameChannel->takeReleased([this](const Frame &frame) {
+        if (frame.sourceId() != id())
+            return;
+
+        --m_pendingFramesCount;
+        Q_ASSERT(m_pendingFramesCount >= 0);
+    });
+    reportPendingFrames();
 
     scheduleNextStep();
 }
 
+void StreamDecoder::reportPendingFrames() const
+{
+    if (auto reporter = statisticsReporter())
+        reporter->setPendingFrames(m_trackType, m_pendingFramesCount);
+}
+
 bool StreamDecoder::canDoNextStep() const
 {
     const qint32 maxCount = maxQueueSize(m_trackType);
 
-    return !m_packets.empty() && m_pendingFramesCount < maxCount
+    return hasPackets() && m_pendingFramesCount < maxCount
             && PlaybackEngineObject::canDoNextStep();
 }
 
@@ -119,11 +186,55 @@ void StreamDecoder::onFrameFound(Frame frame)
 
     Q_ASSERT(m_pendingFramesCount >= 0);
     ++m_pendingFramesCount;
-    emit requestHandleFrame(frame);
+    reportPendingFrames();
+
+    if (m_frameChannel)
+        m_frameChannel->push(std::move(frame));
+    else
+        emit requestHandleFrame(frame);
+}
+
+void StreamDecoder::updateSkipFrame(const Packet &packet)
+{
+    if (m_trackType != QPlatformMediaPlayer::VideoStream || !packet.isValid())
+        return;
+
+    // The renderer falling behind asks for skipping frames until it catches up
+    AVDiscard skipFrame =
+            m_lateFrameController ? m_lateFrameController->skipFrame() : AVDISCARD_DEFAULT;
+
+    // Frames ending before the seek position are dropped after decoding, see onFrameFound.
+    // Non-reference ones are not needed for decoding the next frames either,
+    // so the decoder can skip them. This shortens accurate seeking into long GOPs.
+    const AVPacket *avPacket = packet.avPacket();
+    if (avPacket->pts != AV_NOPTS_VALUE) {
+        const qint64 packetEnd =
+                packet.loopOffset().pos + m_codec.toUs(avPacket->pts + avPacket->duration);
+        if (packetEnd < m_absSeekPos)
+            skipFrame = std::max(skipFrame, AVDISCARD_NONREF);
+    }
+
+    auto codecContext = m_codec.context();
+    if (codecContext->skip_frame != skipFrame) {
+        qCDebug(qLcStreamDecoder) << "Set skip_frame:" << skipFrame
+                                  << "absSeekPos:" << m_absSeekPos;
+        codecContext->skip_frame = skipFrame;
+    }
 }
 
 void StreamDecoder::decodeMedia(Packet packet)
 {
+    updateSkipFrame(packet);
+
+    const auto decodingStart = std::chrono::steady_clock::now();
+    auto reportDecodingTime = qScopeGuard([&]() {
+        auto reporter = statisticsReporter();
+        if (reporter && packet.isValid())
+            reporter->addDecodingTime(m_trackType,
+                                      std::chrono::duration_cast<std::chrono::microseconds>(
+                                              std::chrono::steady_clock::now() - decodingStart));
+    });
+
     auto sendPacketResult = sendAVPacket(packet);
 
     if (sendPacketResult == AVERROR(EAGAIN)) {
@@ -151,7 +262,7 @@ int StreamDecoder::sendAVPacket(Packet packet)
 void StreamDecoder::receiveAVFrames(bool flushPacket)
 {
     while (true) {
-        auto avFrame = makeAVFrame();
+        auto avFrame = m_pool->acquireFrame();
 
         const auto receiveFrameResult = avcodec_receive_frame(m_codec.context(), avFrame.get());
 
@@ -167,8 +278,10 @@ void StreamDecoder::receiveAVFrames(bool flushPacket)
                 qWarning() << "Unexpected FFmpeg behavior: EAGAIN state for avcodec_receive_frame "
                            << "at end of the stream";
                 flushPacket = false;
+                m_pool->recycleFrame(std::move(avFrame));
                 continue;
             }
+            m_pool->recycleFrame(std::move(avFrame));
             break;
         }
 
@@ -179,10 +292,14 @@ void StreamDecoder::receiveAVFrames(bool flushPacket)
 
 
         // Avoid starvation on FFmpeg decoders with fixed size frame pool
-        if (m_trackType == QPlatformMediaPlayer::VideoStream)
-            avFrame = copyFromHwPool(std::move(avFrame));
+        if (m_trackType == QPlatformMediaPlayer::VideoStream) {
+            AVFrameUPtr replaced;
+            avFrame = copyFromHwPool(std::move(avFrame), &replaced);
+            // The copy holds its own texture, the decoder's surface goes back with the shell
+            m_pool->recycleFrame(std::move(replaced));
+        }
 
-        onFrameFound({ m_offset, std::move(avFrame), m_codec, 0, id() });
+        onFrameFound({ m_offset, std::move(avFrame), m_codec, 0, id(), m_pool });
     }
 }
 
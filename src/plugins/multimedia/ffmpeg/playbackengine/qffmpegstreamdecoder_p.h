@@ -16,7 +16,9 @@
 #include "playbackengine/qffmpegplaybackengineobject_p.h"
 #include "playbackengine/qffmpegframe_p.h"
 #include "playbackengine/qffmpegpacket_p.h"
+#include "playbackengine/qffmpegchannel_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "playbackengine/qffmpeglateframecontroller_p.h"
 #include "private/qplatformmediaplayer_p.h"
 
 #include <optional>
@@ -29,7 +31,9 @@ class StreamDecoder : public PlaybackEngineObject
 {
     Q_OBJECT
 public:
-    StreamDecoder(const Codec &codec, qint64 absSeekPos);
+    // The late frame controller makes video decoders skip frames when the renderer is late
+    StreamDecoder(const Codec &codec, qint64 absSeekPos, AVObjectPoolPtr pool,
+                  LateFrameControllerPtr lateFrameController = {});
 
     ~StreamDecoder();
 
@@ -38,6 +42,12 @@ public:
     // Maximum number of frames that we are allowed to keep in render queue
     static qint32 maxQueueSize(QPlatformMediaPlayer::TrackType type);
 
+    // Replace the signal/slot connections with the demuxer and the renderer.
+    // Must be called before the decoder is unpaused.
+    void setPacketChannel(PacketChannelPtr channel);
+
+    void setFrameChannel(FrameChannelPtr channel);
+
 public slots:
     void setInitialPosition(TimePoint tp, qint64 trackPos);
 
@@ -62,15 +72,27 @@ private:
 
     void decodeSubtitle(Packet);
 
+    void updateSkipFrame(const Packet &packet);
+
     void onFrameFound(Frame frame);
 
     int sendAVPacket(Packet);
 
     void receiveAVFrames(bool flushPacket = false);
 
+    Packet takePacket();
+
+    bool hasPackets() const;
+
+    void onFramesReleased();
+
+    void reportPendingFrames() const;
+
 private:
     Codec m_codec;
     qint64 m_absSeekPos = 0;
+    AVObjectPoolPtr m_pool;
+    LateFrameControllerPtr m_lateFrameController;
     const QPlatformMediaPlayer::TrackType m_trackType;
 
     qint32 m_pendingFramesCount = 0;
@@ -78,6 +100,9 @@ private:
     LoopOffset m_offset;
 
     QQueue<Packet> m_packets;
+
+    PacketChannelPtr m_packetChannel;
+    FrameChannelPtr m_frameChannel;
 };
 
 } // namespace QFFmpeg
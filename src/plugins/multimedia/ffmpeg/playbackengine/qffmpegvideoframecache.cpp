@@ -0,0 +1,136 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegvideoframecache_p.h"
+
+#include <qloggingcategory.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcVideoFrameCache, "qt.multimedia.ffmpeg.videoframecache");
+
+namespace QFFmpeg {
+
+VideoFrameCache::VideoFrameCache(qint64 maxMemoryUsage) : m_maxMemoryUsage(maxMemoryUsage)
+{
+    Q_ASSERT(maxMemoryUsage > 0);
+}
+
+void VideoFrameCache::insert(const QVideoFrame &frame, qint64 memoryUsage,
+                             std::optional<qsizetype> hwFrameLimit)
+{
+    if (!frame.isValid() || memoryUsage > m_maxMemoryUsage || hwFrameLimit == 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    const bool isHwFrame = hwFrameLimit.has_value();
+    const qint64 pos = frame.startTime();
+    auto it = m_frames.find(pos);
+    if (it != m_frames.end()) {
+        m_memoryUsage += memoryUsage - it->second.memoryUsage;
+        m_hwFrameCount += int(isHwFrame) - int(it->second.isHwFrame);
+        it->second.frame = frame;
+        it->second.memoryUsage = memoryUsage;
+        it->second.isHwFrame = isHwFrame;
+        touch(it);
+    } else {
+        m_lru.push_front(pos);
+        m_frames.emplace(pos, Entry{ frame, memoryUsage, isHwFrame, m_lru.begin() });
+        m_memoryUsage += memoryUsage;
+        m_hwFrameCount += int(isHwFrame);
+    }
+
+    if (hwFrameLimit)
+        evictHwFrames(*hwFrameLimit);
+
+    while (m_memoryUsage > m_maxMemoryUsage) {
+        Q_ASSERT(!m_lru.empty());
+        erase(m_frames.find(m_lru.back()));
+    }
+}
+
+std::optional<QVideoFrame> VideoFrameCache::find(qint64 pos, qint64 tolerance)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto next = m_frames.upper_bound(pos);
+    std::optional<Frames::iterator> found;
+
+    if (next != m_frames.begin()) {
+        auto prev = std::prev(next);
+        const auto &frame = prev->second.frame;
+        if (pos < frame.endTime() || pos - frame.startTime() <= tolerance)
+            found = prev;
+    }
+
+    if (next != m_frames.end() && next->first - pos <= tolerance
+        && (!found || next->first - pos < pos - (*found)->second.frame.endTime()))
+        found = next;
+
+    if (!found) {
+        qCDebug(qLcVideoFrameCache) << "Cache miss, pos:" << pos;
+        return {};
+    }
+
+    qCDebug(qLcVideoFrameCache) << "Cache hit, pos:" << pos << "frame:" << (*found)->first;
+
+    touch(*found);
+    return (*found)->second.frame;
+}
+
+void VideoFrameCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_frames.clear();
+    m_lru.clear();
+    m_memoryUsage = 0;
+    m_hwFrameCount = 0;
+}
+
+qint64 VideoFrameCache::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryUsage;
+}
+
+qsizetype VideoFrameCache::hwFrameCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hwFrameCount;
+}
+
+void VideoFrameCache::touch(Frames::iterator it)
+{
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+}
+
+void VideoFrameCache::erase(Frames::iterator it)
+{
+    Q_ASSERT(it != m_frames.end());
+
+    m_memoryUsage -= it->second.memoryUsage;
+    m_hwFrameCount -= int(it->second.isHwFrame);
+    m_lru.erase(it->second.lruPosition);
+    m_frames.erase(it);
+}
+
+void VideoFrameCache::evictHwFrames(qsizetype limit)
+{
+    // Walks from the least recently used frame; the software frames are kept
+    auto lruIt = m_lru.end();
+    while (m_hwFrameCount > limit) {
+        Q_ASSERT(lruIt != m_lru.begin());
+        const auto it = m_frames.find(*--lruIt);
+        if (!it->second.isHwFrame)
+            continue;
+
+        lruIt = std::next(lruIt); // stays valid when the frame is erased
+        erase(it);
+    }
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
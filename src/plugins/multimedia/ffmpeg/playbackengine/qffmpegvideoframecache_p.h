@@ -0,0 +1,89 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGVIDEOFRAMECACHE_P_H
+#define QFFMPEGVIDEOFRAMECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qvideoframe.h>
+#include <QtCore/qmutex.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* LRU cache of presented video frames keyed by their start time (without loop offsets).
+ *
+ * The video renderer puts the frames in its thread, the playback engine looks them up
+ * in its thread in order to serve scrubbing seeks without decoding.
+ * The cache is bounded by the estimated memory usage of the frames. Hardware frames
+ * are also bounded by count, as each of them holds a surface of the decoder's pool.
+ */
+class VideoFrameCache
+{
+public:
+    explicit VideoFrameCache(qint64 maxMemoryUsage);
+
+    // For a hardware frame, hwFrameLimit tells how many hardware frames the cache may hold
+    // with it; the least recently used ones are evicted to stay within the limit.
+    void insert(const QVideoFrame &frame, qint64 memoryUsage,
+                std::optional<qsizetype> hwFrameLimit = {});
+
+    // Finds the frame displayed at the position or, if there is none,
+    // the closest frame not farther than the tolerance.
+    std::optional<QVideoFrame> find(qint64 pos, qint64 tolerance);
+
+    void clear();
+
+    qint64 memoryUsage() const;
+
+    qsizetype hwFrameCount() const;
+
+private:
+    struct Entry
+    {
+        QVideoFrame frame;
+        qint64 memoryUsage = 0;
+        bool isHwFrame = false;
+        std::list<qint64>::iterator lruPosition;
+    };
+
+    using Frames = std::map<qint64, Entry>;
+
+    void touch(Frames::iterator it);
+
+    void erase(Frames::iterator it);
+
+    void evictHwFrames(qsizetype limit);
+
+private:
+    const qint64 m_maxMemoryUsage;
+
+    mutable QMutex m_mutex;
+    Frames m_frames;
+    std::list<qint64> m_lru; // the most recently used frames go first
+    qint64 m_memoryUsage = 0;
+    qsizetype m_hwFrameCount = 0;
+};
+
+using VideoFrameCachePtr = std::shared_ptr<VideoFrameCache>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGVIDEOFRAMECACHE_P_H
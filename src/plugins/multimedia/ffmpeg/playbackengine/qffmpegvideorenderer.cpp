@@ -3,16 +3,56 @@
 
 #include "playbackengine/qffmpegvideorenderer_p.h"
 #include "qffmpegvideobuffer_p.h"
+#include "qffmpeghwaccel_p.h"
 #include "qvideosink.h"
 #include "private/qvideoframe_p.h"
 
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+}
+
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 
-VideoRenderer::VideoRenderer(const TimeController &tc, QVideoSink *sink, QtVideo::Rotation rotation)
-    : Renderer(tc), m_sink(sink), m_rotation(rotation)
+// Cached hardware frames hold surfaces of the decoder's pool, and a fixed size pool
+// has to keep most of them for the decoding
+static constexpr qsizetype MaxCachedHwFrames = 4;
+static constexpr int HwPoolSurfacesPerCachedFrame = 4;
+
+static std::optional<qsizetype> cachedHwFrameLimit(const AVFrame *frame)
+{
+    if (!frame->hw_frames_ctx)
+        return {};
+
+    const auto *framesContext =
+            reinterpret_cast<const AVHWFramesContext *>(frame->hw_frames_ctx->data);
+    if (framesContext->initial_pool_size <= 0) // the pool grows on demand
+        return MaxCachedHwFrames;
+
+    return qMin(MaxCachedHwFrames,
+                qsizetype(framesContext->initial_pool_size / HwPoolSurfacesPerCachedFrame));
+}
+
+static qint64 frameMemoryUsage(AVFrame *frame)
+{
+    // Hardware frames are estimated by the size of their software counterparts
+    const int size = av_image_get_buffer_size(HWAccel::format(frame), frame->width, frame->height, 1);
+    return qMax(size, 0);
+}
+
+VideoRenderer::VideoRenderer(const TimeController &tc, QVideoSink *sink, QtVideo::Rotation rotation,
+                             VideoFrameCachePtr frameCache,
+                             LateFrameControllerPtr lateFrameController)
+    : Renderer(tc),
+      m_sink(sink),
+      m_rotation(rotation),
+      m_frameCache(std::move(frameCache)),
+      m_lateFrameController(std::move(lateFrameController))
 {
+    if (m_lateFrameController)
+        m_lateFrameController->resetLateness();
 }
 
 void VideoRenderer::setOutput(QVideoSink *sink, bool cleanPrevSink)
@@ -29,6 +69,13 @@ void VideoRenderer::setOutput(QVideoSink *sink, bool cleanPrevSink)
     });
 }
 
+void VideoRenderer::setFrameCache(VideoFrameCachePtr frameCache)
+{
+    QMetaObject::invokeMethod(this, [this, frameCache = std::move(frameCache)]() mutable {
+        m_frameCache = std::move(frameCache);
+    });
+}
+
 VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
 {
     if (!m_sink)
@@ -41,6 +88,13 @@ VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
 
     //        qCDebug(qLcVideoRenderer) << "RHI:" << accel.isNull() << accel.rhi() << sink->rhi();
 
+    // Forced steps happen while paused, the clock doesn't tell the lateness then
+    if (m_lateFrameController && !isPaused()
+        && m_lateFrameController->onFrame(frameDelay(frame),
+                                          std::chrono::microseconds(frame.duration()),
+                                          playbackRate()))
+        return {};
+
     const auto codec = frame.codec();
     Q_ASSERT(codec);
 
@@ -62,8 +116,11 @@ VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
     }
 #endif
 
+    const qint64 memoryUsage = m_frameCache ? frameMemoryUsage(frame.avFrame()) : 0;
+    const auto hwFrameLimit = cachedHwFrameLimit(frame.avFrame());
     const auto pixelAspectRatio = codec->pixelAspectRatio(frame.avFrame());
-    auto buffer = std::make_unique<QFFmpegVideoBuffer>(frame.takeAVFrame(), pixelAspectRatio);
+    auto buffer = std::make_unique<QFFmpegVideoBuffer>(frame.takeAVFrame(), pixelAspectRatio,
+                                                       m_swsFrameConverter);
     QVideoFrameFormat format(buffer->size(), buffer->pixelFormat());
     format.setColorSpace(buffer->colorSpace());
     format.setColorTransfer(buffer->colorTransfer());
@@ -75,6 +132,13 @@ VideoRenderer::RenderingResult VideoRenderer::renderInternal(Frame frame)
     videoFrame.setEndTime(frame.end());
     m_sink->setVideoFrame(videoFrame);
 
+    if (auto reporter = statisticsReporter())
+        reporter->setPresentedPosition(QPlatformMediaPlayer::VideoStream, frame.absolutePts(),
+                                       Clock::now());
+
+    if (m_frameCache)
+        m_frameCache->insert(videoFrame, memoryUsage, hwFrameLimit);
+
     return {};
 }
 
@@ -15,6 +15,9 @@
 //
 
 #include "playbackengine/qffmpegrenderer_p.h"
+#include "playbackengine/qffmpegvideoframecache_p.h"
+#include "playbackengine/qffmpeglateframecontroller_p.h"
+#include "qffmpegswsframeconverter_p.h"
 
 #include <QtCore/qpointer.h>
 
@@ -28,16 +31,27 @@ class VideoRenderer : public Renderer
 {
     Q_OBJECT
 public:
-    VideoRenderer(const TimeController &tc, QVideoSink *sink, QtVideo::Rotation rotation);
+    // The presented frames are put to the frame cache, if any.
+    // Without a late frame controller, late frames are presented anyway.
+    VideoRenderer(const TimeController &tc, QVideoSink *sink, QtVideo::Rotation rotation,
+                  VideoFrameCachePtr frameCache = {},
+                  LateFrameControllerPtr lateFrameController = {});
 
     void setOutput(QVideoSink *sink, bool cleanPrevSink = false);
 
+    // Switches the cache the presented frames are put to, or stops caching them
+    void setFrameCache(VideoFrameCachePtr frameCache);
+
 protected:
     RenderingResult renderInternal(Frame frame) override;
 
 private:
     QPointer<QVideoSink> m_sink;
     QtVideo::Rotation m_rotation;
+    VideoFrameCachePtr m_frameCache;
+    LateFrameControllerPtr m_lateFrameController;
+    // Shared with the video buffers, as hw frames are converted on mapping
+    SwsFrameConverterPtr m_swsFrameConverter = std::make_shared<SwsFrameConverter>();
 };
 
 } // namespace QFFmpeg
@@ -36,6 +36,10 @@ extern "C" {
   (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(60, 15, 100)) // since ffmpeg n6.1
 #define QT_FFMPEG_HAS_D3D12VA \
     (LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(59, 8, 100)) // since ffmpeg n7.0
+#define QT_FFMPEG_HAS_INDEX_ENTRIES_API \
+  (LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)) // since ffmpeg n4.4
+#define QT_FFMPEG_HAS_SWS_SLICE_THREADS \
+  (LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 4, 100)) // since ffmpeg n5.0
 #define QT_FFMPEG_SWR_CONST_CH_LAYOUT (LIBSWRESAMPLE_VERSION_INT >= AV_VERSION_INT(4, 9, 100))
 #define QT_FFMPEG_AVIO_WRITE_CONST \
   (LIBAVFORMAT_VERSION_MAJOR >= 61)
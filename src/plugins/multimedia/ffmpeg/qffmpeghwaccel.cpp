@@ -514,11 +514,12 @@ void TextureConverter::updateBackend(AVPixelFormat fmt)
     d->format = fmt;
 }
 
-AVFrameUPtr copyFromHwPool(AVFrameUPtr frame)
+AVFrameUPtr copyFromHwPool(AVFrameUPtr frame, AVFrameUPtr *replaced)
 {
 #if QT_CONFIG(wmf)
-    return copyFromHwPoolD3D11(std::move(frame));
+    return copyFromHwPoolD3D11(std::move(frame), replaced);
 #else
+    Q_UNUSED(replaced);
     return frame;
 #endif
 }
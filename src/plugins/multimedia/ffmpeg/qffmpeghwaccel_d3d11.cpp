@@ -346,7 +346,7 @@ void D3D11TextureConverter::SetupDecoderTextures(AVCodecContext *s)
     }
 }
 
-AVFrameUPtr copyFromHwPoolD3D11(AVFrameUPtr src)
+AVFrameUPtr copyFromHwPoolD3D11(AVFrameUPtr src, AVFrameUPtr *replaced)
 {
     if (!src || !src->hw_frames_ctx || src->format != AV_PIX_FMT_D3D11)
         return src;
@@ -378,6 +378,9 @@ AVFrameUPtr copyFromHwPoolD3D11(AVFrameUPtr src)
     dest->format = src->format;
     dest->hw_frames_ctx = av_buffer_ref(src->hw_frames_ctx);
 
+    if (replaced)
+        *replaced = std::move(src);
+
     return dest;
 }
 
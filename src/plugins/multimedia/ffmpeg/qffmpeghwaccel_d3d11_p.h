@@ -95,7 +95,7 @@ private:
     TextureBridge m_bridge;
 };
 
-AVFrameUPtr copyFromHwPoolD3D11(AVFrameUPtr src);
+AVFrameUPtr copyFromHwPoolD3D11(AVFrameUPtr src, AVFrameUPtr *replaced);
 
 } // namespace QFFmpeg
 
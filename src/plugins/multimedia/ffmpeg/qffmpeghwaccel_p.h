@@ -128,7 +128,10 @@ private:
     HWAccel(AVBufferUPtr hwDeviceContext) : m_hwDeviceContext(std::move(hwDeviceContext)) { }
 };
 
-AVFrameUPtr copyFromHwPool(AVFrameUPtr frame);
+// Copies the frame out of the decoder's fixed size surface pool if needed. If it is copied,
+// the source frame is moved to \a replaced, if given, instead of being freed, so that the
+// caller can recycle its shell.
+AVFrameUPtr copyFromHwPool(AVFrameUPtr frame, AVFrameUPtr *replaced = nullptr);
 
 }
 
@@ -20,7 +20,8 @@
 
 #include <qopenglfunctions.h>
 
-//#define VA_EXPORT_USE_LAYERS
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qvarlengtharray.h>
 
 #if __has_include("drm/drm_fourcc.h")
 #include <drm/drm_fourcc.h>
@@ -45,6 +46,10 @@
 #define DRM_FORMAT_BGRA1010102  fourcc_code('B', 'A', '3', '0') /* [31:0] B:G:R:A 10:10:10:2 little endian */
 #endif
 
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
 extern "C" {
 #include <libavutil/hwcontext_vaapi.h>
 }
@@ -55,6 +60,12 @@ extern "C" {
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+// EGL_EXT_image_dma_buf_import_modifiers
+#ifndef EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT
+#define EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT 0x3443
+#define EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT 0x3444
+#endif
+
 #include <unistd.h>
 
 #include <qloggingcategory.h>
@@ -197,6 +208,11 @@ VAAPITextureConverter::VAAPITextureConverter(QRhi *rhi)
         return;
     }
 
+    const char *eglExtensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+    hasDmaBufModifiers = eglExtensions
+            && QByteArrayView(eglExtensions).contains("EGL_EXT_image_dma_buf_import_modifiers");
+    qCDebug(qLHWAccelVAAPI) << "    dma-buf modifiers supported:" << hasDmaBufModifiers;
+
     // everything ok, indicate that we can do zero copy
     this->rhi = rhi;
 }
@@ -205,7 +221,107 @@ VAAPITextureConverter::~VAAPITextureConverter()
 {
 }
 
-//#define VA_EXPORT_USE_LAYERS
+namespace {
+
+enum class ImportResult { Success, BadMatch, Failed };
+
+bool exportSurface(VADisplay vaDisplay, VASurfaceID vaSurface, bool separateLayers,
+                   VADRMPRIMESurfaceDescriptor &prime)
+{
+    const uint32_t layersFlag = separateLayers ? VA_EXPORT_SURFACE_SEPARATE_LAYERS
+                                               : VA_EXPORT_SURFACE_COMPOSED_LAYERS;
+    const VAStatus status =
+            vaExportSurfaceHandle(vaDisplay, vaSurface, VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
+                                  VA_EXPORT_SURFACE_READ_ONLY | layersFlag, &prime);
+    if (status != VA_STATUS_SUCCESS) {
+        qCDebug(qLHWAccelVAAPI) << "vaExportSurfaceHandle failed, separate layers:"
+                                << separateLayers << "status:" << status;
+        return false;
+    }
+
+    return true;
+}
+
+// Imports the planes of the exported surface as GL textures
+ImportResult importPlanes(const VAAPITextureConverter &converter, const AVFrame &frame,
+                          const VADRMPRIMESurfaceDescriptor &prime, bool separateLayers,
+                          const QVideoTextureHelper::TextureDescription &desc,
+                          const quint32 *drmFormats, int nPlanes, GLuint *glTextures)
+{
+    QOpenGLFunctions functions(converter.glContext);
+    functions.glGenTextures(nPlanes, glTextures);
+
+    ImportResult result = ImportResult::Success;
+
+    for (int i = 0; i < nPlanes && result == ImportResult::Success; ++i) {
+        // Composed layers give one layer with all planes, separate layers give
+        // one layer per plane.
+        const int layer = separateLayers ? i : 0;
+        const int plane = separateLayers ? 0 : i;
+
+        if (separateLayers && prime.layers[layer].drm_format != drmFormats[i]) {
+            qCDebug(qLHWAccelVAAPI) << "unexpected DRM format of layer" << layer << "expected"
+                                    << Qt::hex << drmFormats[i] << "got"
+                                    << prime.layers[layer].drm_format;
+        }
+
+        const auto &object = prime.objects[prime.layers[layer].object_index[plane]];
+
+        QVarLengthArray<EGLAttrib, 20> imgAttr = {
+            EGL_LINUX_DRM_FOURCC_EXT,      (EGLint)drmFormats[i],
+            EGL_WIDTH,                     desc.widthForPlane(frame.width, i),
+            EGL_HEIGHT,                    desc.heightForPlane(frame.height, i),
+            EGL_DMA_BUF_PLANE0_FD_EXT,     object.fd,
+            EGL_DMA_BUF_PLANE0_OFFSET_EXT, (EGLint)prime.layers[layer].offset[plane],
+            EGL_DMA_BUF_PLANE0_PITCH_EXT,  (EGLint)prime.layers[layer].pitch[plane],
+        };
+
+        // Tiled or compressed surfaces can't be sampled correctly without their modifiers
+        if (converter.hasDmaBufModifiers
+            && object.drm_format_modifier != DRM_FORMAT_MOD_INVALID) {
+            imgAttr.append(EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT);
+            imgAttr.append(EGLAttrib(object.drm_format_modifier & 0xffffffff));
+            imgAttr.append(EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT);
+            imgAttr.append(EGLAttrib(object.drm_format_modifier >> 32));
+        }
+
+        imgAttr.append(EGL_NONE);
+
+        EGLImage image = eglCreateImage(converter.eglDisplay, EGL_NO_CONTEXT,
+                                        EGL_LINUX_DMA_BUF_EXT, nullptr, imgAttr.constData());
+        if (!image) {
+            const EGLint error = eglGetError();
+            qCDebug(qLHWAccelVAAPI) << "eglCreateImage failed for plane" << i
+                                    << "separate layers:" << separateLayers << "error:" << error;
+            result = error == EGL_BAD_MATCH ? ImportResult::BadMatch : ImportResult::Failed;
+            break;
+        }
+
+        functions.glActiveTexture(GL_TEXTURE0 + i);
+        functions.glBindTexture(GL_TEXTURE_2D, glTextures[i]);
+
+        auto eglImageTargetTexture2D =
+                (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)converter.eglImageTargetTexture2D;
+        eglImageTargetTexture2D(GL_TEXTURE_2D, image);
+        if (const GLenum error = functions.glGetError()) {
+            qWarning() << "eglImageTargetTexture2D failed with error code" << error;
+            result = ImportResult::Failed;
+        }
+
+        functions.glBindTexture(GL_TEXTURE_2D, 0);
+        eglDestroyImage(converter.eglDisplay, image);
+    }
+
+    functions.glActiveTexture(GL_TEXTURE0);
+
+    if (result != ImportResult::Success)
+        functions.glDeleteTextures(nPlanes, glTextures);
+
+    return result;
+}
+
+} // namespace
+
 TextureSet *VAAPITextureConverter::getTextures(AVFrame *frame)
 {
 //        qCDebug(qLHWAccelVAAPI) << "VAAPIAccel::getTextures";
@@ -228,37 +344,6 @@ TextureSet *VAAPITextureConverter::getTextures(AVFrame *frame)
         return nullptr;
     }
 
-    VASurfaceID vaSurface = (uintptr_t)frame->data[3];
-
-    VADRMPRIMESurfaceDescriptor prime = {};
-    if (vaExportSurfaceHandle(vaDisplay, vaSurface,
-                              VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
-                              VA_EXPORT_SURFACE_READ_ONLY |
-#ifdef VA_EXPORT_USE_LAYERS
-                                  VA_EXPORT_SURFACE_SEPARATE_LAYERS,
-#else
-                                  VA_EXPORT_SURFACE_COMPOSED_LAYERS,
-#endif
-                              &prime) != VA_STATUS_SUCCESS)
-    {
-        qWarning() << "vaExportSurfaceHandle failed";
-        return nullptr;
-    }
-
-    // Make sure all fd's in 'prime' are closed when we return from this function
-    QScopeGuard closeObjectsGuard([&prime]() {
-        for (uint32_t i = 0;  i < prime.num_objects;  ++i)
-            close(prime.objects[i].fd);
-    });
-
-    // ### Check that prime.fourcc is what we expect
-    vaSyncSurface(vaDisplay, vaSurface);
-
-//        qCDebug(qLHWAccelVAAPI) << "VAAPIAccel: vaSufraceDesc: width/height" << prime.width << prime.height << "num objects"
-//                 << prime.num_objects << "num layers" << prime.num_layers;
-
-    QOpenGLFunctions functions(glContext);
-
     AVPixelFormat fmt = HWAccel::format(frame);
     bool needsConversion;
     auto qtFormat = QFFmpegVideoBuffer::toQtPixelFormat(fmt, &needsConversion);
@@ -278,75 +363,63 @@ TextureSet *VAAPITextureConverter::getTextures(AVFrame *frame)
     nPlanes = desc->nplanes;
 //        qCDebug(qLHWAccelVAAPI) << "VAAPIAccel: nPlanes" << nPlanes;
 
+    VASurfaceID vaSurface = (uintptr_t)frame->data[3];
+    vaSyncSurface(vaDisplay, vaSurface);
+
     rhi->makeThreadLocalNativeContextCurrent();
 
-    EGLImage images[4];
-    GLuint glTextures[4] = {};
-    functions.glGenTextures(nPlanes, glTextures);
-    for (int i = 0;  i < nPlanes;  ++i) {
-#ifdef VA_EXPORT_USE_LAYERS
-#define LAYER i
-#define PLANE 0
-        if (prime.layers[i].drm_format != drm_formats[i]) {
-            qWarning() << "expected DRM format check failed expected"
-                       << Qt::hex << drm_formats[i] << "got" << prime.layers[i].drm_format;
+    // Drivers differ in the supported export layouts: try the one that has worked
+    // last time first, then the other one.
+    bool badMatch = false;
+    for (const bool separateLayers : { useSeparateLayers, !useSeparateLayers }) {
+        VADRMPRIMESurfaceDescriptor prime = {};
+        if (!exportSurface(vaDisplay, vaSurface, separateLayers, prime))
+            continue;
+
+        // Make sure all fd's in 'prime' are closed when we leave the scope
+        QScopeGuard closeObjectsGuard([&prime]() {
+            for (uint32_t i = 0;  i < prime.num_objects;  ++i)
+                close(prime.objects[i].fd);
+        });
+
+        if (prime.num_layers != (separateLayers ? uint32_t(nPlanes) : 1u)) {
+            qCDebug(qLHWAccelVAAPI) << "unexpected number of layers:" << prime.num_layers;
+            continue;
         }
-#else
-#define LAYER 0
-#define PLANE i
-#endif
 
-        EGLAttrib img_attr[] = {
-            EGL_LINUX_DRM_FOURCC_EXT,      (EGLint)drm_formats[i],
-            EGL_WIDTH,                     desc->widthForPlane(frame->width, i),
-            EGL_HEIGHT,                    desc->heightForPlane(frame->height, i),
-            EGL_DMA_BUF_PLANE0_FD_EXT,     prime.objects[prime.layers[LAYER].object_index[PLANE]].fd,
-            EGL_DMA_BUF_PLANE0_OFFSET_EXT, (EGLint)prime.layers[LAYER].offset[PLANE],
-            EGL_DMA_BUF_PLANE0_PITCH_EXT,  (EGLint)prime.layers[LAYER].pitch[PLANE],
-            EGL_NONE
-        };
-        images[i] = eglCreateImage(eglDisplay, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, img_attr);
-        if (!images[i]) {
-            const GLenum error = eglGetError();
-            if (error == EGL_BAD_MATCH) {
-                qWarning() << "eglCreateImage failed for plane" << i << "with error code EGL_BAD_MATCH, "
-                              "disabling hardware acceleration. This could indicate an EGL implementation issue."
-                              "\nVAAPI driver: " << vaQueryVendorString(vaDisplay)
-                           << "\nEGL vendor:" << eglQueryString(eglDisplay, EGL_VENDOR);
-                this->rhi = nullptr; // Disabling texture conversion here to fix QTBUG-112312
-                return nullptr;
-            }
-            if (error) {
-                qWarning() << "eglCreateImage failed for plane" << i << "with error code" << error;
-                return nullptr;
-            }
-        }
-        functions.glActiveTexture(GL_TEXTURE0 + i);
-        functions.glBindTexture(GL_TEXTURE_2D, glTextures[i]);
+        GLuint glTextures[4] = {};
+        const auto result = importPlanes(*this, *frame, prime, separateLayers, *desc, drm_formats,
+                                         nPlanes, glTextures);
+        if (result == ImportResult::BadMatch)
+            badMatch = true;
+        if (result != ImportResult::Success)
+            continue;
+
+        if (std::exchange(useSeparateLayers, separateLayers) != separateLayers)
+            qCDebug(qLHWAccelVAAPI) << "Switched VA surface export to separate layers:"
+                                    << separateLayers;
+
+        VAAPITextureSet *textureSet = new VAAPITextureSet;
+        textureSet->nPlanes = nPlanes;
+        textureSet->rhi = rhi;
+        textureSet->glContext = glContext;
+
+        for (int i = 0; i < 4; ++i)
+            textureSet->textures[i] = glTextures[i];
+//        qCDebug(qLHWAccelVAAPI) << "VAAPIAccel: got textures" << textures[0] << textures[1] << textures[2] << textures[3];
 
-        PFNGLEGLIMAGETARGETTEXTURE2DOESPROC eglImageTargetTexture2D = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)this->eglImageTargetTexture2D;
-        eglImageTargetTexture2D(GL_TEXTURE_2D, images[i]);
-        GLenum error = glGetError();
-        if (error)
-            qWarning() << "eglImageTargetTexture2D failed with error code" << error;
+        return textureSet;
     }
 
-    for (int i = 0;  i < nPlanes;  ++i) {
-        functions.glActiveTexture(GL_TEXTURE0 + i);
-        functions.glBindTexture(GL_TEXTURE_2D, 0);
-        eglDestroyImage(eglDisplay, images[i]);
+    if (badMatch) {
+        qWarning() << "eglCreateImage failed with error code EGL_BAD_MATCH, "
+                      "disabling hardware acceleration. This could indicate an EGL implementation issue."
+                      "\nVAAPI driver: " << vaQueryVendorString(vaDisplay)
+                   << "\nEGL vendor:" << eglQueryString(eglDisplay, EGL_VENDOR);
+        this->rhi = nullptr; // Disabling texture conversion here to fix QTBUG-112312
     }
 
-    VAAPITextureSet *textureSet = new VAAPITextureSet;
-    textureSet->nPlanes = nPlanes;
-    textureSet->rhi = rhi;
-    textureSet->glContext = glContext;
-
-    for (int i = 0; i < 4; ++i)
-        textureSet->textures[i] = glTextures[i];
-//        qCDebug(qLHWAccelVAAPI) << "VAAPIAccel: got textures" << textures[0] << textures[1] << textures[2] << textures[3];
-
-    return textureSet;
+    return nullptr;
 }
 
 VAAPITextureSet::~VAAPITextureSet()
@@ -38,6 +38,9 @@ public:
     Qt::HANDLE eglDisplay = nullptr;
     QOpenGLContext *glContext = nullptr;
     QFunctionPointer eglImageTargetTexture2D = nullptr;
+    bool hasDmaBufModifiers = false;
+    // The VA surface export layout that has worked last time
+    bool useSeparateLayers = false;
 };
 }
 
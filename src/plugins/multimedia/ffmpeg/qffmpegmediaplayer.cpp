@@ -253,6 +253,8 @@ void QFFmpegMediaPlayer::setMediaAsync(QFFmpeg::MediaDataHolder::Maybe mediaData
 
     m_playbackEngine->setLoops(loops());
     m_playbackEngine->setPlaybackRate(m_playbackRate);
+    m_playbackEngine->setBufferingPolicy(m_bufferingPolicy);
+    m_playbackEngine->setScrubbingMode(m_scrubbingMode);
 
     durationChanged(duration());
     tracksChanged();
@@ -406,6 +408,33 @@ void QFFmpegMediaPlayer::setLoops(int loops)
     QPlatformMediaPlayer::setLoops(loops);
 }
 
+void QFFmpegMediaPlayer::setBufferingPolicy(const std::optional<QPlaybackBufferingPolicy> &policy)
+{
+    m_bufferingPolicy = policy;
+
+    if (m_playbackEngine)
+        m_playbackEngine->setBufferingPolicy(policy);
+}
+
+void QFFmpegMediaPlayer::setScrubbingMode(bool enabled)
+{
+    m_scrubbingMode = enabled;
+
+    if (m_playbackEngine)
+        m_playbackEngine->setScrubbingMode(enabled);
+}
+
+QPlaybackVideoFrameStatistics QFFmpegMediaPlayer::videoFrameStatistics() const
+{
+    return m_playbackEngine ? m_playbackEngine->videoFrameStatistics()
+                            : QPlaybackVideoFrameStatistics{};
+}
+
+QPlaybackStatistics QFFmpegMediaPlayer::playbackStatistics() const
+{
+    return m_playbackEngine ? m_playbackEngine->statistics() : QPlaybackStatistics{};
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qffmpegmediaplayer_p.cpp"
@@ -73,6 +73,10 @@ public:
     int activeTrack(TrackType) override;
     void setActiveTrack(TrackType, int streamNumber) override;
     void setLoops(int loops) override;
+    void setBufferingPolicy(const std::optional<QPlaybackBufferingPolicy> &policy) override;
+    void setScrubbingMode(bool enabled) override;
+    QPlaybackVideoFrameStatistics videoFrameStatistics() const override;
+    QPlaybackStatistics playbackStatistics() const override;
 
 private:
     void runPlayback();
@@ -107,6 +111,8 @@ private:
     QPointer<QIODevice> m_device;
     float m_playbackRate = 1.;
     float m_bufferProgress = 0.f;
+    std::optional<QPlaybackBufferingPolicy> m_bufferingPolicy;
+    bool m_scrubbingMode = false;
     QFuture<void> m_loadMedia;
     std::shared_ptr<QFFmpeg::CancelToken> m_cancelToken; // For interrupting ongoing
                                                          // network connection attempt
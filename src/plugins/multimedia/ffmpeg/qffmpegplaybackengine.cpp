@@ -13,9 +13,12 @@
 #include "playbackengine/qffmpegsubtitlerenderer_p.h"
 #include "playbackengine/qffmpegvideorenderer_p.h"
 #include "playbackengine/qffmpegaudiorenderer_p.h"
+#include "playbackengine/qffmpegplaybackenginethreadpool_p.h"
 
 #include <qloggingcategory.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
@@ -40,10 +43,71 @@ inline Array defaultObjectsArray()
 //
 static constexpr bool shouldPauseStreams = false;
 
+// Capacity of packet channels between the demuxer and stream decoders; the actual amount of
+// buffered packets is limited by the demuxer's data limits.
+static constexpr qsizetype PacketChannelCapacity = 64;
+
+static PlaybackEngine::TransportType defaultTransportType()
+{
+    // Not cached, so that the transport can be switched between players, e.g. in tests
+    const bool useChannels =
+            qEnvironmentVariableIntValue("QT_FFMPEG_PLAYBACK_ENGINE_USE_CHANNELS") != 0;
+    return useChannels ? PlaybackEngine::TransportType::Channels
+                       : PlaybackEngine::TransportType::SignalsAndSlots;
+}
+
+static PlaybackEngine::ThreadingMode defaultThreadingMode()
+{
+    // Not cached, so that the mode can be switched between players, e.g. in tests
+    const bool useSharedThreads =
+            qEnvironmentVariableIntValue("QT_FFMPEG_PLAYBACK_ENGINE_SHARED_THREADS") != 0;
+    return useSharedThreads ? PlaybackEngine::ThreadingMode::SharedThreads
+                            : PlaybackEngine::ThreadingMode::DedicatedThreads;
+}
+
+// Fast seeking snaps to a keyframe only if it's not farther than that from the requested
+// position; the index may lack the keyframes of the parts that haven't been demuxed yet.
+static constexpr qint64 MaxFastSeekDistanceUs = 5'000'000;
+
+// Scrubbing serves a cached frame for a position between frames if it's not farther than that
+static constexpr qint64 ScrubbingCacheToleranceUs = 20'000;
+
+static constexpr qint64 ScrubbingCacheMaxMemoryUsage = 256 * 1024 * 1024;
+
+static PlaybackEngine::SeekMode defaultSeekMode()
+{
+    // Not cached, so that the mode can be switched between players, e.g. in benchmarks
+    const bool useFastSeek =
+            qEnvironmentVariableIntValue("QT_FFMPEG_PLAYBACK_ENGINE_FAST_SEEK") != 0;
+    return useFastSeek ? PlaybackEngine::SeekMode::FastKeyframe
+                       : PlaybackEngine::SeekMode::Accurate;
+}
+
+static LateFrameControllerPtr createLateFrameController()
+{
+    // Late frames can be kept for debugging, e.g. to compare the rendered frames
+    static const bool keepLateFrames =
+            qEnvironmentVariableIntValue("QT_FFMPEG_PLAYBACK_ENGINE_KEEP_LATE_FRAMES") != 0;
+    return keepLateFrames ? nullptr : std::make_shared<LateFrameController>();
+}
+
+static PlaybackEngineThreadPool::Role threadPoolRole(const PlaybackEngineObject &object)
+{
+    if (qobject_cast<const Demuxer *>(&object))
+        return PlaybackEngineThreadPool::Demuxing;
+    if (qobject_cast<const StreamDecoder *>(&object))
+        return PlaybackEngineThreadPool::Decoding;
+    return PlaybackEngineThreadPool::Rendering;
+}
+
 PlaybackEngine::PlaybackEngine()
     : m_demuxer({}, {}),
       m_streams(defaultObjectsArray<decltype(m_streams)>()),
-      m_renderers(defaultObjectsArray<decltype(m_renderers)>())
+      m_renderers(defaultObjectsArray<decltype(m_renderers)>()),
+      m_transportType(defaultTransportType()),
+      m_threadingMode(defaultThreadingMode()),
+      m_seekMode(defaultSeekMode()),
+      m_lateFrameController(createLateFrameController())
 {
     qCDebug(qLcPlaybackEngine) << "Create PlaybackEngine";
     qRegisterMetaType<QFFmpeg::Packet>();
@@ -55,6 +119,12 @@ PlaybackEngine::~PlaybackEngine() {
 
     finalizeOutputs();
     forEachExistingObject([](auto &object) { object.reset(); });
+
+    // Unlike the dedicated threads, the pool threads keep running after the engine is gone,
+    // while the objects killed on them use the media and the codecs until they're deleted.
+    for (QThread *thread : std::exchange(m_killedObjectSharedThreads, {}))
+        PlaybackEngineThreadPool::instance().waitForPostedEvents(thread);
+
     deleteFreeThreads();
 }
 
@@ -131,7 +201,9 @@ void PlaybackEngine::setState(QMediaPlayer::PlaybackState state) {
         finilizeTime(0);
     }
 
-    if (prevState == QMediaPlayer::StoppedState || m_state == QMediaPlayer::StoppedState)
+    // The objects are behind the presented cached frame
+    if (prevState == QMediaPlayer::StoppedState || m_state == QMediaPlayer::StoppedState
+        || m_cachedFramePosition)
         recreateObjects();
 
     if (prevState == QMediaPlayer::StoppedState)
@@ -173,14 +245,40 @@ void PlaybackEngine::ObjectDeleter::operator()(PlaybackEngineObject *object) con
     if (!std::exchange(engine->m_threadsDirty, true))
         QMetaObject::invokeMethod(engine, &PlaybackEngine::deleteFreeThreads, Qt::QueuedConnection);
 
+    const auto &sharedThreads = engine->m_sharedThreads;
+    const bool onSharedThread =
+            std::any_of(sharedThreads.begin(), sharedThreads.end(),
+                        [object](const auto &entry) { return entry.second == object->thread(); });
+    if (onSharedThread)
+        engine->m_killedObjectSharedThreads.insert(object->thread());
+
     object->kill();
 }
 
 void PlaybackEngine::registerObject(PlaybackEngineObject &object)
 {
     connect(&object, &PlaybackEngineObject::error, this, &PlaybackEngine::errorOccured);
+    object.setStatisticsCollector(m_statisticsCollector);
 
     auto threadName = objectThreadName(object);
+
+    if (m_threadingMode == ThreadingMode::SharedThreads) {
+        auto &thread = m_sharedThreads[threadName];
+        if (!thread) {
+            std::vector<QThread *> engineThreads;
+            for (auto &[name, engineThread] : m_sharedThreads)
+                if (engineThread)
+                    engineThreads.push_back(engineThread);
+
+            thread = PlaybackEngineThreadPool::instance().acquire(threadPoolRole(object),
+                                                                  engineThreads);
+        }
+
+        Q_ASSERT(object.thread() != thread);
+        object.moveToThread(thread);
+        return;
+    }
+
     auto &thread = m_threads[threadName];
     if (!thread) {
         thread = std::make_unique<QThread>();
@@ -198,7 +296,9 @@ PlaybackEngine::createRenderer(QPlatformMediaPlayer::TrackType trackType)
     switch (trackType) {
     case QPlatformMediaPlayer::VideoStream:
         return m_videoSink
-                ? createPlaybackEngineObject<VideoRenderer>(m_timeController, m_videoSink, m_media.rotation())
+                ? createPlaybackEngineObject<VideoRenderer>(m_timeController, m_videoSink,
+                                                            m_media.rotation(), m_videoFrameCache,
+                                                            m_lateFrameController)
                 : RendererPtr{ {}, {} };
     case QPlatformMediaPlayer::AudioStream:
         return m_audioOutput || m_audioBufferOutput
@@ -237,6 +337,20 @@ void PlaybackEngine::seek(qint64 pos)
 {
     pos = boundPosition(pos);
 
+    if (m_seekMode == SeekMode::FastKeyframe) {
+        // If no keyframe is known around the position, fall back to the accurate seeking
+        const auto keyframeIndex = m_media.videoKeyframeIndex();
+        const auto keyframePos =
+                keyframeIndex ? keyframeIndex->nearestKeyframe(pos) : std::nullopt;
+        if (keyframePos && qAbs(*keyframePos - pos) <= MaxFastSeekDistanceUs) {
+            qCDebug(qLcPlaybackEngine) << "Fast seek from" << pos << "to keyframe" << *keyframePos;
+            pos = boundPosition(*keyframePos);
+        }
+    }
+
+    if (presentCachedFrame(pos))
+        return;
+
     m_timeController.setPaused(true);
     m_timeController.sync(m_currentLoopOffset.pos + pos);
 
@@ -296,9 +410,11 @@ float PlaybackEngine::playbackRate() const {
 
 void PlaybackEngine::recreateObjects()
 {
+    m_cachedFramePosition.reset();
     m_timeController.setPaused(true);
 
     forEachExistingObject([](auto &object) { object.reset(); });
+    m_statisticsCollector->resetObjectsState();
 
     createObjectsIfNeeded();
 }
@@ -351,10 +467,24 @@ void PlaybackEngine::createStreamAndRenderer(QPlatformMediaPlayer::TrackType tra
     }
 
     auto &stream = m_streams[trackType] =
-            createPlaybackEngineObject<StreamDecoder>(*codec, renderer->seekPosition());
+            createPlaybackEngineObject<StreamDecoder>(
+                    *codec, renderer->seekPosition(), m_avObjectPool,
+                    trackType == QPlatformMediaPlayer::VideoStream ? m_lateFrameController
+                                                                   : nullptr);
 
     Q_ASSERT(trackType == stream->trackType());
 
+    if (m_transportType == TransportType::Channels) {
+        // final frames go through the channel to keep the order
+        auto channel = std::make_shared<FrameChannel>(
+                StreamDecoder::maxQueueSize(trackType) + 1);
+        stream->setFrameChannel(channel);
+        renderer->setFrameChannel(std::move(channel));
+        return;
+    }
+
+    renderer->setFrameChannel(nullptr);
+
     connect(stream.get(), &StreamDecoder::requestHandleFrame, renderer.get(), &Renderer::render);
     connect(stream.get(), &PlaybackEngineObject::atEnd, renderer.get(),
             &Renderer::onFinalFrameReceived);
@@ -411,11 +541,22 @@ void PlaybackEngine::createDemuxer()
     const PositionWithOffset positionWithOffset{ currentPosition(false), m_currentLoopOffset };
 
     m_demuxer = createPlaybackEngineObject<Demuxer>(m_media.avContext(), positionWithOffset,
-                                                    streamIndexes, m_loops);
+                                                    streamIndexes, m_loops, m_avObjectPool,
+                                                    bufferingPolicy());
+
+    m_demuxer->setVideoKeyframeIndex(m_media.videoKeyframeIndex());
 
     connect(m_demuxer.get(), &Demuxer::packetsBuffered, this, &PlaybackEngine::buffered);
 
     forEachExistingObject<StreamDecoder>([&](auto &stream) {
+        if (m_transportType == TransportType::Channels) {
+            // final packets go through the channel to keep the order
+            auto channel = std::make_shared<PacketChannel>(PacketChannelCapacity);
+            m_demuxer->setPacketChannel(stream->trackType(), channel);
+            stream->setPacketChannel(std::move(channel));
+            return;
+        }
+
         connect(m_demuxer.get(), Demuxer::signalByTrackType(stream->trackType()), stream.get(),
                 &StreamDecoder::decode);
         connect(m_demuxer.get(), &PlaybackEngineObject::atEnd, stream.get(),
@@ -444,11 +585,23 @@ void PlaybackEngine::createDemuxer()
 void PlaybackEngine::deleteFreeThreads() {
     m_threadsDirty = false;
     auto freeThreads = std::move(m_threads);
+    auto freeSharedThreads = std::move(m_sharedThreads);
 
+    // After switching the threading mode, both maps might have a thread with the same name
     forEachExistingObject([&](auto &object) {
-        m_threads.insert(freeThreads.extract(objectThreadName(*object)));
+        const auto name = objectThreadName(*object);
+        auto dedicated = freeThreads.find(name);
+        if (dedicated != freeThreads.end() && dedicated->second.get() == object->thread())
+            m_threads.insert(freeThreads.extract(dedicated));
+
+        auto shared = freeSharedThreads.find(name);
+        if (shared != freeSharedThreads.end() && shared->second == object->thread())
+            m_sharedThreads.insert(freeSharedThreads.extract(shared));
     });
 
+    for (auto &[name, thr] : freeSharedThreads)
+        PlaybackEngineThreadPool::instance().release(thr);
+
     for (auto &[name, thr] : freeThreads)
         thr->quit();
 
@@ -461,6 +614,7 @@ void PlaybackEngine::setMedia(MediaDataHolder media)
     Q_ASSERT(!m_media.avContext()); // Playback engine does not support reloading media
     Q_ASSERT(m_state == QMediaPlayer::StoppedState);
     Q_ASSERT(m_threads.empty());
+    Q_ASSERT(m_sharedThreads.empty());
 
     m_media = std::move(media);
     updateVideoSinkSize();
@@ -508,6 +662,9 @@ void PlaybackEngine::setAudioBufferOutput(QAudioBufferOutput *output)
 }
 
 qint64 PlaybackEngine::currentPosition(bool topPos) const {
+    if (m_cachedFramePosition)
+        return *m_cachedFramePosition;
+
     std::optional<qint64> pos;
 
     for (size_t i = 0; i < m_renderers.size(); ++i) {
@@ -559,6 +716,10 @@ void PlaybackEngine::setActiveTrack(QPlatformMediaPlayer::TrackType trackType, i
     if (!m_media.setActiveTrack(trackType, streamNumber))
         return;
 
+    m_cachedFramePosition.reset();
+    if (m_videoFrameCache && trackType == QPlatformMediaPlayer::VideoStream)
+        m_videoFrameCache->clear();
+
     m_codecs[trackType] = {};
 
     m_renderers[trackType].reset();
@@ -570,6 +731,112 @@ void PlaybackEngine::setActiveTrack(QPlatformMediaPlayer::TrackType trackType, i
     updateObjectsPausedState();
 }
 
+void PlaybackEngine::setTransportType(TransportType type)
+{
+    if (std::exchange(m_transportType, type) == type)
+        return;
+
+    qCDebug(qLcPlaybackEngine) << "Set transport type:"
+                               << (type == TransportType::Channels ? "channels"
+                                                                   : "signals and slots");
+    // The objects are linked on creation
+    forceUpdate();
+}
+
+void PlaybackEngine::setThreadingMode(ThreadingMode mode)
+{
+    if (std::exchange(m_threadingMode, mode) == mode)
+        return;
+
+    qCDebug(qLcPlaybackEngine) << "Set threading mode:"
+                               << (mode == ThreadingMode::SharedThreads ? "shared threads"
+                                                                        : "dedicated threads");
+    // Existing objects stay in their threads; the mode applies to the recreated ones
+    forceUpdate();
+}
+
+void PlaybackEngine::setSeekMode(SeekMode mode)
+{
+    if (std::exchange(m_seekMode, mode) == mode)
+        return;
+
+    qCDebug(qLcPlaybackEngine) << "Set seek mode:"
+                               << (mode == SeekMode::FastKeyframe ? "fast keyframe" : "accurate");
+}
+
+void PlaybackEngine::setScrubbingMode(bool enabled)
+{
+    if (enabled == isScrubbingMode())
+        return;
+
+    qCDebug(qLcPlaybackEngine) << "Set scrubbing mode:" << enabled;
+
+    if (enabled) {
+        m_videoFrameCache = std::make_shared<VideoFrameCache>(ScrubbingCacheMaxMemoryUsage);
+    } else {
+        m_videoFrameCache->clear();
+        m_videoFrameCache.reset();
+    }
+
+    // New video renderers get the cache on creation
+    if (auto renderer =
+                qobject_cast<VideoRenderer *>(m_renderers[QPlatformMediaPlayer::VideoStream].get()))
+        renderer->setFrameCache(m_videoFrameCache);
+}
+
+QPlaybackVideoFrameStatistics PlaybackEngine::videoFrameStatistics() const
+{
+    return m_lateFrameController ? m_lateFrameController->statistics()
+                                 : QPlaybackVideoFrameStatistics{};
+}
+
+QPlaybackStatistics PlaybackEngine::statistics() const
+{
+    auto result = m_statisticsCollector->statistics(playbackRate(), std::chrono::steady_clock::now());
+    result.videoFrames = videoFrameStatistics();
+    return result;
+}
+
+bool PlaybackEngine::presentCachedFrame(qint64 pos)
+{
+    if (!m_videoFrameCache || m_state != QMediaPlayer::PausedState || !m_videoSink)
+        return false;
+
+    // The frame of a pending forced step would replace the cached one
+    const auto &videoRenderer = m_renderers[QPlatformMediaPlayer::VideoStream];
+    if (!videoRenderer || videoRenderer->isStepForced())
+        return false;
+
+    auto frame = m_videoFrameCache->find(pos, ScrubbingCacheToleranceUs);
+    if (!frame)
+        return false;
+
+    m_videoSink->setVideoFrame(*frame);
+
+    m_timeController.setPaused(true);
+    m_timeController.sync(m_currentLoopOffset.pos + pos);
+    m_cachedFramePosition = pos;
+
+    return true;
+}
+
+void PlaybackEngine::setBufferingPolicy(const std::optional<QPlaybackBufferingPolicy> &policy)
+{
+    if (std::exchange(m_bufferingPolicy, policy) == policy)
+        return;
+
+    qCDebug(qLcPlaybackEngine) << "Set buffering policy, custom:" << policy.has_value();
+
+    if (m_demuxer)
+        m_demuxer->setBufferingPolicy(bufferingPolicy());
+}
+
+QPlaybackBufferingPolicy PlaybackEngine::bufferingPolicy() const
+{
+    return m_bufferingPolicy ? *m_bufferingPolicy
+                             : QPlaybackBufferingPolicy::defaultPolicy(m_media.sourceType());
+}
+
 void PlaybackEngine::finilizeTime(qint64 pos)
 {
     Q_ASSERT(pos >= 0 && pos <= duration());
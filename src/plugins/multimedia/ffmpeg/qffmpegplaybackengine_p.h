@@ -34,12 +34,20 @@
  *   have free threads. If it does, the thread is to be reused.
  * - If all objects for some thread are deleted, the thread becomes free and the engine
  *   postpones its termination.
+ * - Alternatively, objects can be placed on threads of the process-wide
+ *   PlaybackEngineThreadPool, shared by all engines; free threads are
+ *   returned to the pool instead of being terminated.
  *
  * OBJECTS WEAK CONNECTIVITY
  *
  * - The objects know nothing about others and about PlaybackEngine.
  *   For any interactions the objects use slots/signals.
  *
+ * - Alternatively, packets and frames can be transferred via channels
+ *   (see QFFmpeg::Channel): bounded wait-free queues with coalesced wakeups,
+ *   which avoid a queued signal per packet and per frame. The transport type
+ *   is selected per engine and applied when the objects are recreated.
+ *
  * - PlaybackEngine knows the objects object and is able to create/delete them and
  *   call their public methods.
  *
@@ -50,10 +58,16 @@
 #include "playbackengine/qffmpegmediadataholder_p.h"
 #include "playbackengine/qffmpegcodec_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "playbackengine/qffmpegavobjectpool_p.h"
+#include "playbackengine/qffmpegvideoframecache_p.h"
+#include "playbackengine/qffmpeglateframecontroller_p.h"
+#include "private/qplaybackbufferingpolicy_p.h"
 
 #include <QtCore/qpointer.h>
 
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 
 QT_BEGIN_NAMESPACE
 
@@ -70,6 +84,14 @@ class PlaybackEngine : public QObject
 {
     Q_OBJECT
 public:
+    enum class TransportType { SignalsAndSlots, Channels };
+
+    enum class ThreadingMode { DedicatedThreads, SharedThreads };
+
+    // Accurate seeking decodes the media from the preceding keyframe up to the requested
+    // position; fast seeking moves the position to the nearest known keyframe instead.
+    enum class SeekMode { Accurate, FastKeyframe };
+
     PlaybackEngine();
 
     ~PlaybackEngine() override;
@@ -119,6 +141,35 @@ public:
 
     int activeTrack(QPlatformMediaPlayer::TrackType type) const;
 
+    void setTransportType(TransportType type);
+
+    TransportType transportType() const { return m_transportType; }
+
+    void setThreadingMode(ThreadingMode mode);
+
+    ThreadingMode threadingMode() const { return m_threadingMode; }
+
+    void setSeekMode(SeekMode mode);
+
+    SeekMode seekMode() const { return m_seekMode; }
+
+    // In the scrubbing mode, the presented video frames are cached, and seeking while paused
+    // shows a cached frame, if there is one at the position, without recreating the objects.
+    void setScrubbingMode(bool enabled);
+
+    bool isScrubbingMode() const { return m_videoFrameCache != nullptr; }
+
+    // If no policy is set, the default one for the media source type is used
+    void setBufferingPolicy(const std::optional<QPlaybackBufferingPolicy> &policy);
+
+    QPlaybackBufferingPolicy bufferingPolicy() const;
+
+    // Late frames are dropped, and counted, unless QT_FFMPEG_PLAYBACK_ENGINE_KEEP_LATE_FRAMES is set
+    QPlaybackVideoFrameStatistics videoFrameStatistics() const;
+
+    // A snapshot of the statistics reported by the objects since the media was loaded
+    QPlaybackStatistics statistics() const;
+
 signals:
     void endOfStream();
     void errorOccured(int, const QString &);
@@ -154,6 +205,8 @@ private:
 
     void createDemuxer();
 
+    bool presentCachedFrame(qint64 pos);
+
     void registerObject(PlaybackEngineObject &object);
 
     template<typename C, typename Action>
@@ -203,6 +256,9 @@ private:
     TimeController m_timeController;
 
     std::unordered_map<QString, std::unique_ptr<QThread>> m_threads;
+    std::unordered_map<QString, QThread *> m_sharedThreads;
+    // The pool threads that may still have to delete killed objects
+    std::unordered_set<QThread *> m_killedObjectSharedThreads;
     bool m_threadsDirty = false;
 
     QPointer<QVideoSink> m_videoSink;
@@ -218,6 +274,19 @@ private:
     std::array<std::optional<Codec>, QPlatformMediaPlayer::NTrackTypes> m_codecs;
     int m_loops = QMediaPlayer::Once;
     LoopOffset m_currentLoopOffset;
+    TransportType m_transportType = TransportType::SignalsAndSlots;
+    ThreadingMode m_threadingMode = ThreadingMode::DedicatedThreads;
+    SeekMode m_seekMode = SeekMode::Accurate;
+    AVObjectPoolPtr m_avObjectPool = std::make_shared<AVObjectPool>();
+    std::optional<QPlaybackBufferingPolicy> m_bufferingPolicy;
+
+    LateFrameControllerPtr m_lateFrameController;
+    StatisticsCollectorPtr m_statisticsCollector = std::make_shared<StatisticsCollector>();
+
+    VideoFrameCachePtr m_videoFrameCache;
+    // The position of the cached frame presented by the last seek; the objects
+    // are recreated at this position once they are needed.
+    std::optional<qint64> m_cachedFramePosition;
 };
 
 template<typename T, typename... Args>
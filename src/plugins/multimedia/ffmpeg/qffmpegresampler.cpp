@@ -54,23 +54,55 @@ QAudioBuffer QFFmpegResampler::resample(const AVFrame *frame)
     return resample(const_cast<const uint8_t **>(frame->extended_data), frame->nb_samples);
 }
 
+int QFFmpegResampler::maxOutputFrames(const AVFrame *frame) const
+{
+    // Unlike adjustMaxOutSamples(), this doesn't reset the compensation. It changes the output
+    // by at most its delta, so the bound holds whether resample() keeps it or not.
+    const int maxOutSamples = swr_get_out_samples(m_resampler.get(), frame->nb_samples);
+    if (maxOutSamples <= 0)
+        return 0;
+
+    return maxOutSamples + qAbs(activeSampleCompensationDelta());
+}
+
+qsizetype QFFmpegResampler::resample(const AVFrame *frame, QSpan<char> output)
+{
+    const int maxOutSamples = qMin(adjustMaxOutSamples(frame->nb_samples),
+                                   m_outputFormat.framesForBytes(qint32(output.size())));
+
+    const int outSamples = convert(const_cast<const uint8_t **>(frame->extended_data),
+                                   frame->nb_samples,
+                                   reinterpret_cast<uint8_t *>(output.data()), maxOutSamples);
+    return m_outputFormat.bytesForFrames(outSamples);
+}
+
 QAudioBuffer QFFmpegResampler::resample(const uint8_t **inputData, int inputSamplesCount)
 {
     const int maxOutSamples = adjustMaxOutSamples(inputSamplesCount);
 
     QByteArray samples(m_outputFormat.bytesForFrames(maxOutSamples), Qt::Uninitialized);
-    auto *out = reinterpret_cast<uint8_t *>(samples.data());
-    const int outSamples =
-            swr_convert(m_resampler.get(), &out, maxOutSamples, inputData, inputSamplesCount);
+    const qint64 startTime = m_outputFormat.durationForFrames(m_samplesProcessed) + m_startTime;
+    const int outSamples = convert(inputData, inputSamplesCount,
+                                   reinterpret_cast<uint8_t *>(samples.data()), maxOutSamples);
 
     samples.resize(m_outputFormat.bytesForFrames(outSamples));
 
+    return QAudioBuffer(samples, m_outputFormat, startTime);
+}
+
+int QFFmpegResampler::convert(const uint8_t **inputData, int inputSamplesCount, uint8_t *out,
+                              int maxOutSamples)
+{
+    const int outSamples =
+            swr_convert(m_resampler.get(), &out, maxOutSamples, inputData, inputSamplesCount);
+
     const qint64 startTime = m_outputFormat.durationForFrames(m_samplesProcessed) + m_startTime;
-    m_samplesProcessed += outSamples;
+    if (outSamples > 0)
+        m_samplesProcessed += outSamples;
 
     qCDebug(qLcResampler) << "    new frame" << startTime << "in_samples" << inputSamplesCount
                           << outSamples << maxOutSamples;
-    return QAudioBuffer(samples, m_outputFormat, startTime);
+    return qMax(outSamples, 0);
 }
 
 int QFFmpegResampler::adjustMaxOutSamples(int inputSamplesCount)
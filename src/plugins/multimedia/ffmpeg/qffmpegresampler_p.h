@@ -18,6 +18,8 @@
 #include "qffmpeg_p.h"
 #include "private/qplatformaudioresampler_p.h"
 
+#include <QtCore/qspan.h>
+
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg
@@ -38,6 +40,11 @@ public:
 
     QAudioBuffer resample(const AVFrame *frame);
 
+    // The most frames resample() can output for frame; only queries the resampler
+    int maxOutputFrames(const AVFrame *frame) const;
+    // Resamples frame into output, which holds maxOutputFrames(); returns the bytes written
+    qsizetype resample(const AVFrame *frame, QSpan<char> output);
+
     qint64 samplesProcessed() const { return m_samplesProcessed; }
     void setSampleCompensation(qint32 delta, quint32 distance);
     qint32 activeSampleCompensationDelta() const;
@@ -46,6 +53,8 @@ private:
     int adjustMaxOutSamples(int inputSamplesCount);
 
     QAudioBuffer resample(const uint8_t **inputData, int inputSamplesCount);
+    int convert(const uint8_t **inputData, int inputSamplesCount, uint8_t *out,
+                int maxOutSamples);
 
 private:
     QAudioFormat m_inputFormat;
@@ -0,0 +1,140 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qffmpegswsframeconverter_p.h"
+
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qthread.h>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+}
+
+QT_BEGIN_NAMESPACE
+
+Q_STATIC_LOGGING_CATEGORY(qLcSwsFrameConverter, "qt.multimedia.ffmpeg.swsframeconverter");
+
+namespace QFFmpeg {
+
+// Matches the alignment of av_frame_get_buffer on AVX-512 capable builds
+static constexpr int FrameBufferAlignment = 64;
+
+// Below that, the threads synchronization costs more than the scaling itself
+static constexpr int SliceThreadingMinArea = 1280 * 720;
+
+static constexpr int MaxSliceThreads = 4;
+
+AVFrameUPtr SwsFrameConverter::convert(const AVFrame &srcFrame, AVPixelFormat dstFormat,
+                                       const QSize &dstSize)
+{
+    const Parameters parameters{ QSize(srcFrame.width, srcFrame.height),
+                                 AVPixelFormat(srcFrame.format), dstSize, dstFormat };
+
+    QMutexLocker locker(&m_mutex);
+
+    if (!ensureContext(parameters))
+        return {};
+
+    auto dstFrame = allocateFrame();
+    if (!dstFrame)
+        return {};
+
+    const int scaledHeight = sws_scale(m_context.get(), srcFrame.data, srcFrame.linesize, 0,
+                                       srcFrame.height, dstFrame->data, dstFrame->linesize);
+
+    if (scaledHeight != dstSize.height()) {
+        qCWarning(qLcSwsFrameConverter) << "Unexpected scaled height:" << scaledHeight
+                                        << "expected:" << dstSize.height();
+        return {};
+    }
+
+    return dstFrame;
+}
+
+bool SwsFrameConverter::ensureContext(const Parameters &parameters)
+{
+    if (m_context && m_parameters == parameters)
+        return true;
+
+    m_context.reset();
+    m_bufferPool.reset();
+    m_parameters.reset();
+
+    SwsContextUPtr context(sws_alloc_context(), &sws_freeContext);
+    if (!context)
+        return false;
+
+    av_opt_set_int(context.get(), "srcw", parameters.srcSize.width(), 0);
+    av_opt_set_int(context.get(), "srch", parameters.srcSize.height(), 0);
+    av_opt_set_int(context.get(), "src_format", parameters.srcFormat, 0);
+    av_opt_set_int(context.get(), "dstw", parameters.dstSize.width(), 0);
+    av_opt_set_int(context.get(), "dsth", parameters.dstSize.height(), 0);
+    av_opt_set_int(context.get(), "dst_format", parameters.dstFormat, 0);
+    av_opt_set_int(context.get(), "sws_flags", SWS_BICUBIC, 0);
+
+    int threadsCount = 1;
+#if QT_FFMPEG_HAS_SWS_SLICE_THREADS
+    const QSize &largestSize = parameters.srcSize.width() * parameters.srcSize.height()
+                    > parameters.dstSize.width() * parameters.dstSize.height()
+            ? parameters.srcSize
+            : parameters.dstSize;
+    if (largestSize.width() * largestSize.height() >= SliceThreadingMinArea)
+        threadsCount = qBound(1, QThread::idealThreadCount(), MaxSliceThreads);
+
+    av_opt_set_int(context.get(), "threads", threadsCount, 0);
+#endif
+
+    if (const int error = sws_init_context(context.get(), nullptr, nullptr); error < 0) {
+        qCWarning(qLcSwsFrameConverter) << "Cannot initialize the scaling context:"
+                                        << err2str(error);
+        return false;
+    }
+
+    m_bufferSize = av_image_get_buffer_size(parameters.dstFormat, parameters.dstSize.width(),
+                                            parameters.dstSize.height(), FrameBufferAlignment);
+    if (m_bufferSize <= 0)
+        return false;
+
+    // The buffers in use keep the previous pool alive until they're released
+    m_bufferPool.reset(av_buffer_pool_init(m_bufferSize, nullptr));
+    if (!m_bufferPool)
+        return false;
+
+    qCDebug(qLcSwsFrameConverter)
+            << "Create scaling context from" << parameters.srcSize << parameters.srcFormat << "to"
+            << parameters.dstSize << parameters.dstFormat << "threads:" << threadsCount;
+
+    m_context = std::move(context);
+    m_parameters = parameters;
+    return true;
+}
+
+AVFrameUPtr SwsFrameConverter::allocateFrame()
+{
+    Q_ASSERT(m_parameters && m_bufferPool);
+
+    auto frame = makeAVFrame();
+    if (!frame)
+        return {};
+
+    frame->buf[0] = av_buffer_pool_get(m_bufferPool.get());
+    if (!frame->buf[0])
+        return {};
+
+    frame->format = m_parameters->dstFormat;
+    frame->width = m_parameters->dstSize.width();
+    frame->height = m_parameters->dstSize.height();
+
+    const int filledSize = av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data,
+                                                m_parameters->dstFormat, frame->width,
+                                                frame->height, FrameBufferAlignment);
+    if (filledSize < 0 || filledSize > m_bufferSize)
+        return {};
+
+    return frame;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,83 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGSWSFRAMECONVERTER_P_H
+#define QFFMPEGSWSFRAMECONVERTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qsize.h>
+
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+/* Converts software frames of a video stream into another pixel format and size.
+ *
+ * The scaling context is kept as long as the source and destination parameters stay
+ * the same, and the destination frames are allocated from a buffer pool, so a stream
+ * of frames with the same parameters doesn't allocate anything per frame.
+ * Large frames are scaled with slice threading, if FFmpeg supports it.
+ *
+ * The converter is shared between the video buffers of a stream, which may be mapped
+ * from different threads, so conversions are serialized.
+ */
+class SwsFrameConverter
+{
+public:
+    // Returns null on failure
+    AVFrameUPtr convert(const AVFrame &srcFrame, AVPixelFormat dstFormat, const QSize &dstSize);
+
+private:
+    struct Parameters
+    {
+        QSize srcSize;
+        AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
+        QSize dstSize;
+        AVPixelFormat dstFormat = AV_PIX_FMT_NONE;
+
+        bool operator==(const Parameters &other) const
+        {
+            return srcSize == other.srcSize && srcFormat == other.srcFormat
+                    && dstSize == other.dstSize && dstFormat == other.dstFormat;
+        }
+    };
+
+    bool ensureContext(const Parameters &parameters);
+
+    AVFrameUPtr allocateFrame();
+
+private:
+    using SwsContextUPtr = std::unique_ptr<SwsContext, decltype(&sws_freeContext)>;
+    using AVBufferPoolUPtr =
+            std::unique_ptr<AVBufferPool,
+                            AVDeleter<decltype(&av_buffer_pool_uninit), &av_buffer_pool_uninit>>;
+
+    QMutex m_mutex;
+    std::optional<Parameters> m_parameters;
+    SwsContextUPtr m_context = { nullptr, &sws_freeContext };
+    AVBufferPoolUPtr m_bufferPool;
+    int m_bufferSize = 0;
+};
+
+using SwsFrameConverterPtr = std::shared_ptr<SwsFrameConverter>;
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGSWSFRAMECONVERTER_P_H
@@ -26,11 +26,13 @@ static bool isFrameFlipped(const AVFrame& frame) {
 
 Q_STATIC_LOGGING_CATEGORY(qLcFFmpegVideoBuffer, "qt.multimedia.ffmpeg.videobuffer");
 
-QFFmpegVideoBuffer::QFFmpegVideoBuffer(AVFrameUPtr frame, AVRational pixelAspectRatio)
+QFFmpegVideoBuffer::QFFmpegVideoBuffer(AVFrameUPtr frame, AVRational pixelAspectRatio,
+                                       QFFmpeg::SwsFrameConverterPtr converter)
     : QHwVideoBuffer(QVideoFrame::NoHandle),
       m_frame(frame.get()),
       m_size(qCalculateFrameSize({ frame->width, frame->height },
-                                 { pixelAspectRatio.num, pixelAspectRatio.den }))
+                                 { pixelAspectRatio.num, pixelAspectRatio.den })),
+      m_converter(std::move(converter))
 {
     if (frame->hw_frames_ctx) {
         m_hwFrame = std::move(frame);
@@ -46,7 +48,7 @@ QFFmpegVideoBuffer::QFFmpegVideoBuffer(AVFrameUPtr frame, AVRational pixelAspect
 
 QFFmpegVideoBuffer::~QFFmpegVideoBuffer() = default;
 
-void QFFmpegVideoBuffer::convertSWFrame()
+bool QFFmpegVideoBuffer::convertSWFrame()
 {
     Q_ASSERT(m_swFrame);
 
@@ -57,22 +59,25 @@ void QFFmpegVideoBuffer::convertSWFrame()
         || m_size != QSize(m_swFrame->width, m_swFrame->height)) {
         Q_ASSERT(toQtPixelFormat(targetAVPixelFormat) == m_pixelFormat);
         // convert the format into something we can handle
-        SwsContext *c = sws_getContext(m_swFrame->width, m_swFrame->height, actualAVPixelFormat,
-                                       m_size.width(), m_size.height(), targetAVPixelFormat,
-                                       SWS_BICUBIC, nullptr, nullptr, nullptr);
-
-        auto newFrame = QFFmpeg::makeAVFrame();
-        newFrame->width = m_size.width();
-        newFrame->height = m_size.height();
-        newFrame->format = targetAVPixelFormat;
-        av_frame_get_buffer(newFrame.get(), 0);
+        if (!m_converter)
+            m_converter = std::make_shared<QFFmpeg::SwsFrameConverter>();
+
+        auto newFrame = m_converter->convert(*m_swFrame, targetAVPixelFormat, m_size);
+        if (!newFrame) {
+            qCWarning(qLcFFmpegVideoBuffer) << "Cannot convert the frame from"
+                                            << actualAVPixelFormat << "to" << targetAVPixelFormat;
+            if (m_frame == m_swFrame.get())
+                m_unconvertedFrame = std::move(m_swFrame);
+            m_swFrame.reset();
+            return false;
+        }
 
-        sws_scale(c, m_swFrame->data, m_swFrame->linesize, 0, m_swFrame->height, newFrame->data, newFrame->linesize);
         if (m_frame == m_swFrame.get())
             m_frame = newFrame.get();
         m_swFrame = std::move(newFrame);
-        sws_freeContext(c);
     }
+
+    return true;
 }
 
 void QFFmpegVideoBuffer::setTextureConverter(const QFFmpeg::TextureConverter &converter)
@@ -116,15 +121,22 @@ float QFFmpegVideoBuffer::maxNits()
 QAbstractVideoBuffer::MapData QFFmpegVideoBuffer::map(QVideoFrame::MapMode mode)
 {
     if (!m_swFrame) {
-        Q_ASSERT(m_hwFrame && m_hwFrame->hw_frames_ctx);
+        // The frame given on creation couldn't be converted
+        if (!m_hwFrame)
+            return {};
+
+        Q_ASSERT(m_hwFrame->hw_frames_ctx);
         m_swFrame = QFFmpeg::makeAVFrame();
         /* retrieve data from GPU to CPU */
+        countReadBack();
         int ret = av_hwframe_transfer_data(m_swFrame.get(), m_hwFrame.get(), 0);
         if (ret < 0) {
             qWarning() << "Error transferring the data to system memory:" << ret;
+            m_swFrame.reset();
             return {};
         }
-        convertSWFrame();
+        if (!convertSWFrame())
+            return {};
     }
 
     m_mode = mode;
@@ -20,6 +20,7 @@
 
 #include "qffmpeg_p.h"
 #include "qffmpeghwaccel_p.h"
+#include "qffmpegswsframeconverter_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -28,7 +29,10 @@ class QFFmpegVideoBuffer : public QHwVideoBuffer
 public:
     using AVFrameUPtr = QFFmpeg::AVFrameUPtr;
 
-    QFFmpegVideoBuffer(AVFrameUPtr frame, AVRational pixelAspectRatio = { 1, 1 });
+    // The converter is supposed to be shared between the buffers of a stream;
+    // if it's null, a temporary one is used for each conversion.
+    QFFmpegVideoBuffer(AVFrameUPtr frame, AVRational pixelAspectRatio = { 1, 1 },
+                       QFFmpeg::SwsFrameConverterPtr converter = {});
     ~QFFmpegVideoBuffer() override;
 
     MapData map(QVideoFrame::MapMode mode) override;
@@ -43,7 +47,9 @@ public:
     static QVideoFrameFormat::PixelFormat toQtPixelFormat(AVPixelFormat avPixelFormat, bool *needsConversion = nullptr);
     static AVPixelFormat toAVPixelFormat(QVideoFrameFormat::PixelFormat pixelFormat);
 
-    void convertSWFrame();
+    // Converts the software frame to the reported pixel format and size. On failure,
+    // the software frame is dropped, so that it's never mapped in another format.
+    bool convertSWFrame();
 
     AVFrame *getHWFrame() const { return m_hwFrame.get(); }
 
@@ -60,10 +66,13 @@ private:
     AVFrame *m_frame = nullptr;
     AVFrameUPtr m_hwFrame;
     AVFrameUPtr m_swFrame;
+    // Keeps m_frame alive if the software frame given on creation couldn't be converted
+    AVFrameUPtr m_unconvertedFrame;
     QSize m_size;
     QFFmpeg::TextureConverter m_textureConverter;
     QVideoFrame::MapMode m_mode = QVideoFrame::NotMapped;
     std::unique_ptr<QFFmpeg::TextureSet> m_textures;
+    QFFmpeg::SwsFrameConverterPtr m_converter;
 };
 
 QT_END_NAMESPACE
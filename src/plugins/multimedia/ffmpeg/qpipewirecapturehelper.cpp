@@ -39,13 +39,11 @@
 
 #include "private/qvideoframe_p.h"
 #include "private/qcapturablewindow_p.h"
-#include "private/qmemoryvideobuffer_p.h"
 #include "private/qvideoframeconversionhelper_p.h"
+#include "private/qpipewire_symbolloader_p.h"
 
 QT_BEGIN_NAMESPACE
 
-extern bool isPipewireLoaded();
-
 using namespace Qt::StringLiterals;
 
 static Q_LOGGING_CATEGORY(qLcPipeWireCapture, "qt.multimedia.ffmpeg.pipewirecapture");
@@ -144,7 +142,7 @@ void QPipeWireCaptureHelper::updateError(QPlatformSurfaceCapture::Error error,
 
 bool QPipeWireCapture::isSupported()
 {
-    if (!isPipewireLoaded())
+    if (!isPipeWireLoaded())
         return false;
 
     return QPipeWireCaptureHelper::isSupported();
@@ -789,10 +787,11 @@ void QPipeWireCaptureHelper::onProcess()
     if (m_videoFrameFormat.frameSize() != m_size || m_videoFrameFormat.pixelFormat() != m_pixelFormat)
         m_videoFrameFormat = QVideoFrameFormat(m_size, m_pixelFormat);
 
-    m_currentFrame = QVideoFramePrivate::createFrame(
-            std::make_unique<QMemoryVideoBuffer>(QByteArray(static_cast<const char *>(sdata), size), sstride),
-            m_videoFrameFormat);
-    emit m_capture.newVideoFrame(m_currentFrame);
+    if (auto buffer = m_framePool.createBuffer(size, sstride)) {
+        memcpy(buffer->map(QVideoFrame::WriteOnly).data[0], sdata, size);
+        m_currentFrame = QVideoFramePrivate::createFrame(std::move(buffer), m_videoFrameFormat);
+        emit m_capture.newVideoFrame(m_currentFrame);
+    }
     qCDebug(qLcPipeWireCaptureMore) << "got a frame of size " << buf->datas[0].chunk->size;
 
     pw_stream_queue_buffer(m_stream, b);
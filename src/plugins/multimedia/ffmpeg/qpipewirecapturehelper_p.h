@@ -18,6 +18,7 @@
 #include "qpipewirecapture_p.h"
 
 #include <qvideoframe.h>
+#include <private/qvideoframepool_p.h>
 
 #include <spa/debug/types.h>
 #include <spa/utils/dict.h>
@@ -93,6 +94,7 @@ private:
     QPipeWireCapture &m_capture;
     std::shared_ptr<QtPipeWire::Pipewire> m_pipewire;
 
+    QVideoFramePool m_framePool;
     QVideoFrame m_currentFrame;
     QVideoFrameFormat m_videoFrameFormat;
     QVideoFrameFormat::PixelFormat m_pixelFormat;
@@ -7,7 +7,6 @@
 
 #include <private/qcameradevice_p.h>
 #include <private/qmultimediautils_p.h>
-#include <private/qmemoryvideobuffer_p.h>
 #include <private/qvideoframe_p.h>
 #include <private/qcore_unix_p.h>
 
@@ -374,11 +373,21 @@ void QV4L2Camera::readFrame()
         return;
     }
 
-    auto videoBuffer = std::make_unique<QMemoryVideoBuffer>(buffer->data, m_bytesPerLine);
-    QVideoFrame frame = QVideoFramePrivate::createFrame(std::move(videoBuffer), frameFormat());
-
     auto &v4l2Buffer = buffer->v4l2Buffer;
 
+    if (!buffer->videoBuffer) {
+        // The frame memory couldn't be allocated; drop the frame and give the buffer back
+        qCWarning(qLcV4L2Camera) << "Cannot create video buffer, skipping frame";
+
+        if (!m_memoryTransfer->enqueueBuffer(v4l2Buffer.index))
+            qCWarning(qLcV4L2Camera) << "Cannot add buffer";
+
+        return;
+    }
+
+    QVideoFrame frame =
+            QVideoFramePrivate::createFrame(std::move(buffer->videoBuffer), frameFormat());
+
     if (m_firstFrameTime.tv_sec == -1)
         m_firstFrameTime = v4l2Buffer.timestamp;
     qint64 secs = v4l2Buffer.timestamp.tv_sec - m_firstFrameTime.tv_sec;
@@ -636,7 +645,8 @@ void QV4L2Camera::initV4L2MemoryTransfer()
 
     Q_ASSERT(!m_memoryTransfer);
 
-    m_memoryTransfer = makeUserPtrMemoryTransfer(m_v4l2FileDescriptor, m_imageSize);
+    m_memoryTransfer =
+            makeUserPtrMemoryTransfer(m_v4l2FileDescriptor, m_imageSize, m_bytesPerLine);
 
     if (m_memoryTransfer)
         return;
@@ -648,7 +658,7 @@ void QV4L2Camera::initV4L2MemoryTransfer()
 
     qCDebug(qLcV4L2Camera) << "Cannot init V4L2_MEMORY_USERPTR; trying V4L2_MEMORY_MMAP";
 
-    m_memoryTransfer = makeMMapMemoryTransfer(m_v4l2FileDescriptor);
+    m_memoryTransfer = makeMMapMemoryTransfer(m_v4l2FileDescriptor, m_bytesPerLine);
 
     if (!m_memoryTransfer) {
         qCWarning(qLcV4L2Camera) << "Cannot init v4l2 memory transfer," << qt_error_string(errno);
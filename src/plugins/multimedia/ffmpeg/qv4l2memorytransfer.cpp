@@ -27,7 +27,8 @@ v4l2_buffer makeV4l2Buffer(quint32 memoryType, quint32 index = 0)
 class UserPtrMemoryTransfer : public QV4L2MemoryTransfer
 {
 public:
-    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor, quint32 imageSize)
+    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor, quint32 imageSize,
+                                          quint32 bytesPerLine)
     {
         quint32 buffersCount = 2;
         if (!fileDescriptor->requestBuffers(V4L2_MEMORY_USERPTR, buffersCount)) {
@@ -35,8 +36,8 @@ public:
             return {};
         }
 
-        std::unique_ptr<UserPtrMemoryTransfer> result(
-                new UserPtrMemoryTransfer(std::move(fileDescriptor), buffersCount, imageSize));
+        std::unique_ptr<UserPtrMemoryTransfer> result(new UserPtrMemoryTransfer(
+                std::move(fileDescriptor), buffersCount, imageSize, bytesPerLine));
 
         return result->enqueueBuffers() ? std::move(result) : nullptr;
     }
@@ -47,24 +48,27 @@ public:
         if (!fileDescriptor().call(VIDIOC_DQBUF, &v4l2Buffer))
             return {};
 
-        Q_ASSERT(v4l2Buffer.index < m_byteArrays.size());
-        Q_ASSERT(!m_byteArrays[v4l2Buffer.index].isEmpty());
+        Q_ASSERT(v4l2Buffer.index < m_videoBuffers.size());
+        Q_ASSERT(m_videoBuffers[v4l2Buffer.index]);
 
-        return Buffer{ v4l2Buffer, std::move(m_byteArrays[v4l2Buffer.index]) };
+        return Buffer{ v4l2Buffer, std::move(m_videoBuffers[v4l2Buffer.index]) };
     }
 
     bool enqueueBuffer(quint32 index) override
     {
-        Q_ASSERT(index < m_byteArrays.size());
-        Q_ASSERT(m_byteArrays[index].isEmpty());
+        Q_ASSERT(index < m_videoBuffers.size());
+        Q_ASSERT(!m_videoBuffers[index]);
 
         auto buf = makeV4l2Buffer(V4L2_MEMORY_USERPTR, index);
         static_assert(sizeof(decltype(buf.m.userptr)) == sizeof(size_t), "Not compatible sizes");
 
-        m_byteArrays[index] = QByteArray(static_cast<int>(m_imageSize), Qt::Uninitialized);
+        m_videoBuffers[index] = createVideoBuffer(m_imageSize);
+        if (!m_videoBuffers[index])
+            return false;
 
-        buf.m.userptr = (decltype(buf.m.userptr))m_byteArrays[index].data();
-        buf.length = m_byteArrays[index].size();
+        const auto mapData = m_videoBuffers[index]->map(QVideoFrame::WriteOnly);
+        buf.m.userptr = (decltype(buf.m.userptr))mapData.data[0];
+        buf.length = mapData.dataSize[0];
 
         if (!fileDescriptor().call(VIDIOC_QBUF, &buf)) {
             qWarning() << "Couldn't add V4L2 buffer" << errno << strerror(errno) << index;
@@ -74,20 +78,20 @@ public:
         return true;
     }
 
-    quint32 buffersCount() const override { return static_cast<quint32>(m_byteArrays.size()); }
+    quint32 buffersCount() const override { return static_cast<quint32>(m_videoBuffers.size()); }
 
 private:
     UserPtrMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor, quint32 buffersCount,
-                          quint32 imageSize)
-        : QV4L2MemoryTransfer(std::move(fileDescriptor)),
+                          quint32 imageSize, quint32 bytesPerLine)
+        : QV4L2MemoryTransfer(std::move(fileDescriptor), bytesPerLine),
           m_imageSize(imageSize),
-          m_byteArrays(buffersCount)
+          m_videoBuffers(buffersCount)
     {
     }
 
 private:
     quint32 m_imageSize;
-    std::vector<QByteArray> m_byteArrays;
+    std::vector<std::unique_ptr<QAbstractVideoBuffer>> m_videoBuffers;
 };
 
 class MMapMemoryTransfer : public QV4L2MemoryTransfer
@@ -100,7 +104,8 @@ public:
         bool inQueue = false;
     };
 
-    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor)
+    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor,
+                                          quint32 bytesPerLine)
     {
         quint32 buffersCount = 2;
         if (!fileDescriptor->requestBuffers(V4L2_MEMORY_MMAP, buffersCount)) {
@@ -109,7 +114,7 @@ public:
         }
 
         std::unique_ptr<MMapMemoryTransfer> result(
-                new MMapMemoryTransfer(std::move(fileDescriptor)));
+                new MMapMemoryTransfer(std::move(fileDescriptor), bytesPerLine));
 
         return result->init(buffersCount) ? std::move(result) : nullptr;
     }
@@ -161,8 +166,12 @@ public:
         Q_ASSERT(span.inQueue);
         span.inQueue = false;
 
-        return Buffer{ v4l2Buffer,
-                       QByteArray(reinterpret_cast<const char *>(span.data), span.size) };
+        // The span is queued again right after, so the frame gets a copy
+        auto videoBuffer = createVideoBuffer(span.size);
+        if (videoBuffer)
+            memcpy(videoBuffer->map(QVideoFrame::WriteOnly).data[0], span.data, span.size);
+
+        return Buffer{ v4l2Buffer, std::move(videoBuffer) };
     }
 
     bool enqueueBuffer(quint32 index) override
@@ -188,8 +197,9 @@ private:
 };
 } // namespace
 
-QV4L2MemoryTransfer::QV4L2MemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor)
-    : m_fileDescriptor(std::move(fileDescriptor))
+QV4L2MemoryTransfer::QV4L2MemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
+                                         quint32 bytesPerLine)
+    : m_fileDescriptor(std::move(fileDescriptor)), m_bytesPerLine(bytesPerLine)
 {
     Q_ASSERT(m_fileDescriptor);
     Q_ASSERT(!m_fileDescriptor->streamStarted());
@@ -200,6 +210,11 @@ QV4L2MemoryTransfer::~QV4L2MemoryTransfer()
     Q_ASSERT(!m_fileDescriptor->streamStarted()); // to avoid possible corruptions
 }
 
+std::unique_ptr<QAbstractVideoBuffer> QV4L2MemoryTransfer::createVideoBuffer(qsizetype size)
+{
+    return m_framePool.createBuffer(size, m_bytesPerLine);
+}
+
 bool QV4L2MemoryTransfer::enqueueBuffers()
 {
     for (quint32 i = 0; i < buffersCount(); ++i)
@@ -210,14 +225,15 @@ bool QV4L2MemoryTransfer::enqueueBuffers()
 }
 
 QV4L2MemoryTransferUPtr makeUserPtrMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
-                                                  quint32 imageSize)
+                                                  quint32 imageSize, quint32 bytesPerLine)
 {
-    return UserPtrMemoryTransfer::create(std::move(fileDescriptor), imageSize);
+    return UserPtrMemoryTransfer::create(std::move(fileDescriptor), imageSize, bytesPerLine);
 }
 
-QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor)
+QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
+                                               quint32 bytesPerLine)
 {
-    return MMapMemoryTransfer::create(std::move(fileDescriptor));
+    return MMapMemoryTransfer::create(std::move(fileDescriptor), bytesPerLine);
 }
 
 QT_END_NAMESPACE
@@ -5,7 +5,8 @@
 #define QV4L2MEMORYTRANSFER_P_H
 
 #include <private/qtmultimediaglobal_p.h>
-#include <qbytearray.h>
+#include <private/qvideoframepool_p.h>
+#include <qabstractvideobuffer.h>
 #include <linux/videodev2.h>
 
 #include <memory>
@@ -32,10 +33,10 @@ public:
     struct Buffer
     {
         v4l2_buffer v4l2Buffer = {};
-        QByteArray data;
+        std::unique_ptr<QAbstractVideoBuffer> videoBuffer;
     };
 
-    QV4L2MemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor);
+    QV4L2MemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor, quint32 bytesPerLine);
 
     virtual ~QV4L2MemoryTransfer();
 
@@ -50,16 +51,22 @@ protected:
 
     const QV4L2FileDescriptor &fileDescriptor() const { return *m_fileDescriptor; }
 
+    // The frames return the memory to the pool, so capturing doesn't allocate per frame
+    std::unique_ptr<QAbstractVideoBuffer> createVideoBuffer(qsizetype size);
+
 private:
     QV4L2FileDescriptorPtr m_fileDescriptor;
+    quint32 m_bytesPerLine = 0;
+    QVideoFramePool m_framePool;
 };
 
 using QV4L2MemoryTransferUPtr = std::unique_ptr<QV4L2MemoryTransfer>;
 
 QV4L2MemoryTransferUPtr makeUserPtrMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
-                                                  quint32 imageSize);
+                                                  quint32 imageSize, quint32 bytesPerLine);
 
-QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor);
+QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
+                                               quint32 bytesPerLine);
 
 QT_END_NAMESPACE
 
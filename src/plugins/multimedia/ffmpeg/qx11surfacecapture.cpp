@@ -12,9 +12,9 @@
 #include <qloggingcategory.h>
 
 #include "private/qcapturablewindow_p.h"
-#include "private/qmemoryvideobuffer_p.h"
 #include "private/qvideoframeconversionhelper_p.h"
 #include "private/qvideoframe_p.h"
+#include "private/qvideoframepool_p.h"
 
 #include <X11/Xlib.h>
 #include <sys/shm.h>
@@ -266,17 +266,19 @@ protected:
             return {};
         }
 
-        QByteArray data(m_xImage->bytes_per_line * m_xImage->height, Qt::Uninitialized);
+        const qsizetype size = qsizetype(m_xImage->bytes_per_line) * m_xImage->height;
+        auto buffer = m_framePool.createBuffer(size, m_xImage->bytes_per_line);
+        if (!buffer)
+            return {};
 
         const auto pixelSrc = reinterpret_cast<const uint32_t *>(m_xImage->data);
-        const auto pixelDst = reinterpret_cast<uint32_t *>(data.data());
-        const auto pixelCount = data.size() / 4;
+        const auto pixelDst = reinterpret_cast<uint32_t *>(buffer->map(QVideoFrame::WriteOnly).data[0]);
+        const auto pixelCount = size / 4;
         const auto xImageAlphaVaries = false; // In known cases it doesn't vary - it's 0xff or 0xff
 
         qCopyPixelsWithAlphaMask(pixelDst, pixelSrc, pixelCount, m_format.pixelFormat(),
                                        xImageAlphaVaries);
 
-        auto buffer = std::make_unique<QMemoryVideoBuffer>(data, m_xImage->bytes_per_line);
         return QVideoFramePrivate::createFrame(std::move(buffer), m_format);
     }
 
@@ -291,6 +293,7 @@ private:
     bool m_attached = false;
     VisualID m_visualID = None;
     QVideoFrameFormat m_format;
+    QVideoFramePool m_framePool;
 };
 
 QX11SurfaceCapture::QX11SurfaceCapture(Source initialSource)
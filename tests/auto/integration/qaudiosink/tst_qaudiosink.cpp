@@ -7,6 +7,8 @@
 #include <QtCore/QSharedPointer>
 #include <QtCore/QScopedPointer>
 
+#include <atomic>
+
 #include "../shared/audiogenerationutils.h"
 #include <qaudiosink.h>
 #include <qaudiodevice.h>
@@ -59,6 +61,11 @@ private slots:
     void volume_data();
     void volume();
 
+    void start_rendersAudioWithCallback();
+    void start_printsWarning_whenCallbackDoesNotMatchSampleFormat();
+
+    void beginWrite_lendsBuffer_inPushMode();
+
 private:
     using FilePtr = QSharedPointer<QFile>;
 
@@ -1003,6 +1010,112 @@ void tst_QAudioSink::volume()
     QTRY_VERIFY(qRound(audioOutput.volume()*10.0f) == expectedInt);
 }
 
+void tst_QAudioSink::start_rendersAudioWithCallback()
+{
+    const QAudioFormat format = testFormats.first();
+    QCOMPARE(format.sampleFormat(), QAudioFormat::Int16);
+
+    QAudioSink audioOutput(format, this);
+
+    std::atomic_int callCount = 0;
+    std::atomic_bool hasPartialFrames = false;
+    audioOutput.start([&](QSpan<qint16> samples) {
+        std::fill(samples.begin(), samples.end(), qint16(0));
+        if (samples.empty() || samples.size() % format.channelCount() != 0)
+            hasPartialFrames = true;
+        ++callCount;
+    });
+
+    if (audioOutput.state() == QAudio::StoppedState && audioOutput.error() == QAudio::NoError)
+        QSKIP("The audio backend doesn't support callbacks");
+
+    QCOMPARE(audioOutput.state(), QAudio::ActiveState);
+    QCOMPARE(audioOutput.error(), QAudio::NoError);
+
+    QTRY_VERIFY(callCount > 1);
+    QVERIFY(!hasPartialFrames);
+    QTRY_VERIFY(audioOutput.processedUSecs() > 0);
+
+    audioOutput.stop();
+    QCOMPARE(audioOutput.state(), QAudio::StoppedState);
+
+    // The callback mustn't be invoked once stop() has returned
+    const int callCountAfterStop = callCount;
+    QTest::qWait(100);
+    QCOMPARE(callCount, callCountAfterStop);
+}
+
+void tst_QAudioSink::start_printsWarning_whenCallbackDoesNotMatchSampleFormat()
+{
+    const QAudioFormat format = testFormats.first();
+    QCOMPARE(format.sampleFormat(), QAudioFormat::Int16);
+
+    QAudioSink audioOutput(format, this);
+    QSignalSpy stateSignal(&audioOutput, &QAudioSink::stateChanged);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("doesn't match the sample format"));
+    audioOutput.start([](QSpan<float>) { QFAIL("the callback mustn't be invoked"); });
+
+    QTest::qWait(100);
+    QCOMPARE(audioOutput.state(), QAudio::StoppedState);
+    QCOMPARE(stateSignal.size(), 0);
+}
+
+void tst_QAudioSink::beginWrite_lendsBuffer_inPushMode()
+{
+    const QAudioFormat format = testFormats.first();
+
+    QAudioSink audioOutput(format, this);
+    QVERIFY(audioOutput.beginWrite().isEmpty());
+
+    QIODevice *feed = audioOutput.start();
+    QVERIFY(feed);
+
+    QSpan<char> region = audioOutput.beginWrite();
+    if (region.isEmpty())
+        QSKIP("The audio backend doesn't lend its buffer");
+
+    QCOMPARE_LE(region.size(), audioOutput.bytesFree());
+
+    // Giving the region back doesn't queue anything
+    const qsizetype bytesFree = audioOutput.bytesFree();
+    audioOutput.commitWrite(0);
+    QCOMPARE(audioOutput.bytesFree(), bytesFree);
+
+    // Keep the buffer full, so that the sink doesn't underrun into the idle state while the
+    // checks below wait
+    const qsizetype frameBytes = format.bytesPerFrame();
+    qint64 committed = 0;
+    auto commitSilence = [&] {
+        while (true) {
+            const QSpan<char> region = audioOutput.beginWrite();
+            const qsizetype bytes = region.size() / frameBytes * frameBytes;
+            if (bytes == 0) {
+                audioOutput.commitWrite(0);
+                return;
+            }
+            std::fill(region.begin(), region.end(), '\0');
+            audioOutput.commitWrite(bytes);
+            committed += bytes;
+        }
+    };
+    commitSilence();
+    QCOMPARE_GT(committed, 0);
+
+    QTimer feeder;
+    connect(&feeder, &QTimer::timeout, this, commitSilence);
+    feeder.start(5);
+
+    QTRY_COMPARE(audioOutput.state(), QAudio::ActiveState);
+    QTRY_VERIFY(audioOutput.processedUSecs() > 0);
+    QCOMPARE(audioOutput.state(), QAudio::ActiveState);
+
+    feeder.stop();
+    audioOutput.stop();
+    QCOMPARE(audioOutput.state(), QAudio::StoppedState);
+    QVERIFY(audioOutput.beginWrite().isEmpty());
+}
+
 QTEST_MAIN(tst_QAudioSink)
 
 #include "tst_qaudiosink.moc"
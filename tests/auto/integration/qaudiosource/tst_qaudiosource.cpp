@@ -7,6 +7,8 @@
 #include <QtCore/QSharedPointer>
 #include <QtCore/QScopedPointer>
 
+#include <atomic>
+
 #include <qaudiosource.h>
 #include <qaudiodevice.h>
 #include <qaudioformat.h>
@@ -61,6 +63,9 @@ private slots:
 
     void stop_finishesPushMode_whenInvokedUponReadyReadSignal();
 
+    void start_capturesAudioWithCallback();
+    void start_printsWarning_whenCallbackDoesNotMatchSampleFormat();
+
 private:
     using FilePtr = QSharedPointer<QFile>;
 
@@ -845,6 +850,56 @@ void tst_QAudioSource::stop_finishesPushMode_whenInvokedUponReadyReadSignal()
              "didn't transitions to StoppedState after close()");
 }
 
+void tst_QAudioSource::start_capturesAudioWithCallback()
+{
+    const QAudioFormat format = testFormats.first();
+    QCOMPARE(format.sampleFormat(), QAudioFormat::Int16);
+
+    QAudioSource audioInput(format, this);
+
+    std::atomic_int callCount = 0;
+    std::atomic_bool hasPartialFrames = false;
+    audioInput.start([&](QSpan<const qint16> samples) {
+        if (samples.empty() || samples.size() % format.channelCount() != 0)
+            hasPartialFrames = true;
+        ++callCount;
+    });
+
+    if (audioInput.state() == QAudio::StoppedState && audioInput.error() == QAudio::NoError)
+        QSKIP("The audio backend doesn't support callbacks");
+
+    QCOMPARE(audioInput.state(), QAudio::ActiveState);
+    QCOMPARE(audioInput.error(), QAudio::NoError);
+
+    QTRY_VERIFY(callCount > 1);
+    QVERIFY(!hasPartialFrames);
+    QTRY_VERIFY(audioInput.processedUSecs() > 0);
+
+    audioInput.stop();
+    QCOMPARE(audioInput.state(), QAudio::StoppedState);
+
+    // The callback mustn't be invoked once stop() has returned
+    const int callCountAfterStop = callCount;
+    QTest::qWait(100);
+    QCOMPARE(callCount, callCountAfterStop);
+}
+
+void tst_QAudioSource::start_printsWarning_whenCallbackDoesNotMatchSampleFormat()
+{
+    const QAudioFormat format = testFormats.first();
+    QCOMPARE(format.sampleFormat(), QAudioFormat::Int16);
+
+    QAudioSource audioInput(format, this);
+    QSignalSpy stateSignal(&audioInput, &QAudioSource::stateChanged);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("doesn't match the sample format"));
+    audioInput.start([](QSpan<const float>) { QFAIL("the callback mustn't be invoked"); });
+
+    QTest::qWait(100);
+    QCOMPARE(audioInput.state(), QAudio::StoppedState);
+    QCOMPARE(stateSignal.size(), 0);
+}
+
 QTEST_MAIN(tst_QAudioSource)
 
 #include "tst_qaudiosource.moc"
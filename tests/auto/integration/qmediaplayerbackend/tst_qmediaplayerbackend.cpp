@@ -24,6 +24,8 @@
 #endif
 #include <qmediatimerange.h>
 #include <private/qplatformvideosink_p.h>
+#include <private/qhwvideobuffer_p.h>
+#include <private/qmediaplayer_p.h>
 
 #include <QtQml/qqmlengine.h>
 #include <QtQml/qqmlcomponent.h>
@@ -34,10 +36,12 @@
 
 #include "mediafileselector.h"
 #include "mediabackendutils.h"
+#include "qscopedenvironmentvariable.h"
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
 #include "private/qquickvideooutput_p.h"
 
 #include <array>
+#include <numeric>
 
 // NOLINTBEGIN(readability-convert-member-functions-to-static)
 
@@ -236,9 +240,25 @@ private slots:
     void play_finishes_whenPlayingFileWithPacketsAfterStreamEnd_data();
     void play_finishes_whenPlayingFileWithPacketsAfterStreamEnd();
 
+    void play_doesNotReadBackHwFrames_whenRenderedWithOpenGL_data();
+    void play_doesNotReadBackHwFrames_whenRenderedWithOpenGL();
+
+    void play_reportsVideoFrameStatistics();
+    void play_reportsPlaybackStatistics();
+    void play_reachesEndOfMedia_withDefaultConstructedBufferingPolicy();
+    void stop_resetsObjectsStatistics_whenKilledObjectsAreStillRunning();
+
+    void play_playsAndSeeks_withEngineTransportAndThreading_data();
+    void play_playsAndSeeks_withEngineTransportAndThreading();
+
+    void setPosition_presentsCachedFrame_whenPausedInScrubbingMode();
+    void setPosition_decodesFrame_afterScrubbingModeIsDisabled();
+
     void makeStressTestCases();
     void stressTest_setupAndTeardown();
     void stressTest_setupAndTeardown_data();
+    void stressTest_setupAndTeardown_sharedThreads();
+    void stressTest_setupAndTeardown_sharedThreads_data();
     void stressTest_setupAndTeardown_keepAudioOutput();
     void stressTest_setupAndTeardown_keepAudioOutput_data();
     void stressTest_setupAndTeardown_keepVideoOutput();
@@ -4528,6 +4548,273 @@ void tst_QMediaPlayerBackend::play_finishes_whenPlayingFileWithPacketsAfterStrea
     QCOMPARE(loopIterations(m_fixture->positionChanged).size(), loops);
 }
 
+void tst_QMediaPlayerBackend::play_doesNotReadBackHwFrames_whenRenderedWithOpenGL_data()
+{
+    QTest::addColumn<MaybeUrl>("media");
+
+    QTest::addRow("nv12") << m_localVideoFile;
+    QTest::addRow("p010") << m_hdrVideo;
+}
+
+void tst_QMediaPlayerBackend::play_doesNotReadBackHwFrames_whenRenderedWithOpenGL()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("The test covers the VAAPI zero-copy path only");
+#endif
+    QSKIP_IF_NOT_FFMPEG();
+
+    QFETCH(const MaybeUrl, media);
+    CHECK_SELECTED_URL(media);
+
+    const auto previousGraphicsApi = QQuickWindow::graphicsApi();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL);
+    auto cleanup = qScopeGuard([&] { QQuickWindow::setGraphicsApi(previousGraphicsApi); });
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData("import QtMultimedia; VideoOutput { width: 320; height: 240 }", QUrl());
+    QScopedPointer<QObject> root(component.create());
+    auto *videoOutput = qobject_cast<QQuickVideoOutput *>(root.get());
+    QVERIFY(videoOutput);
+
+    QQuickView view;
+    videoOutput->setParentItem(view.contentItem());
+    view.resize(320, 240);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QMediaPlayer player;
+    player.setVideoOutput(videoOutput);
+    QSignalSpy framesSpy(videoOutput->videoSink(), &QVideoSink::videoFrameChanged);
+    const quint64 readBacksBefore = QHwVideoBuffer::readBackCount();
+
+    player.setSource(*media);
+    player.play();
+
+    QTRY_COMPARE_GE(framesSpy.size(), 10);
+
+    QList<QVideoFrame> frames;
+    for (const auto &arguments : framesSpy) {
+        const auto frame = arguments.front().value<QVideoFrame>();
+        if (frame.isValid())
+            frames.push_back(frame);
+    }
+    QVERIFY(!frames.empty());
+
+    if (frames.front().handleType() != QVideoFrame::RhiTextureHandle)
+        QSKIP("Hardware decoding with texture conversion is not available");
+
+    // The texture converter is dropped once the import fails for both export layouts,
+    // after which the frames come without a texture handle and are read back for rendering
+    for (const QVideoFrame &frame : std::as_const(frames))
+        QCOMPARE(frame.handleType(), QVideoFrame::RhiTextureHandle);
+
+    // The imported planes are sampled: the video is rendered, not a blank texture
+    const QImage rendered = view.grabWindow();
+    QVERIFY(!rendered.isNull());
+    const QRgb firstPixel = rendered.pixel(0, 0);
+    bool hasContent = false;
+    for (int y = 0; y < rendered.height() && !hasContent; y += 8)
+        for (int x = 0; x < rendered.width() && !hasContent; x += 8)
+            hasContent = rendered.pixel(x, y) != firstPixel;
+    QVERIFY(hasContent);
+
+    // A failed import, e.g. of a layout the driver doesn't support, makes the renderer map
+    // the frame, which copies it to system memory
+    QCOMPARE(QHwVideoBuffer::readBackCount(), readBacksBefore);
+}
+
+void tst_QMediaPlayerBackend::play_reportsVideoFrameStatistics()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_localVideoFile3ColorsWithSound);
+
+    // Arrange
+    auto *playerPrivate = QMediaPlayerPrivate::get(&m_fixture->player);
+    m_fixture->player.setSource(*m_localVideoFile3ColorsWithSound);
+
+    // Act
+    m_fixture->player.play();
+    QTRY_COMPARE_WITH_TIMEOUT(m_fixture->player.mediaStatus(), QMediaPlayer::EndOfMedia, 10s);
+
+    // Assert
+    const auto statistics = playerPrivate->videoFrameStatistics();
+    QCOMPARE_GT(statistics.presentedFrames, 0u);
+    QCOMPARE_LE(statistics.lateFrames, statistics.presentedFrames);
+    QCOMPARE_LT(statistics.droppedFrames, statistics.presentedFrames);
+}
+
+void tst_QMediaPlayerBackend::play_reportsPlaybackStatistics()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_15sVideo);
+
+    // Arrange
+    auto *playerPrivate = QMediaPlayerPrivate::get(&m_fixture->player);
+    m_fixture->player.setSource(*m_15sVideo);
+
+    auto decodedPackets = [](const QPlaybackStatistics::Stream &stream) {
+        return std::accumulate(stream.decodingTimeHistogram.begin(),
+                               stream.decodingTimeHistogram.end(), quint64(0));
+    };
+
+    // Act
+    m_fixture->player.play();
+    QTRY_COMPARE_GT(m_fixture->player.position(), 1000);
+
+    // Assert
+    const auto statistics = playerPrivate->playbackStatistics();
+    const auto &video = statistics.streams[QPlatformMediaPlayer::VideoStream];
+
+    QCOMPARE_GT(decodedPackets(video), 0u);
+    QCOMPARE_GT(video.bufferedPackets, 0);
+    QCOMPARE_GT(video.bufferedBytes, 0);
+    QCOMPARE_GT(statistics.videoFrames.presentedFrames, 0u);
+}
+
+void tst_QMediaPlayerBackend::play_reachesEndOfMedia_withDefaultConstructedBufferingPolicy()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_localVideoFile3ColorsWithSound);
+
+    // Arrange: the zero watermarks stand for the built-in defaults
+    QMediaPlayerPrivate::get(&m_fixture->player)->setBufferingPolicy(QPlaybackBufferingPolicy{});
+    m_fixture->player.setSource(*m_localVideoFile3ColorsWithSound);
+
+    // Act
+    m_fixture->player.play();
+
+    // Assert
+    QTRY_COMPARE_WITH_TIMEOUT(m_fixture->player.mediaStatus(), QMediaPlayer::EndOfMedia, 10s);
+    QCOMPARE_GT(m_fixture->framesCount.load(), 0);
+    QCOMPARE(m_fixture->player.error(), QMediaPlayer::NoError);
+}
+
+void tst_QMediaPlayerBackend::stop_resetsObjectsStatistics_whenKilledObjectsAreStillRunning()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_15sVideo);
+
+    // Arrange
+    auto *playerPrivate = QMediaPlayerPrivate::get(&m_fixture->player);
+    m_fixture->player.setSource(*m_15sVideo);
+    m_fixture->player.play();
+    QTRY_COMPARE_GT(m_fixture->player.position(), 500);
+
+    // Act: the killed objects are deleted asynchronously and may report in the meantime
+    m_fixture->player.stop();
+    QTest::qWait(200);
+
+    // Assert
+    const auto statistics = playerPrivate->playbackStatistics();
+    for (const auto &stream : statistics.streams) {
+        QCOMPARE(stream.bufferedPackets, qint64(0));
+        QCOMPARE(stream.bufferedBytes, qint64(0));
+        QCOMPARE(stream.pendingFrames, qint64(0));
+    }
+    QCOMPARE(statistics.audioBufferLoad, qint64(0));
+    QVERIFY(!statistics.audioVideoOffset);
+}
+
+void tst_QMediaPlayerBackend::play_playsAndSeeks_withEngineTransportAndThreading_data()
+{
+    QTest::addColumn<bool>("useChannels");
+    QTest::addColumn<bool>("useSharedThreads");
+
+    QTest::addRow("signals, dedicated threads") << false << false;
+    QTest::addRow("channels, dedicated threads") << true << false;
+    QTest::addRow("signals, shared threads") << false << true;
+    QTest::addRow("channels, shared threads") << true << true;
+}
+
+void tst_QMediaPlayerBackend::play_playsAndSeeks_withEngineTransportAndThreading()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_localVideoFile);
+
+    QFETCH(const bool, useChannels);
+    QFETCH(const bool, useSharedThreads);
+
+    // Arrange
+    QScopedEnvironmentVariable channels("QT_FFMPEG_PLAYBACK_ENGINE_USE_CHANNELS",
+                                        useChannels ? "1" : "0");
+    QScopedEnvironmentVariable sharedThreads("QT_FFMPEG_PLAYBACK_ENGINE_SHARED_THREADS",
+                                             useSharedThreads ? "1" : "0");
+    m_fixture->player.setSource(*m_localVideoFile);
+
+    // Act
+    m_fixture->player.play();
+    QTRY_COMPARE_GT(m_fixture->player.position(), 500);
+    const int framesBeforeSeek = m_fixture->framesCount;
+
+    m_fixture->player.setPosition(0);
+    QTRY_COMPARE_GT(m_fixture->player.position(), 200);
+
+    // Assert
+    QCOMPARE_GT(framesBeforeSeek, 0);
+    QTRY_COMPARE_GT(m_fixture->framesCount.load(), framesBeforeSeek);
+    QCOMPARE(m_fixture->player.error(), QMediaPlayer::NoError);
+
+    m_fixture->player.stop();
+    QCOMPARE(m_fixture->player.playbackState(), QMediaPlayer::StoppedState);
+}
+
+void tst_QMediaPlayerBackend::setPosition_presentsCachedFrame_whenPausedInScrubbingMode()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_localVideoFile);
+
+    // Arrange
+    QMediaPlayerPrivate::get(&m_fixture->player)->setScrubbingMode(true);
+    m_fixture->surface.setStoreFrames();
+    m_fixture->player.setSource(*m_localVideoFile);
+    m_fixture->player.play();
+    QTRY_COMPARE_GT(m_fixture->player.position(), 1000);
+    m_fixture->player.pause();
+    QTRY_COMPARE(m_fixture->player.playbackState(), QMediaPlayer::PausedState);
+
+    const QList<QVideoFrame> frames = m_fixture->surface.m_frameList;
+    QCOMPARE_GT(frames.size(), 2);
+    const QVideoFrame presentedFrame = frames[frames.size() / 2];
+    QVERIFY(presentedFrame.isValid());
+
+    // Act
+    m_fixture->player.setPosition((presentedFrame.startTime() + 999) / 1000);
+
+    // Assert: the presented frame itself is shown again, not a newly decoded copy
+    QTRY_VERIFY(m_fixture->surface.videoFrame() == presentedFrame);
+}
+
+void tst_QMediaPlayerBackend::setPosition_decodesFrame_afterScrubbingModeIsDisabled()
+{
+    QSKIP_IF_NOT_FFMPEG();
+    CHECK_SELECTED_URL(m_localVideoFile);
+
+    // Arrange
+    auto *playerPrivate = QMediaPlayerPrivate::get(&m_fixture->player);
+    playerPrivate->setScrubbingMode(true);
+    m_fixture->surface.setStoreFrames();
+    m_fixture->player.setSource(*m_localVideoFile);
+    m_fixture->player.play();
+    QTRY_COMPARE_GT(m_fixture->player.position(), 1000);
+
+    // The renderer that exists while the mode is disabled has to stop using the cache
+    playerPrivate->setScrubbingMode(false);
+    m_fixture->player.pause();
+    QTRY_COMPARE(m_fixture->player.playbackState(), QMediaPlayer::PausedState);
+
+    const QList<QVideoFrame> frames = m_fixture->surface.m_frameList;
+    QCOMPARE_GT(frames.size(), 2);
+    const QVideoFrame presentedFrame = frames[frames.size() / 2];
+
+    // Act
+    m_fixture->player.setPosition((presentedFrame.startTime() + 999) / 1000);
+
+    // Assert
+    QTRY_COMPARE(m_fixture->surface.videoFrame().startTime(), presentedFrame.startTime());
+    QVERIFY(m_fixture->surface.videoFrame() != presentedFrame);
+}
+
 void tst_QMediaPlayerBackend::makeStressTestCases()
 {
     QTest::addColumn<MaybeUrl>("media");
@@ -4574,6 +4861,42 @@ void tst_QMediaPlayerBackend::stressTest_setupAndTeardown_data()
     makeStressTestCases();
 }
 
+void tst_QMediaPlayerBackend::stressTest_setupAndTeardown_sharedThreads()
+{
+    QSKIP_IF_NOT_FFMPEG();
+
+    QFETCH(MaybeUrl, media);
+    QFETCH(bool, play);
+    QRandomGenerator rng;
+
+    // The engine objects are deleted on pool threads that outlive the players, so the players
+    // are torn down without waiting, while the objects of the previous ones may still be alive
+    QScopedEnvironmentVariable sharedThreads("QT_FFMPEG_PLAYBACK_ENGINE_SHARED_THREADS", "1");
+
+    for (int i = 0; i < 100; i++) {
+        QMediaPlayer player;
+        QAudioOutput output;
+        TestVideoSink videoSink;
+
+        player.setAudioOutput(&output);
+        player.setVideoOutput(&videoSink);
+
+        if (media) {
+            player.setSource(*media);
+            if (play) {
+                player.play();
+                QTRY_COMPARE_GT(player.position(), 10);
+            }
+        }
+        QTest::qWait(rng.bounded(20));
+    }
+}
+
+void tst_QMediaPlayerBackend::stressTest_setupAndTeardown_sharedThreads_data()
+{
+    makeStressTestCases();
+}
+
 void tst_QMediaPlayerBackend::stressTest_setupAndTeardown_keepAudioOutput()
 {
     QFETCH(MaybeUrl, media);
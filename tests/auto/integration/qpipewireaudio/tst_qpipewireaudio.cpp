@@ -0,0 +1,370 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+#include <QtCore/qbuffer.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qtimer.h>
+#include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtMultimedia/qaudiosink.h>
+#include <QtMultimedia/qaudiosource.h>
+#include <QtMultimedia/qmediadevices.h>
+
+#include <algorithm>
+#include <atomic>
+
+using namespace Qt::StringLiterals;
+
+QT_USE_NAMESPACE
+
+namespace {
+
+const QByteArray SinkName = "qt-test-sink"_ba;
+const QByteArray SourceName = "qt-test-source"_ba;
+
+// A daemon without hardware: the graph is driven by the timers of the null nodes
+constexpr char DaemonConfig[] = R"(
+context.properties = {
+    core.daemon = true
+    core.name = pipewire-0
+    support.dbus = false
+    default.clock.rate = 48000
+}
+
+context.spa-libs = {
+    audio.convert.* = audioconvert/libspa-audioconvert
+    support.* = support/libspa-support
+}
+
+context.modules = [
+    { name = libpipewire-module-protocol-native }
+    { name = libpipewire-module-metadata }
+    { name = libpipewire-module-spa-node-factory }
+    { name = libpipewire-module-client-node }
+    { name = libpipewire-module-adapter }
+    { name = libpipewire-module-link-factory }
+    { name = libpipewire-module-session-manager flags = [ ifexists nofail ] }
+]
+
+context.objects = [
+    { factory = spa-node-factory
+        args = {
+            factory.name = support.node.driver
+            node.name = Dummy-Driver
+            node.group = pipewire.dummy
+            priority.driver = 20000
+        }
+    }
+    { factory = adapter
+        args = {
+            factory.name = support.null-audio-sink
+            node.name = qt-test-sink
+            node.description = "Qt Test Sink"
+            media.class = Audio/Sink
+            audio.position = [ FL FR ]
+            priority.session = 2000
+            object.linger = true
+        }
+    }
+    { factory = adapter
+        args = {
+            factory.name = support.null-audio-sink
+            node.name = qt-test-source
+            node.description = "Qt Test Source"
+            media.class = Audio/Source/Virtual
+            audio.position = [ FL FR ]
+            priority.session = 2000
+            object.linger = true
+        }
+    }
+]
+)";
+
+QAudioDevice findDevice(const QList<QAudioDevice> &devices, const QByteArray &id)
+{
+    const auto it = std::find_if(devices.begin(), devices.end(),
+                                 [&](const QAudioDevice &device) { return device.id() == id; });
+    return it != devices.end() ? *it : QAudioDevice();
+}
+
+} // namespace
+
+// Runs the PipeWire backend against a daemon of its own, which plays into a null sink and
+// captures from a virtual source. WirePlumber links the streams of the test to them.
+class tst_QPipeWireAudio : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void mediaDevices_listsNodesOfDaemon();
+    void start_playsPushedData();
+    void start_playsDataOfDevice_untilItsEnd();
+    void start_rendersWithCallback();
+    void start_capturesIntoReturnedDevice();
+    void start_capturesIntoDevice();
+    void suspend_pausesPlayback_untilResumed();
+    void suspend_pausesCapture_untilResumed();
+
+    // Kills the daemon, so it runs last
+    void daemonLoss_stopsStreamsWithFatalError();
+
+private:
+    QAudioDevice sinkDevice() const
+    {
+        return findDevice(QMediaDevices::audioOutputs(), SinkName);
+    }
+    QAudioDevice sourceDevice() const
+    {
+        return findDevice(QMediaDevices::audioInputs(), SourceName);
+    }
+
+    QTemporaryDir m_runtimeDir;
+    QProcess m_daemon;
+    QProcess m_sessionManager;
+    QAudioFormat m_format;
+};
+
+void tst_QPipeWireAudio::initTestCase()
+{
+    const QString pipewire = QStandardPaths::findExecutable(u"pipewire"_s);
+    const QString wireplumber = QStandardPaths::findExecutable(u"wireplumber"_s);
+    if (pipewire.isEmpty() || wireplumber.isEmpty())
+        QSKIP("Needs the pipewire and wireplumber executables");
+
+    QVERIFY(m_runtimeDir.isValid());
+    QFile config(m_runtimeDir.filePath(u"pipewire.conf"_s));
+    QVERIFY(config.open(QIODevice::WriteOnly));
+    config.write(DaemonConfig);
+    config.close();
+
+    // The test and its daemon meet in the temporary directory, away from the daemon of the
+    // session; QMediaDevices connects the first time it is used
+    qputenv("PIPEWIRE_RUNTIME_DIR", QFile::encodeName(m_runtimeDir.path()));
+    qunsetenv("PIPEWIRE_REMOTE");
+    qputenv("QT_PIPEWIRE_AUDIO", "1");
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(u"XDG_RUNTIME_DIR"_s, m_runtimeDir.path());
+    // Keeps WirePlumber from restoring the default nodes of earlier runs
+    environment.insert(u"XDG_STATE_HOME"_s, m_runtimeDir.path());
+    m_daemon.setProcessEnvironment(environment);
+    m_sessionManager.setProcessEnvironment(environment);
+
+    m_daemon.start(pipewire, { u"-c"_s, config.fileName() });
+    QVERIFY(m_daemon.waitForStarted());
+    QTRY_VERIFY(QFile::exists(m_runtimeDir.filePath(u"pipewire-0"_s)));
+
+    m_sessionManager.start(wireplumber, {});
+    QVERIFY(m_sessionManager.waitForStarted());
+
+    m_format.setSampleRate(48000);
+    m_format.setChannelCount(2);
+    m_format.setSampleFormat(QAudioFormat::Int16);
+
+    QTRY_VERIFY2(!sinkDevice().isNull(), "The PipeWire backend isn't used");
+}
+
+void tst_QPipeWireAudio::cleanupTestCase()
+{
+    for (QProcess *process : { &m_sessionManager, &m_daemon }) {
+        if (process->state() == QProcess::NotRunning)
+            continue;
+        process->terminate();
+        if (!process->waitForFinished())
+            process->kill();
+    }
+}
+
+void tst_QPipeWireAudio::mediaDevices_listsNodesOfDaemon()
+{
+    const QAudioDevice sink = sinkDevice();
+    QVERIFY(!sink.isNull());
+    QCOMPARE(sink.mode(), QAudioDevice::Output);
+    QCOMPARE(sink.description(), u"Qt Test Sink"_s);
+    QCOMPARE(QMediaDevices::defaultAudioOutput().id(), SinkName);
+
+    const QAudioDevice source = sourceDevice();
+    QVERIFY(!source.isNull());
+    QCOMPARE(source.mode(), QAudioDevice::Input);
+    QCOMPARE(source.description(), u"Qt Test Source"_s);
+    QCOMPARE(QMediaDevices::defaultAudioInput().id(), SourceName);
+}
+
+void tst_QPipeWireAudio::start_playsPushedData()
+{
+    // Arrange
+    QAudioSink sink(sinkDevice(), m_format);
+    const QByteArray chunk(m_format.bytesForDuration(10000), 0);
+
+    // Act
+    QIODevice *device = sink.start();
+    QVERIFY(device);
+
+    QTimer feeder;
+    connect(&feeder, &QTimer::timeout, this, [&] {
+        while (sink.bytesFree() >= chunk.size()) {
+            if (device->write(chunk) <= 0)
+                break;
+        }
+    });
+    feeder.start(5);
+
+    // Assert; the graph consumes what is written
+    QTRY_VERIFY(sink.processedUSecs() >= 200000);
+    QCOMPARE(sink.error(), QAudio::NoError);
+
+    sink.stop();
+    QCOMPARE(sink.state(), QAudio::StoppedState);
+}
+
+void tst_QPipeWireAudio::start_playsDataOfDevice_untilItsEnd()
+{
+    // Arrange
+    QByteArray data(m_format.bytesForDuration(300000), 0);
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QAudioSink sink(sinkDevice(), m_format);
+
+    // Act
+    sink.start(&buffer);
+
+    // Assert
+    QTRY_VERIFY(buffer.atEnd());
+    QTRY_COMPARE(sink.state(), QAudio::IdleState);
+    QCOMPARE(sink.error(), QAudio::NoError);
+    QCOMPARE(sink.processedUSecs(), 300000);
+}
+
+void tst_QPipeWireAudio::start_rendersWithCallback()
+{
+    // Arrange
+    QAudioSink sink(sinkDevice(), m_format);
+    std::atomic_int callCount = 0;
+    std::atomic_bool hasPartialFrames = false;
+
+    // Act
+    sink.start([&](QSpan<qint16> samples) {
+        std::fill(samples.begin(), samples.end(), qint16(0));
+        if (samples.empty() || samples.size() % m_format.channelCount() != 0)
+            hasPartialFrames = true;
+        ++callCount;
+    });
+
+    // Assert
+    QTRY_VERIFY(callCount >= 10);
+    QCOMPARE(sink.state(), QAudio::ActiveState);
+    QCOMPARE(sink.error(), QAudio::NoError);
+    QVERIFY(!hasPartialFrames);
+    QCOMPARE_GT(sink.processedUSecs(), 0);
+}
+
+void tst_QPipeWireAudio::start_capturesIntoReturnedDevice()
+{
+    // Arrange
+    QAudioSource source(sourceDevice(), m_format);
+
+    // Act
+    QIODevice *device = source.start();
+    QVERIFY(device);
+
+    // Assert
+    QTRY_VERIFY(device->bytesAvailable() >= m_format.bytesForDuration(100000));
+    const QByteArray data = device->readAll();
+    QCOMPARE(data.size() % m_format.bytesPerFrame(), 0);
+    QCOMPARE(source.error(), QAudio::NoError);
+    QCOMPARE_GE(source.processedUSecs(), 100000);
+}
+
+void tst_QPipeWireAudio::start_capturesIntoDevice()
+{
+    // Arrange
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QAudioSource source(sourceDevice(), m_format);
+
+    // Act
+    source.start(&buffer);
+
+    // Assert
+    QTRY_VERIFY(buffer.size() >= m_format.bytesForDuration(100000));
+    QCOMPARE(source.state(), QAudio::ActiveState);
+    QCOMPARE(source.error(), QAudio::NoError);
+
+    source.stop();
+    QCOMPARE(buffer.size() % m_format.bytesPerFrame(), 0);
+}
+
+void tst_QPipeWireAudio::suspend_pausesPlayback_untilResumed()
+{
+    // Arrange
+    QAudioSink sink(sinkDevice(), m_format);
+    sink.start([](QSpan<qint16> samples) { std::fill(samples.begin(), samples.end(), 0); });
+    QTRY_VERIFY(sink.processedUSecs() > 0);
+
+    // Act
+    sink.suspend();
+
+    // Assert; a cycle that was running while suspending may still complete
+    QCOMPARE(sink.state(), QAudio::SuspendedState);
+    QTest::qWait(100);
+    const qint64 processedWhileSuspended = sink.processedUSecs();
+    QTest::qWait(200);
+    QCOMPARE(sink.processedUSecs(), processedWhileSuspended);
+
+    sink.resume();
+    QCOMPARE(sink.state(), QAudio::ActiveState);
+    QTRY_VERIFY(sink.processedUSecs() > processedWhileSuspended);
+}
+
+void tst_QPipeWireAudio::suspend_pausesCapture_untilResumed()
+{
+    // Arrange
+    QAudioSource source(sourceDevice(), m_format);
+    QIODevice *device = source.start();
+    QVERIFY(device);
+    QTRY_VERIFY(source.processedUSecs() > 0);
+
+    // Act
+    source.suspend();
+
+    // Assert
+    QCOMPARE(source.state(), QAudio::SuspendedState);
+    QTest::qWait(100);
+    const qint64 processedWhileSuspended = source.processedUSecs();
+    QTest::qWait(200);
+    QCOMPARE(source.processedUSecs(), processedWhileSuspended);
+
+    source.resume();
+    QCOMPARE(source.state(), QAudio::ActiveState);
+    QTRY_VERIFY(source.processedUSecs() > processedWhileSuspended);
+}
+
+void tst_QPipeWireAudio::daemonLoss_stopsStreamsWithFatalError()
+{
+    // Arrange
+    QAudioSink sink(sinkDevice(), m_format);
+    sink.start([](QSpan<qint16> samples) { std::fill(samples.begin(), samples.end(), 0); });
+    QAudioSource source(sourceDevice(), m_format);
+    QVERIFY(source.start());
+    QTRY_VERIFY(sink.processedUSecs() > 0 && source.processedUSecs() > 0);
+
+    // Act
+    m_daemon.kill();
+    QVERIFY(m_daemon.waitForFinished());
+
+    // Assert; the context reports the broken connection to all its streams
+    QTRY_COMPARE(sink.state(), QAudio::StoppedState);
+    QCOMPARE(sink.error(), QAudio::FatalError);
+    QTRY_COMPARE(source.state(), QAudio::StoppedState);
+    QCOMPARE(source.error(), QAudio::FatalError);
+}
+
+QTEST_GUILESS_MAIN(tst_QPipeWireAudio)
+
+#include "tst_qpipewireaudio.moc"
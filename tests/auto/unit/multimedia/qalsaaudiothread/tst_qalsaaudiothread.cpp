@@ -0,0 +1,350 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include <QtMultimedia/private/qalsaaudiosink_p.h>
+#include <QtMultimedia/private/qalsaaudiosource_p.h>
+#include <QtMultimedia/private/qalsaaudiothread_p.h>
+
+#include <atomic>
+#include <memory>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+constexpr unsigned int SampleRate = 48000;
+constexpr unsigned int ChannelCount = 2;
+
+// Longer than the buffers the sink and the source use by default
+constexpr unsigned long StallMs = 500;
+
+QAudioFormat streamFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(ChannelCount);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+struct PcmCloser
+{
+    void operator()(snd_pcm_t *handle) const { snd_pcm_close(handle); }
+};
+using PcmPtr = std::unique_ptr<snd_pcm_t, PcmCloser>;
+
+// Opens a PCM of 16-bit stereo frames with the thresholds the sink and the source use
+PcmPtr openPcm(const char *name, bool playback, bool mmap, snd_pcm_uframes_t bufferFrames,
+               snd_pcm_uframes_t periodFrames)
+{
+    snd_pcm_t *handle = nullptr;
+    const snd_pcm_stream_t stream = playback ? SND_PCM_STREAM_PLAYBACK : SND_PCM_STREAM_CAPTURE;
+    if (snd_pcm_open(&handle, name, stream, 0) < 0)
+        return {};
+    PcmPtr pcm(handle);
+
+    snd_pcm_hw_params_t *hwparams;
+    snd_pcm_hw_params_alloca(&hwparams);
+    const snd_pcm_access_t access =
+            mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
+    unsigned int rate = SampleRate;
+    if (snd_pcm_hw_params_any(handle, hwparams) < 0
+        || snd_pcm_hw_params_set_access(handle, hwparams, access) < 0
+        || snd_pcm_hw_params_set_format(handle, hwparams, SND_PCM_FORMAT_S16) < 0
+        || snd_pcm_hw_params_set_channels(handle, hwparams, ChannelCount) < 0
+        || snd_pcm_hw_params_set_rate_near(handle, hwparams, &rate, nullptr) < 0
+        || snd_pcm_hw_params_set_period_size_near(handle, hwparams, &periodFrames, nullptr) < 0
+        || snd_pcm_hw_params_set_buffer_size_near(handle, hwparams, &bufferFrames) < 0
+        || snd_pcm_hw_params(handle, hwparams) < 0)
+        return {};
+
+    snd_pcm_sw_params_t *swparams;
+    snd_pcm_sw_params_alloca(&swparams);
+    if (snd_pcm_sw_params_current(handle, swparams) < 0
+        || snd_pcm_sw_params_set_start_threshold(handle, swparams, periodFrames) < 0
+        || snd_pcm_sw_params_set_avail_min(handle, swparams, periodFrames) < 0
+        || snd_pcm_sw_params(handle, swparams) < 0 || snd_pcm_prepare(handle) < 0)
+        return {};
+
+    return pcm;
+}
+
+// What the handlers see, recorded on the audio thread
+struct Transfers
+{
+    void record(qsizetype bytes, qsizetype periodBytes)
+    {
+        threadId = QThread::currentThreadId();
+        if (bytes != periodBytes)
+            ++unexpectedSizes;
+        ++periods;
+    }
+
+    std::atomic<int> periods = 0;
+    std::atomic<int> unexpectedSizes = 0;
+    std::atomic<Qt::HANDLE> threadId = nullptr;
+    std::atomic_bool failed = false;
+};
+
+} // namespace
+
+class tst_QAlsaAudioThread : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void run_transfersPeriodsOnItsOwnThread_data();
+    void run_transfersPeriodsOnItsOwnThread();
+    void run_keepsFramesInOrder_whenMmapPeriodsWrapAroundBuffer();
+    void run_recoversFromXrun_whenHandlerStalls_data();
+    void run_recoversFromXrun_whenHandlerStalls();
+    void run_callsFailureHandler_whenPcmCannotRecover();
+    void xrunCount_countsUnderrunsOfSink_whenCallbackStalls();
+    void xrunCount_countsOverrunsOfSource_whenCallbackStalls();
+
+private:
+    static void addStreamRows();
+};
+
+void tst_QAlsaAudioThread::addStreamRows()
+{
+    QTest::addColumn<bool>("playback");
+    QTest::addColumn<bool>("mmap");
+
+    QTest::addRow("playback, read/write") << true << false;
+    QTest::addRow("playback, mmap") << true << true;
+    QTest::addRow("capture, read/write") << false << false;
+    QTest::addRow("capture, mmap") << false << true;
+}
+
+void tst_QAlsaAudioThread::run_transfersPeriodsOnItsOwnThread_data()
+{
+    addStreamRows();
+}
+
+void tst_QAlsaAudioThread::run_transfersPeriodsOnItsOwnThread()
+{
+    QFETCH(const bool, playback);
+    QFETCH(const bool, mmap);
+
+    // Arrange
+    const PcmPtr pcm = openPcm("null", playback, mmap, 4096, 1024);
+    if (!pcm)
+        QSKIP("The null PCM of ALSA is not available");
+
+    snd_pcm_uframes_t bufferFrames = 0;
+    snd_pcm_uframes_t periodFrames = 0;
+    QCOMPARE_GE(snd_pcm_get_params(pcm.get(), &bufferFrames, &periodFrames), 0);
+    const qsizetype periodBytes = snd_pcm_frames_to_bytes(pcm.get(), periodFrames);
+
+    Transfers transfers;
+    QAlsaAudioThread thread(
+            pcm.get(), periodFrames,
+            [&](char *, qsizetype bytes) {
+                transfers.record(bytes, periodBytes);
+                QThread::usleep(100); // the null PCM never waits, so don't spin
+            },
+            [&] { transfers.failed = true; });
+
+    // Act
+    thread.start();
+    QTRY_VERIFY(transfers.periods >= 16);
+    thread.stop();
+
+    // Assert
+    QVERIFY(thread.isFinished());
+    QVERIFY(transfers.threadId.load() != QThread::currentThreadId());
+    QCOMPARE(transfers.unexpectedSizes.load(), 0);
+    QVERIFY(!transfers.failed);
+    QCOMPARE(thread.xrunCount(), quint64(0));
+}
+
+void tst_QAlsaAudioThread::run_keepsFramesInOrder_whenMmapPeriodsWrapAroundBuffer()
+{
+    // Arrange
+    const PcmPtr pcm = openPcm("null", true, true, 1000, 384);
+    if (!pcm)
+        QSKIP("The null PCM of ALSA is not available");
+
+    snd_pcm_uframes_t bufferFrames = 0;
+    snd_pcm_uframes_t periodFrames = 0;
+    QCOMPARE_GE(snd_pcm_get_params(pcm.get(), &bufferFrames, &periodFrames), 0);
+    if (bufferFrames % periodFrames == 0)
+        QSKIP("The PCM only takes whole periods per buffer, so periods never wrap");
+    const qsizetype periodBytes = snd_pcm_frames_to_bytes(pcm.get(), periodFrames);
+
+    // Each frame holds its index, so that the order can be checked in the buffer of the PCM
+    quint16 nextFrame = 0;
+    Transfers transfers;
+    QAlsaAudioThread thread(
+            pcm.get(), periodFrames,
+            [&](char *data, qsizetype bytes) {
+                auto *samples = reinterpret_cast<qint16 *>(data);
+                for (qsizetype frame = 0; frame < bytes / qsizetype(2 * ChannelCount); ++frame) {
+                    for (unsigned int channel = 0; channel < ChannelCount; ++channel)
+                        samples[frame * ChannelCount + channel] = qint16(nextFrame);
+                    ++nextFrame;
+                }
+                transfers.record(bytes, periodBytes);
+                QThread::usleep(100);
+            },
+            [&] { transfers.failed = true; });
+
+    // Act; runs over the end of the buffer several times
+    thread.start();
+    QTRY_VERIFY(transfers.periods >= int(4 * bufferFrames / periodFrames));
+    thread.stop();
+
+    // Assert
+    QCOMPARE(transfers.unexpectedSizes.load(), 0);
+    QVERIFY(!transfers.failed);
+    QCOMPARE(thread.xrunCount(), quint64(0));
+
+    // The null PCM leaves the data in place, the last buffer of frames ends at the offset
+    const snd_pcm_channel_area_t *areas = nullptr;
+    snd_pcm_uframes_t offset = 0;
+    snd_pcm_uframes_t frames = bufferFrames;
+    QCOMPARE_GE(snd_pcm_mmap_begin(pcm.get(), &areas, &offset, &frames), 0);
+    const auto *samples = reinterpret_cast<const qint16 *>(
+            static_cast<const char *>(areas[0].addr) + areas[0].first / 8);
+
+    for (snd_pcm_uframes_t i = 1; i <= bufferFrames; ++i) {
+        const snd_pcm_uframes_t position = (offset + bufferFrames - i) % bufferFrames;
+        for (unsigned int channel = 0; channel < ChannelCount; ++channel)
+            QCOMPARE(quint16(samples[position * ChannelCount + channel]), quint16(nextFrame - i));
+    }
+}
+
+void tst_QAlsaAudioThread::run_recoversFromXrun_whenHandlerStalls_data()
+{
+    addStreamRows();
+}
+
+void tst_QAlsaAudioThread::run_recoversFromXrun_whenHandlerStalls()
+{
+    QFETCH(const bool, playback);
+    QFETCH(const bool, mmap);
+
+    // Arrange; the null PCM never runs out of data or space
+    const PcmPtr pcm = openPcm("hw:Dummy", playback, mmap, 4096, 1024);
+    if (!pcm)
+        QSKIP("Needs a PCM that keeps time, as of the snd-dummy kernel module");
+
+    snd_pcm_uframes_t bufferFrames = 0;
+    snd_pcm_uframes_t periodFrames = 0;
+    QCOMPARE_GE(snd_pcm_get_params(pcm.get(), &bufferFrames, &periodFrames), 0);
+    const qsizetype periodBytes = snd_pcm_frames_to_bytes(pcm.get(), periodFrames);
+    const unsigned long stallMs = 2 * 1000 * bufferFrames / SampleRate + 20;
+
+    Transfers transfers;
+    QAlsaAudioThread thread(
+            pcm.get(), periodFrames,
+            [&](char *data, qsizetype bytes) {
+                if (playback)
+                    memset(data, 0, bytes);
+                transfers.record(bytes, periodBytes);
+                if (transfers.periods == 4)
+                    QThread::msleep(stallMs); // longer than the buffer lasts
+            },
+            [&] { transfers.failed = true; });
+
+    // Act
+    thread.start();
+    QTRY_VERIFY(thread.xrunCount() >= 1);
+    const int periodsAtXrun = transfers.periods;
+
+    // Assert; the transfers go on
+    QTRY_VERIFY(transfers.periods >= periodsAtXrun + 4);
+    thread.stop();
+
+    QCOMPARE(transfers.unexpectedSizes.load(), 0);
+    QVERIFY(!transfers.failed);
+}
+
+void tst_QAlsaAudioThread::run_callsFailureHandler_whenPcmCannotRecover()
+{
+    // Arrange
+    const PcmPtr pcm = openPcm("null", true, false, 4096, 1024);
+    if (!pcm)
+        QSKIP("The null PCM of ALSA is not available");
+
+    snd_pcm_uframes_t bufferFrames = 0;
+    snd_pcm_uframes_t periodFrames = 0;
+    QCOMPARE_GE(snd_pcm_get_params(pcm.get(), &bufferFrames, &periodFrames), 0);
+
+    // A dropped PCM is in the setup state, which snd_pcm_recover() can't handle
+    std::atomic<Qt::HANDLE> failureThreadId = nullptr;
+    QAlsaAudioThread thread(
+            pcm.get(), periodFrames,
+            [&](char *data, qsizetype bytes) {
+                memset(data, 0, bytes);
+                snd_pcm_drop(pcm.get());
+            },
+            [&] { failureThreadId = QThread::currentThreadId(); });
+
+    // Act
+    thread.start();
+
+    // Assert
+    QTRY_VERIFY(thread.isFinished());
+    QVERIFY(failureThreadId.load() != nullptr);
+    QVERIFY(failureThreadId.load() != QThread::currentThreadId());
+}
+
+void tst_QAlsaAudioThread::xrunCount_countsUnderrunsOfSink_whenCallbackStalls()
+{
+    // Arrange
+    QAlsaAudioSink sink("hw:Dummy", nullptr);
+    sink.setFormat(streamFormat());
+    std::atomic<int> periods = 0;
+    const bool started = sink.startWithCallback(
+            QtAudioPrivate::AudioCallback<qint16>([&](QSpan<qint16> samples) {
+                std::fill(samples.begin(), samples.end(), 0);
+                if (++periods == 4)
+                    QThread::msleep(StallMs);
+            }));
+    if (!started || sink.state() == QAudio::StoppedState)
+        QSKIP("Needs a PCM that keeps time, as of the snd-dummy kernel module");
+
+    // The diagnostics go through the interface of the backends
+    const QPlatformAudioSink &platformSink = sink;
+
+    // Act
+    QTRY_VERIFY(platformSink.xrunCount() >= 1);
+    const quint64 xrunsWhileRunning = platformSink.xrunCount();
+    sink.stop();
+
+    // Assert; stopping keeps the underruns of the audio thread
+    QCOMPARE_GE(platformSink.xrunCount(), xrunsWhileRunning);
+}
+
+void tst_QAlsaAudioThread::xrunCount_countsOverrunsOfSource_whenCallbackStalls()
+{
+    // Arrange
+    QAlsaAudioSource source("hw:Dummy", nullptr);
+    source.setFormat(streamFormat());
+    std::atomic<int> periods = 0;
+    const bool started = source.startWithCallback(
+            QtAudioPrivate::AudioCallback<const qint16>([&](QSpan<const qint16>) {
+                if (++periods == 4)
+                    QThread::msleep(StallMs);
+            }));
+    if (!started || source.state() == QAudio::StoppedState)
+        QSKIP("Needs a PCM that keeps time, as of the snd-dummy kernel module");
+
+    const QPlatformAudioSource &platformSource = source;
+
+    // Act
+    QTRY_VERIFY(platformSource.xrunCount() >= 1);
+    const quint64 xrunsWhileRunning = platformSource.xrunCount();
+    source.stop();
+
+    // Assert
+    QCOMPARE_GE(platformSource.xrunCount(), xrunsWhileRunning);
+}
+
+QTEST_GUILESS_MAIN(tst_QAlsaAudioThread)
+
+#include "tst_qalsaaudiothread.moc"
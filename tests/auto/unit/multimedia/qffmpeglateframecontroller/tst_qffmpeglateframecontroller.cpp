@@ -0,0 +1,203 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpeglateframecontroller_p.h"
+
+using namespace std::chrono_literals;
+using QFFmpeg::LateFrameController;
+
+class tst_QFFmpegLateFrameController : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void onFrame_presentsFirstFrame_whenItIsLate();
+    void onFrame_dropsFrame_whenLatenessExceedsFrameDuration();
+    void onFrame_scalesFrameDurationByPlaybackRate_data();
+    void onFrame_scalesFrameDurationByPlaybackRate();
+    void onFrame_presentsFrame_afterMaxConsecutiveDrops();
+
+    void skipFrame_skipsNonRefFrames_whenAverageLatenessGrows();
+    void skipFrame_keepsLevel_whenAverageLatenessIsBetweenThresholds();
+    void skipFrame_skipsNonKeyFrames_andStepsBackToNonRef();
+    void resetLateness_stopsSkipping_andKeepsStatistics();
+
+private:
+    // Feeds frames with a duration that never makes them dropped
+    static void feedFrames(LateFrameController &controller, std::chrono::microseconds lateness,
+                           int count)
+    {
+        for (int i = 0; i < count; ++i)
+            controller.onFrame(lateness, 10s);
+    }
+};
+
+void tst_QFFmpegLateFrameController::onFrame_presentsFirstFrame_whenItIsLate()
+{
+    // Arrange
+    LateFrameController controller;
+
+    // Act
+    const bool dropped = controller.onFrame(1s, 40ms);
+
+    // Assert
+    QVERIFY(!dropped);
+    const auto statistics = controller.statistics();
+    QCOMPARE(statistics.presentedFrames, 1u);
+    QCOMPARE(statistics.lateFrames, 1u);
+    QCOMPARE(statistics.droppedFrames, 0u);
+}
+
+void tst_QFFmpegLateFrameController::onFrame_dropsFrame_whenLatenessExceedsFrameDuration()
+{
+    // Arrange
+    LateFrameController controller;
+    controller.onFrame(0us, 40ms);
+
+    // Act
+    const bool droppedSlightlyLate = controller.onFrame(30ms, 40ms);
+    const bool droppedVeryLate = controller.onFrame(50ms, 40ms);
+
+    // Assert
+    QVERIFY(!droppedSlightlyLate);
+    QVERIFY(droppedVeryLate);
+    const auto statistics = controller.statistics();
+    QCOMPARE(statistics.presentedFrames, 2u);
+    QCOMPARE(statistics.lateFrames, 1u);
+    QCOMPARE(statistics.droppedFrames, 1u);
+}
+
+void tst_QFFmpegLateFrameController::onFrame_scalesFrameDurationByPlaybackRate_data()
+{
+    QTest::addColumn<float>("playbackRate");
+    QTest::addColumn<bool>("expectDropped");
+
+    // A 40 ms frame is displayed for 80 ms at half rate, and for 20 ms at double rate
+    QTest::addRow("half rate") << 0.5f << false;
+    QTest::addRow("normal rate") << 1.f << true;
+    QTest::addRow("double rate") << 2.f << true;
+}
+
+void tst_QFFmpegLateFrameController::onFrame_scalesFrameDurationByPlaybackRate()
+{
+    QFETCH(const float, playbackRate);
+    QFETCH(const bool, expectDropped);
+
+    // Arrange
+    LateFrameController controller;
+    controller.onFrame(0us, 40ms, playbackRate);
+
+    // Act
+    const bool dropped = controller.onFrame(60ms, 40ms, playbackRate);
+
+    // Assert
+    QCOMPARE(dropped, expectDropped);
+    QCOMPARE(controller.statistics().droppedFrames, expectDropped ? 1u : 0u);
+}
+
+void tst_QFFmpegLateFrameController::onFrame_presentsFrame_afterMaxConsecutiveDrops()
+{
+    // Arrange
+    LateFrameController controller;
+    controller.onFrame(0us, 40ms);
+
+    // Act
+    int consecutiveDrops = 0;
+    while (controller.onFrame(1s, 40ms) && consecutiveDrops < 100)
+        ++consecutiveDrops;
+
+    // Assert
+    QCOMPARE(consecutiveDrops, 8);
+    const auto statistics = controller.statistics();
+    QCOMPARE(statistics.presentedFrames, 2u);
+    QCOMPARE(statistics.droppedFrames, 8u);
+    QVERIFY(controller.onFrame(1s, 40ms));
+}
+
+void tst_QFFmpegLateFrameController::skipFrame_skipsNonRefFrames_whenAverageLatenessGrows()
+{
+    // Arrange
+    LateFrameController controller;
+    QCOMPARE(controller.skipFrame(), AVDISCARD_DEFAULT);
+
+    // Act
+    feedFrames(controller, 100ms, 30);
+
+    // Assert; the average lateness stays below the threshold of skipping non-key frames
+    QCOMPARE(controller.skipFrame(), AVDISCARD_NONREF);
+}
+
+void tst_QFFmpegLateFrameController::skipFrame_keepsLevel_whenAverageLatenessIsBetweenThresholds()
+{
+    // Arrange
+    LateFrameController controller;
+    feedFrames(controller, 100ms, 30);
+    QCOMPARE(controller.skipFrame(), AVDISCARD_NONREF);
+
+    // Act; 30 ms is below the threshold of entering the level, above the one of leaving it
+    feedFrames(controller, 30ms, 100);
+    const AVDiscard skipFrameInBetween = controller.skipFrame();
+
+    feedFrames(controller, 0us, 100);
+    const AVDiscard skipFrameCaughtUp = controller.skipFrame();
+
+    // Assert
+    QCOMPARE(skipFrameInBetween, AVDISCARD_NONREF);
+    QCOMPARE(skipFrameCaughtUp, AVDISCARD_DEFAULT);
+
+    // Act; the level isn't entered again in between
+    feedFrames(controller, 30ms, 100);
+
+    // Assert
+    QCOMPARE(controller.skipFrame(), AVDISCARD_DEFAULT);
+}
+
+void tst_QFFmpegLateFrameController::skipFrame_skipsNonKeyFrames_andStepsBackToNonRef()
+{
+    // Arrange
+    LateFrameController controller;
+
+    // Act
+    feedFrames(controller, 1s, 30);
+    const AVDiscard skipFrameVeryLate = controller.skipFrame();
+
+    // 150 ms is between the thresholds of entering and leaving the non-key level
+    feedFrames(controller, 150ms, 100);
+    const AVDiscard skipFrameInBetween = controller.skipFrame();
+
+    // 30 ms leaves the non-key level, but not the non-ref one
+    feedFrames(controller, 30ms, 100);
+    const AVDiscard skipFrameSlightlyLate = controller.skipFrame();
+
+    // Assert
+    QCOMPARE(skipFrameVeryLate, AVDISCARD_NONKEY);
+    QCOMPARE(skipFrameInBetween, AVDISCARD_NONKEY);
+    QCOMPARE(skipFrameSlightlyLate, AVDISCARD_NONREF);
+}
+
+void tst_QFFmpegLateFrameController::resetLateness_stopsSkipping_andKeepsStatistics()
+{
+    // Arrange
+    LateFrameController controller;
+    controller.onFrame(0us, 40ms);
+    controller.onFrame(1s, 40ms);
+    feedFrames(controller, 1s, 30);
+    QCOMPARE(controller.skipFrame(), AVDISCARD_NONKEY);
+    const auto statistics = controller.statistics();
+
+    // Act
+    controller.resetLateness();
+
+    // Assert
+    QCOMPARE(controller.skipFrame(), AVDISCARD_DEFAULT);
+    QCOMPARE(controller.statistics(), statistics);
+
+    // The first frame after the reset is presented, however late it is
+    QVERIFY(!controller.onFrame(1s, 40ms));
+}
+
+QTEST_APPLESS_MAIN(tst_QFFmpegLateFrameController)
+
+#include "tst_qffmpeglateframecontroller.moc"
@@ -0,0 +1,219 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include <private/qplaybackbufferingpolicy_p.h>
+
+#include <limits>
+
+using namespace std::chrono_literals;
+
+class tst_QPlaybackBufferingPolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void budget_isZero_byDefault();
+
+    void defaultPolicy_isNormalized_data();
+    void defaultPolicy_isNormalized();
+    void defaultPolicy_keepsDemuxerLimits_forLocalSource();
+
+    void normalized_swapsScales_whenMinScaleIsAboveMaxScale();
+    void normalized_resetsScales_whenScalesAreNotPositiveAndFinite_data();
+    void normalized_resetsScales_whenScalesAreNotPositiveAndFinite();
+    void normalized_boundsWatermarks();
+    void normalized_usesDefaultWatermarks_forDefaultConstructedPolicy();
+
+    void adaptedScale_growsScale_whenSourceIsReadSlowly();
+    void adaptedScale_shrinksScale_whenSourceIsReadFast();
+    void adaptedScale_keepsScale_whenReadSpeedIsInRange();
+    void adaptedScale_staysWithinScaleRange();
+    void adaptedScale_onlyBoundsScale_inFixedMode();
+};
+
+void tst_QPlaybackBufferingPolicy::budget_isZero_byDefault()
+{
+    const QPlaybackBufferingPolicy::Budget budget;
+
+    QCOMPARE(budget.highWatermarkDuration.count(), 0);
+    QCOMPARE(budget.lowWatermarkDuration.count(), 0);
+    QCOMPARE(budget.highWatermarkSize, qint64(0));
+    QCOMPARE(budget.lowWatermarkSize, qint64(0));
+}
+
+void tst_QPlaybackBufferingPolicy::defaultPolicy_isNormalized_data()
+{
+    QTest::addColumn<QPlaybackBufferingPolicy::SourceType>("sourceType");
+
+    QTest::addRow("local") << QPlaybackBufferingPolicy::LocalSource;
+    QTest::addRow("network") << QPlaybackBufferingPolicy::NetworkSource;
+}
+
+void tst_QPlaybackBufferingPolicy::defaultPolicy_isNormalized()
+{
+    QFETCH(const QPlaybackBufferingPolicy::SourceType, sourceType);
+
+    const auto policy = QPlaybackBufferingPolicy::defaultPolicy(sourceType);
+
+    QVERIFY(policy == policy.normalized());
+    for (const auto &budget : policy.budgets) {
+        QCOMPARE_GT(budget.highWatermarkDuration.count(), 0);
+        QCOMPARE_GT(budget.highWatermarkSize, qint64(0));
+    }
+}
+
+void tst_QPlaybackBufferingPolicy::defaultPolicy_keepsDemuxerLimits_forLocalSource()
+{
+    const auto policy =
+            QPlaybackBufferingPolicy::defaultPolicy(QPlaybackBufferingPolicy::LocalSource);
+
+    QCOMPARE(policy.mode, QPlaybackBufferingPolicy::Fixed);
+    for (const auto &budget : policy.budgets) {
+        QVERIFY(budget.highWatermarkDuration == 4s);
+        QVERIFY(budget.lowWatermarkDuration == 4s);
+        QCOMPARE(budget.highWatermarkSize, qint64(32 * 1024 * 1024));
+        QCOMPARE(budget.lowWatermarkSize, qint64(32 * 1024 * 1024));
+    }
+}
+
+void tst_QPlaybackBufferingPolicy::normalized_swapsScales_whenMinScaleIsAboveMaxScale()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.minScale = 4.f;
+    policy.maxScale = 0.5f;
+
+    const auto normalized = policy.normalized();
+
+    QCOMPARE(normalized.minScale, 0.5f);
+    QCOMPARE(normalized.maxScale, 4.f);
+    QCOMPARE(normalized.boundedScale(8.f), 4.f);
+    QCOMPARE(normalized.boundedScale(0.1f), 0.5f);
+}
+
+void tst_QPlaybackBufferingPolicy::normalized_resetsScales_whenScalesAreNotPositiveAndFinite_data()
+{
+    QTest::addColumn<float>("scale");
+
+    QTest::addRow("zero") << 0.f;
+    QTest::addRow("negative") << -2.f;
+    QTest::addRow("infinity") << std::numeric_limits<float>::infinity();
+    QTest::addRow("nan") << std::numeric_limits<float>::quiet_NaN();
+}
+
+void tst_QPlaybackBufferingPolicy::normalized_resetsScales_whenScalesAreNotPositiveAndFinite()
+{
+    QFETCH(const float, scale);
+
+    QPlaybackBufferingPolicy policy;
+    policy.minScale = scale;
+    policy.maxScale = scale;
+
+    const auto normalized = policy.normalized();
+
+    QCOMPARE(normalized.minScale, 1.f);
+    QCOMPARE(normalized.maxScale, 1.f);
+}
+
+void tst_QPlaybackBufferingPolicy::normalized_boundsWatermarks()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.budgets[0] = { 2s, 4s, 100, 200 };
+    policy.budgets[1] = { -1s, -2s, -100, -200 };
+    policy.budgets[2] = { 4s, -1s, 200, -100 };
+
+    const auto normalized = policy.normalized();
+
+    const auto defaults = QPlaybackBufferingPolicy::defaultPolicy(
+            QPlaybackBufferingPolicy::LocalSource);
+
+    QVERIFY(normalized.budgets[0] == (QPlaybackBufferingPolicy::Budget{ 2s, 2s, 100, 100 }));
+    QVERIFY(normalized.budgets[1] == defaults.budgets[1]);
+    QVERIFY(normalized.budgets[2] == (QPlaybackBufferingPolicy::Budget{ 4s, 4s, 200, 200 }));
+}
+
+void tst_QPlaybackBufferingPolicy::normalized_usesDefaultWatermarks_forDefaultConstructedPolicy()
+{
+    // Arrange
+    const QPlaybackBufferingPolicy policy;
+
+    // Act
+    const auto normalized = policy.normalized();
+
+    // Assert
+    const auto defaults = QPlaybackBufferingPolicy::defaultPolicy(
+            QPlaybackBufferingPolicy::LocalSource);
+    QVERIFY(normalized.budgets == defaults.budgets);
+    for (const auto &budget : normalized.budgets) {
+        QCOMPARE_GT(budget.lowWatermarkDuration.count(), 0);
+        QCOMPARE_GT(budget.lowWatermarkSize, qint64(0));
+    }
+}
+
+void tst_QPlaybackBufferingPolicy::adaptedScale_growsScale_whenSourceIsReadSlowly()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.mode = QPlaybackBufferingPolicy::Adaptive;
+    policy.maxScale = 4.f;
+
+    const float scale = policy.adaptedScale(1.f, QPlaybackBufferingPolicy::SlowReadSpeedFactor / 2);
+
+    QCOMPARE(scale, QPlaybackBufferingPolicy::ScaleStep);
+}
+
+void tst_QPlaybackBufferingPolicy::adaptedScale_shrinksScale_whenSourceIsReadFast()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.mode = QPlaybackBufferingPolicy::Adaptive;
+    policy.minScale = 0.5f;
+
+    const float scale = policy.adaptedScale(1.f, QPlaybackBufferingPolicy::FastReadSpeedFactor * 2);
+
+    QCOMPARE(scale, 1.f / QPlaybackBufferingPolicy::ScaleStep);
+}
+
+void tst_QPlaybackBufferingPolicy::adaptedScale_keepsScale_whenReadSpeedIsInRange()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.mode = QPlaybackBufferingPolicy::Adaptive;
+    policy.minScale = 0.5f;
+    policy.maxScale = 4.f;
+
+    const float readSpeedFactor = (QPlaybackBufferingPolicy::SlowReadSpeedFactor
+                                   + QPlaybackBufferingPolicy::FastReadSpeedFactor)
+            / 2;
+
+    QCOMPARE(policy.adaptedScale(2.f, readSpeedFactor), 2.f);
+}
+
+void tst_QPlaybackBufferingPolicy::adaptedScale_staysWithinScaleRange()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.mode = QPlaybackBufferingPolicy::Adaptive;
+    policy.minScale = 0.5f;
+    policy.maxScale = 2.f;
+
+    float scale = 1.f;
+    for (int i = 0; i < 10; ++i)
+        scale = policy.adaptedScale(scale, 0.f);
+    QCOMPARE(scale, 2.f);
+
+    for (int i = 0; i < 20; ++i)
+        scale = policy.adaptedScale(scale, 100.f);
+    QCOMPARE(scale, 0.5f);
+}
+
+void tst_QPlaybackBufferingPolicy::adaptedScale_onlyBoundsScale_inFixedMode()
+{
+    QPlaybackBufferingPolicy policy;
+    policy.minScale = 0.5f;
+    policy.maxScale = 2.f;
+
+    QCOMPARE(policy.adaptedScale(1.f, 0.f), 1.f);
+    QCOMPARE(policy.adaptedScale(4.f, 0.f), 2.f);
+}
+
+QTEST_MAIN(tst_QPlaybackBufferingPolicy)
+
+#include "tst_qplaybackbufferingpolicy.moc"
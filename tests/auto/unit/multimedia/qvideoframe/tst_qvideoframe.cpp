@@ -13,6 +13,7 @@
 #include <QtCore/QPointer>
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
 #include "private/qvideoframeconverter_p.h"
+#include <rhi/qrhi.h>
 #include "../../../integration/shared/mediabackendutils.h"
 
 // Adds an enum, and the stringized version
@@ -233,6 +234,22 @@ private slots:
     void constructor_createsFrameWithCorrectFormat_whenCalledWithSupportedImageFormats();
     void constructor_copiesImageData_whenCalledWithRGBFormats_data();
     void constructor_copiesImageData_whenCalledWithRGBFormats();
+
+    void convertOnCpu_producesSameImage_whenConvertedInParallel_data();
+    void convertOnCpu_producesSameImage_whenConvertedInParallel();
+
+    void asyncConverter_producesSameImagesAsSynchronousConversion();
+    void asyncConverter_returnsCanceledFutureImmediately_whenAllSlotsAreBusy();
+
+    void convertOnGpu_producesImages_whenFramesOfTwoRhisAlternate();
+    void convertOnGpu_producesImageOfTargetSize_whenDownscaledInSeveralPasses();
+
+    void convertOnCpu_producesCroppedImage_whenCalledWithSourceRect();
+    void convertOnCpu_producesScaledImageOfTargetFormat_whenCalledWithTargetSize();
+    void convertOnCpu_averagesSourcePixels_whenDownscaledStrongly();
+
+    void convertOnCpu_tonemapsToSdr_whenFrameHasHdrTransfer_data();
+    void convertOnCpu_tonemapsToSdr_whenFrameHasHdrTransfer();
 };
 
 class QtTestVideoBuffer : public QObject, public QHwVideoBuffer
@@ -270,6 +287,62 @@ public:
     std::unique_ptr<QObject> m_mapObject;
 };
 
+// A frame in memory attributed to a QRhi, like the frames rendered by a video sink's window
+class QtTestRhiVideoBuffer : public QHwVideoBuffer
+{
+public:
+    QtTestRhiVideoBuffer(QRhi *rhi, const QImage &image)
+        : QHwVideoBuffer(QVideoFrame::NoHandle, rhi), m_image(image)
+    {
+    }
+
+    MapData map(QVideoFrame::MapMode) override
+    {
+        MapData mapData;
+        mapData.planeCount = 1;
+        mapData.data[0] = m_image.bits();
+        mapData.bytesPerLine[0] = m_image.bytesPerLine();
+        mapData.dataSize[0] = m_image.sizeInBytes();
+        return mapData;
+    }
+
+    void unmap() override { }
+
+private:
+    QImage m_image;
+};
+
+// Blocks the mapping until the test releases it
+class QtTestBlockingVideoBuffer : public QHwVideoBuffer
+{
+public:
+    QtTestBlockingVideoBuffer(const QImage &image, QSemaphore &mapped, QSemaphore &unblock)
+        : QHwVideoBuffer(QVideoFrame::NoHandle), m_image(image), m_mapped(mapped),
+          m_unblock(unblock)
+    {
+    }
+
+    MapData map(QVideoFrame::MapMode) override
+    {
+        m_mapped.release();
+        m_unblock.acquire();
+
+        MapData mapData;
+        mapData.planeCount = 1;
+        mapData.data[0] = m_image.bits();
+        mapData.bytesPerLine[0] = m_image.bytesPerLine();
+        mapData.dataSize[0] = m_image.sizeInBytes();
+        return mapData;
+    }
+
+    void unmap() override { }
+
+private:
+    QImage m_image;
+    QSemaphore &m_mapped;
+    QSemaphore &m_unblock;
+};
+
 tst_QVideoFrame::tst_QVideoFrame()
 {
 }
@@ -1463,6 +1536,381 @@ void tst_QVideoFrame::constructor_copiesImageData_whenCalledWithRGBFormats()
     QVERIFY(compareEq(frame, image));
 }
 
+void tst_QVideoFrame::convertOnGpu_producesImageOfTargetSize_whenDownscaledInSeveralPasses()
+{
+    // Arrange
+    QRhiNullInitParams params;
+    std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, &params));
+    QVERIFY(rhi);
+
+    QImage image(QSize(640, 480), QImage::Format_ARGB32);
+    image.fill(Qt::green);
+    const QVideoFrameFormat format(image.size(), QVideoFrameFormat::Format_ARGB8888);
+    const QVideoFrame frame = QVideoFramePrivate::createFrame(
+            std::make_unique<QtTestRhiVideoBuffer>(rhi.get(), image), format);
+
+    // Act; 640 / 37 needs a conversion at 37 * 16 and 4 halving passes horizontally
+    const QImage first = qImageFromVideoFrame(frame, {}, QSize(37, 120), QImage::Format_ARGB32);
+    const QImage second = qImageFromVideoFrame(frame, {}, QSize(37, 120), QImage::Format_ARGB32);
+
+    // Assert; the second conversion reuses the passes
+    QCOMPARE(first.size(), QSize(37, 120));
+    QCOMPARE(second, first);
+}
+
+static QVideoFrame createPatternFrame(QSize size, QVideoFrameFormat::PixelFormat pixelFormat)
+{
+    QVideoFrame frame(QVideoFrameFormat(size, pixelFormat));
+    if (!frame.map(QVideoFrame::WriteOnly))
+        return {};
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        uchar *bits = frame.bits(plane);
+        for (int i = 0; i < frame.mappedBytes(plane); ++i)
+            bits[i] = uchar(i * 7 + plane * 31);
+    }
+    frame.unmap();
+    return frame;
+}
+
+void tst_QVideoFrame::convertOnCpu_producesSameImage_whenConvertedInParallel_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+
+    for (auto pixelFormat : { QVideoFrameFormat::Format_NV12, QVideoFrameFormat::Format_YUV420P,
+                              QVideoFrameFormat::Format_YUV422P, QVideoFrameFormat::Format_IMC2,
+                              QVideoFrameFormat::Format_P010, QVideoFrameFormat::Format_UYVY,
+                              QVideoFrameFormat::Format_BGRA8888 })
+        QTest::addRow("%s", QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1().constData())
+                << pixelFormat;
+}
+
+void tst_QVideoFrame::convertOnCpu_producesSameImage_whenConvertedInParallel()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+
+    // Arrange; the height doesn't split into equal bands
+    const QVideoFrame frame = createPatternFrame(QSize(1920, 1082), pixelFormat);
+    QVERIFY(frame.isValid());
+
+    // Act
+    const QImage singleThreaded = qImageFromVideoFrameOnCpu(frame, 1);
+    const QImage parallel = qImageFromVideoFrameOnCpu(frame, 4);
+
+    // Assert
+    QVERIFY(!singleThreaded.isNull());
+    QCOMPARE(parallel, singleThreaded);
+}
+
+void tst_QVideoFrame::asyncConverter_producesSameImagesAsSynchronousConversion()
+{
+    // Arrange
+    QList<QVideoFrame> frames;
+    for (auto color : { Qt::red, Qt::green, Qt::blue, Qt::white, Qt::black }) {
+        QImage image(QSize(64, 48), QImage::Format_ARGB32);
+        image.fill(color);
+        frames.push_back(QVideoFrame(image));
+    }
+
+    // Act; each frame waits for the previous one, so that none is dropped
+    QList<QFuture<QImage>> futures;
+    {
+        QVideoFrameAsyncConverter converter(2);
+        for (const QVideoFrame &frame : frames) {
+            futures.push_back(converter.convert(frame));
+            futures.back().waitForFinished();
+        }
+    }
+
+    // Assert
+    QCOMPARE(futures.size(), frames.size());
+    for (qsizetype i = 0; i < frames.size(); ++i) {
+        QVERIFY(futures[i].isFinished());
+        QCOMPARE(futures[i].result().convertToFormat(QImage::Format_ARGB32),
+                 qImageFromVideoFrame(frames[i]).convertToFormat(QImage::Format_ARGB32));
+    }
+}
+
+void tst_QVideoFrame::asyncConverter_returnsCanceledFutureImmediately_whenAllSlotsAreBusy()
+{
+    // Arrange; the conversion of the first frame blocks the only slot until it's released
+    QImage image(QSize(64, 48), QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    QSemaphore mapped;
+    QSemaphore unblock;
+    const QVideoFrame blockingFrame = QVideoFramePrivate::createFrame(
+            std::make_unique<QtTestBlockingVideoBuffer>(image, mapped, unblock),
+            QVideoFrameFormat(image.size(), QVideoFrameFormat::Format_ARGB8888));
+
+    QVideoFrameAsyncConverter converter(1);
+    const QFuture<QImage> blockedFuture = converter.convert(blockingFrame);
+    auto unblockConversion = qScopeGuard([&] { unblock.release(); });
+    QVERIFY(mapped.tryAcquire(1, 5000));
+
+    // Act
+    QElapsedTimer timer;
+    timer.start();
+    const QFuture<QImage> droppedFuture = converter.convert(QVideoFrame(image));
+    const qint64 elapsedMs = timer.elapsed();
+
+    // Assert
+    QCOMPARE_LT(elapsedMs, 1000);
+    QVERIFY(droppedFuture.isFinished());
+    QVERIFY(droppedFuture.isCanceled());
+    QVERIFY(!blockedFuture.isFinished());
+
+    unblockConversion.dismiss();
+    unblock.release();
+    blockedFuture.waitForFinished();
+    QCOMPARE(blockedFuture.result().size(), image.size());
+}
+
+void tst_QVideoFrame::convertOnGpu_producesImages_whenFramesOfTwoRhisAlternate()
+{
+    // Arrange
+    QRhiNullInitParams params;
+    std::unique_ptr<QRhi> firstRhi(QRhi::create(QRhi::Null, &params));
+    std::unique_ptr<QRhi> secondRhi(QRhi::create(QRhi::Null, &params));
+    QVERIFY(firstRhi);
+    QVERIFY(secondRhi);
+
+    QImage image(QSize(64, 48), QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    const QVideoFrameFormat format(image.size(), QVideoFrameFormat::Format_ARGB8888);
+
+    auto createFrame = [&](QRhi *rhi) {
+        return QVideoFramePrivate::createFrame(std::make_unique<QtTestRhiVideoBuffer>(rhi, image),
+                                               format);
+    };
+
+    // Act; the conversion resources of both rhis are used in turns
+    QList<QImage> images;
+    for (int i = 0; i < 6; ++i) {
+        QRhi *rhi = i % 2 ? secondRhi.get() : firstRhi.get();
+        images.push_back(qImageFromVideoFrame(createFrame(rhi)));
+    }
+
+    // The cached resources of a destroyed rhi are dropped; the other ones stay usable
+    firstRhi.reset();
+    images.push_back(qImageFromVideoFrame(createFrame(secondRhi.get())));
+
+    // Assert
+    for (const QImage &converted : std::as_const(images)) {
+        QVERIFY(!converted.isNull());
+        QCOMPARE(converted.size(), image.size());
+    }
+    for (qsizetype i = 1; i < images.size(); ++i)
+        QCOMPARE(images[i], images.front());
+}
+
+void tst_QVideoFrame::convertOnCpu_producesCroppedImage_whenCalledWithSourceRect()
+{
+    // Arrange; the rect starts at an odd row and column
+    const QVideoFrame frame = createPatternFrame(QSize(320, 240), QVideoFrameFormat::Format_NV12);
+    QVERIFY(frame.isValid());
+    const QRect sourceRect(33, 21, 100, 61);
+
+    // Act
+    const QImage cropped = qImageFromVideoFrame(frame, sourceRect, {}, QImage::Format_Invalid, true);
+
+    // Assert
+    QCOMPARE(cropped, qImageFromVideoFrame(frame, true).copy(sourceRect));
+}
+
+void tst_QVideoFrame::convertOnCpu_producesScaledImageOfTargetFormat_whenCalledWithTargetSize()
+{
+    // Arrange
+    const QVideoFrame frame = createPatternFrame(QSize(320, 240), QVideoFrameFormat::Format_YUV420P);
+    QVERIFY(frame.isValid());
+    const QImage fullImage = qImageFromVideoFrame(frame, true).convertToFormat(QImage::Format_ARGB32);
+
+    // Act
+    const QImage scaled =
+            qImageFromVideoFrame(frame, {}, QSize(160, 120), QImage::Format_RGBA8888, true);
+
+    // Assert; halving samples the middle of each block of 2x2 pixels
+    QCOMPARE(scaled.size(), QSize(160, 120));
+    QCOMPARE(scaled.format(), QImage::Format_RGBA8888);
+
+    const QImage scaledArgb = scaled.convertToFormat(QImage::Format_ARGB32);
+    for (int y = 0; y < scaledArgb.height(); ++y) {
+        for (int x = 0; x < scaledArgb.width(); ++x) {
+            const QRgb block[] = { fullImage.pixel(2 * x, 2 * y), fullImage.pixel(2 * x + 1, 2 * y),
+                                   fullImage.pixel(2 * x, 2 * y + 1),
+                                   fullImage.pixel(2 * x + 1, 2 * y + 1) };
+            const QRgb pixel = scaledArgb.pixel(x, y);
+            for (auto channel : { qRed, qGreen, qBlue }) {
+                int sum = 0;
+                for (QRgb blockPixel : block)
+                    sum += channel(blockPixel);
+                QVERIFY2(qAbs(channel(pixel) - sum / 4) <= 2,
+                         qPrintable(QStringLiteral("at %1, %2").arg(x).arg(y)));
+            }
+        }
+    }
+}
+
+void tst_QVideoFrame::convertOnCpu_averagesSourcePixels_whenDownscaledStrongly()
+{
+    // Arrange; columns of black and white pixels, which point sampling would alias
+    QImage stripes(QSize(640, 480), QImage::Format_RGB32);
+    for (int y = 0; y < stripes.height(); ++y) {
+        auto *line = reinterpret_cast<QRgb *>(stripes.scanLine(y));
+        for (int x = 0; x < stripes.width(); ++x)
+            line[x] = x % 2 ? qRgb(255, 255, 255) : qRgb(0, 0, 0);
+    }
+    const QVideoFrame frame(stripes);
+
+    // Act; not an integer scale, so the boxes cover parts of the source pixels
+    const QImage scaled =
+            qImageFromVideoFrame(frame, {}, QSize(61, 47), QImage::Format_RGB32, true);
+
+    // Assert; a box of ~10.5 columns is off the even mix by half a column at most
+    QCOMPARE(scaled.size(), QSize(61, 47));
+    for (int y = 0; y < scaled.height(); ++y) {
+        for (int x = 0; x < scaled.width(); ++x) {
+            const QRgb pixel = scaled.pixel(x, y);
+            QVERIFY2(qAbs(qGray(pixel) - 128) <= 13,
+                     qPrintable(QStringLiteral("at %1, %2").arg(x).arg(y)));
+        }
+    }
+}
+
+// The math of the nv12_bt2020_pq and nv12_bt2020_hlg shaders, in double precision
+static QRgb expectedToneMappedPixel(QVideoFrameFormat::ColorTransfer transfer, double maxLuminance,
+                                    double y, double u, double v)
+{
+    const bool hlg = transfer == QVideoFrameFormat::ColorTransfer_STD_B67;
+    const auto pqFromLinear = [](double sig) {
+        const double p = std::pow(sig / 100., 1305. / 8192.);
+        return std::pow((107. / 128. + 2413. / 128. * p) / (1. + 2392. / 128. * p), 2523. / 32.);
+    };
+    const auto hlgFromLinear = [](double sig) {
+        if (sig < 1. / 12.)
+            return std::sqrt(3. * sig);
+        return 0.17883277 * std::log(12. * sig - 0.28466892) + 0.55991073;
+    };
+    const auto fromLinear = [&](double sig) {
+        return hlg ? hlgFromLinear(sig) : pqFromLinear(sig);
+    };
+
+    // BT.2020, video range
+    double rgb[3] = { 1.1644 * y + 1.6787 * v - 0.9157,
+                      1.1644 * y - 0.1874 * u - 0.6504 * v + 0.3475,
+                      1.1644 * y + 2.1418 * u - 1.1483 };
+
+    const double masteringWhite = fromLinear(maxLuminance / 100.);
+    const double maxLum = fromLinear(1.);
+    const double luma = (y - 16. / 256.) * 256. / 219.;
+    double p = luma / masteringWhite;
+    const double ks = 1.5 * maxLum - 0.5;
+    double scale = 1.;
+    if (p >= ks) {
+        const double t = (p - ks) / (1. - ks);
+        p = (2 * t * t * t - 3 * t * t + 1) * ks + (t * t * t - 2 * t * t + t) * (1. - ks)
+                + (-2 * t * t * t + 3 * t * t) * maxLum;
+        scale = p * masteringWhite / luma;
+    }
+
+    for (double &c : rgb) {
+        c = qBound(0., c * scale, 1.);
+        if (hlg) {
+            c = c < 0.5 ? c * c / 3. : (std::exp((c - 0.55991073) / 0.17883277) + 0.28466892) / 12.;
+        } else {
+            const double e = std::pow(c, 32. / 2523.);
+            c = std::pow(std::max(e - 107. / 128., 0.) / (2413. / 128. - 2392. / 128. * e),
+                         8192. / 1305.) * 100.;
+        }
+    }
+    if (hlg) {
+        const double lum = 0.2627 * rgb[0] + 0.6780 * rgb[1] + 0.0593 * rgb[2];
+        for (double &c : rgb)
+            c *= std::pow(lum, 0.2) * maxLum;
+    }
+
+    const double srgb[3] = { 1.6605 * rgb[0] - 0.5876 * rgb[1] - 0.0728 * rgb[2],
+                             -0.1246 * rgb[0] + 1.1329 * rgb[1] - 0.0083 * rgb[2],
+                             -0.0182 * rgb[0] - 0.1006 * rgb[1] + 1.1187 * rgb[2] };
+    int encoded[3];
+    for (int i = 0; i < 3; ++i) {
+        const double c = qBound(0., srgb[i], 1.);
+        encoded[i] = qRound(
+                255. * (c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1. / 2.4) - 0.055));
+    }
+    return qRgb(encoded[0], encoded[1], encoded[2]);
+}
+
+void tst_QVideoFrame::convertOnCpu_tonemapsToSdr_whenFrameHasHdrTransfer_data()
+{
+    QTest::addColumn<QVideoFrameFormat::ColorTransfer>("transfer");
+    QTest::addColumn<float>("maxLuminance");
+    QTest::addColumn<int>("y");
+    QTest::addColumn<int>("u");
+    QTest::addColumn<int>("v");
+
+    // 10-bit samples
+    const std::pair<const char *, QVideoFrameFormat::ColorTransfer> transfers[] = {
+        { "PQ", QVideoFrameFormat::ColorTransfer_ST2084 },
+        { "HLG", QVideoFrameFormat::ColorTransfer_STD_B67 },
+    };
+    for (const auto &[name, transfer] : transfers) {
+        QTest::addRow("%s, white", name) << transfer << 1000.f << 940 << 512 << 512;
+        QTest::addRow("%s, gray", name) << transfer << 1000.f << 500 << 512 << 512;
+        QTest::addRow("%s, color", name) << transfer << 1000.f << 520 << 470 << 580;
+        QTest::addRow("%s, highlight", name) << transfer << 4000.f << 800 << 560 << 470;
+        QTest::addRow("%s, no metadata", name) << transfer << 0.f << 700 << 512 << 512;
+    }
+}
+
+void tst_QVideoFrame::convertOnCpu_tonemapsToSdr_whenFrameHasHdrTransfer()
+{
+    QFETCH(const QVideoFrameFormat::ColorTransfer, transfer);
+    QFETCH(const float, maxLuminance);
+    QFETCH(const int, y);
+    QFETCH(const int, u);
+    QFETCH(const int, v);
+
+    // Arrange
+    QVideoFrameFormat format(QSize(67, 9), QVideoFrameFormat::Format_P010);
+    format.setColorSpace(QVideoFrameFormat::ColorSpace_BT2020);
+    format.setColorRange(QVideoFrameFormat::ColorRange_Video);
+    format.setColorTransfer(transfer);
+    format.setMaxLuminance(maxLuminance);
+
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    // P010 keeps the samples in the high bits
+    for (int row = 0; row < frame.height(); ++row) {
+        auto *luma = reinterpret_cast<quint16 *>(frame.bits(0) + row * frame.bytesPerLine(0));
+        std::fill_n(luma, frame.width(), quint16(y << 6));
+    }
+    for (int row = 0; row < (frame.height() + 1) / 2; ++row) {
+        auto *chroma = reinterpret_cast<quint16 *>(frame.bits(1) + row * frame.bytesPerLine(1));
+        for (int x = 0; x < frame.width() + 1; x += 2) {
+            chroma[x] = quint16(u << 6);
+            chroma[x + 1] = quint16(v << 6);
+        }
+    }
+    frame.unmap();
+
+    // Act
+    const QImage image = qImageFromVideoFrame(frame, true).convertToFormat(QImage::Format_RGB32);
+
+    // Assert
+    QCOMPARE(image.size(), format.frameSize());
+    const QRgb expected = expectedToneMappedPixel(transfer, format.maxLuminance(),
+                                                  (y << 6) / 65535., (u << 6) / 65535.,
+                                                  (v << 6) / 65535.);
+    for (const QPoint &position : { QPoint(0, 0), QPoint(33, 4), QPoint(66, 8) }) {
+        const QRgb pixel = image.pixel(position);
+        for (auto channel : { qRed, qGreen, qBlue }) {
+            QVERIFY2(qAbs(channel(pixel) - channel(expected)) <= 2,
+                     qPrintable(QStringLiteral("%1 instead of %2")
+                                        .arg(pixel, 0, 16)
+                                        .arg(expected, 0, 16)));
+        }
+    }
+}
+
 QTEST_MAIN(tst_QVideoFrame)
 
 #include "tst_qvideoframe.moc"
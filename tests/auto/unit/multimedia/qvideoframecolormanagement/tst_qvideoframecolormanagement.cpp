@@ -10,9 +10,11 @@
 #include "private/qplatformmediaintegration_p.h"
 #include "private/qimagevideobuffer_p.h"
 #include "private/qvideoframe_p.h"
+#include "private/qvideotexturehelper_p.h"
 #include <QtGui/QColorSpace>
 #include <QtGui/QImage>
 #include <QtCore/QPointer>
+#include <QtCore/QScopeGuard>
 
 #include "../../../integration/shared/mediabackendutils.h"
 
@@ -176,6 +178,31 @@ QVideoFrame createTestFrame(const TestParams &params, const QImage &image)
     return QPlatformMediaIntegration::instance()->convertVideoFrame(source, format);
 }
 
+// The frames of the backends may keep their own textures; copying them to memory makes
+// the rendering upload the planes
+QVideoFrame toMemoryFrame(QVideoFrame source)
+{
+    if (!source.map(QVideoFrame::ReadOnly))
+        return {};
+
+    QVideoFrame frame(source.surfaceFormat());
+    if (!frame.map(QVideoFrame::WriteOnly))
+        return {};
+
+    for (int plane = 0; plane < source.planeCount(); ++plane) {
+        const int rows = std::min(source.mappedBytes(plane) / source.bytesPerLine(plane),
+                                  frame.mappedBytes(plane) / frame.bytesPerLine(plane));
+        const int rowBytes = std::min(source.bytesPerLine(plane), frame.bytesPerLine(plane));
+        for (int y = 0; y < rows; ++y)
+            memcpy(frame.bits(plane) + y * frame.bytesPerLine(plane),
+                   source.bits(plane) + y * source.bytesPerLine(plane), rowBytes);
+    }
+
+    frame.unmap();
+    source.unmap();
+    return frame;
+}
+
 struct ImageDiffReport
 {
     int DiffCountAboveThreshold; // Number of channel differences above threshold
@@ -464,6 +491,63 @@ private slots:
         QCOMPARE_LT(result->MaxDiff, 6); // Maximum per-channel difference
     }
 
+    void qImageFromVideoFrame_returnsSameColors_whenPacked10BitUploadIsEnabled_data()
+    {
+        if (!isRhiRenderingSupported())
+            QSKIP("The packed upload is a part of the RHI rendering");
+
+        QTest::addColumn<TestParams>("params");
+        for (const QVideoFrameFormat::PixelFormat pixelFormat :
+             { QVideoFrameFormat::Format_P010, QVideoFrameFormat::Format_YUV420P10 }) {
+            if (!isSupportedPixelFormat(pixelFormat))
+                continue;
+
+            for (const QVideoFrameFormat::ColorSpace colorSpace : colorSpaces()) {
+                for (const QVideoFrameFormat::ColorRange colorRange : colorRanges()) {
+                    TestParams param{
+                        "umbrellas.jpg", pixelFormat, colorSpace, colorRange, false,
+                    };
+                    QTest::addRow("%s", name(param).toLatin1().data()) << param;
+                }
+            }
+        }
+    }
+
+    // Compares the output of packed10.glsl to the references of the unpacked upload
+    void qImageFromVideoFrame_returnsSameColors_whenPacked10BitUploadIsEnabled()
+    {
+        QFETCH(const TestParams, params);
+
+        // Arrange
+        const QImage templateImage = m_reference.getTestdata(params.fileName);
+        QVERIFY(!templateImage.isNull());
+
+        const QVideoFrame frame = toMemoryFrame(createTestFrame(params, templateImage));
+        QVERIFY(frame.isValid());
+
+        const bool packed10BitUploadWasEnabled = QVideoTextureHelper::isPacked10BitUploadEnabled();
+        QVideoTextureHelper::setPacked10BitUploadEnabled(true);
+        const auto restorePacked10BitUpload = qScopeGuard([packed10BitUploadWasEnabled] {
+            QVideoTextureHelper::setPacked10BitUploadEnabled(packed10BitUploadWasEnabled);
+        });
+
+        // Act
+        const QImage actual = qImageFromVideoFrame(frame, params.forceCpu);
+
+        // Assert
+        constexpr int diffThreshold = 4;
+        std::optional<ImageDiffReport> result =
+                compareToReference(params, actual, m_reference, diffThreshold);
+
+        QVERIFY(result.has_value());
+        QCOMPARE_GT(result->PixelCount, 0);
+
+        const double ratioAboveThreshold =
+                static_cast<double>(result->DiffCountAboveThreshold) / result->PixelCount;
+        QCOMPARE_LT(ratioAboveThreshold, 0.01);
+        QCOMPARE_LT(result->MaxDiff, 6);
+    }
+
 
 private:
     ReferenceData m_reference;
@@ -0,0 +1,197 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include <private/qvideoframeconversionhelper_p.h>
+#include <QtCore/qrandom.h>
+
+#include <memory>
+#include <numeric>
+#include <vector>
+
+class tst_QVideoFrameConversionHelper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void yuvToRGBCoefficients_matchLegacyValues_forBT601LimitedRange();
+
+    void yuvToRGBCoefficients_mapBlackAndWhite_data();
+    void yuvToRGBCoefficients_mapBlackAndWhite();
+
+    void yuvLineConverter_isBitExactWithScalarReference_data();
+    void yuvLineConverter_isBitExactWithScalarReference();
+
+private:
+    static QVideoFrameFormat makeFormat(QVideoFrameFormat::ColorSpace colorSpace,
+                                        QVideoFrameFormat::ColorRange colorRange)
+    {
+        QVideoFrameFormat format({ 64, 64 }, QVideoFrameFormat::Format_YUV420P);
+        format.setColorSpace(colorSpace);
+        format.setColorRange(colorRange);
+        return format;
+    }
+
+    static void addColorSpaceColumns()
+    {
+        QTest::addColumn<QVideoFrameFormat::ColorSpace>("colorSpace");
+        QTest::addColumn<QVideoFrameFormat::ColorRange>("colorRange");
+    }
+
+    template<typename AddRow>
+    static void forEachColorSpace(AddRow addRow)
+    {
+        const std::pair<QVideoFrameFormat::ColorSpace, const char *> colorSpaces[] = {
+            { QVideoFrameFormat::ColorSpace_BT601, "BT601" },
+            { QVideoFrameFormat::ColorSpace_BT709, "BT709" },
+            { QVideoFrameFormat::ColorSpace_BT2020, "BT2020" },
+        };
+
+        for (const auto &[colorSpace, colorSpaceName] : colorSpaces) {
+            addRow(colorSpace, QVideoFrameFormat::ColorRange_Video,
+                   QStringLiteral("%1, video range").arg(QLatin1StringView(colorSpaceName)));
+            addRow(colorSpace, QVideoFrameFormat::ColorRange_Full,
+                   QStringLiteral("%1, full range").arg(QLatin1StringView(colorSpaceName)));
+        }
+    }
+};
+
+void tst_QVideoFrameConversionHelper::yuvToRGBCoefficients_matchLegacyValues_forBT601LimitedRange()
+{
+    const auto c = qYUVToRGBCoefficients(
+            makeFormat(QVideoFrameFormat::ColorSpace_BT601, QVideoFrameFormat::ColorRange_Video));
+
+    QCOMPARE(c.yOffset, 16);
+    QCOMPARE(c.y, 298);
+    QCOMPARE(c.rv, 409);
+    QCOMPARE(c.gu, 100);
+    QCOMPARE(c.gv, 208);
+    QCOMPARE(c.bu, 516);
+}
+
+void tst_QVideoFrameConversionHelper::yuvToRGBCoefficients_mapBlackAndWhite_data()
+{
+    addColorSpaceColumns();
+
+    forEachColorSpace([](auto colorSpace, auto colorRange, const QString &name) {
+        QTest::newRow(name.toLocal8Bit().constData()) << colorSpace << colorRange;
+    });
+}
+
+void tst_QVideoFrameConversionHelper::yuvToRGBCoefficients_mapBlackAndWhite()
+{
+    QFETCH(QVideoFrameFormat::ColorSpace, colorSpace);
+    QFETCH(QVideoFrameFormat::ColorRange, colorRange);
+
+    const auto c = qYUVToRGBCoefficients(makeFormat(colorSpace, colorRange));
+    const bool fullRange = colorRange == QVideoFrameFormat::ColorRange_Full;
+
+    QCOMPARE(qYUVToARGB32(fullRange ? 0 : 16, 128, 128, c), 0xff000000u);
+    QCOMPARE(qYUVToARGB32(fullRange ? 255 : 235, 128, 128, c), 0xffffffffu);
+}
+
+void tst_QVideoFrameConversionHelper::yuvLineConverter_isBitExactWithScalarReference_data()
+{
+    addColorSpaceColumns();
+    QTest::addColumn<YUVLineLayout>("layout");
+
+    const std::pair<YUVLineLayout, const char *> layouts[] = {
+        { YUVLineLayout::Planar, "planar" },
+        { YUVLineLayout::SemiPlanar, "semi-planar" },
+        { YUVLineLayout::Interleaved, "interleaved" },
+    };
+
+    for (const auto &[layout, layoutName] : layouts) {
+        forEachColorSpace([&](auto colorSpace, auto colorRange, const QString &name) {
+            QTest::addRow("%s, %s", layoutName, name.toLocal8Bit().constData())
+                    << colorSpace << colorRange << layout;
+        });
+    }
+}
+
+void tst_QVideoFrameConversionHelper::yuvLineConverter_isBitExactWithScalarReference()
+{
+    QFETCH(QVideoFrameFormat::ColorSpace, colorSpace);
+    QFETCH(QVideoFrameFormat::ColorRange, colorRange);
+    QFETCH(YUVLineLayout, layout);
+
+    const auto coefficients = qYUVToRGBCoefficients(makeFormat(colorSpace, colorRange));
+    const YUVLineConvertFunc convertLine = qYUVLineConverter(layout);
+    QVERIFY(convertLine);
+
+    QRandomGenerator random(42);
+
+    // Odd widths and widths around the vector sizes cover the leftovers
+    std::vector<int> widths(130);
+    std::iota(widths.begin(), widths.end(), 1);
+    widths.push_back(1920);
+    widths.push_back(1921);
+
+    for (int width : widths) {
+        const int chromaCount = (width + 1) / 2;
+
+        // Buffers of the exact line size, so that sanitizers catch reading beyond the line
+        std::unique_ptr<uchar[]> luma;
+        std::unique_ptr<uchar[]> chroma;
+        const uchar *y = nullptr;
+        const uchar *u = nullptr;
+        const uchar *v = nullptr;
+
+        auto makeRandomBuffer = [&](int size) {
+            auto buffer = std::make_unique<uchar[]>(size);
+            for (int i = 0; i < size; ++i)
+                buffer[i] = uchar(random.bounded(256));
+            return buffer;
+        };
+
+        switch (layout) {
+        case YUVLineLayout::Planar:
+            luma = makeRandomBuffer(width);
+            chroma = makeRandomBuffer(chromaCount * 2);
+            y = luma.get();
+            u = chroma.get();
+            v = chroma.get() + chromaCount;
+            break;
+        case YUVLineLayout::SemiPlanar:
+            luma = makeRandomBuffer(width);
+            chroma = makeRandomBuffer(chromaCount * 2);
+            y = luma.get();
+            u = chroma.get();
+            v = chroma.get() + 1;
+            break;
+        case YUVLineLayout::Interleaved:
+            // YUYV
+            luma = makeRandomBuffer(chromaCount * 4);
+            y = luma.get();
+            u = y + 1;
+            v = y + 3;
+            break;
+        default:
+            QFAIL("Unexpected layout");
+        }
+
+        std::vector<quint32> expected(width, 0);
+        std::vector<quint32> actual(width, 0);
+
+        switch (layout) {
+        case YUVLineLayout::Planar:
+            qt_convert_YUV_line_to_ARGB32<1, 1>(y, u, v, expected.data(), width, coefficients);
+            break;
+        case YUVLineLayout::SemiPlanar:
+            qt_convert_YUV_line_to_ARGB32<1, 2>(y, u, v, expected.data(), width, coefficients);
+            break;
+        default:
+            qt_convert_YUV_line_to_ARGB32<2, 4>(y, u, v, expected.data(), width, coefficients);
+            break;
+        }
+
+        convertLine(y, u, v, actual.data(), width, coefficients);
+
+        QVERIFY2(expected == actual, QByteArray::number(width));
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QVideoFrameConversionHelper)
+
+#include "tst_qvideoframeconversionhelper.moc"
@@ -0,0 +1,175 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+
+#include <private/qvideoframepool_p.h>
+#include <private/qvideoframe_p.h>
+
+class tst_QVideoFramePool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void createFrame_createsWritableFrameWithLayoutOfAllocatedFrame_data();
+    void createFrame_createsWritableFrameWithLayoutOfAllocatedFrame();
+
+    void createFrame_reusesMemory_whenPreviousFrameIsDestroyed();
+    void createFrame_allocatesMemory_whenPreviousFrameIsAlive();
+    void createFrame_dropsFreeMemory_whenFrameSizeChanges();
+
+    void freeBufferCount_isLimited_whenManyFramesAreDestroyed();
+    void frame_staysValid_whenPoolIsDestroyed();
+
+    void createBuffer_createsBufferOfGivenSizeAndStride();
+};
+
+void tst_QVideoFramePool::createFrame_createsWritableFrameWithLayoutOfAllocatedFrame_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+
+    for (auto pixelFormat : { QVideoFrameFormat::Format_NV12, QVideoFrameFormat::Format_YUV420P,
+                              QVideoFrameFormat::Format_P010, QVideoFrameFormat::Format_BGRA8888 })
+        QTest::addRow("%s", QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1().constData())
+                << pixelFormat;
+}
+
+void tst_QVideoFramePool::createFrame_createsWritableFrameWithLayoutOfAllocatedFrame()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+
+    // Arrange
+    const QVideoFrameFormat format(QSize(636, 358), pixelFormat);
+    QVideoFramePool pool;
+    QVideoFrame expected(format);
+
+    // Act
+    QVideoFrame frame = pool.createFrame(format);
+
+    // Assert
+    QVERIFY(frame.isValid());
+    QCOMPARE(frame.surfaceFormat(), format);
+    QVERIFY(frame.map(QVideoFrame::ReadWrite));
+    QVERIFY(expected.map(QVideoFrame::ReadOnly));
+    QCOMPARE(frame.planeCount(), expected.planeCount());
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        QCOMPARE(frame.bytesPerLine(plane), expected.bytesPerLine(plane));
+        QCOMPARE(frame.mappedBytes(plane), expected.mappedBytes(plane));
+        QCOMPARE(quintptr(frame.bits(plane)) % 64, quintptr(0));
+    }
+}
+
+void tst_QVideoFramePool::createFrame_reusesMemory_whenPreviousFrameIsDestroyed()
+{
+    // Arrange
+    const QVideoFrameFormat format(QSize(320, 240), QVideoFrameFormat::Format_NV12);
+    QVideoFramePool pool;
+
+    QVideoFrame frame = pool.createFrame(format);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    const uchar *bits = frame.bits(0);
+    QVideoFrame copy = frame;
+
+    // Act
+    frame = {};
+    copy = {};
+    QCOMPARE(pool.freeBufferCount(), 1);
+    QVideoFrame nextFrame = pool.createFrame(format);
+
+    // Assert
+    QCOMPARE(pool.freeBufferCount(), 0);
+    QVERIFY(nextFrame.map(QVideoFrame::ReadOnly));
+    QCOMPARE(nextFrame.bits(0), bits);
+}
+
+void tst_QVideoFramePool::createFrame_allocatesMemory_whenPreviousFrameIsAlive()
+{
+    // Arrange
+    const QVideoFrameFormat format(QSize(320, 240), QVideoFrameFormat::Format_NV12);
+    QVideoFramePool pool;
+
+    QVideoFrame frame = pool.createFrame(format);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+
+    // Act
+    QVideoFrame nextFrame = pool.createFrame(format);
+
+    // Assert
+    QVERIFY(nextFrame.map(QVideoFrame::ReadOnly));
+    QCOMPARE_NE(nextFrame.bits(0), frame.bits(0));
+}
+
+void tst_QVideoFramePool::createFrame_dropsFreeMemory_whenFrameSizeChanges()
+{
+    // Arrange
+    QVideoFramePool pool;
+    pool.createFrame(QVideoFrameFormat(QSize(320, 240), QVideoFrameFormat::Format_NV12));
+    QCOMPARE(pool.freeBufferCount(), 1);
+
+    // Act
+    QVideoFrame frame =
+            pool.createFrame(QVideoFrameFormat(QSize(640, 480), QVideoFrameFormat::Format_NV12));
+
+    // Assert
+    QVERIFY(frame.isValid());
+    QCOMPARE(pool.freeBufferCount(), 0);
+}
+
+void tst_QVideoFramePool::freeBufferCount_isLimited_whenManyFramesAreDestroyed()
+{
+    // Arrange
+    const QVideoFrameFormat format(QSize(320, 240), QVideoFrameFormat::Format_NV12);
+    QVideoFramePool pool(2);
+
+    QList<QVideoFrame> frames;
+    for (int i = 0; i < 5; ++i)
+        frames.push_back(pool.createFrame(format));
+
+    // Act
+    frames.clear();
+
+    // Assert
+    QCOMPARE(pool.freeBufferCount(), 2);
+}
+
+void tst_QVideoFramePool::frame_staysValid_whenPoolIsDestroyed()
+{
+    // Arrange
+    const QVideoFrameFormat format(QSize(320, 240), QVideoFrameFormat::Format_BGRA8888);
+    auto pool = std::make_unique<QVideoFramePool>();
+    QVideoFrame frame = pool->createFrame(format);
+
+    // Act
+    pool.reset();
+
+    // Assert
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    std::fill_n(frame.bits(0), frame.mappedBytes(0), uchar(0xff));
+    frame.unmap();
+    QCOMPARE(frame.toImage().pixel(0, 0), qRgba(0xff, 0xff, 0xff, 0xff));
+}
+
+void tst_QVideoFramePool::createBuffer_createsBufferOfGivenSizeAndStride()
+{
+    // Arrange
+    QVideoFramePool pool;
+
+    // Act
+    auto buffer = pool.createBuffer(1000 * 100, 1000);
+
+    // Assert
+    QVERIFY(buffer);
+    const auto mapData = buffer->map(QVideoFrame::WriteOnly);
+    QCOMPARE(mapData.planeCount, 1);
+    QCOMPARE(mapData.bytesPerLine[0], 1000);
+    QCOMPARE(mapData.dataSize[0], qsizetype(1000 * 100));
+    QVERIFY(mapData.data[0]);
+
+    QVideoFrame frame = QVideoFramePrivate::createFrame(
+            std::move(buffer), QVideoFrameFormat(QSize(250, 100), QVideoFrameFormat::Format_BGRA8888));
+    QVERIFY(frame.isValid());
+}
+
+QTEST_MAIN(tst_QVideoFramePool)
+
+#include "tst_qvideoframepool.moc"
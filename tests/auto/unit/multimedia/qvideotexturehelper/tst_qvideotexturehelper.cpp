@@ -194,11 +194,46 @@ QMatrix4x4 getColorMatrix(const QByteArray &uniformDataBytes)
     return QMatrix4x4{ colorMatrixData }.transposed();
 };
 
+// An RGB10A2 texel with three packed samples, see QVideoTextureHelper::packPlaneTo10Bit
+constexpr quint32 packedTexel(quint32 first, quint32 second, quint32 third)
+{
+    return first | second << 10 | third << 20 | 3u << 30;
+}
+
+// Fills the 10-bit samples of a plane with row * 100 + column, shifted to the bits of the format
+void fillPlaneWith10BitSamples(QVideoFrame &frame, int plane, int samplesPerRow, int rows)
+{
+    const int shift = frame.pixelFormat() == QVideoFrameFormat::Format_P010 ? 6 : 0;
+    for (int y = 0; y < rows; ++y) {
+        auto *row = reinterpret_cast<quint16 *>(frame.bits(plane) + y * frame.bytesPerLine(plane));
+        for (int x = 0; x < samplesPerRow; ++x)
+            row[x] = quint16((y * 100 + x) << shift);
+    }
+}
+
+QList<quint32> toTexels(const QByteArray &data)
+{
+    const auto *texels = reinterpret_cast<const quint32 *>(data.constData());
+    return QList<quint32>(texels, texels + data.size() / sizeof(quint32));
+}
+
 class tst_qvideotexturehelper : public QObject
 {
     Q_OBJECT
 public:
 private slots:
+    void initTestCase()
+    {
+        // Only the 10-bit formats are affected
+        m_packed10BitUploadWasEnabled = QVideoTextureHelper::isPacked10BitUploadEnabled();
+        QVideoTextureHelper::setPacked10BitUploadEnabled(true);
+    }
+
+    void cleanupTestCase()
+    {
+        QVideoTextureHelper::setPacked10BitUploadEnabled(m_packed10BitUploadWasEnabled);
+    }
+
     void updateUniformData_populatesYUV2RGBColorMatrix_data()
     {
         QTest::addColumn<QVideoFrameFormat::ColorSpace>("colorSpace");
@@ -231,7 +266,7 @@ private slots:
 
         // Act
         QByteArray data;
-        QVideoTextureHelper::updateUniformData(&data, format, {}, {}, 0.0);
+        QVideoTextureHelper::updateUniformData(&data, nullptr, format, {}, {}, 0.0);
         const QMatrix4x4 actual = getColorMatrix(data);
 
         // Assert
@@ -253,6 +288,181 @@ private slots:
             QVERIFY(fuzzyCompareWithTolerance(actualBlackRgb, expectedBlackRgb, 5e-4f));
         }
     }
+
+    void createTextures_reusesReleasedTextures_whenFramesHaveSameSize()
+    {
+        // Arrange
+        QRhiNullInitParams params;
+        std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, &params));
+        QVERIFY(rhi);
+
+        QVideoFrame frame(QVideoFrameFormat(QSize(64, 48), QVideoFrameFormat::Format_NV12));
+        QVideoFrame otherFrame(QVideoFrameFormat(QSize(64, 48), QVideoFrameFormat::Format_NV12));
+        QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+
+        auto textures = QVideoTextureHelper::createTextures(frame, rhi.get(), rub, {});
+        QVERIFY(textures);
+        const QRhiTexture *texture = textures->texture(0);
+        const QRhiTexture *uvTexture = textures->texture(1);
+
+        // Act; as if one sink was destroyed and another one started
+        textures.reset();
+        auto otherTextures = QVideoTextureHelper::createTextures(otherFrame, rhi.get(), rub, {});
+
+        // Assert
+        QVERIFY(otherTextures);
+        QCOMPARE(otherTextures->texture(0), texture);
+        QCOMPARE(otherTextures->texture(1), uvTexture);
+
+        rub->release();
+    }
+
+    void createTextures_createsTexturesOfFrameSize_whenFrameSizeChanges()
+    {
+        // Arrange
+        QRhiNullInitParams params;
+        std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, &params));
+        QVERIFY(rhi);
+
+        QVideoFrame frame(QVideoFrameFormat(QSize(64, 48), QVideoFrameFormat::Format_NV12));
+        QVideoFrame largerFrame(QVideoFrameFormat(QSize(128, 96), QVideoFrameFormat::Format_NV12));
+        QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+
+        auto textures = QVideoTextureHelper::createTextures(frame, rhi.get(), rub, {});
+        QVERIFY(textures);
+
+        // Act
+        textures = QVideoTextureHelper::createTextures(largerFrame, rhi.get(), rub,
+                                                       std::move(textures));
+
+        // Assert
+        QVERIFY(textures);
+        QCOMPARE(textures->texture(0)->pixelSize(), QSize(128, 96));
+        QCOMPARE(textures->texture(1)->pixelSize(), QSize(64, 48));
+
+        rub->release();
+    }
+
+    void createTextures_packsThreeSamplesPerTexel_whenPacked10BitUploadIsEnabled_data()
+    {
+        QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+        QTest::addColumn<QList<QSize>>("textureSizes");
+
+        // The rows of UV have two samples per pixel
+        QTest::addRow("P010") << QVideoFrameFormat::Format_P010
+                              << QList<QSize>{ { 427, 240 }, { 427, 120 } };
+        QTest::addRow("YUV420P10") << QVideoFrameFormat::Format_YUV420P10
+                                   << QList<QSize>{ { 427, 240 }, { 214, 120 }, { 214, 120 } };
+    }
+
+    void createTextures_packsThreeSamplesPerTexel_whenPacked10BitUploadIsEnabled()
+    {
+        QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+        QFETCH(const QList<QSize>, textureSizes);
+
+        // Arrange
+        QRhiNullInitParams params;
+        std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, &params));
+        QVERIFY(rhi);
+
+        QVideoFrame frame(QVideoFrameFormat(QSize(1280, 240), pixelFormat));
+        QVERIFY(QVideoTextureHelper::usesPacked10BitUpload(frame, rhi.get()));
+        QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+
+        // Act
+        auto textures = QVideoTextureHelper::createTextures(frame, rhi.get(), rub, {});
+        QByteArray uniformData;
+        QVideoTextureHelper::updateUniformData(&uniformData, rhi.get(), frame.surfaceFormat(),
+                                               frame, {}, 1.f);
+
+        // Assert
+        QVERIFY(textures);
+        for (int plane = 0; plane < textureSizes.size(); ++plane) {
+            QCOMPARE(textures->texture(plane)->format(), QRhiTexture::RGB10A2);
+            QCOMPARE(textures->texture(plane)->pixelSize(), textureSizes[plane]);
+        }
+
+        // The shaders tell the packed textures by the flag
+        const auto *data =
+                reinterpret_cast<const QVideoTextureHelper::UniformData *>(uniformData.constData());
+        QCOMPARE(data->width, 1280.f);
+        QCOMPARE(data->packed10Bit, 1.f);
+
+        rub->release();
+    }
+
+    void updateUniformData_clearsPacked10BitFlag_whenRhiIsUnknown()
+    {
+        // Arrange
+        QVideoFrame frame(QVideoFrameFormat(QSize(1280, 240), QVideoFrameFormat::Format_P010));
+
+        // Act
+        QByteArray uniformData;
+        QVideoTextureHelper::updateUniformData(&uniformData, nullptr, frame.surfaceFormat(),
+                                               frame, {}, 1.f);
+
+        // Assert; without a rhi, the textures can't be known to support RGB10A2
+        QVERIFY(!QVideoTextureHelper::usesPacked10BitUpload(frame, nullptr));
+        const auto *data =
+                reinterpret_cast<const QVideoTextureHelper::UniformData *>(uniformData.constData());
+        QCOMPARE(data->width, 1280.f);
+        QCOMPARE(data->packed10Bit, 0.f);
+    }
+
+    void packPlaneTo10Bit_packsThreeSamplesPerTexel_data()
+    {
+        QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+        QTest::addColumn<int>("plane");
+        QTest::addColumn<int>("samplesPerRow");
+        QTest::addColumn<int>("rows");
+        QTest::addColumn<QList<quint32>>("expected");
+
+        // The frames are 4x4; the last texel of a row repeats the last sample
+        const QList<quint32> lumaTexels{
+            packedTexel(0, 1, 2),       packedTexel(3, 3, 3),
+            packedTexel(100, 101, 102), packedTexel(103, 103, 103),
+            packedTexel(200, 201, 202), packedTexel(203, 203, 203),
+            packedTexel(300, 301, 302), packedTexel(303, 303, 303),
+        };
+
+        // P010 has the samples in the high bits, and interleaved UV
+        QTest::addRow("P010_Y") << QVideoFrameFormat::Format_P010 << 0 << 4 << 4 << lumaTexels;
+        QTest::addRow("P010_UV") << QVideoFrameFormat::Format_P010 << 1 << 4 << 2
+                                 << QList<quint32>{ packedTexel(0, 1, 2), packedTexel(3, 3, 3),
+                                                    packedTexel(100, 101, 102),
+                                                    packedTexel(103, 103, 103) };
+
+        // YUV420P10 has the samples in the low bits, and separate U and V planes
+        QTest::addRow("YUV420P10_Y")
+                << QVideoFrameFormat::Format_YUV420P10 << 0 << 4 << 4 << lumaTexels;
+        QTest::addRow("YUV420P10_V")
+                << QVideoFrameFormat::Format_YUV420P10 << 2 << 2 << 2
+                << QList<quint32>{ packedTexel(0, 1, 1), packedTexel(100, 101, 101) };
+    }
+
+    void packPlaneTo10Bit_packsThreeSamplesPerTexel()
+    {
+        QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+        QFETCH(const int, plane);
+        QFETCH(const int, samplesPerRow);
+        QFETCH(const int, rows);
+        QFETCH(const QList<quint32>, expected);
+
+        // Arrange
+        QVideoFrame frame(QVideoFrameFormat(QSize(4, 4), pixelFormat));
+        QVERIFY(frame.map(QVideoFrame::ReadWrite));
+        fillPlaneWith10BitSamples(frame, plane, samplesPerRow, rows);
+
+        // Act
+        QByteArray data;
+        QVideoTextureHelper::packPlaneTo10Bit(frame, plane, data);
+
+        // Assert
+        QCOMPARE(toTexels(data), expected);
+    }
+
+private:
+    bool m_packed10BitUploadWasEnabled = false;
 };
 
 QTEST_MAIN(tst_qvideotexturehelper)
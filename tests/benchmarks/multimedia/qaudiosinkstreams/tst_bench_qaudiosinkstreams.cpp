@@ -0,0 +1,208 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+#include <QtCore/qthread.h>
+#include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudiosink.h>
+#include <QtMultimedia/qmediadevices.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+class tst_QAudioSinkStreams : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void feedStreams_data();
+    void feedStreams();
+    void feedStreamsFromThreads_data();
+    void feedStreamsFromThreads();
+
+private:
+    struct Stream
+    {
+        std::unique_ptr<QAudioSink> sink;
+        QIODevice *device = nullptr;
+    };
+
+    QAudioFormat streamFormat() const;
+    std::vector<Stream> startStreams(const QAudioFormat &format, int streamCount) const;
+
+    QAudioDevice m_device;
+};
+
+void tst_QAudioSinkStreams::initTestCase()
+{
+    const QList<QAudioDevice> outputs = QMediaDevices::audioOutputs();
+    if (outputs.isEmpty())
+        QSKIP("No audio output device");
+
+    // Prefer a null sink, e.g. module-null-sink of PulseAudio, so that the numbers don't
+    // depend on the hardware
+    const auto nullSink = std::find_if(outputs.begin(), outputs.end(), [](const QAudioDevice &d) {
+        return d.id().contains("null");
+    });
+    m_device = nullSink != outputs.end() ? *nullSink : QMediaDevices::defaultAudioOutput();
+    qInfo() << "Playing to" << m_device.description();
+}
+
+QAudioFormat tst_QAudioSinkStreams::streamFormat() const
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return m_device.isFormatSupported(format) ? format : m_device.preferredFormat();
+}
+
+// Returns fewer streams than asked for if the device can't start them all
+std::vector<tst_QAudioSinkStreams::Stream>
+tst_QAudioSinkStreams::startStreams(const QAudioFormat &format, int streamCount) const
+{
+    std::vector<Stream> streams;
+    for (int i = 0; i < streamCount; ++i) {
+        Stream stream;
+        stream.sink = std::make_unique<QAudioSink>(m_device, format);
+        stream.device = stream.sink->start();
+        if (!stream.device)
+            break;
+        streams.push_back(std::move(stream));
+    }
+    return streams;
+}
+
+void tst_QAudioSinkStreams::feedStreams_data()
+{
+    QTest::addColumn<int>("streamCount");
+
+    QTest::addRow("1 stream") << 1;
+    QTest::addRow("8 streams") << 8;
+    QTest::addRow("40 streams") << 40;
+    QTest::addRow("64 streams") << 64;
+}
+
+// Measures what an application feeding many push mode streams from one thread pays per
+// period: bytesFree(), processedUSecs() and a write() for each stream, while the backend
+// serves the same streams on its own thread, e.g. in an intercom or a monitoring wall.
+void tst_QAudioSinkStreams::feedStreams()
+{
+    QFETCH(const int, streamCount);
+
+    const QAudioFormat format = streamFormat();
+    std::vector<Stream> streams = startStreams(format, streamCount);
+    if (int(streams.size()) < streamCount)
+        QSKIP("Can't start enough streams on the device");
+
+    // 10 ms of silence per write
+    const QByteArray period(format.bytesForDuration(10000), '\0');
+    constexpr int periodsPerIteration = 100;
+
+    qint64 written = 0;
+    qint64 processedUSecs = 0;
+    QBENCHMARK {
+        for (int i = 0; i < periodsPerIteration; ++i) {
+            for (Stream &stream : streams) {
+                const qsizetype bytesFree = stream.sink->bytesFree();
+                if (bytesFree > 0)
+                    written += stream.device->write(period.constData(),
+                                                    qMin(bytesFree, period.size()));
+                processedUSecs = qMax(processedUSecs, stream.sink->processedUSecs());
+            }
+            QCoreApplication::processEvents();
+        }
+    }
+
+    for (Stream &stream : streams) {
+        QCOMPARE_NE(stream.sink->error(), QAudio::OpenError);
+        stream.sink->reset();
+    }
+
+    QCOMPARE_GT(written, 0);
+    QCOMPARE_GE(processedUSecs, 0);
+}
+
+void tst_QAudioSinkStreams::feedStreamsFromThreads_data()
+{
+    QTest::addColumn<int>("streamCount");
+    QTest::addColumn<int>("threadCount");
+
+    QTest::addRow("8 streams, 2 threads") << 8 << 2;
+    QTest::addRow("40 streams, 4 threads") << 40 << 4;
+    QTest::addRow("64 streams, 8 threads") << 64 << 8;
+}
+
+// Like feedStreams(), but the streams are split between feeder threads, e.g. one per group of
+// channels of a mixer, so that the feeders also contend with each other for the backend. Each
+// stream is only written from one thread.
+void tst_QAudioSinkStreams::feedStreamsFromThreads()
+{
+    QFETCH(const int, streamCount);
+    QFETCH(const int, threadCount);
+
+    const QAudioFormat format = streamFormat();
+    std::vector<Stream> streams = startStreams(format, streamCount);
+    if (int(streams.size()) < streamCount)
+        QSKIP("Can't start enough streams on the device");
+
+    // 10 ms of silence per write
+    const QByteArray period(format.bytesForDuration(10000), '\0');
+    constexpr int periodsPerIteration = 100;
+
+    std::atomic<qint64> written = 0;
+    std::atomic<qint64> processedUSecs = 0;
+    auto feed = [&](int firstStream, int lastStream) {
+        qint64 threadWritten = 0;
+        qint64 threadProcessedUSecs = 0;
+        for (int i = 0; i < periodsPerIteration; ++i) {
+            for (int s = firstStream; s < lastStream; ++s) {
+                Stream &stream = streams[s];
+                const qsizetype bytesFree = stream.sink->bytesFree();
+                if (bytesFree > 0)
+                    threadWritten += stream.device->write(period.constData(),
+                                                          qMin(bytesFree, period.size()));
+                threadProcessedUSecs = qMax(threadProcessedUSecs, stream.sink->processedUSecs());
+            }
+            QThread::yieldCurrentThread();
+        }
+        written += threadWritten;
+        qint64 expected = processedUSecs;
+        while (expected < threadProcessedUSecs
+               && !processedUSecs.compare_exchange_weak(expected, threadProcessedUSecs)) {
+        }
+    };
+
+    QBENCHMARK {
+        std::vector<std::unique_ptr<QThread>> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back(QThread::create(feed, streamCount * t / threadCount,
+                                                 streamCount * (t + 1) / threadCount));
+            threads.back()->start();
+        }
+
+        // The sinks live on this thread, keep serving their events while the feeders run
+        for (const auto &thread : threads) {
+            while (!thread->wait(QDeadlineTimer(1)))
+                QCoreApplication::processEvents();
+        }
+    }
+
+    for (Stream &stream : streams) {
+        QCOMPARE_NE(stream.sink->error(), QAudio::OpenError);
+        stream.sink->reset();
+    }
+
+    QCOMPARE_GT(written.load(), 0);
+    QCOMPARE_GE(processedUSecs.load(), 0);
+}
+
+QTEST_MAIN(tst_QAudioSinkStreams)
+
+#include "tst_bench_qaudiosinkstreams.moc"
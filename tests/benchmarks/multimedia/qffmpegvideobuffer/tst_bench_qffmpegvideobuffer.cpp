@@ -0,0 +1,139 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qmediaplayer.h>
+#include <QtMultimedia/qvideosink.h>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtMultimedia/private/qvideoframeconverter_p.h>
+
+#include "mediabackendutils.h"
+
+QT_USE_NAMESPACE
+
+class tst_QFFmpegVideoBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void map_data();
+    void map();
+
+    void convert_data();
+    void convert();
+
+private:
+    void addMediaRows();
+    QList<QVideoFrame> decodeFrames(const QUrl &source);
+};
+
+// Not more than that, as the frames of hardware decoders may hold surfaces of a small pool
+static constexpr qsizetype FrameCount = 8;
+
+void tst_QFFmpegVideoBuffer::initTestCase()
+{
+    QSKIP_IF_NOT_FFMPEG();
+}
+
+void tst_QFFmpegVideoBuffer::addMediaRows()
+{
+    QTest::addColumn<QUrl>("source");
+
+    const char *files[] = {
+        "15s.mkv",
+        "BigBuckBunny.mp4",
+        "h264_avc1_yuv420p10le_tv_bt2020.mov", // 10-bit
+    };
+
+    for (const char *file : files) {
+        const QString path = QFINDTESTDATA(
+                QStringLiteral("../../../auto/integration/qmediaplayerbackend/testdata/")
+                + QLatin1StringView(file));
+        if (!path.isEmpty())
+            QTest::addRow("%s", file) << QUrl::fromLocalFile(path);
+    }
+}
+
+// The frames are taken from the sink before any mapping, like a video sink of
+// the application gets them
+QList<QVideoFrame> tst_QFFmpegVideoBuffer::decodeFrames(const QUrl &source)
+{
+    QMediaPlayer player;
+    QVideoSink sink;
+    player.setVideoSink(&sink);
+
+    QList<QVideoFrame> frames;
+    connect(&sink, &QVideoSink::videoFrameChanged, this, [&frames](const QVideoFrame &frame) {
+        if (frame.isValid() && frames.size() < FrameCount)
+            frames.push_back(frame);
+    });
+
+    player.setSource(source);
+    player.play();
+    QTest::qWaitFor([&frames] { return frames.size() == FrameCount; });
+    player.stop();
+
+    return frames;
+}
+
+void tst_QFFmpegVideoBuffer::map_data()
+{
+    addMediaRows();
+}
+
+// Measures the first mapping of decoded frames, which transfers the frames of hardware
+// decoders to memory and converts the pixel formats Qt doesn't support. Mapping a frame
+// again is free, so the mappings are timed one by one instead of with QBENCHMARK.
+// The default decoding uses hardware decoders where available; run with an empty
+// QT_FFMPEG_DECODING_HW_DEVICE_TYPES to measure software decoded frames.
+void tst_QFFmpegVideoBuffer::map()
+{
+    QFETCH(const QUrl, source);
+
+    QList<QVideoFrame> frames = decodeFrames(source);
+    QCOMPARE(frames.size(), FrameCount);
+
+    qint64 elapsed = 0;
+    for (QVideoFrame &frame : frames) {
+        QElapsedTimer timer;
+        timer.start();
+        const bool mapped = frame.map(QVideoFrame::ReadOnly);
+        elapsed += timer.nsecsElapsed();
+
+        QVERIFY(mapped);
+        frame.unmap();
+    }
+
+    QTest::setBenchmarkResult(qreal(elapsed) / frames.size(), QTest::WalltimeNanoseconds);
+}
+
+void tst_QFFmpegVideoBuffer::convert_data()
+{
+    addMediaRows();
+}
+
+// Measures the conversion of decoded frames to images, on the GPU where available.
+// The frames are mapped beforehand, so that the conversions from memory don't include
+// the transfers measured by map().
+void tst_QFFmpegVideoBuffer::convert()
+{
+    QFETCH(const QUrl, source);
+
+    QList<QVideoFrame> frames = decodeFrames(source);
+    QCOMPARE(frames.size(), FrameCount);
+    for (QVideoFrame &frame : frames) {
+        QVERIFY(frame.map(QVideoFrame::ReadOnly));
+        frame.unmap();
+    }
+
+    QBENCHMARK {
+        for (const QVideoFrame &frame : std::as_const(frames))
+            QVERIFY(!qImageFromVideoFrame(frame).isNull());
+    }
+}
+
+QTEST_MAIN(tst_QFFmpegVideoBuffer)
+
+#include "tst_bench_qffmpegvideobuffer.moc"
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qmediaplayer.h>
+#include <QtMultimedia/qvideosink.h>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtCore/qscopeguard.h>
+
+#include "mediabackendutils.h"
+
+QT_USE_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+class tst_QMediaPlayerSeek : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void seekWhilePaused_data();
+    void seekWhilePaused();
+
+private:
+    QUrl m_source;
+};
+
+void tst_QMediaPlayerSeek::initTestCase()
+{
+    QSKIP_IF_NOT_FFMPEG();
+
+    const QString path =
+            QFINDTESTDATA("../../../auto/integration/qmediaplayerbackend/testdata/15s.mkv");
+    if (path.isEmpty())
+        QSKIP("Test media is not found");
+
+    m_source = QUrl::fromLocalFile(path);
+}
+
+void tst_QMediaPlayerSeek::seekWhilePaused_data()
+{
+    QTest::addColumn<QByteArray>("fastSeek");
+
+    QTest::addRow("accurate") << "0"_ba;
+    QTest::addRow("fast_keyframe") << "1"_ba;
+}
+
+// Measures the time from setPosition() until the frame at the new position is presented,
+// which is what the user sees when scrubbing a paused video.
+void tst_QMediaPlayerSeek::seekWhilePaused()
+{
+    QFETCH(const QByteArray, fastSeek);
+
+    // The seek mode is read on media loading
+    qputenv("QT_FFMPEG_PLAYBACK_ENGINE_FAST_SEEK", fastSeek);
+    auto restoreEnv = qScopeGuard([] { qunsetenv("QT_FFMPEG_PLAYBACK_ENGINE_FAST_SEEK"); });
+
+    QMediaPlayer player;
+    QVideoSink sink;
+    player.setVideoSink(&sink);
+
+    QSignalSpy frameSpy(&sink, &QVideoSink::videoFrameChanged);
+
+    player.setSource(m_source);
+    player.pause();
+    QTRY_VERIFY(!frameSpy.empty());
+
+    const qint64 duration = player.duration();
+    QCOMPARE_GT(duration, 0);
+
+    // Positions jump back and forth and fall in the middle of GOPs,
+    // similar to dragging a timeline slider.
+    QList<qint64> positions;
+    for (int i = 0; i < 10; ++i)
+        positions.push_back((i * 7 % 10) * duration / 10 + duration / 23);
+
+    qsizetype index = 0;
+    QBENCHMARK {
+        frameSpy.clear();
+        player.setPosition(positions[index++ % positions.size()]);
+        if (frameSpy.empty())
+            QVERIFY(frameSpy.wait(5000));
+    }
+}
+
+QTEST_MAIN(tst_QMediaPlayerSeek)
+
+#include "tst_bench_qmediaplayerseek.moc"
@@ -0,0 +1,257 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtMultimedia/private/qhwvideobuffer_p.h>
+#include <QtMultimedia/private/qvideoframe_p.h>
+#include <QtMultimedia/private/qvideoframeconversionhelper_p.h>
+#include <QtMultimedia/private/qvideoframeconverter_p.h>
+#include <rhi/qrhi.h>
+
+#include "mediabackendutils.h"
+
+QT_USE_NAMESPACE
+
+namespace {
+
+// Exposes a memory frame as a frame of the given QRhi, so that qImageFromVideoFrame()
+// converts it on that QRhi instead of the one it would create itself
+class RhiFrameBuffer : public QHwVideoBuffer
+{
+public:
+    RhiFrameBuffer(QVideoFrame frame, QRhi *rhi)
+        : QHwVideoBuffer(QVideoFrame::NoHandle, rhi), m_frame(std::move(frame))
+    {
+    }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData mapData;
+        if (!m_frame.map(mode))
+            return mapData;
+
+        mapData.planeCount = m_frame.planeCount();
+        for (int plane = 0; plane < mapData.planeCount; ++plane) {
+            mapData.data[plane] = m_frame.bits(plane);
+            mapData.bytesPerLine[plane] = m_frame.bytesPerLine(plane);
+            mapData.dataSize[plane] = m_frame.mappedBytes(plane);
+        }
+        return mapData;
+    }
+
+    void unmap() override { m_frame.unmap(); }
+
+private:
+    QVideoFrame m_frame;
+};
+
+enum class Converter { Cpu, Rhi, NullRhi };
+
+} // namespace
+
+class tst_QVideoFrameConverter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convertOnCpu_data();
+    void convertOnCpu();
+
+    void convertWithConverterForFormat_data();
+    void convertWithConverterForFormat();
+
+    void qImageFromVideoFrame_data();
+    void qImageFromVideoFrame();
+
+private:
+    static QVideoFrame createFrame(QSize size, QVideoFrameFormat::PixelFormat pixelFormat,
+                                   QVideoFrameFormat::ColorTransfer colorTransfer =
+                                           QVideoFrameFormat::ColorTransfer_Unknown)
+    {
+        QVideoFrameFormat format(size, pixelFormat);
+        format.setColorTransfer(colorTransfer);
+        QVideoFrame frame(format);
+        if (frame.map(QVideoFrame::WriteOnly)) {
+            // Some variation in the data keeps the conversion away from trivial paths
+            for (int plane = 0; plane < frame.planeCount(); ++plane) {
+                uchar *bits = frame.bits(plane);
+                for (int i = 0; i < frame.mappedBytes(plane); ++i)
+                    bits[i] = uchar(i * 7 + plane * 31);
+            }
+            frame.unmap();
+        }
+        return frame;
+    }
+};
+
+void tst_QVideoFrameConverter::convertOnCpu_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("threadCount");
+
+    const std::pair<QSize, const char *> sizes[] = {
+        { { 1920, 1080 }, "1080p" },
+        { { 3840, 2160 }, "4K" },
+        { { 7680, 4320 }, "8K" },
+    };
+
+    const QVideoFrameFormat::PixelFormat pixelFormats[] = {
+        QVideoFrameFormat::Format_NV12,
+        QVideoFrameFormat::Format_YUV420P,
+        QVideoFrameFormat::Format_P010,
+        QVideoFrameFormat::Format_BGRA8888,
+    };
+
+    QList<int> threadCounts;
+    for (int count = 1; count < QThread::idealThreadCount(); count *= 2)
+        threadCounts.push_back(count);
+    threadCounts.push_back(QThread::idealThreadCount());
+
+    for (auto pixelFormat : pixelFormats) {
+        const QByteArray formatName =
+                QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+        for (const auto &[size, sizeName] : sizes) {
+            for (int threadCount : threadCounts)
+                QTest::addRow("%s, %s, %d threads", formatName.constData(), sizeName, threadCount)
+                        << pixelFormat << size << threadCount;
+        }
+    }
+}
+
+// Shows how the CPU conversion of large frames scales with the number of threads
+void tst_QVideoFrameConverter::convertOnCpu()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(const QSize, size);
+    QFETCH(const int, threadCount);
+
+    const QVideoFrame frame = createFrame(size, pixelFormat);
+
+    QBENCHMARK {
+        const QImage image = qImageFromVideoFrameOnCpu(frame, threadCount);
+        QVERIFY(!image.isNull());
+    }
+}
+
+void tst_QVideoFrameConverter::convertWithConverterForFormat_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QVideoFrameFormat::ColorTransfer>("colorTransfer");
+
+    const std::pair<QSize, const char *> sizes[] = {
+        { { 1280, 720 }, "720p" },
+        { { 1920, 1080 }, "1080p" },
+        { { 3840, 2160 }, "4K" },
+    };
+
+    for (int i = QVideoFrameFormat::Format_Invalid + 1; i < QVideoFrameFormat::NPixelFormats; ++i) {
+        const auto pixelFormat = QVideoFrameFormat::PixelFormat(i);
+        if (!qConverterForFormat(pixelFormat))
+            continue;
+
+        const QByteArray formatName =
+                QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+        for (const auto &[size, sizeName] : sizes) {
+            QTest::addRow("%s, %s", formatName.constData(), sizeName)
+                    << pixelFormat << size << QVideoFrameFormat::ColorTransfer_Unknown;
+
+            // HDR frames are tone mapped
+            if (pixelFormat == QVideoFrameFormat::Format_P010)
+                QTest::addRow("%s PQ, %s", formatName.constData(), sizeName)
+                        << pixelFormat << size << QVideoFrameFormat::ColorTransfer_ST2084;
+        }
+    }
+}
+
+// The single threaded conversion of a whole frame, without the image handling around it;
+// shows the gains of the SIMD line converters
+void tst_QVideoFrameConverter::convertWithConverterForFormat()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(const QSize, size);
+    QFETCH(const QVideoFrameFormat::ColorTransfer, colorTransfer);
+
+    QVideoFrame frame = createFrame(size, pixelFormat, colorTransfer);
+    const VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
+    QVERIFY(convert);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    QImage image(frame.size(), QImage::Format_ARGB32);
+
+    QBENCHMARK {
+        convert(frame, image.bits());
+    }
+
+    frame.unmap();
+}
+
+void tst_QVideoFrameConverter::qImageFromVideoFrame_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<Converter>("converter");
+
+    const std::pair<Converter, const char *> converters[] = {
+        { Converter::Cpu, "CPU" },
+        { Converter::Rhi, "RHI" },
+        { Converter::NullRhi, "Null RHI" },
+    };
+
+    const QVideoFrameFormat::PixelFormat pixelFormats[] = {
+        QVideoFrameFormat::Format_NV12,
+        QVideoFrameFormat::Format_YUV420P,
+        QVideoFrameFormat::Format_P010,
+        QVideoFrameFormat::Format_BGRA8888,
+    };
+
+    for (auto pixelFormat : pixelFormats) {
+        const QByteArray formatName =
+                QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+
+        for (const auto &[converter, converterName] : converters)
+            QTest::addRow("%s, 1080p, %s", formatName.constData(), converterName)
+                    << pixelFormat << converter;
+    }
+}
+
+// Compares the conversion on the CPU with the one on the QRhi that qImageFromVideoFrame()
+// creates, e.g. OpenGL on a software rasterizer on headless machines. The conversion on
+// the Null QRhi shows the overhead of the GPU path without any rendering.
+void tst_QVideoFrameConverter::qImageFromVideoFrame()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(const Converter, converter);
+
+    const QVideoFrame frame = createFrame({ 1920, 1080 }, pixelFormat);
+    std::unique_ptr<QRhi> nullRhi;
+    QVideoFrame convertedFrame = frame;
+
+    switch (converter) {
+    case Converter::Cpu:
+        break;
+    case Converter::Rhi:
+        if (!isRhiRenderingSupported())
+            QSKIP("The platform doesn't support rendering with QRhi");
+        break;
+    case Converter::NullRhi: {
+        QRhiNullInitParams params;
+        nullRhi.reset(QRhi::create(QRhi::Null, &params));
+        QVERIFY(nullRhi);
+        convertedFrame = QVideoFramePrivate::createFrame(
+                std::make_unique<RhiFrameBuffer>(frame, nullRhi.get()), frame.surfaceFormat());
+        break;
+    }
+    }
+
+    const bool forceCpu = converter == Converter::Cpu;
+
+    QBENCHMARK {
+        const QImage image = ::qImageFromVideoFrame(convertedFrame, forceCpu);
+        QVERIFY(!image.isNull());
+    }
+}
+
+QTEST_MAIN(tst_QVideoFrameConverter)
+
+#include "tst_bench_qvideoframeconverter.moc"
@@ -0,0 +1,103 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtMultimedia/private/qvideotexturehelper_p.h>
+#include <rhi/qrhi.h>
+
+QT_USE_NAMESPACE
+
+class tst_QVideoTextureHelper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void createTextures_data();
+    void createTextures();
+
+private:
+    std::unique_ptr<QRhi> m_rhi;
+};
+
+void tst_QVideoTextureHelper::initTestCase()
+{
+    QRhiNullInitParams params;
+    m_rhi.reset(QRhi::create(QRhi::Null, &params));
+    QVERIFY(m_rhi);
+}
+
+void tst_QVideoTextureHelper::cleanupTestCase()
+{
+    m_rhi.reset();
+}
+
+void tst_QVideoTextureHelper::createTextures_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<bool>("reuseTextures");
+
+    const std::pair<QSize, const char *> sizes[] = {
+        { { 1280, 720 }, "720p" },
+        { { 1920, 1080 }, "1080p" },
+        { { 3840, 2160 }, "4K" },
+    };
+
+    for (int i = QVideoFrameFormat::Format_Invalid + 1; i < QVideoFrameFormat::NPixelFormats; ++i) {
+        const auto pixelFormat = QVideoFrameFormat::PixelFormat(i);
+        if (pixelFormat == QVideoFrameFormat::Format_SamplerExternalOES
+            || pixelFormat == QVideoFrameFormat::Format_SamplerRect
+            || pixelFormat == QVideoFrameFormat::Format_Jpeg)
+            continue; // Not uploaded from plain memory
+
+        const QByteArray formatName =
+                QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+        for (const auto &[size, sizeName] : sizes) {
+            QTest::addRow("%s, %s, pooled textures", formatName.constData(), sizeName)
+                    << pixelFormat << size << false;
+            QTest::addRow("%s, %s, previous textures", formatName.constData(), sizeName)
+                    << pixelFormat << size << true;
+        }
+    }
+}
+
+// Measures the preparation of the uploads of memory frames, as done by the video sinks
+// for each frame, on the Null QRhi so that no driver is involved. Reusing the textures of
+// the previous frame is the steady state of playback; otherwise they go through the
+// texture pool of the QRhi, as when sinks are created and destroyed. Set
+// QT_MEDIA_PACKED_10BIT_UPLOAD=1 to measure the packed upload of the 10-bit formats.
+void tst_QVideoTextureHelper::createTextures()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(const QSize, size);
+    QFETCH(const bool, reuseTextures);
+
+    QVideoFrame frame(QVideoFrameFormat(size, pixelFormat));
+    if (!frame.isValid())
+        QSKIP("The frame can't be allocated");
+
+    std::unique_ptr<QVideoFrameTextures> textures;
+
+    QBENCHMARK {
+        QRhiCommandBuffer *cb = nullptr;
+        QCOMPARE(m_rhi->beginOffscreenFrame(&cb), QRhi::FrameOpSuccess);
+
+        QRhiResourceUpdateBatch *rub = m_rhi->nextResourceUpdateBatch();
+        if (!reuseTextures)
+            textures.reset();
+        textures = QVideoTextureHelper::createTextures(frame, m_rhi.get(), rub,
+                                                       std::move(textures));
+        QVERIFY(textures);
+        cb->resourceUpdate(rub);
+
+        m_rhi->endOffscreenFrame();
+    }
+}
+
+QTEST_MAIN(tst_QVideoTextureHelper)
+
+#include "tst_bench_qvideotexturehelper.moc"